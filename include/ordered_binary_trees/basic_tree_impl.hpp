@@ -81,6 +81,15 @@ struct BasicTreeImpl {
     return tree.find_node_at_index(index);
   }
 
+  /**
+   *  @brief
+   *  Called when the node at an index is found without
+   *    `find_node_at_index()`, e.g., by the index cache of `ManagedTree`.
+   *
+   *  This basic implementation does nothing.
+   */
+  static constexpr void record_access(Tree&, NodePtr) {}
+
   /**
    *  @brief
    *  Constructs a new node and places it as the first node in a tree.
@@ -188,16 +197,18 @@ struct BasicTreeImpl {
 
   /**
    *  @brief
-   *  Clears the tree and assigns values from `[input_begin, input_end)` to the
-   *    tree.
+   *  Replaces the values in the tree with values from
+   *    `[input_begin, input_end)`.
+   *
+   *  Existing nodes are reused, and the result is balanced.
+   *  (See `OrderedBinaryTree::assign_reusing_nodes()`.)
    */
   template<class InputIterator>
   static constexpr void assign(
       Tree& tree,
       InputIterator input_begin,
       InputIterator input_end) {
-    tree.destroy_all_nodes();
-    insert_nodes_before(tree, tree.first, input_begin, input_end);
+    tree.assign_reusing_nodes(input_begin, input_end);
   }
 
   /**
@@ -0,0 +1,1106 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/tiered_vector_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Write-optimized sequence: a B-epsilon tree whose internal nodes buffer
+ *    positional insertions and erasures.
+ *
+ *  Leaves hold up to `kLeafCapacity` values in arrays.
+ *  Each internal node holds up to `kFanout` children, the number of values
+ *    under each child, and a buffer of up to `kBufferCapacity` pending
+ *    *messages*.
+ *  A message is an insertion or an erasure at an index relative to the
+ *    sequence that the node's children would represent once all messages
+ *    before it have been applied.
+ *
+ *  An insertion or erasure only appends a message to the root's buffer.
+ *  When a buffer fills up, all of its messages are routed to the children in
+ *    one batch: each message's index is rebased on the child it falls in,
+ *    and the message is either applied to a leaf or appended to the child's
+ *    buffer, which may in turn be flushed.
+ *  Each flush moves `kBufferCapacity` messages down one level while touching
+ *    at most `kFanout` children, so the amortized cost of a modification is
+ *    far below one node visit per level.
+ *  Nodes are split and merged only right after their buffers are flushed.
+ *
+ *  Reads do not modify the tree.
+ *  `operator[]` walks from the root to a leaf and, at each internal node,
+ *    replays the node's buffer backwards to translate the index; if the
+ *    index lands on a pending insertion, the value is read from the message.
+ *  Iterators use the same lookup, and step through contiguous runs of leaf
+ *    values that no pending message splits.
+ *  `flush()` applies every pending message, after which reads only visit
+ *    leaves and iteration runs through whole leaves.
+ *
+ *  Like `TieredVector`, this class uses `TieredVectorIterator`, whose
+ *    iterators refer to positions rather than elements.
+ *  References and iterators are invalidated by every modification.
+ *
+ *  The public interface mirrors that of `ManagedTree`, so this class can be
+ *    used through `ManagedTree<BufferedTreeImpl<...>>`.
+ */
+template<
+    class ValueT,
+    class AllocatorT = std::allocator<ValueT>,
+    std::size_t kLeafCapacity =
+        std::max<std::size_t>(16, 1024 / sizeof(ValueT)),
+    std::size_t kFanout = 16,
+    std::size_t kBufferCapacity = 64>
+class BufferedTree {
+  static_assert(kLeafCapacity >= 4, "BufferedTree -- leaves are too small");
+  static_assert(kFanout >= 4, "BufferedTree -- fanout is too small");
+  static_assert(kBufferCapacity >= 1, "BufferedTree -- buffers are too small");
+
+ private:
+  /// This type.
+  using This = BufferedTree<
+      ValueT, AllocatorT, kLeafCapacity, kFanout, kBufferCapacity>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<value_type>;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// `difference_type` derived from `allocator_type`.
+  using difference_type = typename std::allocator_traits<allocator_type>::
+      difference_type;
+
+  /// `value_type&`.
+  using reference = value_type&;
+
+  /// `value_type const&`.
+  using const_reference = value_type const&;
+
+  /// `pointer` type dervied from `allocator_type`.
+  using pointer = typename std::allocator_traits<allocator_type>::pointer;
+
+  /// `const_pointer` type dervied from `allocator_type`.
+  using const_pointer = typename std::allocator_traits<allocator_type>::
+      const_pointer;
+
+ protected:
+  /// Parametrized iterator type.
+  template<bool constant = false, bool reverse = false>
+  using p_iterator = TieredVectorIterator<This, constant, reverse>;
+
+  template<class SequenceT, bool constant, bool reverse>
+  friend class TieredVectorIterator;
+
+ public:
+  /// Type of iterators.
+  using iterator = p_iterator<false, false>;
+  /// Type of const-iterators.
+  using const_iterator = p_iterator<true, false>;
+  /// Type of reverse-iterators.
+  using reverse_iterator = p_iterator<false, true>;
+  /// Type of const-reverse-iterators.
+  using const_reverse_iterator = p_iterator<true, true>;
+
+ protected:
+  /// Allocator for values of type `T`.
+  template<class T>
+  using RebindAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<T>;
+
+  struct Node;
+
+  /**
+   *  @brief
+   *  Pending insertion or erasure.
+   */
+  struct Message {
+    /// Index in the sequence of the node that holds the message.
+    size_type index;
+    /// Inserted value, or nothing for an erasure.
+    std::optional<value_type> value;
+  };
+
+  /**
+   *  @brief
+   *  Child of an internal node.
+   */
+  struct Child {
+    /// Child node.
+    Node* node;
+    /// Number of values under `node`, with `node`'s messages applied.
+    size_type count;
+  };
+
+  /**
+   *  @brief
+   *  Leaf or internal node.
+   *
+   *  A leaf only uses `values`; an internal node uses `children` and
+   *    `buffer`.
+   *  All leaves are at the same depth.
+   */
+  struct Node {
+    Node(bool leaf, allocator_type const& allocator)
+      : values(allocator),
+        children(RebindAllocator<Child>(allocator)),
+        buffer(RebindAllocator<Message>(allocator)),
+        leaf{leaf} {}
+
+    /// Values in a leaf.
+    std::vector<value_type, allocator_type> values;
+    /// Children of an internal node.
+    std::vector<Child, RebindAllocator<Child>> children;
+    /// Pending messages of an internal node, oldest first.
+    std::vector<Message, RebindAllocator<Message>> buffer;
+    /// Whether this node is a leaf.
+    bool leaf;
+  };
+
+  /// Allocator for nodes.
+  using NodeAllocator = RebindAllocator<Node>;
+
+  /// Type of lists of children.
+  using Children = std::vector<Child, RebindAllocator<Child>>;
+
+  /// Allocator for values.
+  mutable allocator_type allocator_;
+
+  /// Root, or null if the sequence is empty.
+  Node* root_{nullptr};
+
+  /// Number of elements.
+  size_type size_{0};
+
+  /// Creates an empty node.
+  Node* new_node(bool leaf) {
+    NodeAllocator node_allocator{allocator_};
+    Node* n{std::allocator_traits<NodeAllocator>::allocate(node_allocator, 1)};
+    std::allocator_traits<NodeAllocator>::construct(
+        node_allocator, n, leaf, allocator_);
+    return n;
+  }
+
+  /// Destroys one node without its children.
+  void delete_node(Node* n) {
+    NodeAllocator node_allocator{allocator_};
+    std::allocator_traits<NodeAllocator>::destroy(node_allocator, n);
+    std::allocator_traits<NodeAllocator>::deallocate(node_allocator, n, 1);
+  }
+
+  /// Destroys `n` and all its descendants.
+  void delete_subtree(Node* n) {
+    for (Child const& child : n->children) {
+      delete_subtree(child.node);
+    }
+    delete_node(n);
+  }
+
+  /// Returns `true` if `n` is below its minimum occupancy.
+  static bool is_underfull(Node const* n) {
+    return n->leaf
+        ? n->values.size() < kLeafCapacity / 4
+        : n->children.size() < kFanout / 4;
+  }
+
+  /// Returns `true` if `n` is above its capacity.
+  static bool is_overfull(Node const* n) {
+    return n->leaf
+        ? n->values.size() > kLeafCapacity
+        : n->children.size() > kFanout;
+  }
+
+  /// Applies the messages in `n`'s buffer if it has any.
+  void make_current(Node* n) {
+    if (!n->leaf && !n->buffer.empty()) {
+      flush_node(n);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Routes every message in the buffer of `n` to its children, then fixes
+   *    the children's sizes.
+   */
+  void flush_node(Node* n) {
+    assert(!n->leaf);
+    Children& children{n->children};
+    for (Message& message : n->buffer) {
+      size_type index{message.index};
+      std::size_t c{0};
+      if (message.value) {
+        while (c + 1 < children.size() && index > children[c].count) {
+          index -= children[c].count;
+          ++c;
+        }
+      } else {
+        while (index >= children[c].count) {
+          index -= children[c].count;
+          ++c;
+          assert(c < children.size());
+        }
+      }
+      Child& child{children[c]};
+      if (message.value) {
+        ++child.count;
+      } else {
+        --child.count;
+      }
+      if (!child.node->leaf) {
+        child.node->buffer.push_back(Message{index, std::move(message.value)});
+      } else if (message.value) {
+        child.node->values.insert(
+            child.node->values.begin() + index, std::move(*message.value));
+      } else {
+        child.node->values.erase(child.node->values.begin() + index);
+      }
+    }
+    n->buffer.clear();
+    for (Child const& child : children) {
+      if (!child.node->leaf && child.node->buffer.size() >= kBufferCapacity) {
+        flush_node(child.node);
+      }
+    }
+    normalize(n);
+  }
+
+  /// Moves the children of `from` to the end of `to`, and deletes `from`.
+  void merge_nodes(Child& to, Child& from) {
+    if (to.node->leaf) {
+      to.node->values.insert(to.node->values.end(),
+          std::make_move_iterator(from.node->values.begin()),
+          std::make_move_iterator(from.node->values.end()));
+    } else {
+      to.node->children.insert(to.node->children.end(),
+          from.node->children.begin(), from.node->children.end());
+      from.node->children.clear();
+    }
+    to.count += from.count;
+    delete_node(from.node);
+  }
+
+  /// Appends `child` to `out`, split into pieces if it is overfull.
+  void split_into(Children& out, Child child) {
+    Node* n{child.node};
+    std::size_t const length{n->leaf ? n->values.size() : n->children.size()};
+    std::size_t const capacity{n->leaf ? kLeafCapacity : kFanout};
+    if (length <= capacity) {
+      out.push_back(child);
+      return;
+    }
+    std::size_t const piece{std::max<std::size_t>(capacity * 3 / 4, 1)};
+    std::size_t const num_pieces{(length + piece - 1) / piece};
+    for (std::size_t k{num_pieces - 1}; k > 0; --k) {
+      std::size_t const first{length * k / num_pieces};
+      std::size_t const last{length * (k + 1) / num_pieces};
+      Node* m{new_node(n->leaf)};
+      size_type count{0};
+      if (n->leaf) {
+        m->values.assign(
+            std::make_move_iterator(n->values.begin() + first),
+            std::make_move_iterator(n->values.begin() + last));
+        count = m->values.size();
+      } else {
+        m->children.assign(
+            n->children.begin() + first, n->children.begin() + last);
+        for (Child const& grandchild : m->children) {
+          count += grandchild.count;
+        }
+      }
+      if (n->leaf) {
+        n->values.erase(n->values.begin() + first, n->values.end());
+      } else {
+        n->children.erase(n->children.begin() + first, n->children.end());
+      }
+      child.count -= count;
+      out.push_back(Child{m, count});
+    }
+    out.push_back(child);
+    std::reverse(out.end() - num_pieces, out.end());
+  }
+
+  /**
+   *  @brief
+   *  Removes empty children of `n` and merges or splits children that are
+   *    underfull or overfull.
+   *
+   *  Internal children are flushed before they are merged or split.
+   */
+  void normalize(Node* n) {
+    Children& children{n->children};
+    Children merged{children.get_allocator()};
+    merged.reserve(children.size());
+    for (Child child : children) {
+      if (child.count == 0) {
+        delete_subtree(child.node);
+        continue;
+      }
+      if (is_underfull(child.node) || is_overfull(child.node)) {
+        make_current(child.node);
+      }
+      if (!merged.empty() &&
+          (is_underfull(merged.back().node) || is_underfull(child.node))) {
+        make_current(merged.back().node);
+        make_current(child.node);
+        merge_nodes(merged.back(), child);
+        continue;
+      }
+      merged.push_back(child);
+    }
+    children.clear();
+    for (Child child : merged) {
+      if (is_overfull(child.node)) {
+        make_current(child.node);
+      }
+      split_into(children, child);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Grows or shrinks the tree at the root after the root has changed.
+   */
+  void fix_root() {
+    while (root_) {
+      if (is_overfull(root_)) {
+        make_current(root_);
+        Node* n{new_node(false)};
+        n->children.push_back(Child{root_, size_});
+        normalize(n);
+        root_ = n;
+      } else if (root_->leaf) {
+        if (root_->values.empty()) {
+          delete_node(root_);
+          root_ = nullptr;
+        }
+        return;
+      } else if (root_->buffer.empty() && root_->children.size() <= 1) {
+        Node* n{root_};
+        root_ = n->children.empty() ? nullptr : n->children.front().node;
+        n->children.clear();
+        delete_node(n);
+      } else {
+        return;
+      }
+    }
+  }
+
+  /// Flushes `n` and all its descendants.
+  void flush_subtree(Node* n) {
+    if (n->leaf) {
+      return;
+    }
+    make_current(n);
+    for (Child const& child : n->children) {
+      flush_subtree(child.node);
+    }
+    normalize(n);
+  }
+
+  /// Inserts `value` at `index`.
+  void insert_at(size_type index, value_type&& value) {
+    assert(index <= size_);
+    if (!root_) {
+      root_ = new_node(true);
+    }
+    if (root_->leaf) {
+      root_->values.insert(root_->values.begin() + index, std::move(value));
+      ++size_;
+    } else {
+      root_->buffer.push_back(Message{index, std::move(value)});
+      ++size_;
+      if (root_->buffer.size() >= kBufferCapacity) {
+        flush_node(root_);
+      }
+    }
+    fix_root();
+  }
+
+  /// Erases the element at `index`.
+  void erase_at(size_type index) {
+    assert(index < size_);
+    if (root_->leaf) {
+      root_->values.erase(root_->values.begin() + index);
+      --size_;
+    } else {
+      root_->buffer.push_back(Message{index, std::nullopt});
+      --size_;
+      if (root_->buffer.size() >= kBufferCapacity) {
+        flush_node(root_);
+      }
+    }
+    fix_root();
+  }
+
+  /**
+   *  @brief
+   *  Returns the element at `index` together with the contiguous run of
+   *    memory around it whose elements have consecutive indices.
+   *
+   *  At each internal node, the index is translated through the node's
+   *    messages from newest to oldest, and the run is narrowed so that it
+   *    does not cross a message's position or a child boundary.
+   */
+  std::tuple<value_type*, value_type*, value_type*> locate_run(
+      size_type index) const {
+    assert(index < size_);
+    Node* n{root_};
+    size_type before{index};
+    size_type after{size_ - index};
+    while (!n->leaf) {
+      for (auto it{n->buffer.rbegin()}; it != n->buffer.rend(); ++it) {
+        size_type const p{it->index};
+        if (it->value) {
+          if (p == index) {
+            value_type* v{std::addressof(*it->value)};
+            return {v, v, v + 1};
+          } else if (p < index) {
+            before = std::min(before, index - p - 1);
+            --index;
+          } else {
+            after = std::min(after, p - index);
+          }
+        } else if (p <= index) {
+          before = std::min(before, index - p);
+          ++index;
+        } else {
+          after = std::min(after, p - index);
+        }
+      }
+      auto child{n->children.begin()};
+      while (index >= child->count) {
+        index -= child->count;
+        ++child;
+        assert(child != n->children.end());
+      }
+      before = std::min(before, index);
+      after = std::min(after, child->count - index);
+      n = child->node;
+    }
+    value_type* v{n->values.data() + index};
+    return {v, v - before, v + after};
+  }
+
+  /// Returns the element at `index`.
+  value_type* locate(size_type index) const {
+    return std::get<0>(locate_run(index));
+  }
+
+  /// Converts `index` into an iterator.
+  template<bool constant = false, bool reverse = false>
+  p_iterator<constant, reverse> make_iterator(size_type index) const {
+    return {const_cast<This*>(this), index};
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty sequence with a given `allocator`.
+   */
+  BufferedTree(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence using the given `allocator`.
+   */
+  BufferedTree(This const& other, allocator_type const& allocator)
+    : BufferedTree{allocator} {
+    for (auto const& value : other) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence. The allocator is copied via
+   *    `select_on_container_copy_construction()`.
+   */
+  BufferedTree(This const& other)
+    : BufferedTree{other,
+        std::allocator_traits<allocator_type>::
+          select_on_container_copy_construction(other.allocator_)} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence if `allocator != other.allocator`,
+   *    or takes ownership of the data from another sequence otherwise.
+   */
+  BufferedTree(This&& other, allocator_type const& allocator)
+    : BufferedTree{allocator} {
+    if (allocator_ == other.allocator_) {
+      std::swap(root_, other.root_);
+      std::swap(size_, other.size_);
+    } else {
+      for (auto& value : other) {
+        emplace_back(std::move(value));
+      }
+      other.clear();
+    }
+  }
+
+  /**
+   *  @brief
+   *  Moves data from another sequence.
+   */
+  BufferedTree(This&& other)
+    : allocator_{std::move(other.allocator_)},
+      root_{std::exchange(other.root_, nullptr)},
+      size_{std::exchange(other.size_, 0)} {}
+
+  /**
+   *  @brief
+   *  Destroys the sequence.
+   */
+  ~BufferedTree() {
+    clear();
+  }
+
+  /**
+   *  @brief
+   *  Empties the sequence.
+   */
+  void clear() {
+    if (root_) {
+      delete_subtree(root_);
+      root_ = nullptr;
+    }
+    size_ = 0;
+  }
+
+  /**
+   *  @brief
+   *  Copies the sequence from `other`.
+   */
+  This& operator=(This const& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_copy_assignment::value) {
+      allocator_ = other.allocator_;
+    }
+    for (auto const& value : other) {
+      emplace_back(value);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes the sequence from `other`.
+   */
+  This& operator=(This&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_move_assignment::value) {
+      allocator_ = std::move(other.allocator_);
+    }
+    swap(other);
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Swaps this sequence with `other`.
+   */
+  void swap(This& other) {
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_swap::value) {
+      using std::swap;
+      swap(allocator_, other.allocator_);
+    }
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements in the sequence.
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the sequence is empty.
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns the allocator.
+   */
+  allocator_type get_allocator() const noexcept {
+    return allocator_;
+  }
+
+  /**
+   *  @brief
+   *  Applies every pending message.
+   *
+   *  This takes O(n) time in the worst case.
+   *  Afterwards, reads visit no messages until the sequence is modified.
+   */
+  void flush() {
+    if (root_) {
+      flush_subtree(root_);
+      fix_root();
+    }
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `[first, last)` to it.
+   */
+  template<class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    clear();
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `ilist` to it.
+   */
+  template<class V>
+  void assign(std::initializer_list<V> ilist) {
+    assign(ilist.begin(), ilist.end());
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns `n` copies of `value` to it.
+   */
+  void assign(size_type n, value_type const& value) {
+    clear();
+    for (size_type i{0}; i < n; ++i) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference operator[](size_type index) {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference operator[](size_type index) const {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("BufferedTree::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("BufferedTree::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  reference front() {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  const_reference front() const {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  reference back() {
+    return *locate(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  const_reference back() const {
+    return *locate(size_ - 1);
+  }
+
+  /// Returns the iterator to the first element.
+  iterator begin() {
+    return make_iterator(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator begin() const {
+    return make_iterator<true>(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  /// Returns the reverse-iterator to the last element.
+  reverse_iterator rbegin() {
+    return make_iterator<false, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator rbegin() const {
+    return make_iterator<true, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator crbegin() const {
+    return rbegin();
+  }
+
+  /// Returns the past-the-end iterator.
+  iterator end() {
+    return make_iterator(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator end() const {
+    return make_iterator<true>(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator cend() const {
+    return end();
+  }
+
+  /// Returns the past-the-beginning reverse-iterator.
+  reverse_iterator rend() {
+    return make_iterator<false, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator rend() const {
+    return make_iterator<true, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator crend() const {
+    return rend();
+  }
+
+  /**
+   *  @brief
+   *  Returns an iterator for the `index`-th element.
+   */
+  iterator get_iterator_at_index(size_type index) {
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Returns a const-iterator for the `index`-th element.
+   */
+  const_iterator get_iterator_at_index(size_type index) const {
+    return make_iterator<true>(index);
+  }
+
+  /// Returns an iterator for the first element.
+  iterator get_front_iterator() {
+    return begin();
+  }
+
+  /// Returns a const-iterator for the first element.
+  const_iterator get_front_iterator() const {
+    return begin();
+  }
+
+  /// Returns an iterator for the last element.
+  iterator get_back_iterator() {
+    assert(!empty());
+    return make_iterator(size_ - 1);
+  }
+
+  /// Returns a const-iterator for the last element.
+  const_iterator get_back_iterator() const {
+    assert(!empty());
+    return make_iterator<true>(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Converts a const-iterator to a regular iterator.
+   *
+   *  This function works on reverse iterators also.
+   */
+  template<bool constant = false, bool reverse = false>
+  p_iterator<false, reverse> make_mutable_iterator(
+      p_iterator<constant, reverse> it) const {
+    return make_iterator<false, reverse>(it.index_);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type const& value) {
+    return emplace(pos, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a new `value` and inserts it right before `pos`, then returns
+   *    the iterator to the newly inserted value.
+   */
+  template<bool constant, class... Args>
+  iterator emplace(p_iterator<constant> pos, Args&&... args) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    insert_at(index, value_type(std::forward<Args>(args)...));
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Inserts a list of values from `[first, last)` right before `pos`, then
+   *    returns the iterator to the first value that was inserted.
+   *
+   *  Each value becomes one message.
+   */
+  template<bool constant, class InputIterator>
+  iterator insert(
+      p_iterator<constant> pos,
+      InputIterator first,
+      InputIterator last) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    std::vector<value_type, allocator_type> values(first, last, allocator_);
+    for (size_type i{0}; i < values.size(); ++i) {
+      insert_at(index + i, std::move(values[i]));
+    }
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Moves elements from `other` right before `pos`, then returns the iterator
+   *    to the first moved element.
+   *
+   *  `other` will be empty afterwards.
+   */
+  template<bool constant>
+  iterator join(p_iterator<constant> pos, This& other) {
+    assert(pos.seq_ == this);
+    if (empty() && allocator_ == other.allocator_) {
+      swap(other);
+      return begin();
+    }
+    iterator it{insert(
+        pos,
+        std::make_move_iterator(other.begin()),
+        std::make_move_iterator(other.end()))};
+    other.clear();
+    return it;
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(begin(), other)`.
+   */
+  iterator join_front(This& other) {
+    return join(begin(), other);
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(end(), other)`.
+   */
+  iterator join_back(This& other) {
+    return join(end(), other);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type const& value) {
+    emplace_front(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type&& value) {
+    emplace_front(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the first element.
+   */
+  template<class... Args>
+  void emplace_front(Args&&... args) {
+    insert_at(0, value_type(std::forward<Args>(args)...));
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the last element.
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    insert_at(size_, value_type(std::forward<Args>(args)...));
+  }
+
+  /**
+   *  @brief
+   *  Erases an element pointed to by `pos`, then returns the iterator to the
+   *    position right after `pos`.
+   */
+  template<bool constant>
+  iterator erase(p_iterator<constant> pos) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    erase_at(index);
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Erases elements in the interval `[first, last)`, then returns the
+   *    iterator to the position right after the erased elements.
+   */
+  template<bool constant_1, bool constant_2>
+  iterator erase(
+      p_iterator<constant_1> first,
+      p_iterator<constant_2> last) {
+    assert(first.seq_ == this);
+    assert(last.seq_ == this);
+    assert(first <= last);
+    size_type const begin_index{first.index_};
+    size_type const count{last.index_ - begin_index};
+    for (size_type i{0}; i < count; ++i) {
+      erase_at(begin_index);
+    }
+    return make_iterator(begin_index);
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    assert(!empty());
+    erase_at(0);
+  }
+
+  /**
+   *  @brief
+   *  Erases the last element.
+   */
+  void pop_back() {
+    assert(!empty());
+    erase_at(size_ - 1);
+  }
+
+};
+
+/**
+ *  @brief
+ *  Implementation struct that makes `ManagedTree<BufferedTreeImpl<...>>` a
+ *    `BufferedTree`.
+ *
+ *  A buffered tree suits insert-heavy ingest: modifications are batched in
+ *    internal node buffers and pushed down together, at the cost of reads
+ *    having to look through the buffers on their path.
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+struct BufferedTreeImpl {
+  /// This type.
+  using This = BufferedTreeImpl<ValueT, AllocatorT>;
+
+  /// Type of values to present to the user.
+  using Value = ValueT;
+
+  /// Type of allocators for `Value`.
+  using ValueAllocator = AllocatorT;
+
+  /// Container that provides the interface of `ManagedTree`.
+  using Container = BufferedTree<Value, ValueAllocator>;
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,452 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/managed_tree.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Resumable in-order traversal of a `ManagedTree`, e.g., for writing it out
+ *    a few elements at a time from an event loop.
+ *
+ *  Each call to `step(budget)` calls `f(value)` for at most `budget` more
+ *    elements.
+ *  The cursor holds an iterator to the next element, so the tree may be
+ *    edited between steps as long as that element is not erased.
+ *  Elements inserted before the cursor are not visited.
+ */
+template<class TreeImplT, class F>
+class TraversalCursor {
+ public:
+  /// Type of the sequence being traversed.
+  using managed_type = ManagedTree<TreeImplT>;
+
+  /// `managed_type::size_type`.
+  using size_type = typename managed_type::size_type;
+
+ protected:
+  /// Next element to visit.
+  typename managed_type::const_iterator next_;
+
+  /// Past-the-end iterator.
+  typename managed_type::const_iterator end_;
+
+  /// Function to call for each element.
+  F f_;
+
+ public:
+  /**
+   *  @brief
+   *  Creates a cursor at the first element of `tree`.
+   */
+  TraversalCursor(managed_type const& tree, F f)
+    : next_{tree.begin()}, end_{tree.end()}, f_{std::move(f)} {}
+
+  /**
+   *  @brief
+   *  Returns `true` iff all elements have been visited.
+   */
+  bool done() const {
+    return next_ == end_;
+  }
+
+  /**
+   *  @brief
+   *  Visits at most `budget` elements, and returns `done()`.
+   */
+  bool step(size_type budget) {
+    for (; budget > 0 && next_ != end_; --budget) {
+      // Advance first, so `f_` may erase the element it is given.
+      auto it{next_++};
+      f_(*it);
+    }
+    return done();
+  }
+};
+
+/**
+ *  @brief
+ *  Resumable destruction of nodes that are no longer part of any tree.
+ *
+ *  The constructor takes all elements of a `ManagedTree` in O(1) time and
+ *    leaves it empty, so the tree can be reused right away.
+ *  Each call to `step(budget)` then does at most `budget` units of work,
+ *    where a unit destroys a node or performs a rotation.
+ *  Rotations move left children onto the right spine, so no stack is needed
+ *    and the total work is O(n).
+ *
+ *  Nodes that are left when the cursor is destroyed are destroyed in the
+ *    destructor.
+ */
+template<class TreeImplT>
+class DestructionCursor {
+ private:
+  /// This class.
+  using This = DestructionCursor<TreeImplT>;
+
+ public:
+  /// Type of sequences whose elements can be taken.
+  using managed_type = ManagedTree<TreeImplT>;
+
+ protected:
+  /// Type of trees. Only `allocator` and `root` are used.
+  using Tree = typename TreeImplT::Tree;
+
+  /// Type of node pointers.
+  using NodePtr = typename Tree::NodePtr;
+
+  /// Type of node allocators.
+  using Allocator = typename Tree::Allocator;
+
+ public:
+  /// `Tree::size_type`.
+  using size_type = typename Tree::size_type;
+
+ protected:
+  /// Owner of the nodes left to destroy.
+  Tree tree_;
+
+ public:
+  /**
+   *  @brief
+   *  Takes the subtree rooted at `root`, whose nodes were allocated by
+   *    `allocator`.
+   *
+   *  `root` must not be part of a tree that is still in use.
+   */
+  DestructionCursor(Allocator const& allocator, NodePtr root)
+    : tree_{allocator} {
+    tree_.root = root;
+  }
+
+  /**
+   *  @brief
+   *  Takes all elements of `tree`, leaving it empty.
+   */
+  explicit DestructionCursor(managed_type& tree)
+    : tree_{tree.tree_.allocator} {
+    tree.record_change(ChangeKind::kErase, 0, tree.size());
+    tree_.root = tree.tree_.root;
+    tree.tree_.clear();
+  }
+
+  DestructionCursor(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the nodes that are left.
+   */
+  ~DestructionCursor() {
+    while (!step(~size_type{0})) {}
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff all nodes have been destroyed.
+   */
+  bool done() const {
+    return !tree_.root;
+  }
+
+  /**
+   *  @brief
+   *  Does at most `budget` units of work, and returns `done()`.
+   */
+  bool step(size_type budget) {
+    NodePtr n{tree_.root};
+    for (; budget > 0 && n; --budget) {
+      NodePtr l{n->left_child};
+      if (l) {
+        n->left_child = l->right_child;
+        l->right_child = n;
+        n = l;
+      } else {
+        NodePtr r{n->right_child};
+        tree_.destroy_node(n);
+        n = r;
+      }
+    }
+    tree_.root = n;
+    return done();
+  }
+};
+
+/**
+ *  @brief
+ *  Resumable copy of a `ManagedTree`.
+ *
+ *  Each call to `step(budget)` copies at most `budget` nodes, in pre-order
+ *    with an explicit stack, into a tree of the same shape.
+ *  The source must not be modified or accessed by index, which may splay it,
+ *    until the copy is done.
+ *  `take()` then returns the copy.
+ *
+ *  A partial copy is destroyed with the cursor.
+ */
+template<class TreeImplT>
+class CloneCursor {
+ private:
+  /// This class.
+  using This = CloneCursor<TreeImplT>;
+
+ public:
+  /// Type of the sequence being copied.
+  using managed_type = ManagedTree<TreeImplT>;
+
+ protected:
+  /// Type of trees.
+  using Tree = typename TreeImplT::Tree;
+
+  /// Type of node pointers.
+  using NodePtr = typename Tree::NodePtr;
+
+  /// Type of const node pointers.
+  using ConstNodePtr = typename Tree::ConstNodePtr;
+
+ public:
+  /// `Tree::size_type`.
+  using size_type = typename Tree::size_type;
+
+ protected:
+  /// Source node whose copy is yet to be created.
+  struct Pending {
+    /// Node to copy.
+    ConstNodePtr source;
+    /// Copy of the parent of `source`.
+    NodePtr parent;
+    /// `true` iff `source` is a right child.
+    bool right;
+  };
+
+  /// The copy, built from the top down.
+  managed_type copy_;
+
+  /// Nodes to copy next, on top of the stack.
+  std::vector<Pending, typename std::allocator_traits<
+      typename Tree::Allocator>::template rebind_alloc<Pending>> stack_;
+
+ public:
+  /**
+   *  @brief
+   *  Creates a cursor that copies `source`.
+   *
+   *  The allocator is copied via `select_on_container_copy_construction()`.
+   */
+  explicit CloneCursor(managed_type const& source)
+    : copy_{std::allocator_traits<typename managed_type::allocator_type>::
+          select_on_container_copy_construction(source.get_allocator())},
+      stack_(typename decltype(stack_)::allocator_type(
+          copy_.tree_.allocator)) {
+    if (source.tree_.root) {
+      stack_.push_back(Pending{source.tree_.root, nullptr, false});
+    }
+  }
+
+  CloneCursor(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys a partial copy without recursion.
+   */
+  ~CloneCursor() {
+    DestructionCursor<TreeImplT>{copy_};
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff all nodes have been copied.
+   */
+  bool done() const {
+    return stack_.empty();
+  }
+
+  /**
+   *  @brief
+   *  Copies at most `budget` nodes, and returns `done()`.
+   */
+  bool step(size_type budget) {
+    Tree& tree{copy_.tree_};
+    for (; budget > 0 && !stack_.empty(); --budget) {
+      Pending const p{stack_.back()};
+      NodePtr n{tree.create_node(p.source->data)};
+      stack_.pop_back();
+      n->size = p.source->size;
+      n->parent = p.parent;
+      if (!p.parent) {
+        tree.root = tree.first = tree.last = n;
+      } else {
+        p.parent->child(p.right) = n;
+        if (p.right ? p.parent == tree.last : p.parent == tree.first) {
+          (p.right ? tree.last : tree.first) = n;
+        }
+      }
+      if (p.source->right_child) {
+        stack_.push_back(Pending{p.source->right_child, n, true});
+      }
+      if (p.source->left_child) {
+        stack_.push_back(Pending{p.source->left_child, n, false});
+      }
+    }
+    return done();
+  }
+
+  /**
+   *  @brief
+   *  Returns the copy. `done()` must be `true`.
+   */
+  managed_type take() {
+    assert(done());
+    return std::move(copy_);
+  }
+};
+
+/**
+ *  @brief
+ *  Resumable construction of a balanced `ManagedTree` from `count` values
+ *    starting at `values`.
+ *
+ *  Each call to `step(budget)` creates at most `budget` nodes, in pre-order
+ *    with an explicit stack, in the same shape as
+ *    `OrderedBinaryTree::build_balanced_from()`.
+ *  `take()` then returns the tree.
+ *  To insert the values into an existing tree without stalling, build them
+ *    with this cursor and pass the result to `ManagedTree::join()`.
+ *
+ *  A partial tree is destroyed with the cursor.
+ */
+template<class TreeImplT, class RandomAccessIterator>
+class BuildCursor {
+ private:
+  /// This class.
+  using This = BuildCursor<TreeImplT, RandomAccessIterator>;
+
+ public:
+  /// Type of the sequence being built.
+  using managed_type = ManagedTree<TreeImplT>;
+
+ protected:
+  /// Type of trees.
+  using Tree = typename TreeImplT::Tree;
+
+  /// Type of node pointers.
+  using NodePtr = typename Tree::NodePtr;
+
+ public:
+  /// `Tree::size_type`.
+  using size_type = typename Tree::size_type;
+
+ protected:
+  /// Balanced subtree that is yet to be created.
+  struct Pending {
+    /// Index of the first value of the subtree.
+    size_type offset;
+    /// Number of values in the subtree.
+    size_type count;
+    /// Parent of the subtree, or null for the root.
+    NodePtr parent;
+    /// `true` iff the subtree is a right subtree.
+    bool right;
+  };
+
+  /// Values to construct nodes from.
+  RandomAccessIterator values_;
+
+  /// The tree, built from the top down.
+  managed_type built_;
+
+  /// Subtrees to create next, on top of the stack.
+  std::vector<Pending, typename std::allocator_traits<
+      typename Tree::Allocator>::template rebind_alloc<Pending>> stack_;
+
+ public:
+  /**
+   *  @brief
+   *  Creates a cursor that builds a tree from `count` values starting at
+   *    `values`.
+   */
+  BuildCursor(
+      RandomAccessIterator values,
+      size_type count,
+      typename managed_type::allocator_type const& allocator =
+          typename managed_type::allocator_type())
+    : values_{values},
+      built_{allocator},
+      stack_(typename decltype(stack_)::allocator_type(
+          built_.tree_.allocator)) {
+    if (count > 0) {
+      stack_.push_back(Pending{0, count, nullptr, false});
+    }
+  }
+
+  BuildCursor(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys a partial tree without recursion.
+   */
+  ~BuildCursor() {
+    DestructionCursor<TreeImplT>{built_};
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff all nodes have been created.
+   */
+  bool done() const {
+    return stack_.empty();
+  }
+
+  /**
+   *  @brief
+   *  Creates at most `budget` nodes, and returns `done()`.
+   */
+  bool step(size_type budget) {
+    Tree& tree{built_.tree_};
+    for (; budget > 0 && !stack_.empty(); --budget) {
+      Pending const p{stack_.back()};
+      size_type const mid{p.count / 2};
+      NodePtr n{tree.create_node(values_[p.offset + mid])};
+      stack_.pop_back();
+      n->size = p.count;
+      n->parent = p.parent;
+      if (!p.parent) {
+        tree.root = tree.first = tree.last = n;
+      } else {
+        p.parent->child(p.right) = n;
+        if (p.right ? p.parent == tree.last : p.parent == tree.first) {
+          (p.right ? tree.last : tree.first) = n;
+        }
+      }
+      if (p.count - mid - 1 > 0) {
+        stack_.push_back(
+            Pending{p.offset + mid + 1, p.count - mid - 1, n, true});
+      }
+      if (mid > 0) {
+        stack_.push_back(Pending{p.offset, mid, n, false});
+      }
+    }
+    return done();
+  }
+
+  /**
+   *  @brief
+   *  Returns the tree. `done()` must be `true`.
+   */
+  managed_type take() {
+    assert(done());
+    return std::move(built_);
+  }
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Kinds of changes reported by `ChangeFeed`.
+ */
+enum class ChangeKind : unsigned char {
+  /// `count` elements were inserted at `index`.
+  kInsert,
+  /// Elements in `[index, index + count)` were erased.
+  kErase,
+  /// `count` elements were joined from another sequence at `index`.
+  kJoin,
+  /// Elements in `[index, index + count)` were modified in place.
+  kUpdate,
+  /// Changes were not recorded; the sequence must be scanned again.
+  kReset,
+};
+
+/**
+ *  @brief
+ *  A change to an indexed sequence, expressed as a range of indices.
+ *
+ *  Indices refer to the sequence right after the change.
+ *  For `kErase`, they refer to the sequence right before the change.
+ */
+template<class SizeT = std::size_t>
+struct ChangeRecord {
+  /// Type of indices.
+  using size_type = SizeT;
+  /// Kind of the change.
+  ChangeKind kind;
+  /// First index affected by the change.
+  size_type index;
+  /// Number of elements affected by the change.
+  size_type count;
+  /// Returns `true` iff all fields are equal.
+  constexpr bool operator==(ChangeRecord const& other) const {
+    return kind == other.kind && index == other.index && count == other.count;
+  }
+  /// Returns `true` iff some fields differ.
+  constexpr bool operator!=(ChangeRecord const& other) const {
+    return !(*this == other);
+  }
+};
+
+/**
+ *  @brief
+ *  Single-producer single-consumer queue of coalesced `ChangeRecord`s.
+ *
+ *  The producer, e.g., a `ManagedTree` given to `set_change_feed()`, calls
+ *    `record()` for every change.
+ *  A change that extends the last recorded one is merged into it, e.g.,
+ *    consecutive `push_back()` calls become one `kInsert`, and erasing
+ *    repeatedly at the same index becomes one `kErase`.
+ *  The merged record is held back until a change that cannot be merged
+ *    arrives, or until the producer calls `flush()`, typically once per
+ *    tick.
+ *
+ *  Published records go into a ring buffer of fixed capacity that is shared
+ *    with the consumer without locks.
+ *  The consumer calls `drain()` or `try_pop()` from another thread.
+ *  If the ring is full, records are dropped, and a `kReset` record is
+ *    published as soon as there is room again.
+ *  A consumer that receives `kReset` should drain the feed and then scan the
+ *    whole sequence.
+ */
+template<class SizeT = std::size_t>
+class ChangeFeed {
+ private:
+  /// This class.
+  using This = ChangeFeed<SizeT>;
+
+ public:
+  /// Type of indices.
+  using size_type = SizeT;
+
+  /// Type of records.
+  using record_type = ChangeRecord<size_type>;
+
+  /// Default number of slots in the ring buffer.
+  static constexpr std::size_t kDefaultCapacity{1024};
+
+ protected:
+  /// Slots of the ring buffer. The number of slots is a power of two.
+  std::unique_ptr<record_type[]> slots_;
+
+  /// `capacity() - 1`.
+  std::size_t mask_;
+
+  /// Number of records published. Written by the producer only.
+  alignas(64) std::atomic<std::size_t> tail_{0};
+
+  /// Number of records consumed. Written by the consumer only.
+  alignas(64) std::atomic<std::size_t> head_{0};
+
+  /// Record that may still be merged with the next change.
+  alignas(64) record_type pending_{};
+
+  /// `true` iff `pending_` holds a record.
+  bool has_pending_{false};
+
+  /// `true` iff records were dropped since the last successful publish.
+  bool lost_{false};
+
+  /// Returns the smallest power of two that is at least `n`.
+  static constexpr std::size_t round_up(std::size_t n) {
+    std::size_t p{1};
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  /**
+   *  @brief
+   *  Merges `next` into `pending_` if the two records describe one
+   *    contiguous change.
+   */
+  bool merge(record_type const& next) {
+    record_type& last{pending_};
+    if (next.kind != last.kind) {
+      return false;
+    }
+    switch (next.kind) {
+      case ChangeKind::kInsert:
+      case ChangeKind::kJoin:
+        // The new elements land inside or at either end of the last block.
+        if (next.index >= last.index &&
+            next.index <= last.index + last.count) {
+          last.count += next.count;
+          return true;
+        }
+        return false;
+      case ChangeKind::kErase:
+        // Erasing forward from the same index, or backward up to it.
+        if (next.index == last.index) {
+          last.count += next.count;
+          return true;
+        }
+        if (next.index + next.count == last.index) {
+          last.index = next.index;
+          last.count += next.count;
+          return true;
+        }
+        return false;
+      case ChangeKind::kUpdate: {
+        // Overlapping or adjacent ranges.
+        if (next.index > last.index + last.count ||
+            last.index > next.index + next.count) {
+          return false;
+        }
+        size_type const end{std::max(
+            last.index + last.count, next.index + next.count)};
+        last.index = std::min(last.index, next.index);
+        last.count = end - last.index;
+        return true;
+      }
+      case ChangeKind::kReset:
+        return true;
+    }
+    return false;
+  }
+
+  /// Pushes `r` into the ring buffer. Returns `false` if it is full.
+  bool push(record_type const& r) {
+    std::size_t const tail{tail_.load(std::memory_order_relaxed)};
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    slots_[tail & mask_] = r;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Publishes `r`, preceded by `kReset` if records were dropped.
+  void publish(record_type const& r) {
+    if (lost_) {
+      if (!push(record_type{ChangeKind::kReset, 0, 0})) {
+        return;
+      }
+      lost_ = false;
+      if (r.kind == ChangeKind::kReset) {
+        return;
+      }
+    }
+    if (!push(r)) {
+      lost_ = true;
+    }
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates a feed whose ring buffer holds at least `capacity` records.
+   */
+  explicit ChangeFeed(std::size_t capacity = kDefaultCapacity)
+    : slots_{new record_type[round_up(capacity < 2 ? 2 : capacity)]},
+      mask_{round_up(capacity < 2 ? 2 : capacity) - 1} {}
+
+  ChangeFeed(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Returns the number of slots in the ring buffer.
+   */
+  std::size_t capacity() const {
+    return mask_ + 1;
+  }
+
+  /**
+   *  @brief
+   *  Records a change. Called by the producer.
+   *
+   *  Records with `count == 0` are ignored, except for `kReset`.
+   */
+  void record(ChangeKind kind, size_type index, size_type count) {
+    if (count == 0 && kind != ChangeKind::kReset) {
+      return;
+    }
+    record_type const next{kind, index, count};
+    if (has_pending_) {
+      if (merge(next)) {
+        return;
+      }
+      publish(pending_);
+    }
+    pending_ = next;
+    has_pending_ = true;
+  }
+
+  /**
+   *  @brief
+   *  Records that elements in `[index, index + count)` were modified in
+   *    place, e.g., through a reference returned by `operator[]`.
+   */
+  void record_update(size_type index, size_type count = 1) {
+    record(ChangeKind::kUpdate, index, count);
+  }
+
+  /**
+   *  @brief
+   *  Publishes the record held back for merging. Called by the producer.
+   */
+  void flush() {
+    if (has_pending_) {
+      publish(pending_);
+      has_pending_ = false;
+    } else if (lost_) {
+      publish(record_type{ChangeKind::kReset, 0, 0});
+    }
+  }
+
+  /**
+   *  @brief
+   *  Pops the oldest published record into `r`. Called by the consumer.
+   *
+   *  Returns `false` if there is no published record.
+   */
+  bool try_pop(record_type& r) {
+    std::size_t const head{head_.load(std::memory_order_relaxed)};
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    r = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   *  @brief
+   *  Calls `f(r)` for every published record `r` in order, and returns the
+   *    number of records consumed. Called by the consumer.
+   */
+  template<class F>
+  std::size_t drain(F f) {
+    std::size_t head{head_.load(std::memory_order_relaxed)};
+    std::size_t const tail{tail_.load(std::memory_order_acquire)};
+    std::size_t const count{tail - head};
+    for (; head != tail; ++head) {
+      f(static_cast<record_type const&>(slots_[head & mask_]));
+    }
+    head_.store(head, std::memory_order_release);
+    return count;
+  }
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Table of rows with several columns, where one tree indexes the rows and
+ *    each column stores its values in its own array.
+ *
+ *  Keeping one `ManagedTree` per column repeats every structural operation
+ *    and every node once per column.
+ *  Here, each row has exactly one tree node, and that node only holds a
+ *    *slot*: the position of the row's values in every column array.
+ *  Inserting or erasing a row costs one tree operation plus one array write
+ *    per column.
+ *  Slots of erased rows are reused by later insertions.
+ *  If inserting a row throws, the table is left as it was.
+ *
+ *  A pass over one column with `for_each_in_column()` reads only that
+ *    column's array besides the tree nodes.
+ *  After `compact()`, slots are in row order, so such a pass also reads the
+ *    array sequentially.
+ *
+ *  @tparam TreeImplT
+ *    Tree implementation whose `Value` is an unsigned integer type, e.g.,
+ *      `SplayTreeImpl<std::size_t>`.
+ *    Column arrays use `TreeImplT::ValueAllocator` rebound to the column
+ *      types.
+ *  @tparam ColumnTs
+ *    Types of the columns.
+ *    They must be default-constructible and move-assignable.
+ */
+template<class TreeImplT, class... ColumnTs>
+class ColumnTable {
+ private:
+  /// This class.
+  using This = ColumnTable<TreeImplT, ColumnTs...>;
+
+ protected:
+  /// `TreeImplT`.
+  using TreeImpl = TreeImplT;
+
+  /// Type of the tree that indexes rows.
+  using Tree = typename TreeImpl::Tree;
+
+  /// Type of pointers to nodes.
+  using NodePtr = typename Tree::NodePtr;
+
+  /// `ExtractValue` of `TreeImpl`.
+  using ExtractValue = typename TreeImpl::ExtractValue;
+
+  /// Type of the value in each node, i.e., positions in column arrays.
+  using Slot = typename TreeImpl::Value;
+
+  static_assert(sizeof...(ColumnTs) > 0,
+      "ColumnTable requires at least one column");
+
+  static_assert(std::is_unsigned_v<Slot>,
+      "ColumnTable requires a tree implementation with unsigned values");
+
+  /// Allocator for values of type `T`.
+  template<class T>
+  using RebindAllocator = typename std::allocator_traits<
+      typename TreeImpl::ValueAllocator>::template rebind_alloc<T>;
+
+  /// Storage for one column, indexed by slot.
+  template<class T>
+  using ColumnArray = std::vector<T, RebindAllocator<T>>;
+
+  /// Number of columns.
+  static constexpr std::size_t kNumColumns{sizeof...(ColumnTs)};
+
+  /// Sequence `0, ..., kNumColumns - 1`.
+  using ColumnIndices = std::make_index_sequence<kNumColumns>;
+
+  /// Tree of slots in row order.
+  Tree tree_;
+
+  /// One array per column.
+  std::tuple<ColumnArray<ColumnTs>...> columns_;
+
+  /// Slots that are not used by any row.
+  std::vector<Slot, RebindAllocator<Slot>> free_slots_;
+
+  /// Returns the slot stored in `n`.
+  static constexpr Slot slot_of(NodePtr n) {
+    return ExtractValue::value_in_data(n->data);
+  }
+
+  /// Returns the node of row `index`.
+  NodePtr find_node(std::size_t index) {
+    assert(index < size());
+    return TreeImpl::find_node_at_index(tree_, index);
+  }
+
+  /// Takes a slot and stores `values` in it.
+  ///
+  /// `free_slots_` keeps room for every slot, so `release_slot()` does not
+  /// allocate.
+  /// If storing a value throws, every column keeps its previous size and the
+  /// slot stays free.
+  template<class... Values, std::size_t... Is>
+  Slot acquire_slot(std::index_sequence<Is...>, Values&&... values) {
+    if (free_slots_.empty()) {
+      std::size_t const count{std::get<0>(columns_).size()};
+      (std::get<Is>(columns_).reserve(count + 1), ...);
+      free_slots_.reserve(count + 1);
+      try {
+        (std::get<Is>(columns_).emplace_back(
+            std::forward<Values>(values)), ...);
+      } catch (...) {
+        ((std::get<Is>(columns_).size() > count
+            ? std::get<Is>(columns_).pop_back()
+            : void()), ...);
+        throw;
+      }
+      return static_cast<Slot>(count);
+    }
+    Slot const slot{free_slots_.back()};
+    free_slots_.pop_back();
+    try {
+      ((std::get<Is>(columns_)[slot] = std::forward<Values>(values)), ...);
+    } catch (...) {
+      free_slots_.push_back(slot);
+      throw;
+    }
+    return slot;
+  }
+
+  /// Adds a node holding `slot` with `link(slot)`, and releases `slot` if
+  /// that throws.
+  template<class Link>
+  void link_slot(Slot slot, Link link) {
+    try {
+      link(slot);
+    } catch (...) {
+      release_slot(ColumnIndices{}, slot);
+      throw;
+    }
+  }
+
+  /// Resets the values in `slot` and marks it free.
+  template<std::size_t... Is>
+  void release_slot(std::index_sequence<Is...>, Slot slot) {
+    ((std::get<Is>(columns_)[slot] = ColumnTs{}), ...);
+    free_slots_.push_back(slot);
+  }
+
+  /// Returns references to the values in `slot`.
+  template<std::size_t... Is>
+  std::tuple<ColumnTs&...> values_in_slot(
+      std::index_sequence<Is...>, Slot slot) {
+    return {std::get<Is>(columns_)[slot]...};
+  }
+
+  /// Moves the values of all rows into new arrays in row order.
+  template<std::size_t... Is>
+  void compact_columns(std::index_sequence<Is...>) {
+    std::tuple<ColumnArray<ColumnTs>...> columns{
+        ColumnArray<ColumnTs>(std::get<Is>(columns_).get_allocator())...};
+    (std::get<Is>(columns).reserve(size()), ...);
+    Slot slot{0};
+    for (NodePtr n{tree_.first}; n; n = n->find_next_node(), ++slot) {
+      Slot& old_slot{ExtractValue::value_in_data(n->data)};
+      (std::get<Is>(columns).emplace_back(
+          std::move(std::get<Is>(columns_)[old_slot])), ...);
+      old_slot = slot;
+    }
+    columns_ = std::move(columns);
+  }
+
+ public:
+  /// Type of indices.
+  using size_type = std::size_t;
+
+  /// Type of the allocator.
+  using allocator_type = typename TreeImpl::ValueAllocator;
+
+  /// Type of the `I`-th column.
+  template<std::size_t I>
+  using column_type = std::tuple_element_t<I, std::tuple<ColumnTs...>>;
+
+  /// Type of a row as references to its values.
+  using row_reference = std::tuple<ColumnTs&...>;
+
+  /**
+   *  @brief
+   *  Creates an empty table with a given `allocator`.
+   */
+  ColumnTable(allocator_type const& allocator = allocator_type())
+    : tree_{typename TreeImpl::Allocator(allocator)},
+      columns_{ColumnArray<ColumnTs>(RebindAllocator<ColumnTs>(allocator))...},
+      free_slots_(RebindAllocator<Slot>(allocator)) {}
+
+  ColumnTable(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Takes all rows from `other`, which will be empty afterwards.
+   */
+  ColumnTable(This&& other)
+    : tree_{std::move(other.tree_)},
+      columns_{std::move(other.columns_)},
+      free_slots_{std::move(other.free_slots_)} {
+    other.clear();
+  }
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the table.
+   */
+  ~ColumnTable() {
+    tree_.destroy_all_nodes();
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of rows.
+   */
+  size_type size() const {
+    return tree_.root ? tree_.root->size : 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` if there are no rows.
+   */
+  bool empty() const {
+    return !tree_.root;
+  }
+
+  /**
+   *  @brief
+   *  Erases all rows and releases the column arrays.
+   */
+  void clear() {
+    tree_.destroy_all_nodes();
+    std::apply([](auto&... columns) { (columns.clear(), ...); }, columns_);
+    free_slots_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Inserts a row before row `index`, with one value per column.
+   *
+   *  `index` may be `size()`.
+   *  This takes one tree insertion and one write per column.
+   */
+  template<class... Values>
+  void insert(size_type index, Values&&... values) {
+    static_assert(sizeof...(Values) == kNumColumns,
+        "ColumnTable::insert -- one value per column is required");
+    assert(index <= size());
+    Slot const slot{
+        acquire_slot(ColumnIndices{}, std::forward<Values>(values)...)};
+    link_slot(slot, [this, index](Slot slot) {
+      if (index == size()) {
+        TreeImpl::emplace_back(tree_, slot);
+      } else {
+        TreeImpl::emplace_node_before(tree_, find_node(index), slot);
+      }
+    });
+  }
+
+  /**
+   *  @brief
+   *  Appends a row.
+   */
+  template<class... Values>
+  void push_back(Values&&... values) {
+    static_assert(sizeof...(Values) == kNumColumns,
+        "ColumnTable::push_back -- one value per column is required");
+    Slot const slot{
+        acquire_slot(ColumnIndices{}, std::forward<Values>(values)...)};
+    link_slot(slot, [this](Slot slot) {
+      TreeImpl::emplace_back(tree_, slot);
+    });
+  }
+
+  /**
+   *  @brief
+   *  Prepends a row.
+   */
+  template<class... Values>
+  void push_front(Values&&... values) {
+    static_assert(sizeof...(Values) == kNumColumns,
+        "ColumnTable::push_front -- one value per column is required");
+    Slot const slot{
+        acquire_slot(ColumnIndices{}, std::forward<Values>(values)...)};
+    link_slot(slot, [this](Slot slot) {
+      TreeImpl::emplace_front(tree_, slot);
+    });
+  }
+
+  /**
+   *  @brief
+   *  Erases row `index`.
+   */
+  void erase(size_type index) {
+    NodePtr n{find_node(index)};
+    release_slot(ColumnIndices{}, slot_of(n));
+    TreeImpl::erase_node(tree_, n);
+  }
+
+  /**
+   *  @brief
+   *  Returns the value of column `I` in row `index`.
+   */
+  template<std::size_t I>
+  column_type<I>& get(size_type index) {
+    return std::get<I>(columns_)[slot_of(find_node(index))];
+  }
+
+  /**
+   *  @brief
+   *  Returns the value of column `I` in row `index`.
+   *
+   *  If `index` is out of range, `std::out_of_range` will be thrown.
+   */
+  template<std::size_t I>
+  column_type<I>& at(size_type index) {
+    if (index >= size()) {
+      throw std::out_of_range("ColumnTable::at -- index out of range");
+    }
+    return get<I>(index);
+  }
+
+  /**
+   *  @brief
+   *  Returns references to all values in row `index`.
+   */
+  row_reference row(size_type index) {
+    return values_in_slot(ColumnIndices{}, slot_of(find_node(index)));
+  }
+
+  /**
+   *  @brief
+   *  Calls `f(value)` on every value of column `I` in row order.
+   *
+   *  Other columns are not touched.
+   */
+  template<std::size_t I, class F>
+  void for_each_in_column(F&& f) {
+    auto& column{std::get<I>(columns_)};
+    for (NodePtr n{tree_.first}; n; n = n->find_next_node()) {
+      f(column[slot_of(n)]);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Renumbers slots in row order and drops unused slots.
+   *
+   *  This takes O(n) time.
+   *  Afterwards, `for_each_in_column()` reads each column array from front to
+   *    back until rows are inserted or erased again.
+   */
+  void compact() {
+    compact_columns(ColumnIndices{});
+    free_slots_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of slots in each column array, including unused ones.
+   */
+  size_type capacity() const {
+    return std::get<0>(columns_).size();
+  }
+};
+
+} // namespace ordered_binary_trees
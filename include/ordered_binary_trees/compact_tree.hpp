@@ -0,0 +1,441 @@
+#pragma once
+
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <ordered_binary_trees/managed_tree.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Sequence that stores nothing but a pointer to the root node, for programs
+ *    that hold millions of small sequences.
+ *
+ *  `ManagedTree` keeps `root`, `first`, `last` and the allocator, and
+ *    maintains `first` and `last` on every edit.
+ *  `CompactTree` finds `first` and `last` on demand instead, which costs
+ *    O(depth) per operation that needs them, and requires a stateless
+ *    allocator, so `sizeof(CompactTree)` is the size of one pointer.
+ *
+ *  Elements are accessed and edited by index.
+ *  For iteration and heavier editing, `expand()` converts the sequence to a
+ *    `ManagedTree` in O(depth) time, and the converting constructor converts
+ *    it back.
+ *  Nodes are compatible between the two, so no elements are copied.
+ *
+ *  `TreeImplT` must be built on `OrderedBinaryTree`, e.g., `BasicTreeImpl` or
+ *    `SplayTreeImpl`.
+ */
+template<class TreeImplT>
+class CompactTree {
+ private:
+  /// This class.
+  using This = CompactTree<TreeImplT>;
+
+ protected:
+  /// Class that contains implementations of the tree data structure.
+  using TreeImpl = TreeImplT;
+
+  /// Type of the temporary tree that operations work on.
+  using Tree = typename TreeImpl::Tree;
+
+  /// Type of nodes.
+  using Node = typename TreeImpl::Node;
+
+  /// Type of node pointers.
+  using NodePtr = typename Tree::NodePtr;
+
+  /// Type of the node allocator.
+  using Allocator = typename TreeImpl::Allocator;
+
+  /// Type of `ExtractValue`. See `basic_tree_impl.hpp` for more information.
+  using ExtractValue = typename TreeImpl::ExtractValue;
+
+  static_assert(std::is_empty_v<Allocator>,
+      "CompactTree requires a stateless allocator");
+
+ public:
+  /// Type of values.
+  using value_type = typename TreeImpl::Value;
+
+  /// Type of the allocator for values.
+  using allocator_type = typename TreeImpl::ValueAllocator;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// `value_type&`.
+  using reference = value_type&;
+
+  /// `value_type const&`.
+  using const_reference = value_type const&;
+
+  /// Type of the equivalent `ManagedTree`.
+  using managed_type = ManagedTree<TreeImpl>;
+
+ protected:
+  /// Root of the tree. This is null when the tree is empty.
+  mutable NodePtr root_{nullptr};
+
+  /**
+   *  @brief
+   *  `Tree` that views the nodes of a `CompactTree` during one operation, and
+   *    stores the possibly new root back when it goes out of scope.
+   */
+  struct TreeView {
+    /// The sequence being viewed.
+    This const& owner;
+    /// Tree with `first` and `last` found from `owner.root_`.
+    Tree tree;
+
+    /// Creates a view of `owner`.
+    explicit TreeView(This const& owner)
+      : owner{owner}, tree{Allocator{}, owner.root_} {}
+
+    TreeView(TreeView const&) = delete;
+
+    TreeView& operator=(TreeView const&) = delete;
+
+    /// Stores `tree.root` back into `owner`.
+    ~TreeView() {
+      owner.root_ = tree.root;
+    }
+  };
+
+  /// Returns the node at `index`. `index` must be less than `size()`.
+  NodePtr node_at(size_type index) const {
+    assert(index < size());
+    TreeView view{*this};
+    return TreeImpl::find_node_at_index(view.tree, index);
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty sequence.
+   */
+  constexpr CompactTree() = default;
+
+  /**
+   *  @brief
+   *  Creates a sequence from `ilist`.
+   */
+  CompactTree(std::initializer_list<value_type> ilist) {
+    TreeView view{*this};
+    TreeImpl::assign(view.tree, ilist.begin(), ilist.end());
+  }
+
+  /**
+   *  @brief
+   *  Takes the nodes of `tree`, leaving it empty.
+   */
+  explicit CompactTree(managed_type&& tree) : root_{tree.tree_.root} {
+    tree.record_change(ChangeKind::kErase, 0, tree.size());
+    tree.tree_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence.
+   */
+  CompactTree(This const& other) {
+    if (other.root_) {
+      root_ = Tree{}.clone_nodes(other.root_);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Takes data from another sequence.
+   */
+  CompactTree(This&& other) noexcept : root_{other.root_} {
+    other.root_ = nullptr;
+  }
+
+  /**
+   *  @brief
+   *  Destroys the sequence.
+   */
+  ~CompactTree() {
+    clear();
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence.
+   */
+  This& operator=(This const& other) {
+    if (this != &other) {
+      This copy{other};
+      swap(copy);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes data from another sequence.
+   */
+  This& operator=(This&& other) noexcept {
+    if (this != &other) {
+      clear();
+      std::swap(root_, other.root_);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Swaps this sequence with `other`.
+   */
+  void swap(This& other) noexcept {
+    std::swap(root_, other.root_);
+  }
+
+  /**
+   *  @brief
+   *  Moves all elements into a `ManagedTree`, leaving this sequence empty.
+   */
+  managed_type expand() {
+    managed_type tree;
+    tree.tree_ = Tree{Allocator{}, root_};
+    root_ = nullptr;
+    return tree;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements.
+   */
+  size_type size() const {
+    return root_ ? root_->size : 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the sequence is empty.
+   */
+  bool empty() const {
+    return !root_;
+  }
+
+  /**
+   *  @brief
+   *  Destroys all elements.
+   */
+  void clear() {
+    if (root_) {
+      Tree tree{Allocator{}, root_};
+      tree.destroy_all_nodes();
+      root_ = nullptr;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference operator[](size_type index) {
+    return ExtractValue::value_in_data(node_at(index)->data);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference operator[](size_type index) const {
+    return ExtractValue::value_in_data(node_at(index)->data);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element with bounds checking.
+   */
+  reference at(size_type index) {
+    if (index >= size()) {
+      throw std::out_of_range("CompactTree::at -- index out of range");
+    }
+    return operator[](index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element with bounds checking.
+   */
+  const_reference at(size_type index) const {
+    if (index >= size()) {
+      throw std::out_of_range("CompactTree::at -- index out of range");
+    }
+    return operator[](index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  reference front() {
+    assert(root_);
+    return ExtractValue::value_in_data(root_->find_first_node()->data);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  const_reference front() const {
+    assert(root_);
+    return ExtractValue::value_in_data(root_->find_first_node()->data);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  reference back() {
+    assert(root_);
+    return ExtractValue::value_in_data(root_->find_last_node()->data);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  const_reference back() const {
+    assert(root_);
+    return ExtractValue::value_in_data(root_->find_last_node()->data);
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it at `index`.
+   */
+  template<class... Args>
+  void emplace(size_type index, Args&&... args) {
+    assert(index <= size());
+    TreeView view{*this};
+    NodePtr n{index < size() ?
+        TreeImpl::find_node_at_index(view.tree, index) : nullptr};
+    TreeImpl::emplace_node_before(
+        view.tree, n, std::forward<Args>(args)...);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` at `index`.
+   */
+  void insert(size_type index, value_type const& value) {
+    emplace(index, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` at `index`.
+   */
+  void insert(size_type index, value_type&& value) {
+    emplace(index, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the first element.
+   */
+  template<class... Args>
+  void emplace_front(Args&&... args) {
+    TreeView view{*this};
+    TreeImpl::emplace_front(view.tree, std::forward<Args>(args)...);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type const& value) {
+    emplace_front(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type&& value) {
+    emplace_front(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the last element.
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    TreeView view{*this};
+    TreeImpl::emplace_back(view.tree, std::forward<Args>(args)...);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Erases the `index`-th element.
+   */
+  void erase(size_type index) {
+    assert(index < size());
+    TreeView view{*this};
+    TreeImpl::erase_node(
+        view.tree, TreeImpl::find_node_at_index(view.tree, index));
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    assert(root_);
+    TreeView view{*this};
+    TreeImpl::erase_front(view.tree);
+  }
+
+  /**
+   *  @brief
+   *  Erases the last element.
+   */
+  void pop_back() {
+    assert(root_);
+    TreeView view{*this};
+    TreeImpl::erase_back(view.tree);
+  }
+
+  /**
+   *  @brief
+   *  Calls `f(value)` for every element in order.
+   */
+  template<class F>
+  void for_each(F f) const {
+    if (!root_) {
+      return;
+    }
+    for (NodePtr n{root_->find_first_node()}; n; n = n->find_next_node()) {
+      f(static_cast<const_reference>(ExtractValue::value_in_data(n->data)));
+    }
+  }
+};
+
+} // namespace ordered_binary_trees
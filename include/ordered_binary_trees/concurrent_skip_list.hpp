@@ -0,0 +1,600 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Indexable skip list that supports lock-free appends, lookups and erasures
+ *    from any number of threads.
+ *
+ *  Every node receives a sequence number `seq` when it is appended: the
+ *    number of nodes appended before it plus one, with `0` for the head.
+ *  The height of a node is one plus the number of trailing zeros of `seq`,
+ *    so the successor of a node at level `l` is always the node whose `seq`
+ *    is `2^l` larger.
+ *  Each forward link also counts the erased nodes in the range it skips, so
+ *    the width of a link at level `l`, i.e., the number of elements it skips,
+ *    is `2^l` minus that count.
+ *  `operator[]` descends along the widths in O(log n) time.
+ *
+ *  Because link ranges are fixed by `seq`, no link is ever split.
+ *  - Appends claim the next `seq` with a compare-and-swap on the last link
+ *    of the bottom level, then store each upper link of the new node into
+ *    its predecessor at that level, which no other thread writes.
+ *  - Erasures are logical: a compare-and-swap on the `erased` flag of a node
+ *    decides which writer erases it, and that writer then increments the
+ *    erased count of one link per level.
+ *  - Lookups never write to the list.
+ *  Nothing waits for another thread, and no mutex is involved.
+ *
+ *  Appends never change the index of an existing element, so lookups that
+ *    race with appends only are exact.
+ *  A lookup that races with an erasure may see the erasure at some levels and
+ *    not at others, so it may return an element next to the one it would
+ *    return before or after the erasure.
+ *  Elements can be inserted at the back only.
+ *  For arbitrary positions, use `ConcurrentTree`, which offers the same
+ *    index-based interface.
+ *
+ *  Erased nodes stay in the list, skipped by the widths, until
+ *    `collect_garbage()` is called at a time when no other thread is
+ *    accessing the list.
+ *  Values are never modified after insertion, so readers may copy them
+ *    without synchronization.
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+class ConcurrentSkipList {
+ private:
+  /// This type.
+  using This = ConcurrentSkipList<ValueT, AllocatorT>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = AllocatorT;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /**
+   *  @brief
+   *  Number of levels.
+   *
+   *  A list of `n` elements needs `log2(n) + 1` levels for O(log n) lookups.
+   */
+  static constexpr unsigned kMaxHeight{
+      std::numeric_limits<size_type>::digits < 32 ?
+      std::numeric_limits<size_type>::digits : 32};
+
+ protected:
+  struct NodeBase;
+
+  /**
+   *  @brief
+   *  Forward link of a node at one level.
+   *
+   *  At level `l`, the link of the node with sequence number `s` skips the
+   *    nodes in `(s, s + 2^l]`, whether or not `next` is set yet.
+   */
+  struct Link {
+    /// Next node at this level, or null if it has not been linked yet.
+    std::atomic<NodeBase*> next{nullptr};
+    /// Number of erased nodes among the nodes this link skips.
+    std::atomic<size_type> erased{0};
+  };
+
+  /// Part of a node that does not depend on `Value`.
+  struct NodeBase {
+    /// Sequence number. Fixed once the node is reachable.
+    size_type seq{0};
+    /// `true` once the node has been erased.
+    std::atomic<bool> erased{false};
+    /// Array of `height_of(seq)` links.
+    Link* links{nullptr};
+  };
+
+  /// Node that holds a value.
+  struct Node : NodeBase {
+    /// Immutable value.
+    value_type value;
+
+    template<class... Args>
+    Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+  };
+
+  /// Allocator for `Node`.
+  using NodeAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<Node>;
+
+  /// Allocator for `Link`.
+  using LinkAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<Link>;
+
+  /// Node allocator.
+  mutable NodeAllocator allocator_;
+
+  /// Link allocator.
+  mutable LinkAllocator link_allocator_;
+
+  /// Links of the head sentinel.
+  Link head_links_[kMaxHeight];
+
+  /// Head sentinel, with `seq == 0` and all levels.
+  NodeBase head_;
+
+  /// Last node, or a node close to it.
+  std::atomic<NodeBase*> tail_{&head_};
+
+  /// Number of elements that have not been erased.
+  std::atomic<size_type> size_{0};
+
+  /// Number of erased nodes that have not been collected.
+  std::atomic<size_type> retired_size_{0};
+
+  /// Returns the height of the node with sequence number `seq`.
+  static constexpr unsigned height_of(size_type seq) {
+    assert(seq > 0);
+    unsigned h{1};
+    while (h < kMaxHeight && !(seq & (size_type{1} << (h - 1)))) {
+      ++h;
+    }
+    return h;
+  }
+
+  /// Returns the next node of `n` at level `l`.
+  static NodeBase* get_next(NodeBase const* n, unsigned l) {
+    return n->links[l].next.load(std::memory_order_acquire);
+  }
+
+  /// Returns the number of elements skipped by the link of `n` at level `l`.
+  static size_type get_width(NodeBase const* n, unsigned l) {
+    return (size_type{1} << l) -
+        n->links[l].erased.load(std::memory_order_acquire);
+  }
+
+  /**
+   *  @brief
+   *  Moves forward from `n` to the node with sequence number `seq`, using
+   *    links at level `l` and below.
+   *
+   *  `n->seq` must not be greater than `seq`, `seq` must be a multiple of
+   *    `2^l`, and the target node must have been appended.
+   */
+  static NodeBase* advance_to(NodeBase* n, unsigned l, size_type seq) {
+    for (NodeBase* next{get_next(n, l)};
+        next && next->seq <= seq;
+        next = get_next(n, l)) {
+      n = next;
+    }
+    // Upper links of recent nodes may not be stored yet.
+    while (n->seq < seq) {
+      n = get_next(n, 0);
+      assert(n);
+    }
+    return n;
+  }
+
+  /// Allocates and default-constructs `height` links.
+  Link* create_links(unsigned height) {
+    Link* links{std::allocator_traits<LinkAllocator>::allocate(
+        link_allocator_, height)};
+    for (unsigned l{0}; l < height; ++l) {
+      std::allocator_traits<LinkAllocator>::construct(
+          link_allocator_, links + l);
+    }
+    return links;
+  }
+
+  /// Destroys and deallocates `height` links.
+  void destroy_links(Link* links, unsigned height) {
+    for (unsigned l{0}; l < height; ++l) {
+      std::allocator_traits<LinkAllocator>::destroy(
+          link_allocator_, links + l);
+    }
+    std::allocator_traits<LinkAllocator>::deallocate(
+        link_allocator_, links, height);
+  }
+
+  /// Allocates and constructs a node that has no links yet.
+  template<class... Args>
+  Node* create_node(Args&&... args) {
+    Node* n{std::allocator_traits<NodeAllocator>::allocate(allocator_, 1)};
+    try {
+      std::allocator_traits<NodeAllocator>::construct(
+          allocator_, n, std::forward<Args>(args)...);
+    } catch (...) {
+      std::allocator_traits<NodeAllocator>::deallocate(allocator_, n, 1);
+      throw;
+    }
+    return n;
+  }
+
+  /// Destroys and deallocates a node together with its links.
+  void destroy_node(Node* n) {
+    if (n->links) {
+      destroy_links(n->links, height_of(n->seq));
+    }
+    std::allocator_traits<NodeAllocator>::destroy(allocator_, n);
+    std::allocator_traits<NodeAllocator>::deallocate(allocator_, n, 1);
+  }
+
+  /**
+   *  @brief
+   *  Gives `n` sequence number `seq`, reallocating its links if the height
+   *    changes.
+   *
+   *  `n` must not be reachable.
+   */
+  void set_seq(Node* n, size_type seq) {
+    unsigned const height{height_of(seq)};
+    if (!n->links || height_of(n->seq) != height) {
+      Link* links{create_links(height)};
+      if (n->links) {
+        destroy_links(n->links, height_of(n->seq));
+      }
+      n->links = links;
+    }
+    n->seq = seq;
+  }
+
+  /// Appends `n` and links it at all levels.
+  void append_node(Node* n) {
+    size_.fetch_add(1, std::memory_order_release);
+    NodeBase* last{tail_.load(std::memory_order_acquire)};
+    while (true) {
+      NodeBase* next{get_next(last, 0)};
+      if (next) {
+        // Help move `tail_` forward.
+        tail_.compare_exchange_weak(
+            last, next, std::memory_order_acq_rel, std::memory_order_acquire);
+        last = tail_.load(std::memory_order_acquire);
+        continue;
+      }
+      try {
+        set_seq(n, last->seq + 1);
+      } catch (...) {
+        size_.fetch_sub(1, std::memory_order_release);
+        destroy_node(n);
+        throw;
+      }
+      if (last->links[0].next.compare_exchange_weak(
+            next, n, std::memory_order_release, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    tail_.compare_exchange_strong(
+        last, n, std::memory_order_release, std::memory_order_relaxed);
+
+    // The predecessor of `n` at level `l` is the node `2^l` before it.
+    // Above the height of `n`, move towards the predecessor at the top level
+    // of `n`, stopping at nodes that are tall enough.
+    unsigned const height{height_of(n->seq)};
+    size_type const top{n->seq - (size_type{1} << (height - 1))};
+    NodeBase* p{&head_};
+    for (unsigned l{kMaxHeight - 1}; l > 0; --l) {
+      if (l >= height) {
+        p = advance_to(p, l, top >> l << l);
+        continue;
+      }
+      p = advance_to(p, l, n->seq - (size_type{1} << l));
+      p->links[l].next.store(n, std::memory_order_release);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Returns the node of the `index`-th element, or null if there is no such
+   *    element.
+   */
+  NodeBase* find_node(size_type index) const {
+    NodeBase const* n{&head_};
+    size_type remaining{index + 1};
+    for (unsigned l{kMaxHeight}; l-- > 0;) {
+      for (NodeBase* next{get_next(n, l)}; next; next = get_next(n, l)) {
+        size_type const width{get_width(n, l)};
+        if (width >= remaining) {
+          break;
+        }
+        remaining -= width;
+        n = next;
+      }
+    }
+    return get_next(n, 0);
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty list.
+   */
+  ConcurrentSkipList(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator}, link_allocator_{allocator} {
+    head_.links = head_links_;
+  }
+
+  ConcurrentSkipList(This const&) = delete;
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the list and all erased nodes.
+   */
+  ~ConcurrentSkipList() {
+    NodeBase* n{get_next(&head_, 0)};
+    while (n) {
+      NodeBase* next{get_next(n, 0)};
+      destroy_node(static_cast<Node*>(n));
+      n = next;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Deallocates erased nodes and renumbers the remaining ones.
+   *
+   *  This must only be called while no other thread is accessing the list.
+   */
+  void collect_garbage() {
+    std::vector<Node*> nodes;
+    std::vector<Node*> erased_nodes;
+    nodes.reserve(size_.load(std::memory_order_relaxed));
+    erased_nodes.reserve(retired_size_.load(std::memory_order_relaxed));
+    for (NodeBase* n{get_next(&head_, 0)}; n; n = get_next(n, 0)) {
+      (n->erased.load(std::memory_order_relaxed) ? erased_nodes : nodes)
+          .push_back(static_cast<Node*>(n));
+    }
+    // Allocate new links first so that a failure leaves the list intact.
+    std::vector<Link*> links(nodes.size(), nullptr);
+    try {
+      for (size_type i{0}; i < nodes.size(); ++i) {
+        if (height_of(nodes[i]->seq) != height_of(i + 1)) {
+          links[i] = create_links(height_of(i + 1));
+        }
+      }
+    } catch (...) {
+      for (size_type i{0}; i < nodes.size(); ++i) {
+        if (links[i]) {
+          destroy_links(links[i], height_of(i + 1));
+        }
+      }
+      throw;
+    }
+    for (Node* n : erased_nodes) {
+      destroy_node(n);
+    }
+
+    NodeBase* last[kMaxHeight];
+    for (unsigned l{0}; l < kMaxHeight; ++l) {
+      head_links_[l].next.store(nullptr, std::memory_order_relaxed);
+      head_links_[l].erased.store(0, std::memory_order_relaxed);
+      last[l] = &head_;
+    }
+    for (size_type i{0}; i < nodes.size(); ++i) {
+      Node* n{nodes[i]};
+      unsigned const height{height_of(i + 1)};
+      if (links[i]) {
+        destroy_links(n->links, height_of(n->seq));
+        n->links = links[i];
+      }
+      n->seq = i + 1;
+      for (unsigned l{0}; l < height; ++l) {
+        n->links[l].next.store(nullptr, std::memory_order_relaxed);
+        n->links[l].erased.store(0, std::memory_order_relaxed);
+        last[l]->links[l].next.store(n, std::memory_order_relaxed);
+        last[l] = n;
+      }
+    }
+    tail_.store(last[0], std::memory_order_release);
+    retired_size_.store(0, std::memory_order_release);
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of erased nodes waiting for `collect_garbage()`.
+   */
+  size_type retired_size() const {
+    return retired_size_.load(std::memory_order_acquire);
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements.
+   *
+   *  This includes insertions that are still in progress.
+   */
+  size_type size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the list is empty.
+   */
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns a copy of the `index`-th element.
+   *
+   *  This never blocks writers.
+   *  Throws `std::out_of_range` if `index` is not smaller than the size
+   *    observed by the lookup.
+   */
+  value_type at(size_type index) const {
+    NodeBase* n{find_node(index)};
+    if (!n) {
+      throw std::out_of_range(
+          "ConcurrentSkipList::at -- index out of range");
+    }
+    return static_cast<Node*>(n)->value;
+  }
+
+  /**
+   *  @brief
+   *  Same as `at(index)`.
+   */
+  value_type operator[](size_type index) const {
+    return at(index);
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and appends it as the last element.
+   *
+   *  Concurrent calls never fail and never wait for each other.
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    append_node(create_node(std::forward<Args>(args)...));
+  }
+
+  /**
+   *  @brief
+   *  Appends `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Appends `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Erases the `index`-th element.
+   *
+   *  The erased node stays in the list until `collect_garbage()` is called.
+   *  Throws `std::out_of_range` if `index` is not smaller than the size
+   *    observed by the lookup.
+   */
+  void erase(size_type index) {
+    NodeBase* n;
+    while (true) {
+      n = find_node(index);
+      if (!n) {
+        throw std::out_of_range(
+            "ConcurrentSkipList::erase -- index out of range");
+      }
+      bool expected{false};
+      if (n->erased.compare_exchange_strong(
+            expected, true, std::memory_order_acq_rel)) {
+        break;
+      }
+      // Another writer erased the node first, so the element at `index`
+      // is now a different one.
+    }
+    size_.fetch_sub(1, std::memory_order_release);
+    retired_size_.fetch_add(1, std::memory_order_release);
+
+    // The link at level `l` that skips `n` starts at the largest multiple of
+    // `2^l` below `n->seq`.
+    size_type const s{n->seq - 1};
+    NodeBase* p{&head_};
+    for (unsigned l{kMaxHeight}; l-- > 0;) {
+      p = advance_to(p, l, s >> l << l);
+      p->links[l].erased.fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    erase(0);
+  }
+
+  /**
+   *  @brief
+   *  Copies all elements into a `std::vector`.
+   *
+   *  This must only be called while no other thread is modifying the list.
+   */
+  std::vector<value_type> to_vector() const {
+    std::vector<value_type> values;
+    values.reserve(size());
+    for (NodeBase* n{get_next(&head_, 0)}; n; n = get_next(n, 0)) {
+      if (!n->erased.load(std::memory_order_relaxed)) {
+        values.push_back(static_cast<Node*>(n)->value);
+      }
+    }
+    return values;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of levels in use, or `0` if the list is empty.
+   */
+  unsigned height() const {
+    unsigned h{0};
+    while (h < kMaxHeight && get_next(&head_, h)) {
+      ++h;
+    }
+    return h;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff every link points `2^l` nodes ahead, every erased
+   *    count matches the `erased` flags, and `size()` matches the number of
+   *    elements.
+   *
+   *  This must only be called while no other thread is modifying the list.
+   */
+  bool check_invariants() const {
+    std::vector<NodeBase const*> nodes{&head_};
+    for (NodeBase* n{get_next(&head_, 0)}; n; n = get_next(n, 0)) {
+      if (n->seq != nodes.size()) {
+        return false;
+      }
+      nodes.push_back(n);
+    }
+    size_type num_erased{0};
+    for (NodeBase const* n : nodes) {
+      num_erased += n->erased.load() ? 1 : 0;
+    }
+    if (size() + num_erased + 1 != nodes.size() ||
+        retired_size() != num_erased) {
+      return false;
+    }
+    for (NodeBase const* n : nodes) {
+      unsigned const height{n == &head_ ? kMaxHeight : height_of(n->seq)};
+      for (unsigned l{0}; l < height; ++l) {
+        size_type const end{n->seq + (size_type{1} << l)};
+        NodeBase const* next{get_next(n, l)};
+        if (end < nodes.size() ? next != nodes[end] : next != nullptr) {
+          return false;
+        }
+        size_type erased{0};
+        for (size_type i{n->seq + 1}; i <= end && i < nodes.size(); ++i) {
+          erased += nodes[i]->erased.load() ? 1 : 0;
+        }
+        if (n->links[l].erased.load() != erased) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+};
+
+} // namespace ordered_binary_trees
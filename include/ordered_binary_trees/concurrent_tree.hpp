@@ -0,0 +1,811 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Size-augmented binary tree that supports concurrent readers and writers
+ *    through optimistic lock coupling.
+ *
+ *  Every node carries a version counter whose lowest bit is a lock bit.
+ *  - Readers never lock.
+ *    They descend the same way as `OrderedBinaryTreeNode::find_node_at_index`
+ *    and validate the version of every node they leave, restarting from the
+ *    root if a writer has modified it in the meantime.
+ *  - Writers descend top-down with lock coupling, holding only a node and its
+ *    parent at a time, plus the nodes involved in a rotation.
+ *    Because the target position of an insertion or an erasure is known on the
+ *    way down, each writer updates `size` of a node while it holds the node,
+ *    then hands the node over to the next writer.
+ *    Writers therefore pipeline through the upper levels instead of
+ *    serializing on a global lock, and `size` is always consistent for every
+ *    node that is not currently locked.
+ *  - Balance is maintained top-down with weight-balanced rotations (the
+ *    weight of a subtree being `size + 1`), so no writer ever has to walk back
+ *    up to the root.
+ *
+ *  Nodes have no parent pointers, so `OrderedBinaryTreeNode` and
+ *    `ManagedTree`'s node-based iterators are not used here.
+ *  Elements are addressed by index only.
+ *
+ *  Erased nodes cannot be deallocated immediately because a reader may still
+ *    be looking at them.
+ *  They are kept in a retired list until `collect_garbage()` is called at a
+ *    time when no other thread is accessing the tree, or until the tree is
+ *    destroyed.
+ *  Values are never modified after insertion, so readers may copy them
+ *    without synchronization.
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+class ConcurrentTree {
+ private:
+  /// This type.
+  using This = ConcurrentTree<ValueT, AllocatorT>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = AllocatorT;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /**
+   *  @brief
+   *  Parameter `Delta` of the weight-balance condition:
+   *    `weight(one child) <= Delta * weight(other child)`.
+   */
+  static constexpr size_type kDelta{3};
+
+  /**
+   *  @brief
+   *  Parameter `Gamma` that chooses between a single and a double rotation.
+   */
+  static constexpr size_type kGamma{2};
+
+ protected:
+  /// Bit of `version` that is set while a writer holds the node.
+  static constexpr std::uint64_t kLockedBit{1};
+  /// Bit of `version` that is set once the node has been erased.
+  static constexpr std::uint64_t kObsoleteBit{2};
+  /// Amount added to `version` every time a writer releases a modified node.
+  static constexpr std::uint64_t kVersionIncrement{4};
+
+  /// Index of the left child in `child`.
+  static constexpr unsigned kLeft{0};
+  /// Index of the right child in `child`.
+  static constexpr unsigned kRight{1};
+
+  /**
+   *  @brief
+   *  Part of a node that does not depend on `Value`.
+   *
+   *  The head sentinel is a bare `NodeBase` whose left child is the root, so
+   *    replacing the root is synchronized the same way as replacing any other
+   *    child.
+   */
+  struct NodeBase {
+    /// Version counter, lock bit and obsolete bit.
+    std::atomic<std::uint64_t> version{0};
+    /// Left and right children.
+    std::atomic<NodeBase*> child[2]{nullptr, nullptr};
+    /// Size of the subtree rooted at this node.
+    std::atomic<size_type> size{1};
+  };
+
+  /// Node that holds a value.
+  struct Node : NodeBase {
+    /// Immutable value.
+    value_type value;
+
+    template<class... Args>
+    Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+  };
+
+  /// Allocator for `Node`.
+  using NodeAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<Node>;
+
+  /// Thrown internally when a reader must restart from the root.
+  struct Restart {};
+
+  /// Node allocator.
+  mutable NodeAllocator allocator_;
+
+  /// Head sentinel. `head_.child[kLeft]` is the root.
+  NodeBase head_;
+
+  /// Erased nodes that have not been deallocated yet.
+  std::vector<Node*> retired_;
+
+  /// Protects `retired_`.
+  std::mutex retired_mutex_;
+
+  /// Returns the size of `n`, or `0` if `n` is null.
+  static size_type get_size(NodeBase* n) {
+    return n ? n->size.load(std::memory_order_acquire) : 0;
+  }
+
+  /// Returns the child of `n` in the given direction.
+  static NodeBase* get_child(NodeBase* n, unsigned dir) {
+    return n->child[dir].load(std::memory_order_acquire);
+  }
+
+  /// Sets the child of `n` in the given direction.
+  static void set_child(NodeBase* n, unsigned dir, NodeBase* c) {
+    n->child[dir].store(c, std::memory_order_release);
+  }
+
+  /// Recomputes `size` of `n` from its children.
+  static void update_size(NodeBase* n) {
+    n->size.store(
+        1 + get_size(get_child(n, kLeft)) + get_size(get_child(n, kRight)),
+        std::memory_order_release);
+  }
+
+  /**
+   *  @brief
+   *  Waits until `n` is not locked, then returns its version.
+   *
+   *  Throws `Restart` if `n` has been erased.
+   */
+  static std::uint64_t read_lock(NodeBase* n) {
+    while (true) {
+      std::uint64_t const v{n->version.load(std::memory_order_acquire)};
+      if (v & kObsoleteBit) {
+        throw Restart{};
+      }
+      if (!(v & kLockedBit)) {
+        return v;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   *  @brief
+   *  Throws `Restart` if the version of `n` is no longer `v`.
+   */
+  static void validate(NodeBase* n, std::uint64_t v) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (n->version.load(std::memory_order_relaxed) != v) {
+      throw Restart{};
+    }
+  }
+
+  /**
+   *  @brief
+   *  Acquires the lock of `n` and returns the version before locking.
+   *
+   *  Writers only lock nodes that are reachable from a node they already
+   *    hold, so `n` cannot be obsolete here.
+   */
+  static std::uint64_t write_lock(NodeBase* n) {
+    while (true) {
+      std::uint64_t v{n->version.load(std::memory_order_relaxed)};
+      assert(!(v & kObsoleteBit));
+      if (!(v & kLockedBit) && n->version.compare_exchange_weak(
+            v, v | kLockedBit, std::memory_order_acquire)) {
+        return v;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  /// Releases `n`, which has been modified.
+  static void write_unlock(NodeBase* n, std::uint64_t v) {
+    n->version.store(v + kVersionIncrement, std::memory_order_release);
+  }
+
+  /// Releases `n`, which has not been modified.
+  static void write_unlock_unchanged(NodeBase* n, std::uint64_t v) {
+    n->version.store(v, std::memory_order_release);
+  }
+
+  /// Releases `n` and marks it as erased.
+  static void write_unlock_obsolete(NodeBase* n, std::uint64_t v) {
+    n->version.store(
+        (v | kObsoleteBit) + kVersionIncrement,
+        std::memory_order_release);
+  }
+
+  /**
+   *  @brief
+   *  Locked node on a writer's path, together with the version it had before
+   *    it was locked and whether it has been modified.
+   */
+  struct Held {
+    NodeBase* node;
+    std::uint64_t version;
+    bool modified;
+
+    void release() {
+      if (modified) {
+        write_unlock(node, version);
+      } else {
+        write_unlock_unchanged(node, version);
+      }
+    }
+  };
+
+  /**
+   *  @brief
+   *  Returns `true` if a subtree of weight `heavy` is too heavy compared to
+   *    its sibling of weight `light`.
+   */
+  static bool is_too_heavy(size_type heavy, size_type light) {
+    return heavy > kDelta * light;
+  }
+
+  /**
+   *  @brief
+   *  Rotates the subtree rooted at `n.node` so that its child in direction
+   *    `heavy_dir` moves up, and returns the new root of the subtree.
+   *
+   *  `p` and `n` must be locked, and `n` must be the child of `p` in
+   *    direction `p_dir`.
+   *  On return, `p` is marked as modified, `n` and any other node that was
+   *    restructured is released, and the returned node is locked.
+   *  Nodes below the rotated ones are not touched.
+   */
+  Held rotate(Held& p, unsigned p_dir, Held& n, unsigned heavy_dir) {
+    unsigned const d{heavy_dir};
+    unsigned const e{1 - heavy_dir};
+    NodeBase* c{get_child(n.node, d)};
+    assert(c);
+    Held held_c{c, write_lock(c), true};
+    NodeBase* inner{get_child(c, e)};
+    NodeBase* outer{get_child(c, d)};
+    if (get_size(inner) + 1 < kGamma * (get_size(outer) + 1)) {
+      // Single rotation.
+      set_child(n.node, d, inner);
+      set_child(c, e, n.node);
+      update_size(n.node);
+      update_size(c);
+      set_child(p.node, p_dir, c);
+      p.modified = true;
+      n.modified = true;
+      n.release();
+      return held_c;
+    }
+    // Double rotation.
+    assert(inner);
+    Held held_g{inner, write_lock(inner), true};
+    NodeBase* g{inner};
+    set_child(c, e, get_child(g, d));
+    set_child(n.node, d, get_child(g, e));
+    set_child(g, d, c);
+    set_child(g, e, n.node);
+    update_size(c);
+    update_size(n.node);
+    update_size(g);
+    set_child(p.node, p_dir, g);
+    p.modified = true;
+    n.modified = true;
+    n.release();
+    held_c.release();
+    return held_g;
+  }
+
+  /// Allocates and constructs a node.
+  template<class... Args>
+  Node* create_node(Args&&... args) {
+    Node* n{std::allocator_traits<NodeAllocator>::allocate(allocator_, 1)};
+    try {
+      std::allocator_traits<NodeAllocator>::construct(
+          allocator_, n, std::forward<Args>(args)...);
+    } catch (...) {
+      std::allocator_traits<NodeAllocator>::deallocate(allocator_, n, 1);
+      throw;
+    }
+    return n;
+  }
+
+  /// Destroys and deallocates a node.
+  void destroy_node(Node* n) {
+    std::allocator_traits<NodeAllocator>::destroy(allocator_, n);
+    std::allocator_traits<NodeAllocator>::deallocate(allocator_, n, 1);
+  }
+
+  /// Adds an erased node to the retired list.
+  void retire(Node* n) {
+    std::lock_guard<std::mutex> lock{retired_mutex_};
+    retired_.push_back(n);
+  }
+
+  /// Destroys all nodes in the subtree rooted at `n`.
+  void destroy_subtree(NodeBase* n) {
+    std::vector<NodeBase*> stack;
+    if (n) {
+      stack.push_back(n);
+    }
+    while (!stack.empty()) {
+      NodeBase* m{stack.back()};
+      stack.pop_back();
+      for (unsigned dir : {kLeft, kRight}) {
+        if (NodeBase* c{get_child(m, dir)}) {
+          stack.push_back(c);
+        }
+      }
+      destroy_node(static_cast<Node*>(m));
+    }
+  }
+
+  /**
+   *  @brief
+   *  Removes the leftmost node of the right subtree of `n` and puts it in
+   *    place of `n`, which is the child of `p` in direction `p_dir`.
+   *
+   *  `p` and `n` must be locked, `n` must have two children, and `n->size`
+   *    must already account for the erasure.
+   */
+  void replace_with_successor(Held& p, unsigned p_dir, Held& n) {
+    NodeBase* r{get_child(n.node, kRight)};
+    Held prev{n.node, n.version, true};
+    bool prev_is_n{true};
+    Held cur{r, write_lock(r), true};
+    cur.node->size.fetch_sub(1, std::memory_order_acq_rel);
+    while (NodeBase* l{get_child(cur.node, kLeft)}) {
+      Held next{l, write_lock(l), true};
+      next.node->size.fetch_sub(1, std::memory_order_acq_rel);
+      if (!prev_is_n) {
+        prev.release();
+      }
+      prev = cur;
+      prev_is_n = false;
+      cur = next;
+    }
+    NodeBase* s{cur.node};
+    if (prev_is_n) {
+      // `s` is the right child of `n`.
+      set_child(s, kLeft, get_child(n.node, kLeft));
+    } else {
+      set_child(prev.node, kLeft, get_child(s, kRight));
+      set_child(s, kLeft, get_child(n.node, kLeft));
+      set_child(s, kRight, get_child(n.node, kRight));
+      prev.release();
+    }
+    s->size.store(
+        n.node->size.load(std::memory_order_acquire),
+        std::memory_order_release);
+    set_child(p.node, p_dir, s);
+    p.modified = true;
+    cur.release();
+  }
+
+  /**
+   *  @brief
+   *  Links `new_node` so that it becomes the `index`-th element, or the last
+   *    element if `at_end` is `true`.
+   *
+   *  Returns `false` without modifying the tree if `index` is out of range.
+   *  When `at_end` is `true`, the index is read from the root while it is
+   *    locked, so the insertion cannot fail.
+   */
+  bool insert_node(size_type index, bool at_end, Node* new_node) {
+    Held p{&head_, write_lock(&head_), false};
+    unsigned p_dir{kLeft};
+    NodeBase* root{get_child(&head_, kLeft)};
+    if (!root) {
+      if (!at_end && index != 0) {
+        p.release();
+        return false;
+      }
+      set_child(&head_, kLeft, new_node);
+      p.modified = true;
+      p.release();
+      return true;
+    }
+    Held n{root, write_lock(root), false};
+    if (at_end) {
+      index = get_size(root);
+    } else if (index > get_size(root)) {
+      n.release();
+      p.release();
+      return false;
+    }
+    bool rotated{false};
+    while (true) {
+      NodeBase* l{get_child(n.node, kLeft)};
+      NodeBase* r{get_child(n.node, kRight)};
+      size_type const l_size{get_size(l)};
+      unsigned const dir{index <= l_size ? kLeft : kRight};
+      size_type const heavy{get_size(dir == kLeft ? l : r) + 2};
+      size_type const light{get_size(dir == kLeft ? r : l) + 1};
+      if (!rotated && heavy > 2 && is_too_heavy(heavy, light)) {
+        n = rotate(p, p_dir, n, dir);
+        rotated = true;
+        continue;
+      }
+      rotated = false;
+      n.node->size.fetch_add(1, std::memory_order_acq_rel);
+      n.modified = true;
+      if (dir == kRight) {
+        index -= l_size + 1;
+      }
+      NodeBase* c{get_child(n.node, dir)};
+      if (!c) {
+        set_child(n.node, dir, new_node);
+        n.release();
+        p.release();
+        return true;
+      }
+      Held held_c{c, write_lock(c), false};
+      p.release();
+      p = n;
+      p_dir = dir;
+      n = held_c;
+    }
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty tree.
+   */
+  ConcurrentTree(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator} {
+    head_.size.store(0, std::memory_order_relaxed);
+  }
+
+  ConcurrentTree(This const&) = delete;
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the tree and all retired nodes.
+   */
+  ~ConcurrentTree() {
+    destroy_subtree(get_child(&head_, kLeft));
+    collect_garbage();
+  }
+
+  /**
+   *  @brief
+   *  Deallocates erased nodes.
+   *
+   *  This must only be called while no other thread is accessing the tree.
+   */
+  void collect_garbage() {
+    std::lock_guard<std::mutex> lock{retired_mutex_};
+    for (Node* n : retired_) {
+      destroy_node(n);
+    }
+    retired_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of erased nodes waiting for `collect_garbage()`.
+   */
+  size_type retired_size() {
+    std::lock_guard<std::mutex> lock{retired_mutex_};
+    return retired_.size();
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements.
+   *
+   *  This includes insertions that are still in progress.
+   */
+  size_type size() const {
+    return get_size(get_child(const_cast<NodeBase*>(&head_), kLeft));
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the tree is empty.
+   */
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns a copy of the `index`-th element.
+   *
+   *  This never blocks writers.
+   *  Throws `std::out_of_range` if `index` is not smaller than the size
+   *    observed by the lookup.
+   */
+  value_type at(size_type index) const {
+    NodeBase* const head{const_cast<NodeBase*>(&head_)};
+    while (true) {
+      try {
+        std::uint64_t v{read_lock(head)};
+        NodeBase* n{get_child(head, kLeft)};
+        if (!n) {
+          validate(head, v);
+          throw std::out_of_range("ConcurrentTree::at -- index out of range");
+        }
+        std::uint64_t nv{read_lock(n)};
+        validate(head, v);
+        if (index >= get_size(n)) {
+          validate(n, nv);
+          throw std::out_of_range("ConcurrentTree::at -- index out of range");
+        }
+        size_type i{index};
+        while (true) {
+          NodeBase* l{get_child(n, kLeft)};
+          size_type const l_size{get_size(l)};
+          NodeBase* next;
+          if (i < l_size) {
+            next = l;
+          } else if (i == l_size) {
+            value_type value{static_cast<Node*>(n)->value};
+            validate(n, nv);
+            return value;
+          } else {
+            i -= l_size + 1;
+            next = get_child(n, kRight);
+          }
+          if (!next) {
+            throw Restart{};
+          }
+          std::uint64_t const next_v{read_lock(next)};
+          validate(n, nv);
+          n = next;
+          nv = next_v;
+        }
+      } catch (Restart const&) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   *  @brief
+   *  Same as `at(index)`.
+   */
+  value_type operator[](size_type index) const {
+    return at(index);
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it so that it becomes the `index`-th
+   *    element.
+   *
+   *  `index` may be equal to `size()`.
+   *  Throws `std::out_of_range` if `index` is greater than `size()`.
+   */
+  template<class... Args>
+  void emplace(size_type index, Args&&... args) {
+    Node* new_node{create_node(std::forward<Args>(args)...)};
+    if (!insert_node(index, false, new_node)) {
+      destroy_node(new_node);
+      throw std::out_of_range("ConcurrentTree::emplace -- index out of range");
+    }
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` so that it becomes the `index`-th element.
+   */
+  void insert(size_type index, value_type const& value) {
+    emplace(index, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` so that it becomes the `index`-th element.
+   */
+  void insert(size_type index, value_type&& value) {
+    emplace(index, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type const& value) {
+    emplace(0, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type&& value) {
+    emplace(0, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the last element.
+   *
+   *  The position is determined while the root is locked, so concurrent
+   *    calls never fail.
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    Node* new_node{create_node(std::forward<Args>(args)...)};
+    insert_node(0, true, new_node);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Erases the `index`-th element.
+   *
+   *  The erased node is retired, not deallocated.
+   *  (See `collect_garbage()`.)
+   *  Throws `std::out_of_range` if `index` is not smaller than `size()`.
+   */
+  void erase(size_type index) {
+    Held p{&head_, write_lock(&head_), false};
+    unsigned p_dir{kLeft};
+    NodeBase* root{get_child(&head_, kLeft)};
+    if (!root) {
+      p.release();
+      throw std::out_of_range("ConcurrentTree::erase -- index out of range");
+    }
+    Held n{root, write_lock(root), false};
+    if (index >= get_size(root)) {
+      n.release();
+      p.release();
+      throw std::out_of_range("ConcurrentTree::erase -- index out of range");
+    }
+    bool rotated{false};
+    while (true) {
+      NodeBase* l{get_child(n.node, kLeft)};
+      NodeBase* r{get_child(n.node, kRight)};
+      size_type const l_size{get_size(l)};
+      if (index == l_size) {
+        n.node->size.fetch_sub(1, std::memory_order_acq_rel);
+        if (l && r) {
+          replace_with_successor(p, p_dir, n);
+        } else {
+          set_child(p.node, p_dir, l ? l : r);
+          p.modified = true;
+        }
+        write_unlock_obsolete(n.node, n.version);
+        p.release();
+        retire(static_cast<Node*>(n.node));
+        return;
+      }
+      unsigned const dir{index < l_size ? kLeft : kRight};
+      size_type const light{get_size(dir == kLeft ? l : r)};
+      size_type const heavy{get_size(dir == kLeft ? r : l) + 1};
+      if (!rotated && is_too_heavy(heavy, light) &&
+          get_child(n.node, 1 - dir)) {
+        n = rotate(p, p_dir, n, 1 - dir);
+        rotated = true;
+        continue;
+      }
+      rotated = false;
+      n.node->size.fetch_sub(1, std::memory_order_acq_rel);
+      n.modified = true;
+      if (dir == kRight) {
+        index -= l_size + 1;
+      }
+      NodeBase* c{get_child(n.node, dir)};
+      assert(c);
+      Held held_c{c, write_lock(c), false};
+      p.release();
+      p = n;
+      p_dir = dir;
+      n = held_c;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    erase(0);
+  }
+
+  /**
+   *  @brief
+   *  Copies all elements into a `std::vector`.
+   *
+   *  This must only be called while no other thread is modifying the tree.
+   */
+  std::vector<value_type> to_vector() const {
+    std::vector<value_type> values;
+    std::vector<NodeBase*> stack;
+    NodeBase* n{get_child(const_cast<NodeBase*>(&head_), kLeft)};
+    while (n || !stack.empty()) {
+      for (; n; n = get_child(n, kLeft)) {
+        stack.push_back(n);
+      }
+      n = stack.back();
+      stack.pop_back();
+      values.push_back(static_cast<Node*>(n)->value);
+      n = get_child(n, kRight);
+    }
+    return values;
+  }
+
+  /**
+   *  @brief
+   *  Returns the height of the tree, or `0` if the tree is empty.
+   *
+   *  This must only be called while no other thread is modifying the tree.
+   */
+  size_type height() const {
+    size_type max_depth{0};
+    std::vector<std::pair<NodeBase*, size_type>> stack;
+    if (NodeBase* root{get_child(const_cast<NodeBase*>(&head_), kLeft)}) {
+      stack.emplace_back(root, 1);
+    }
+    while (!stack.empty()) {
+      auto [n, depth] = stack.back();
+      stack.pop_back();
+      max_depth = std::max(max_depth, depth);
+      for (unsigned dir : {kLeft, kRight}) {
+        if (NodeBase* c{get_child(n, dir)}) {
+          stack.emplace_back(c, depth + 1);
+        }
+      }
+    }
+    return max_depth;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff every `size` equals one plus the sizes of the
+   *    children and no node is locked.
+   *
+   *  This must only be called while no other thread is modifying the tree.
+   */
+  bool check_invariants() const {
+    std::vector<NodeBase*> stack;
+    if (NodeBase* root{get_child(const_cast<NodeBase*>(&head_), kLeft)}) {
+      stack.push_back(root);
+    }
+    while (!stack.empty()) {
+      NodeBase* n{stack.back()};
+      stack.pop_back();
+      NodeBase* l{get_child(n, kLeft)};
+      NodeBase* r{get_child(n, kRight)};
+      if (get_size(n) != 1 + get_size(l) + get_size(r)) {
+        return false;
+      }
+      if (n->version.load() & (kLockedBit | kObsoleteBit)) {
+        return false;
+      }
+      if (l) {
+        stack.push_back(l);
+      }
+      if (r) {
+        stack.push_back(r);
+      }
+    }
+    return true;
+  }
+
+};
+
+} // namespace ordered_binary_trees
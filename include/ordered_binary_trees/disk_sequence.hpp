@@ -0,0 +1,1106 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Fixed-size cache of file pages with clock (second-chance) eviction.
+ *
+ *  Pages are read with `pread()` on a miss and written back with `pwrite()`
+ *    when a dirty page is evicted or `flush()` is called.
+ *  A page is pinned while a `PageRef` to it exists, and pinned pages are
+ *    never evicted.
+ *  The memory used is `num_frames * kPageSize` bytes regardless of the file
+ *    size.
+ */
+template<std::size_t kPageSize>
+class BufferPool {
+ public:
+  /// Type of page numbers.
+  using PageId = std::uint64_t;
+
+  /// Storage for one page.
+  struct alignas(64) Page {
+    unsigned char bytes[kPageSize];
+  };
+
+ protected:
+  /// State of one frame.
+  struct Frame {
+    /// Page held by this frame, or `kNoPage`.
+    PageId page;
+    /// Number of `PageRef`s to this frame.
+    std::uint32_t pins;
+    /// Whether the page must be written back.
+    bool dirty;
+    /// Clock reference bit.
+    bool referenced;
+  };
+
+  /// Page number that no frame holds.
+  static constexpr PageId kNoPage{~PageId{0}};
+
+  /// File descriptor.
+  int fd_;
+
+  /// Frame states.
+  std::vector<Frame> frames_;
+
+  /// Frame contents.
+  std::unique_ptr<Page[]> pages_;
+
+  /// Map from page numbers to frames.
+  std::unordered_map<PageId, std::size_t> table_;
+
+  /// Clock hand.
+  std::size_t hand_{0};
+
+  /// Number of pages read from the file.
+  std::size_t num_reads_{0};
+
+  /// Number of pages written to the file.
+  std::size_t num_writes_{0};
+
+  [[noreturn]] static void throw_errno(char const* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  /// Writes the page in frame `f` back to the file.
+  void write_frame(std::size_t f) {
+    Frame& frame{frames_[f]};
+    off_t const offset{static_cast<off_t>(frame.page * kPageSize)};
+    if (::pwrite(fd_, pages_[f].bytes, kPageSize, offset) !=
+        static_cast<ssize_t>(kPageSize)) {
+      throw_errno("BufferPool -- pwrite");
+    }
+    frame.dirty = false;
+    ++num_writes_;
+  }
+
+  /// Reads `page` into frame `f`. Bytes past the end of file read as zero.
+  void read_frame(std::size_t f, PageId page) {
+    off_t const offset{static_cast<off_t>(page * kPageSize)};
+    ssize_t const n{::pread(fd_, pages_[f].bytes, kPageSize, offset)};
+    if (n < 0) {
+      throw_errno("BufferPool -- pread");
+    }
+    std::memset(pages_[f].bytes + n, 0, kPageSize - n);
+    ++num_reads_;
+  }
+
+  /**
+   *  @brief
+   *  Finds an unpinned frame with the clock algorithm, writes it back if
+   *    needed, and detaches it from its page.
+   */
+  std::size_t acquire_frame() {
+    for (std::size_t steps{0}; steps < 2 * frames_.size(); ++steps) {
+      std::size_t const f{hand_};
+      hand_ = (hand_ + 1) % frames_.size();
+      Frame& frame{frames_[f]};
+      if (frame.pins > 0) {
+        continue;
+      }
+      if (frame.referenced) {
+        frame.referenced = false;
+        continue;
+      }
+      if (frame.page != kNoPage) {
+        if (frame.dirty) {
+          write_frame(f);
+        }
+        table_.erase(frame.page);
+        frame.page = kNoPage;
+      }
+      return f;
+    }
+    throw std::runtime_error("BufferPool -- all frames are pinned");
+  }
+
+  /// Attaches frame `f` to `page`, pinned.
+  void attach(std::size_t f, PageId page) {
+    frames_[f] = Frame{page, 1, false, true};
+    table_.emplace(page, f);
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Pinned reference to a cached page.
+   */
+  class PageRef {
+   public:
+    PageRef() = default;
+
+    PageRef(BufferPool* pool, std::size_t frame)
+      : pool_{pool}, frame_{frame} {}
+
+    PageRef(PageRef&& other) noexcept
+      : pool_{std::exchange(other.pool_, nullptr)}, frame_{other.frame_} {}
+
+    PageRef& operator=(PageRef&& other) noexcept {
+      if (this != &other) {
+        release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        frame_ = other.frame_;
+      }
+      return *this;
+    }
+
+    ~PageRef() {
+      release();
+    }
+
+    /// Unpins the page.
+    void release() {
+      if (pool_) {
+        assert(pool_->frames_[frame_].pins > 0);
+        --pool_->frames_[frame_].pins;
+        pool_ = nullptr;
+      }
+    }
+
+    /// Returns the page number.
+    PageId id() const {
+      assert(pool_);
+      return pool_->frames_[frame_].page;
+    }
+
+    /// Returns the page contents as `T`.
+    template<class T>
+    T* as() const {
+      static_assert(sizeof(T) <= kPageSize);
+      assert(pool_);
+      return reinterpret_cast<T*>(pool_->pages_[frame_].bytes);
+    }
+
+    /// Marks the page as modified.
+    void mark_dirty() {
+      assert(pool_);
+      pool_->frames_[frame_].dirty = true;
+    }
+
+   protected:
+    BufferPool* pool_{nullptr};
+    std::size_t frame_{0};
+  };
+
+  /**
+   *  @brief
+   *  Creates a pool of `num_frames` frames for the file `fd`.
+   */
+  BufferPool(int fd, std::size_t num_frames)
+    : fd_{fd},
+      frames_(num_frames, Frame{kNoPage, 0, false, false}),
+      pages_{new Page[num_frames]} {
+    table_.reserve(num_frames);
+  }
+
+  BufferPool(BufferPool const&) = delete;
+
+  BufferPool& operator=(BufferPool const&) = delete;
+
+  /**
+   *  @brief
+   *  Returns a pinned reference to `page`, reading it if necessary.
+   */
+  PageRef fetch(PageId page) {
+    auto it{table_.find(page)};
+    if (it != table_.end()) {
+      Frame& frame{frames_[it->second]};
+      ++frame.pins;
+      frame.referenced = true;
+      return {this, it->second};
+    }
+    std::size_t const f{acquire_frame()};
+    read_frame(f, page);
+    attach(f, page);
+    return {this, f};
+  }
+
+  /**
+   *  @brief
+   *  Returns a pinned reference to `page` filled with zeros, without reading
+   *    it.
+   *
+   *  The page is marked dirty.
+   */
+  PageRef create(PageId page) {
+    auto it{table_.find(page)};
+    std::size_t f;
+    if (it != table_.end()) {
+      f = it->second;
+      assert(frames_[f].pins == 0);
+      ++frames_[f].pins;
+      frames_[f].referenced = true;
+    } else {
+      f = acquire_frame();
+      attach(f, page);
+    }
+    std::memset(pages_[f].bytes, 0, kPageSize);
+    frames_[f].dirty = true;
+    return {this, f};
+  }
+
+  /**
+   *  @brief
+   *  Asks the operating system to start reading `count` pages from `page`
+   *    in the background.
+   */
+  void readahead(PageId page, std::size_t count) {
+#if defined(POSIX_FADV_WILLNEED)
+    ::posix_fadvise(fd_,
+        static_cast<off_t>(page * kPageSize),
+        static_cast<off_t>(count * kPageSize),
+        POSIX_FADV_WILLNEED);
+#else
+    (void)page;
+    (void)count;
+#endif
+  }
+
+  /**
+   *  @brief
+   *  Writes every dirty page back to the file.
+   */
+  void flush() {
+    for (std::size_t f{0}; f < frames_.size(); ++f) {
+      if (frames_[f].page != kNoPage && frames_[f].dirty) {
+        write_frame(f);
+      }
+    }
+  }
+
+  /// Returns the number of frames.
+  std::size_t num_frames() const {
+    return frames_.size();
+  }
+
+  /// Returns the number of pages read from the file so far.
+  std::size_t num_reads() const {
+    return num_reads_;
+  }
+
+  /// Returns the number of pages written to the file so far.
+  std::size_t num_writes() const {
+    return num_writes_;
+  }
+};
+
+/**
+ *  @brief
+ *  Sequence stored in a file as an order-statistic B+ tree, cached by a
+ *    `BufferPool` of bounded size.
+ *
+ *  Each page is one node.
+ *  Leaves store values and are chained left to right; internal nodes store
+ *    child page numbers and the number of values under each child, so the
+ *    `index`-th value is found by one root-to-leaf descent.
+ *  Insertion splits full nodes, and erasure merges or redistributes nodes
+ *    that fall below a quarter of their capacity.
+ *  A node on the rightmost spine that overflows at its right end is split
+ *    by starting a new node instead of halving, so appending fills pages
+ *    completely.
+ *  Freed pages are kept in a free list inside the file.
+ *
+ *  Values are copied in and out, so `ValueT` must be trivially copyable and
+ *    element access returns values rather than references.
+ *  Iterating with `begin()` and `end()` walks the leaf chain and asks the
+ *    operating system to read ahead of the current leaf.
+ *
+ *  Contents persist in the file: `flush()` writes them out, and so does the
+ *    destructor.
+ *  A file written with a different `ValueT` size or `kPageSize` is rejected.
+ */
+template<class ValueT, std::size_t kPageSize = 4096>
+class DiskSequence {
+  static_assert(std::is_trivially_copyable_v<ValueT>,
+      "DiskSequence requires trivially copyable values");
+
+ private:
+  /// This class.
+  using This = DiskSequence<ValueT, kPageSize>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of indices.
+  using size_type = std::size_t;
+
+  /// Type of the buffer pool.
+  using Pool = BufferPool<kPageSize>;
+
+  /// Default number of pages kept in memory.
+  static constexpr std::size_t kDefaultNumFrames{1024};
+
+  /// Smallest accepted number of frames.
+  static constexpr std::size_t kMinNumFrames{16};
+
+  /// Number of pages the operating system is asked to read ahead.
+  static constexpr std::size_t kReadaheadPages{8};
+
+ protected:
+  /// Type of page numbers.
+  using PageId = typename Pool::PageId;
+
+  /// Pinned page.
+  using PageRef = typename Pool::PageRef;
+
+  /// Page 0 holds `FileHeader`, so `0` can mean "no page" elsewhere.
+  static constexpr PageId kNoPage{0};
+
+  /// File signature.
+  static constexpr std::uint64_t kMagic{0x3151455344544f42}; // "OBTDSEQ1"
+
+  /// Kinds of pages.
+  enum PageKind: std::uint32_t {
+    kFreePage = 0,
+    kLeafPage = 1,
+    kInternalPage = 2,
+  };
+
+  /// Header common to all node pages.
+  struct NodeHeader {
+    /// `PageKind`.
+    std::uint32_t kind;
+    /// Number of values in a leaf, or of children in an internal node.
+    std::uint32_t count;
+    /// Next leaf, or next free page.
+    PageId next;
+  };
+
+  /// Number of values in a leaf.
+  static constexpr std::size_t kLeafCapacity{
+      (kPageSize - sizeof(NodeHeader)) / sizeof(ValueT)};
+
+  /// Number of children in an internal node.
+  static constexpr std::size_t kFanout{
+      (kPageSize - sizeof(NodeHeader)) / (sizeof(PageId) + sizeof(size_type))};
+
+  static_assert(kLeafCapacity >= 4 && kFanout >= 4,
+      "DiskSequence -- kPageSize is too small");
+
+  /// Layout of a leaf page.
+  struct LeafNode {
+    NodeHeader header;
+    ValueT values[kLeafCapacity];
+  };
+
+  /// Layout of an internal page.
+  struct InternalNode {
+    NodeHeader header;
+    PageId children[kFanout];
+    std::uint64_t counts[kFanout];
+  };
+
+  /// Layout of page 0.
+  struct FileHeader {
+    std::uint64_t magic;
+    std::uint64_t page_size;
+    std::uint64_t value_size;
+    PageId root;
+    std::uint64_t size;
+    std::uint64_t num_pages;
+    PageId free_head;
+  };
+
+  /// Result of inserting into a subtree: a new right sibling, if any.
+  struct Split {
+    PageId page{kNoPage};
+    std::uint64_t count{0};
+  };
+
+  /// Path of the file.
+  std::string path_;
+
+  /// File descriptor.
+  int fd_;
+
+  /// In-memory copy of page 0.
+  FileHeader header_;
+
+  /// Page cache.
+  mutable Pool pool_;
+
+  [[noreturn]] static void throw_errno(char const* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  /// Opens or creates `path`.
+  static int open_file(std::string const& path) {
+    int const fd{::open(path.c_str(), O_RDWR | O_CREAT, 0644)};
+    if (fd < 0) {
+      throw_errno("DiskSequence -- open");
+    }
+    return fd;
+  }
+
+  /// Reads page 0, or initializes it for an empty file.
+  void load_header() {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+      throw_errno("DiskSequence -- fstat");
+    }
+    if (st.st_size == 0) {
+      header_ = FileHeader{
+          kMagic, kPageSize, sizeof(ValueT), kNoPage, 0, 1, kNoPage};
+      write_header();
+      return;
+    }
+    if (::pread(fd_, &header_, sizeof(header_), 0) !=
+        static_cast<ssize_t>(sizeof(header_))) {
+      throw_errno("DiskSequence -- pread");
+    }
+    if (header_.magic != kMagic ||
+        header_.page_size != kPageSize ||
+        header_.value_size != sizeof(ValueT)) {
+      throw std::runtime_error("DiskSequence -- incompatible file");
+    }
+  }
+
+  /// Writes page 0.
+  void write_header() {
+    if (::pwrite(fd_, &header_, sizeof(header_), 0) !=
+        static_cast<ssize_t>(sizeof(header_))) {
+      throw_errno("DiskSequence -- pwrite");
+    }
+  }
+
+  /// Takes a page from the free list or the end of the file.
+  PageRef allocate_page(PageKind kind) {
+    PageId id{header_.free_head};
+    if (id != kNoPage) {
+      header_.free_head = pool_.fetch(id).template as<NodeHeader>()->next;
+    } else {
+      id = header_.num_pages++;
+    }
+    PageRef ref{pool_.create(id)};
+    ref.template as<NodeHeader>()->kind = kind;
+    return ref;
+  }
+
+  /// Puts `id` on the free list.
+  void free_page(PageId id) {
+    PageRef ref{pool_.create(id)};
+    NodeHeader* header{ref.template as<NodeHeader>()};
+    header->kind = kFreePage;
+    header->next = header_.free_head;
+    header_.free_head = id;
+  }
+
+  /// Returns the leaf holding the `index`-th value and its offset there.
+  std::pair<PageRef, std::size_t> find_leaf(size_type index) const {
+    assert(index < size());
+    PageRef ref{pool_.fetch(header_.root)};
+    while (ref.template as<NodeHeader>()->kind == kInternalPage) {
+      InternalNode const* node{ref.template as<InternalNode>()};
+      std::size_t i{0};
+      while (index >= node->counts[i]) {
+        index -= node->counts[i];
+        ++i;
+        assert(i < node->header.count);
+      }
+      ref = pool_.fetch(node->children[i]);
+    }
+    return {std::move(ref), index};
+  }
+
+  /// Inserts `value` at `index` in the subtree at `id`.
+  ///
+  /// A full page is halved, except that a page on the rightmost spine of the
+  /// tree (`rightmost` for internal pages, the end of the leaf chain for
+  /// leaves) that overflows at its right end is left full.
+  Split insert_into(
+      PageId id,
+      size_type index,
+      ValueT const& value,
+      bool rightmost) {
+    PageRef ref{pool_.fetch(id)};
+    ref.mark_dirty();
+    if (ref.template as<NodeHeader>()->kind == kLeafPage) {
+      LeafNode* leaf{ref.template as<LeafNode>()};
+      std::size_t const count{leaf->header.count};
+      assert(index <= count);
+      if (count < kLeafCapacity) {
+        insert_into_leaf(leaf, index, value);
+        return {};
+      }
+      PageRef right_ref{allocate_page(kLeafPage)};
+      LeafNode* right{right_ref.template as<LeafNode>()};
+      bool const append{index == count && leaf->header.next == kNoPage};
+      std::size_t const half{append ? count : count / 2};
+      std::copy(leaf->values + half, leaf->values + count, right->values);
+      right->header.count = static_cast<std::uint32_t>(count - half);
+      leaf->header.count = static_cast<std::uint32_t>(half);
+      right->header.next = leaf->header.next;
+      leaf->header.next = right_ref.id();
+      if (index <= half && half < count) {
+        insert_into_leaf(leaf, index, value);
+      } else {
+        insert_into_leaf(right, index - half, value);
+      }
+      return {right_ref.id(), right->header.count};
+    }
+
+    InternalNode* node{ref.template as<InternalNode>()};
+    std::size_t i{0};
+    while (i + 1 < node->header.count && index > node->counts[i]) {
+      index -= node->counts[i];
+      ++i;
+    }
+    bool const last{i + 1 == node->header.count};
+    Split const split{
+        insert_into(node->children[i], index, value, rightmost && last)};
+    ++node->counts[i];
+    if (split.page == kNoPage) {
+      return {};
+    }
+    node->counts[i] -= split.count;
+    if (node->header.count < kFanout) {
+      insert_child(node, i + 1, split.page, split.count);
+      return {};
+    }
+    PageRef right_ref{allocate_page(kInternalPage)};
+    InternalNode* right{right_ref.template as<InternalNode>()};
+    std::size_t const count{node->header.count};
+    std::size_t const half{rightmost && last ? count : count / 2};
+    std::copy(node->children + half, node->children + count, right->children);
+    std::copy(node->counts + half, node->counts + count, right->counts);
+    right->header.count = static_cast<std::uint32_t>(count - half);
+    node->header.count = static_cast<std::uint32_t>(half);
+    if (i + 1 <= half && half < count) {
+      insert_child(node, i + 1, split.page, split.count);
+    } else {
+      insert_child(right, i + 1 - half, split.page, split.count);
+    }
+    return {right_ref.id(), total_count(right)};
+  }
+
+  static void insert_into_leaf(
+      LeafNode* leaf,
+      std::size_t index,
+      ValueT const& value) {
+    std::size_t const count{leaf->header.count};
+    std::copy_backward(
+        leaf->values + index, leaf->values + count,
+        leaf->values + count + 1);
+    leaf->values[index] = value;
+    ++leaf->header.count;
+  }
+
+  static void insert_child(
+      InternalNode* node,
+      std::size_t i,
+      PageId child,
+      std::uint64_t count) {
+    std::size_t const n{node->header.count};
+    std::copy_backward(node->children + i, node->children + n,
+        node->children + n + 1);
+    std::copy_backward(node->counts + i, node->counts + n,
+        node->counts + n + 1);
+    node->children[i] = child;
+    node->counts[i] = count;
+    ++node->header.count;
+  }
+
+  static void erase_child(InternalNode* node, std::size_t i) {
+    std::size_t const n{node->header.count};
+    std::copy(node->children + i + 1, node->children + n, node->children + i);
+    std::copy(node->counts + i + 1, node->counts + n, node->counts + i);
+    --node->header.count;
+  }
+
+  static std::uint64_t total_count(InternalNode const* node) {
+    std::uint64_t total{0};
+    for (std::size_t i{0}; i < node->header.count; ++i) {
+      total += node->counts[i];
+    }
+    return total;
+  }
+
+  /// Erases the `index`-th value in the subtree at `id`.
+  void erase_from(PageId id, size_type index) {
+    PageRef ref{pool_.fetch(id)};
+    ref.mark_dirty();
+    if (ref.template as<NodeHeader>()->kind == kLeafPage) {
+      LeafNode* leaf{ref.template as<LeafNode>()};
+      assert(index < leaf->header.count);
+      std::copy(leaf->values + index + 1, leaf->values + leaf->header.count,
+          leaf->values + index);
+      --leaf->header.count;
+      return;
+    }
+    InternalNode* node{ref.template as<InternalNode>()};
+    std::size_t i{0};
+    while (index >= node->counts[i]) {
+      index -= node->counts[i];
+      ++i;
+      assert(i < node->header.count);
+    }
+    erase_from(node->children[i], index);
+    --node->counts[i];
+    fix_underflow(node, i);
+  }
+
+  /**
+   *  @brief
+   *  Merges or redistributes child `i` of `node` with a sibling if it has
+   *    fewer than a quarter of its capacity.
+   */
+  void fix_underflow(InternalNode* node, std::size_t i) {
+    if (node->header.count < 2) {
+      return;
+    }
+    PageRef child_ref{pool_.fetch(node->children[i])};
+    NodeHeader const* child{child_ref.template as<NodeHeader>()};
+    bool const is_leaf{child->kind == kLeafPage};
+    std::size_t const capacity{is_leaf ? kLeafCapacity : kFanout};
+    if (child->count >= capacity / 4) {
+      return;
+    }
+    std::size_t const l{i + 1 < node->header.count ? i : i - 1};
+    std::size_t const r{l + 1};
+    PageRef left_ref{pool_.fetch(node->children[l])};
+    PageRef right_ref{pool_.fetch(node->children[r])};
+    left_ref.mark_dirty();
+    right_ref.mark_dirty();
+    child_ref.release();
+    if (is_leaf) {
+      LeafNode* left{left_ref.template as<LeafNode>()};
+      LeafNode* right{right_ref.template as<LeafNode>()};
+      std::size_t const total{left->header.count + right->header.count};
+      if (total <= capacity) {
+        std::copy(right->values, right->values + right->header.count,
+            left->values + left->header.count);
+        left->header.count = static_cast<std::uint32_t>(total);
+        left->header.next = right->header.next;
+        merge_entries(node, l, std::move(right_ref));
+        return;
+      }
+      std::size_t const target{total / 2};
+      if (left->header.count < target) {
+        std::size_t const k{target - left->header.count};
+        std::copy(right->values, right->values + k,
+            left->values + left->header.count);
+        std::copy(right->values + k, right->values + right->header.count,
+            right->values);
+        left->header.count += static_cast<std::uint32_t>(k);
+        right->header.count -= static_cast<std::uint32_t>(k);
+      } else {
+        std::size_t const k{left->header.count - target};
+        std::copy_backward(right->values,
+            right->values + right->header.count,
+            right->values + right->header.count + k);
+        std::copy(left->values + target, left->values + left->header.count,
+            right->values);
+        left->header.count -= static_cast<std::uint32_t>(k);
+        right->header.count += static_cast<std::uint32_t>(k);
+      }
+      node->counts[l] = left->header.count;
+      node->counts[r] = right->header.count;
+      return;
+    }
+
+    InternalNode* left{left_ref.template as<InternalNode>()};
+    InternalNode* right{right_ref.template as<InternalNode>()};
+    std::size_t const total{left->header.count + right->header.count};
+    if (total <= capacity) {
+      std::copy(right->children, right->children + right->header.count,
+          left->children + left->header.count);
+      std::copy(right->counts, right->counts + right->header.count,
+          left->counts + left->header.count);
+      left->header.count = static_cast<std::uint32_t>(total);
+      merge_entries(node, l, std::move(right_ref));
+      return;
+    }
+    std::size_t const target{total / 2};
+    if (left->header.count < target) {
+      std::size_t const k{target - left->header.count};
+      std::copy(right->children, right->children + k,
+          left->children + left->header.count);
+      std::copy(right->counts, right->counts + k,
+          left->counts + left->header.count);
+      std::copy(right->children + k, right->children + right->header.count,
+          right->children);
+      std::copy(right->counts + k, right->counts + right->header.count,
+          right->counts);
+      left->header.count += static_cast<std::uint32_t>(k);
+      right->header.count -= static_cast<std::uint32_t>(k);
+    } else {
+      std::size_t const k{left->header.count - target};
+      std::size_t const n{right->header.count};
+      std::copy_backward(right->children, right->children + n,
+          right->children + n + k);
+      std::copy_backward(right->counts, right->counts + n,
+          right->counts + n + k);
+      std::copy(left->children + target, left->children + left->header.count,
+          right->children);
+      std::copy(left->counts + target, left->counts + left->header.count,
+          right->counts);
+      left->header.count -= static_cast<std::uint32_t>(k);
+      right->header.count += static_cast<std::uint32_t>(k);
+    }
+    std::uint64_t const left_total{total_count(left)};
+    node->counts[r] = node->counts[l] + node->counts[r] - left_total;
+    node->counts[l] = left_total;
+  }
+
+  /// Removes child `l + 1` of `node`, whose entries moved into child `l`.
+  void merge_entries(InternalNode* node, std::size_t l, PageRef right_ref) {
+    PageId const right_id{right_ref.id()};
+    right_ref.release();
+    node->counts[l] += node->counts[l + 1];
+    erase_child(node, l + 1);
+    free_page(right_id);
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Constant forward iterator over the values, in order.
+   *
+   *  Dereferencing returns a copy of the value.
+   */
+  class const_iterator {
+   public:
+    using value_type = ValueT;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = ValueT;
+    using iterator_category = std::input_iterator_tag;
+
+    const_iterator() = default;
+
+    /// Returns the value.
+    ValueT operator*() const {
+      PageRef ref{sequence_->pool_.fetch(leaf_)};
+      return ref.template as<LeafNode>()->values[offset_];
+    }
+
+    /// Moves to the next value.
+    const_iterator& operator++() {
+      ++index_;
+      if (index_ == sequence_->size()) {
+        return *this;
+      }
+      PageRef ref{sequence_->pool_.fetch(leaf_)};
+      LeafNode const* leaf{ref.template as<LeafNode>()};
+      if (++offset_ < leaf->header.count) {
+        return *this;
+      }
+      leaf_ = leaf->header.next;
+      offset_ = 0;
+      ref = sequence_->pool_.fetch(leaf_);
+      PageId const next{ref.template as<LeafNode>()->header.next};
+      if (next != kNoPage) {
+        sequence_->pool_.readahead(next, kReadaheadPages);
+      }
+      return *this;
+    }
+
+    /// Moves to the next value.
+    const_iterator operator++(int) {
+      const_iterator result{*this};
+      ++*this;
+      return result;
+    }
+
+    /// Returns the index of the value.
+    size_type get_index() const {
+      return index_;
+    }
+
+    bool operator==(const_iterator const& other) const {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const_iterator const& other) const {
+      return index_ != other.index_;
+    }
+
+   protected:
+    friend class DiskSequence;
+
+    const_iterator(
+        This const* sequence,
+        PageId leaf,
+        std::size_t offset,
+        size_type index)
+      : sequence_{sequence}, leaf_{leaf}, offset_{offset}, index_{index} {}
+
+    This const* sequence_{nullptr};
+    PageId leaf_{kNoPage};
+    std::size_t offset_{0};
+    size_type index_{0};
+  };
+
+  /// Values cannot be modified through iterators.
+  using iterator = const_iterator;
+
+  /**
+   *  @brief
+   *  Opens the sequence stored in `path`, or creates an empty one, with a
+   *    buffer pool of `num_frames` pages.
+   */
+  explicit DiskSequence(
+      std::string const& path,
+      std::size_t num_frames = kDefaultNumFrames)
+    : path_{path},
+      fd_{open_file(path)},
+      pool_{fd_, std::max(num_frames, kMinNumFrames)} {
+    try {
+      load_header();
+    } catch (...) {
+      ::close(fd_);
+      throw;
+    }
+  }
+
+  DiskSequence(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Writes pending changes and closes the file.
+   */
+  ~DiskSequence() {
+    try {
+      flush();
+    } catch (...) {
+    }
+    ::close(fd_);
+  }
+
+  /**
+   *  @brief
+   *  Writes every modified page and the file header.
+   */
+  void flush() {
+    pool_.flush();
+    write_header();
+  }
+
+  /// Returns the path of the file.
+  std::string const& path() const {
+    return path_;
+  }
+
+  /// Returns the number of values.
+  size_type size() const {
+    return static_cast<size_type>(header_.size);
+  }
+
+  /// Returns `true` iff there are no values.
+  bool empty() const {
+    return header_.size == 0;
+  }
+
+  /// Returns the number of pages in the file, including free ones.
+  std::size_t num_pages() const {
+    return static_cast<std::size_t>(header_.num_pages);
+  }
+
+  /// Returns the buffer pool.
+  Pool const& pool() const {
+    return pool_;
+  }
+
+  /**
+   *  @brief
+   *  Returns the `index`-th value.
+   */
+  ValueT operator[](size_type index) const {
+    auto [ref, offset]{find_leaf(index)};
+    return ref.template as<LeafNode>()->values[offset];
+  }
+
+  /**
+   *  @brief
+   *  Returns the `index`-th value.
+   *
+   *  If `index` is out of range, `std::out_of_range` will be thrown.
+   */
+  ValueT at(size_type index) const {
+    if (index >= size()) {
+      throw std::out_of_range("DiskSequence::at -- index out of range");
+    }
+    return operator[](index);
+  }
+
+  /// Returns the first value.
+  ValueT front() const {
+    return operator[](0);
+  }
+
+  /// Returns the last value.
+  ValueT back() const {
+    return operator[](size() - 1);
+  }
+
+  /**
+   *  @brief
+   *  Replaces the `index`-th value with `value`.
+   */
+  void set(size_type index, ValueT const& value) {
+    auto [ref, offset]{find_leaf(index)};
+    ref.mark_dirty();
+    ref.template as<LeafNode>()->values[offset] = value;
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` so that it becomes the `index`-th value.
+   *
+   *  `index` may be `size()`.
+   */
+  void insert(size_type index, ValueT const& value) {
+    assert(index <= size());
+    if (header_.root == kNoPage) {
+      header_.root = allocate_page(kLeafPage).id();
+    }
+    Split const split{insert_into(header_.root, index, value, true)};
+    ++header_.size;
+    if (split.page != kNoPage) {
+      PageRef root_ref{allocate_page(kInternalPage)};
+      InternalNode* root{root_ref.template as<InternalNode>()};
+      root->header.count = 2;
+      root->children[0] = header_.root;
+      root->counts[0] = header_.size - split.count;
+      root->children[1] = split.page;
+      root->counts[1] = split.count;
+      header_.root = root_ref.id();
+    }
+  }
+
+  /// Appends `value`.
+  void push_back(ValueT const& value) {
+    insert(size(), value);
+  }
+
+  /// Prepends `value`.
+  void push_front(ValueT const& value) {
+    insert(0, value);
+  }
+
+  /**
+   *  @brief
+   *  Erases the `index`-th value.
+   */
+  void erase(size_type index) {
+    assert(index < size());
+    erase_from(header_.root, index);
+    --header_.size;
+    PageRef root_ref{pool_.fetch(header_.root)};
+    NodeHeader const* root{root_ref.template as<NodeHeader>()};
+    PageId const old_root{header_.root};
+    if (root->kind == kInternalPage && root->count == 1) {
+      header_.root = root_ref.template as<InternalNode>()->children[0];
+    } else if (root->kind == kLeafPage && root->count == 0) {
+      header_.root = kNoPage;
+    } else {
+      return;
+    }
+    root_ref.release();
+    free_page(old_root);
+  }
+
+  /// Erases the first value.
+  void pop_front() {
+    erase(0);
+  }
+
+  /// Erases the last value.
+  void pop_back() {
+    erase(size() - 1);
+  }
+
+  /**
+   *  @brief
+   *  Erases all values and returns all pages to the free list.
+   */
+  void clear() {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+
+  /// Returns an iterator to the first value.
+  const_iterator begin() const {
+    return get_iterator_at_index(0);
+  }
+
+  /// Returns the past-the-end iterator.
+  const_iterator end() const {
+    return {this, kNoPage, 0, size()};
+  }
+
+  /// Returns an iterator to the `index`-th value.
+  const_iterator get_iterator_at_index(size_type index) const {
+    if (index >= size()) {
+      return end();
+    }
+    auto [ref, offset]{find_leaf(index)};
+    PageId const next{ref.template as<LeafNode>()->header.next};
+    if (next != kNoPage) {
+      pool_.readahead(next, kReadaheadPages);
+    }
+    return {this, ref.id(), offset, index};
+  }
+
+  /**
+   *  @brief
+   *  Calls `f(value)` for every value with index in `[first, last)`, one leaf
+   *    at a time.
+   */
+  template<class F>
+  void for_each(size_type first, size_type last, F&& f) const {
+    if (first >= last) {
+      return;
+    }
+    auto [ref, offset]{find_leaf(first)};
+    size_type remaining{last - first};
+    while (true) {
+      LeafNode const* leaf{ref.template as<LeafNode>()};
+      PageId const next{leaf->header.next};
+      if (next != kNoPage) {
+        pool_.readahead(next, kReadaheadPages);
+      }
+      std::size_t const end{std::min<std::size_t>(
+          leaf->header.count, offset + remaining)};
+      for (std::size_t i{offset}; i < end; ++i) {
+        f(leaf->values[i]);
+      }
+      remaining -= end - offset;
+      if (remaining == 0) {
+        return;
+      }
+      assert(next != kNoPage);
+      ref = pool_.fetch(next);
+      offset = 0;
+    }
+  }
+};
+
+} // namespace ordered_binary_trees
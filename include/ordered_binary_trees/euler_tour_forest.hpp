@@ -0,0 +1,390 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Dynamic forest that supports adding and removing edges and answering
+ *    connectivity queries in O(log n) amortized time.
+ *
+ *  Vertices are numbered from `0` to `num_vertices() - 1`.
+ *  Each tree of the forest is stored as its Euler tour: a sequence with one
+ *    node per vertex and one node per direction of each edge, kept in a
+ *    splay tree with subtree sizes.
+ *  A tree with `k` vertices has a tour of `3k - 2` nodes.
+ *
+ *  Nodes never move, so each vertex and each directed edge keeps a pointer to
+ *    its node.
+ *  `link()` and `cut()` split tours at these nodes and join the pieces in a
+ *    different order, and `connected()` checks whether two nodes end up under
+ *    the same root.
+ *  Sizes are read from subtree sizes, the same way `Node::get_index()`
+ *    computes indices.
+ */
+template<
+    class SizeT = std::size_t,
+    class AllocatorT = std::allocator<SizeT>>
+class EulerTourForest {
+ private:
+  /// This class.
+  using This = EulerTourForest<SizeT, AllocatorT>;
+
+ public:
+  /// Type of vertices and sizes.
+  using size_type = SizeT;
+
+  /// Type of the allocator.
+  using allocator_type = AllocatorT;
+
+ protected:
+  /**
+   *  @brief
+   *  Element of an Euler tour: a directed edge from `from` to `to`, or a
+   *    vertex if `from == to`.
+   */
+  struct Arc {
+    /// Tail of the edge.
+    size_type from;
+    /// Head of the edge.
+    size_type to;
+  };
+
+  /// Allocator for values of type `T`.
+  template<class T>
+  using RebindAllocator = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<T>;
+
+  /// Tree implementation whose nodes hold tours.
+  using TreeImpl = SplayTreeImpl<Arc, RebindAllocator<Arc>>;
+
+  /// Type of nodes.
+  using Node = typename TreeImpl::Node;
+
+  /// Type of pointers to nodes.
+  using NodePtr = typename TreeImpl::NodePtr;
+
+  /// Type of node allocators.
+  using Allocator = typename TreeImpl::Allocator;
+
+  /// Key of a directed edge.
+  using ArcKey = std::pair<size_type, size_type>;
+
+  /// Hash function for `ArcKey`.
+  struct ArcHash {
+    /// Combines the hashes of both ends.
+    std::size_t operator()(ArcKey const& key) const {
+      std::size_t const h{std::hash<size_type>()(key.first)};
+      return h ^ (std::hash<size_type>()(key.second) +
+          0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+    }
+  };
+
+  /// Type of the map from directed edges to nodes.
+  using Arcs = std::unordered_map<
+      ArcKey,
+      NodePtr,
+      ArcHash,
+      std::equal_to<ArcKey>,
+      RebindAllocator<std::pair<ArcKey const, NodePtr>>>;
+
+  /// Allocator for nodes.
+  OBT_NO_UNIQUE_ADDRESS Allocator allocator_;
+
+  /// `vertices_[v]` is the node of vertex `v`.
+  std::vector<NodePtr, RebindAllocator<NodePtr>> vertices_;
+
+  /// Nodes of both directions of every edge.
+  Arcs arcs_;
+
+  /// Creates a node that is not in any tour.
+  NodePtr create_node(size_type from, size_type to) {
+    NodePtr n{std::allocator_traits<Allocator>::allocate(allocator_, 1)};
+    std::allocator_traits<Allocator>::construct(allocator_,
+        std::addressof(*n), Arc{from, to});
+    return n;
+  }
+
+  /// Destroys a node that is not in any tour.
+  void destroy_node(NodePtr n) {
+    std::allocator_traits<Allocator>::destroy(allocator_, std::addressof(*n));
+    std::allocator_traits<Allocator>::deallocate(allocator_, n, 1);
+  }
+
+  /// Splays `n` to the root of its tour and returns it.
+  static NodePtr splay(NodePtr n) {
+    n->splay();
+    return n;
+  }
+
+  /**
+   *  @brief
+   *  Concatenates the tours rooted at `a` and `b` and returns the new root.
+   *
+   *  Either may be null.
+   */
+  static NodePtr join(NodePtr a, NodePtr b) {
+    if (!a) {
+      return b;
+    }
+    if (!b) {
+      return a;
+    }
+    NodePtr m{splay(a->find_last_node())};
+    assert(!m->right_child);
+    m->right_child = b;
+    b->parent = m;
+    m->update_size();
+    return m;
+  }
+
+  /**
+   *  @brief
+   *  Splits the tour of `n` right before `n`, and returns the roots of both
+   *    parts. The second part starts with `n`.
+   */
+  static std::pair<NodePtr, NodePtr> split_before(NodePtr n) {
+    splay(n);
+    NodePtr l{n->left_child};
+    if (l) {
+      l->parent = nullptr;
+      n->left_child = nullptr;
+      n->update_size();
+    }
+    return {l, n};
+  }
+
+  /**
+   *  @brief
+   *  Splits the tour of `n` right after `n`, and returns the roots of both
+   *    parts. The first part ends with `n`.
+   */
+  static std::pair<NodePtr, NodePtr> split_after(NodePtr n) {
+    splay(n);
+    NodePtr r{n->right_child};
+    if (r) {
+      r->parent = nullptr;
+      n->right_child = nullptr;
+      n->update_size();
+    }
+    return {n, r};
+  }
+
+  /**
+   *  @brief
+   *  Rotates the tour of `v` so that it starts at the node of `v`, and
+   *    returns the new root.
+   */
+  NodePtr reroot(size_type v) {
+    auto [before, rest]{split_before(vertices_[v])};
+    return join(rest, before);
+  }
+
+  /// Returns the node of the directed edge from `u` to `v`, or null.
+  NodePtr find_arc(size_type u, size_type v) const {
+    auto it{arcs_.find(ArcKey{u, v})};
+    return it == arcs_.end() ? nullptr : it->second;
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates a forest of `num_vertices` isolated vertices.
+   */
+  explicit EulerTourForest(
+      size_type num_vertices = 0,
+      allocator_type const& allocator = allocator_type())
+    : allocator_(allocator),
+      vertices_(RebindAllocator<NodePtr>(allocator)),
+      arcs_(0,
+          ArcHash(),
+          std::equal_to<ArcKey>(),
+          typename Arcs::allocator_type(allocator)) {
+    vertices_.reserve(num_vertices);
+    for (size_type v{0}; v < num_vertices; ++v) {
+      add_vertex();
+    }
+  }
+
+  EulerTourForest(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the forest.
+   */
+  ~EulerTourForest() {
+    for (auto& [key, n] : arcs_) {
+      destroy_node(n);
+    }
+    for (NodePtr n : vertices_) {
+      destroy_node(n);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of vertices.
+   */
+  size_type num_vertices() const {
+    return static_cast<size_type>(vertices_.size());
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of edges.
+   */
+  size_type num_edges() const {
+    return static_cast<size_type>(arcs_.size() / 2);
+  }
+
+  /**
+   *  @brief
+   *  Adds an isolated vertex and returns it.
+   */
+  size_type add_vertex() {
+    size_type const v{num_vertices()};
+    NodePtr n{create_node(v, v)};
+    try {
+      vertices_.push_back(n);
+    } catch (...) {
+      destroy_node(n);
+      throw;
+    }
+    return v;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff there is an edge between `u` and `v`.
+   */
+  bool has_edge(size_type u, size_type v) const {
+    return find_arc(u, v) != nullptr;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff `u` and `v` are in the same tree.
+   */
+  bool connected(size_type u, size_type v) {
+    assert(u < num_vertices() && v < num_vertices());
+    if (u == v) {
+      return true;
+    }
+    // Splaying `v` moves `u` away from the root only if they share a tour.
+    NodePtr const nu{splay(vertices_[u])};
+    splay(vertices_[v]);
+    return nu->parent != nullptr;
+  }
+
+  /**
+   *  @brief
+   *  Adds an edge between `u` and `v`, merging their trees.
+   *
+   *  Returns `false` without changing anything if `u` and `v` are already
+   *    connected.
+   */
+  bool link(size_type u, size_type v) {
+    if (connected(u, v)) {
+      return false;
+    }
+    NodePtr uv{create_node(u, v)};
+    NodePtr vu{nullptr};
+    try {
+      vu = create_node(v, u);
+      arcs_.emplace(ArcKey{u, v}, uv);
+      arcs_.emplace(ArcKey{v, u}, vu);
+    } catch (...) {
+      arcs_.erase(ArcKey{u, v});
+      if (vu) {
+        destroy_node(vu);
+      }
+      destroy_node(uv);
+      throw;
+    }
+
+    // The tour of `u` from `u`, then `u -> v`, the tour of `v` from `v`, and
+    //   `v -> u`.
+    NodePtr tu{reroot(u)};
+    NodePtr tv{reroot(v)};
+    join(join(join(tu, uv), tv), vu);
+    return true;
+  }
+
+  /**
+   *  @brief
+   *  Removes the edge between `u` and `v`, splitting their tree.
+   *
+   *  Returns `false` if there is no such edge.
+   */
+  bool cut(size_type u, size_type v) {
+    NodePtr a{find_arc(u, v)};
+    if (!a) {
+      return false;
+    }
+    NodePtr b{find_arc(v, u)};
+    assert(b);
+
+    // The tour is `A a B b C`, where `B` is the tour of one side.
+    // The other side is `C A`, which is a rotation of `A C`.
+    splay(b);
+    a->splay(b);
+    if (b->right_child == a) {
+      std::swap(a, b);
+    }
+    NodePtr const before{split_before(a).first};
+    split_after(a);
+    NodePtr const after{split_after(b).second};
+    split_before(b);
+    join(before, after);
+
+    arcs_.erase(ArcKey{u, v});
+    arcs_.erase(ArcKey{v, u});
+    destroy_node(a);
+    destroy_node(b);
+    return true;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of vertices in the tree of `v`.
+   */
+  size_type component_size(size_type v) {
+    assert(v < num_vertices());
+    return (splay(vertices_[v])->size + 2) / 3;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of vertices on the side of `v` when the edge between
+   *    `v` and `parent` is removed, i.e., the size of the subtree of `v` when
+   *    the tree is rooted on the side of `parent`.
+   *
+   *  There must be an edge between `v` and `parent`.
+   */
+  size_type subtree_size(size_type v, size_type parent) {
+    NodePtr down{find_arc(parent, v)};
+    NodePtr up{find_arc(v, parent)};
+    assert(down && up);
+
+    // The side of `v` is the part of the cyclic tour from `down` to `up`.
+    splay(up);
+    down->splay(up);
+    size_type const inside{up->left_child == down ?
+        Node::get_size(down->right_child) :
+        up->size - Node::get_size(down->left_child) - 2};
+    return (inside + 2) / 3;
+  }
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/ordered_binary_tree.hpp>
+#include <ordered_binary_trees/ordered_binary_tree_iterator.hpp>
+#include <ordered_binary_trees/ordered_binary_tree_node.hpp>
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  `Data` for `FrequencyBiasedTreeImpl`: a value and the number of times it
+ *    has been looked up by index.
+ */
+template<class ValueT>
+struct AccessCountedData {
+  /// Type of values.
+  using Value = ValueT;
+
+  /// The value presented to the user.
+  Value value;
+
+  /// Number of index lookups that reached this node.
+  ///
+  /// Lookups through a `const` tree increment this too, so it is a relaxed
+  /// atomic to let several threads read the same tree.
+  std::atomic<std::size_t> access_count{0};
+
+  /// Constructs `value` from `args`.
+  template<class... Args,
+      std::enable_if_t<std::is_constructible_v<Value, Args&&...>, int> = 0>
+  constexpr AccessCountedData(Args&&... args)
+    : value(std::forward<Args>(args)...) {}
+
+  /// Copies `other`, including its counter.
+  AccessCountedData(AccessCountedData const& other)
+    : value(other.value),
+      access_count{other.access_count.load(std::memory_order_relaxed)} {}
+
+  /// Moves `other`, copying its counter.
+  AccessCountedData(AccessCountedData&& other)
+    : value(std::move(other.value)),
+      access_count{other.access_count.load(std::memory_order_relaxed)} {}
+
+  /// Copies `other`, including its counter.
+  AccessCountedData& operator=(AccessCountedData const& other) {
+    value = other.value;
+    access_count.store(
+        other.access_count.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    return *this;
+  }
+
+  /// Moves `other`, copying its counter.
+  AccessCountedData& operator=(AccessCountedData&& other) {
+    value = std::move(other.value);
+    access_count.store(
+        other.access_count.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    return *this;
+  }
+};
+
+/**
+ *  @brief
+ *  Tree implementation that counts index lookups and can rebuild itself into
+ *    a static shape biased towards frequently accessed elements.
+ *
+ *  Lookups do not restructure the tree; they only increment a counter in the
+ *    node they reach.
+ *  `rebuild_by_access_frequency()` relinks the existing nodes in O(n) time
+ *    into a weight-balanced shape where an element accessed a fraction `p` of
+ *    the time sits at depth at most `log2(1 / p) + 1`.
+ *  Between rebuilds, the tree behaves like `BasicTreeImpl`.
+ *
+ *  This class only contains types and static functions.
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+struct FrequencyBiasedTreeImpl: BasicTreeImpl<
+    AccessCountedData<ValueT>,
+    typename std::allocator_traits<AllocatorT>::
+        template rebind_alloc<AccessCountedData<ValueT>>> {
+  /// This type.
+  using This = FrequencyBiasedTreeImpl<ValueT, AllocatorT>;
+
+  /// Type of values to present to the user.
+  using Value = ValueT;
+
+  /// Type of allocators for `Value`.
+  using ValueAllocator = AllocatorT;
+
+  /// A value with an access counter.
+  using Data = AccessCountedData<Value>;
+
+  /// Base class: `BasicTreeImpl` over `Data`.
+  using Super = BasicTreeImpl<
+      Data,
+      typename std::allocator_traits<ValueAllocator>::
+          template rebind_alloc<Data>>;
+
+  /// Extraction of `AddPointer` inside `AddPointerFromAllocator`.
+  template<class T>
+  using AddPointer = typename Super::template AddPointer<T>;
+
+  /// Type of nodes in a tree.
+  using Node = typename Super::Node;
+
+  /// Type of node allocators.
+  using Allocator = typename Super::Allocator;
+
+  /// Type of trees.
+  using Tree = typename Super::Tree;
+
+  /// Type of indices.
+  using size_type = typename Super::size_type;
+
+  /// Type of node pointers.
+  using NodePtr = typename Super::NodePtr;
+
+  /// `Tree::InsertPosition`.
+  using InsertPosition = typename Super::InsertPosition;
+
+  /// Conversion from `Data` to `Value` that drops the counter.
+  struct ExtractValue {
+    /// `FrequencyBiasedTreeImpl::Value`.
+    using Value = typename This::Value;
+
+    /// Returns `data.value`.
+    static constexpr Value& value_in_data(Data& data) {
+      return data.value;
+    }
+
+    /// Returns `data.value`.
+    static constexpr Value const& value_in_data(Data const& data) {
+      return data.value;
+    }
+  };
+
+  /**
+   *  @brief
+   *  Returns the node at a given index and counts the access.
+   */
+  static constexpr NodePtr find_node_at_index(Tree& tree, size_type index) {
+    NodePtr n{tree.find_node_at_index(index)};
+    if (n) {
+      record_access(tree, n);
+    }
+    return n;
+  }
+
+  /**
+   *  @brief
+   *  Counts an access to `n` that did not go through
+   *    `find_node_at_index()`.
+   */
+  static void record_access(Tree&, NodePtr n) {
+    n->data.access_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   *  @brief
+   *  Relinks all nodes of `tree` into a shape where frequently accessed nodes
+   *    are close to the root.
+   *
+   *  Each node weighs `access_count + 1`, and each subtree root is the node
+   *    that contains the weighted midpoint of its range (Mehlhorn's
+   *    bisection rule).
+   *  The midpoint is found by exponential search from both ends of the range,
+   *    so the whole rebuild takes O(n) time.
+   *  No node is created or destroyed, so iterators stay valid.
+   *
+   *  Afterwards, every counter is halved so that later rebuilds follow
+   *    changes in the access pattern.
+   */
+  static void rebuild_by_access_frequency(Tree& tree) {
+    if (!tree.root) {
+      return;
+    }
+    size_type const count{tree.root->size};
+    std::vector<NodePtr> nodes;
+    nodes.reserve(count);
+    std::vector<std::size_t> prefix;
+    prefix.reserve(count + 1);
+    prefix.push_back(0);
+    for (NodePtr n{tree.first}; n; n = n->find_next_node()) {
+      nodes.push_back(n);
+      std::size_t const access_count{
+          n->data.access_count.load(std::memory_order_relaxed)};
+      prefix.push_back(prefix.back() + access_count + 1);
+      n->data.access_count.store(
+          access_count / 2, std::memory_order_relaxed);
+    }
+    assert(nodes.size() == count);
+    tree.root = build_biased_subtree(nodes, prefix, 0, count);
+    tree.root->parent = nullptr;
+  }
+
+ protected:
+  /**
+   *  @brief
+   *  Returns the smallest `m` in `[l, r)` such that the total weight of
+   *    `nodes[l], ..., nodes[m]` exceeds half the weight of `[l, r)`.
+   *
+   *  This takes O(log(min(m - l, r - m)) + 1) time.
+   */
+  static size_type find_weighted_median(
+      std::vector<std::size_t> const& prefix,
+      size_type l,
+      size_type r) {
+    assert(l < r);
+    std::size_t const target{prefix[l] + (prefix[r] - prefix[l]) / 2};
+    auto const past_target = [&prefix, target](size_type m) {
+      return prefix[m + 1] > target;
+    };
+    size_type lo{l};
+    size_type hi{r - 1};
+    for (size_type step{1}; step <= r - l; step *= 2) {
+      size_type const a{l + step - 1};
+      size_type const b{r - step};
+      if (a >= b) {
+        break;
+      }
+      if (past_target(a)) {
+        hi = a;
+        break;
+      }
+      lo = a + 1;
+      if (!past_target(b)) {
+        lo = b + 1;
+        break;
+      }
+      hi = b;
+    }
+    while (lo < hi) {
+      size_type const mid{lo + (hi - lo) / 2};
+      if (past_target(mid)) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  /**
+   *  @brief
+   *  Links `nodes[l], ..., nodes[r - 1]` into a biased subtree and returns
+   *    its root.
+   *
+   *  The recursion depth is bounded by `log2` of the total weight.
+   */
+  static NodePtr build_biased_subtree(
+      std::vector<NodePtr> const& nodes,
+      std::vector<std::size_t> const& prefix,
+      size_type l,
+      size_type r) {
+    if (l == r) {
+      return nullptr;
+    }
+    size_type const m{find_weighted_median(prefix, l, r)};
+    NodePtr n{nodes[m]};
+    n->size = r - l;
+    n->left_child = build_biased_subtree(nodes, prefix, l, m);
+    if (n->left_child) {
+      n->left_child->parent = n;
+    }
+    n->right_child = build_biased_subtree(nodes, prefix, m + 1, r);
+    if (n->right_child) {
+      n->right_child->parent = n;
+    }
+    return n;
+  }
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,519 @@
+#pragma once
+
+#include <cassert>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Immutable snapshot of a sequence, stored in one contiguous array.
+ *
+ *  A `FrozenSequence` is typically produced by `ManagedTree::freeze()` and
+ *    turned back into a tree by `ManagedTree::thaw()`.
+ *  While frozen, `operator[]` is a plain array access, iteration walks
+ *    contiguous memory, and `data()` together with `size()` can be handed to
+ *    anything that expects a span.
+ *
+ *  Optionally, prefix aggregates can be precomputed with
+ *    `compute_prefix_aggregates()`, after which `prefix_aggregate(i)` returns
+ *    the aggregate of the first `i + 1` values in O(1).
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+class FrozenSequence {
+ private:
+  /// This type.
+  using This = FrozenSequence<ValueT, AllocatorT>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<value_type>;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// `difference_type` derived from `allocator_type`.
+  using difference_type = typename std::allocator_traits<allocator_type>::
+      difference_type;
+
+  /// Elements cannot be modified, so `reference` is a const reference.
+  using reference = value_type const&;
+
+  /// `value_type const&`.
+  using const_reference = value_type const&;
+
+  /// Elements cannot be modified, so `pointer` is a pointer to const.
+  using pointer = value_type const*;
+
+  /// `value_type const*`.
+  using const_pointer = value_type const*;
+
+  /// Type of iterators.
+  using iterator = value_type const*;
+  /// Type of const-iterators.
+  using const_iterator = value_type const*;
+  /// Type of reverse-iterators.
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  /// Type of const-reverse-iterators.
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  /**
+   *  @brief
+   *  Minimum number of elements that a subtree must have before
+   *    `from_subtree()` copies it on a separate thread.
+   */
+  static constexpr size_type kParallelGrainSize{size_type{1} << 16};
+
+ protected:
+  /// Allocator for values.
+  mutable allocator_type allocator_;
+
+  /// Storage for values.
+  typename std::allocator_traits<allocator_type>::pointer values_{nullptr};
+
+  /// Number of values.
+  size_type size_{0};
+
+  /// Prefix aggregates. Empty unless `compute_prefix_aggregates()` is called.
+  std::vector<value_type, allocator_type> prefix_;
+
+  /// Returns a raw pointer to the storage.
+  value_type* raw_values() const {
+    return values_ ? std::addressof(values_[0]) : nullptr;
+  }
+
+  /// Allocates storage for `count` values.
+  void allocate(size_type count) {
+    assert(!values_);
+    if (count > 0) {
+      values_ = std::allocator_traits<allocator_type>::allocate(
+          allocator_, count);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Copies the values of `count` nodes, starting from `n` in in-order, to
+   *    `out`.
+   *
+   *  This is iterative, so it does not depend on the depth of the tree.
+   *  If a copy throws, the values copied so far are destroyed.
+   */
+  template<class ExtractValue, class NodePtr>
+  void copy_nodes(NodePtr n, size_type count, value_type* out) {
+    size_type i{0};
+    try {
+      for (; i < count; ++i) {
+        assert(n);
+        std::allocator_traits<allocator_type>::construct(
+            allocator_, out + i, ExtractValue::value_in_data(n->data));
+        if (i + 1 < count) {
+          n = n->find_next_node();
+        }
+      }
+    } catch (...) {
+      destroy_values(out, i);
+      throw;
+    }
+  }
+
+  /// Destroys `count` values starting at `out`.
+  void destroy_values(value_type* out, size_type count) {
+    for (size_type i{0}; i < count; ++i) {
+      std::allocator_traits<allocator_type>::destroy(allocator_, out + i);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Frees storage for `capacity` values, none of which are constructed, and
+   *    leaves the sequence empty.
+   */
+  void deallocate(size_type capacity) {
+    if (values_) {
+      std::allocator_traits<allocator_type>::deallocate(
+          allocator_, values_, capacity);
+    }
+    values_ = nullptr;
+    size_ = 0;
+  }
+
+  /**
+   *  @brief
+   *  Copies the values in the subtree rooted at `n` to `out`.
+   *
+   *  Left subtrees that are large enough are copied by asynchronous tasks,
+   *    as long as `budget` allows more tasks.
+   *  The position of each subtree in the output is known from `size`, so
+   *    tasks never need to communicate.
+   *  If a task cannot be started, its subtree is copied on this thread.
+   */
+  template<class ExtractValue, class NodePtr>
+  void copy_subtree(
+      NodePtr n,
+      value_type* out,
+      unsigned budget,
+      std::vector<std::future<void>>& tasks) {
+    tasks.reserve(tasks.size() + budget);
+    while (n) {
+      if (budget == 0 || n->size < 2 * kParallelGrainSize) {
+        copy_nodes<ExtractValue>(n->find_first_node(), n->size, out);
+        return;
+      }
+      auto l{n->left_child};
+      size_type const left_size{l ? l->size : 0};
+      if (l) {
+        --budget;
+        unsigned const left_budget{budget / 2};
+        budget -= left_budget;
+        try {
+          tasks.push_back(std::async(std::launch::async,
+              [this, l, out, left_budget]() {
+                std::vector<std::future<void>> subtasks;
+                copy_subtree<ExtractValue>(l, out, left_budget, subtasks);
+                for (auto& task : subtasks) {
+                  task.get();
+                }
+              }));
+        } catch (std::system_error const&) {
+          copy_nodes<ExtractValue>(l->find_first_node(), left_size, out);
+        }
+      }
+      std::allocator_traits<allocator_type>::construct(
+          allocator_, out + left_size, ExtractValue::value_in_data(n->data));
+      out += left_size + 1;
+      n = n->right_child;
+    }
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty sequence.
+   */
+  FrozenSequence(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator}, prefix_{allocator} {}
+
+  /**
+   *  @brief
+   *  Copies values from `[first, last)`.
+   */
+  template<class ForwardIterator>
+  FrozenSequence(
+      ForwardIterator first,
+      ForwardIterator last,
+      allocator_type const& allocator = allocator_type())
+    : FrozenSequence{allocator} {
+    size_type const capacity{
+        static_cast<size_type>(std::distance(first, last))};
+    allocate(capacity);
+    try {
+      for (; first != last; ++first, ++size_) {
+        std::allocator_traits<allocator_type>::construct(
+            allocator_, raw_values() + size_, *first);
+      }
+    } catch (...) {
+      destroy_values(raw_values(), size_);
+      deallocate(capacity);
+      throw;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence.
+   */
+  FrozenSequence(This const& other)
+    : FrozenSequence{other.begin(), other.end(),
+        std::allocator_traits<allocator_type>::
+          select_on_container_copy_construction(other.allocator_)} {
+    prefix_ = other.prefix_;
+  }
+
+  /**
+   *  @brief
+   *  Takes data from another sequence.
+   */
+  FrozenSequence(This&& other)
+    : allocator_{std::move(other.allocator_)},
+      values_{other.values_},
+      size_{other.size_},
+      prefix_{std::move(other.prefix_)} {
+    other.values_ = nullptr;
+    other.size_ = 0;
+    other.prefix_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Copies the values in the subtree rooted at `root`, in order.
+   *
+   *  `ExtractValue` converts `root->data` to a value, as in `ManagedTree`.
+   *  If `root->size` is large and `Value` can be copied without throwing,
+   *    the copy is split across up to `std::thread::hardware_concurrency()`
+   *    threads.
+   *  Otherwise, the copy runs on this thread, and if it throws, the values
+   *    copied so far are destroyed before the exception is rethrown.
+   */
+  template<class ExtractValue, class NodePtr>
+  static This from_subtree(
+      NodePtr root,
+      allocator_type const& allocator = allocator_type()) {
+    This frozen{allocator};
+    if (!root) {
+      return frozen;
+    }
+    frozen.allocate(root->size);
+    unsigned budget{0};
+    if constexpr (std::is_nothrow_copy_constructible_v<value_type>) {
+      if (root->size >= 2 * kParallelGrainSize) {
+        budget = std::thread::hardware_concurrency();
+        budget = budget > 1 ? budget - 1 : 0;
+      }
+    }
+    std::vector<std::future<void>> tasks;
+    try {
+      frozen.template copy_subtree<ExtractValue>(
+          root, frozen.raw_values(), budget, tasks);
+    } catch (...) {
+      // Only the sequential copy throws, and it has destroyed its values.
+      assert(tasks.empty());
+      frozen.deallocate(root->size);
+      throw;
+    }
+    for (auto& task : tasks) {
+      task.get();
+    }
+    frozen.size_ = root->size;
+    return frozen;
+  }
+
+  /**
+   *  @brief
+   *  Destroys the sequence.
+   */
+  ~FrozenSequence() {
+    clear();
+  }
+
+  /**
+   *  @brief
+   *  Copies the sequence from `other`.
+   */
+  This& operator=(This const& other) {
+    if (this != &other) {
+      This copy{other};
+      swap(copy);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes the sequence from `other`.
+   */
+  This& operator=(This&& other) {
+    if (this != &other) {
+      clear();
+      swap(other);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Swaps this sequence with `other`.
+   */
+  void swap(This& other) {
+    using std::swap;
+    swap(allocator_, other.allocator_);
+    swap(values_, other.values_);
+    swap(size_, other.size_);
+    prefix_.swap(other.prefix_);
+  }
+
+  /**
+   *  @brief
+   *  Empties the sequence.
+   */
+  void clear() {
+    if (values_) {
+      for (size_type i{0}; i < size_; ++i) {
+        std::allocator_traits<allocator_type>::destroy(
+            allocator_, raw_values() + i);
+      }
+      std::allocator_traits<allocator_type>::deallocate(
+          allocator_, values_, size_);
+    }
+    values_ = nullptr;
+    size_ = 0;
+    prefix_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements.
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the sequence is empty.
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns the allocator.
+   */
+  allocator_type get_allocator() const noexcept {
+    return allocator_;
+  }
+
+  /**
+   *  @brief
+   *  Returns a pointer to the contiguous array of values.
+   */
+  const_pointer data() const {
+    return raw_values();
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference operator[](size_type index) const {
+    assert(index < size_);
+    return raw_values()[index];
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference at(size_type pos) const {
+    if (pos >= size_) {
+      throw std::out_of_range("FrozenSequence::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /// Accesses the first element.
+  const_reference front() const {
+    return operator[](0);
+  }
+
+  /// Accesses the last element.
+  const_reference back() const {
+    return operator[](size_ - 1);
+  }
+
+  /// Returns the iterator to the first element.
+  const_iterator begin() const {
+    return raw_values();
+  }
+
+  /// Returns the iterator to the first element.
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  /// Returns the past-the-end iterator.
+  const_iterator end() const {
+    return raw_values() + size_;
+  }
+
+  /// Returns the past-the-end iterator.
+  const_iterator cend() const {
+    return end();
+  }
+
+  /// Returns the reverse-iterator to the last element.
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator{end()};
+  }
+
+  /// Returns the reverse-iterator to the last element.
+  const_reverse_iterator crbegin() const {
+    return rbegin();
+  }
+
+  /// Returns the past-the-beginning reverse-iterator.
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator{begin()};
+  }
+
+  /// Returns the past-the-beginning reverse-iterator.
+  const_reverse_iterator crend() const {
+    return rend();
+  }
+
+  /**
+   *  @brief
+   *  Precomputes `prefix_aggregate(i) = op(...op(op(v[0], v[1]), v[2])...,
+   *    v[i])` for every `i`.
+   *
+   *  `op` should be associative.
+   *  Calling this function again replaces the previous aggregates.
+   */
+  template<class BinaryOperation>
+  void compute_prefix_aggregates(BinaryOperation op) {
+    prefix_.clear();
+    prefix_.reserve(size_);
+    for (size_type i{0}; i < size_; ++i) {
+      if (i == 0) {
+        prefix_.push_back(operator[](0));
+      } else {
+        prefix_.push_back(op(prefix_.back(), operator[](i)));
+      }
+    }
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff prefix aggregates are available.
+   */
+  bool has_prefix_aggregates() const {
+    return !empty() && prefix_.size() == size_;
+  }
+
+  /**
+   *  @brief
+   *  Returns the aggregate of the first `index + 1` values.
+   *
+   *  `compute_prefix_aggregates()` must have been called.
+   */
+  const_reference prefix_aggregate(size_type index) const {
+    assert(has_prefix_aggregates());
+    assert(index < size_);
+    return prefix_[index];
+  }
+
+  /**
+   *  @brief
+   *  Returns the contiguous array of prefix aggregates, or null if there are
+   *    none.
+   */
+  const_pointer prefix_aggregates_data() const {
+    return has_prefix_aggregates() ? prefix_.data() : nullptr;
+  }
+
+};
+
+} // namespace ordered_binary_trees
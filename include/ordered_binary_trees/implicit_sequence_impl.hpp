@@ -0,0 +1,966 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/tiered_vector_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Pointer-free sequence for append-mostly workloads.
+ *
+ *  Elements are stored in *chunks* whose capacities double:
+ *    chunk `c` holds `B << c` elements, starting at index `B * (2^c - 1)`,
+ *    where `B = 1 << kFirstChunkShift`.
+ *  The chunk and the offset of an index are therefore computed with a shift
+ *    and a count-leading-zeros, so `operator[]` is O(1), and appending never
+ *    moves existing elements.
+ *  There are no nodes at all: no child, parent or size fields.
+ *
+ *  If `OperationT` is not `void`, the sequence also maintains a Fenwick tree
+ *    of aggregates under the associative operation `OperationT`.
+ *  Appending updates it in O(log n), and `prefix_aggregate()` and
+ *    `prefix_search()` run in O(log n).
+ *  `OperationT` need not be commutative or invertible.
+ *
+ *  Insertion and erasure anywhere except at the back are supported so that
+ *    the interface matches `ManagedTree`, but they take O(n - index) because
+ *    the tail is moved out and appended back.
+ *
+ *  Iterators are `TieredVectorIterator`s, which step through each chunk as a
+ *    contiguous run.
+ */
+template<
+    class ValueT,
+    class AllocatorT = std::allocator<ValueT>,
+    class OperationT = void>
+class ImplicitSequence {
+ private:
+  /// This type.
+  using This = ImplicitSequence<ValueT, AllocatorT, OperationT>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<value_type>;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// `difference_type` derived from `allocator_type`.
+  using difference_type = typename std::allocator_traits<allocator_type>::
+      difference_type;
+
+  /// `value_type&`.
+  using reference = value_type&;
+
+  /// `value_type const&`.
+  using const_reference = value_type const&;
+
+  /// `pointer` type dervied from `allocator_type`.
+  using pointer = typename std::allocator_traits<allocator_type>::pointer;
+
+  /// `const_pointer` type dervied from `allocator_type`.
+  using const_pointer = typename std::allocator_traits<allocator_type>::
+      const_pointer;
+
+  /// `true` iff aggregates are maintained.
+  static constexpr bool kHasAggregates{!std::is_void_v<OperationT>};
+
+ protected:
+  /// Parametrized iterator type.
+  template<bool constant = false, bool reverse = false>
+  using p_iterator = TieredVectorIterator<This, constant, reverse>;
+
+  template<class SequenceT, bool constant, bool reverse>
+  friend class TieredVectorIterator;
+
+  /// Placeholder for `OperationT = void`.
+  struct NoOperation {};
+
+ public:
+  /// Type of iterators.
+  using iterator = p_iterator<false, false>;
+  /// Type of const-iterators.
+  using const_iterator = p_iterator<true, false>;
+  /// Type of reverse-iterators.
+  using reverse_iterator = p_iterator<false, true>;
+  /// Type of const-reverse-iterators.
+  using const_reverse_iterator = p_iterator<true, true>;
+
+  /// Type of the aggregation operation.
+  using operation_type = std::conditional_t<
+      kHasAggregates, OperationT, NoOperation>;
+
+  /// Base-2 logarithm of the capacity of the first chunk.
+  static constexpr unsigned kFirstChunkShift{4};
+
+ protected:
+  /// Allocator for chunk pointers.
+  using PointerAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<pointer>;
+
+  /// Allocator for values.
+  mutable allocator_type allocator_;
+
+  /// Chunks. `chunks_[c]` has capacity `chunk_capacity(c)`.
+  std::vector<pointer, PointerAllocator> chunks_;
+
+  /// Number of elements.
+  size_type size_{0};
+
+  /// Aggregation operation.
+  operation_type operation_;
+
+  /**
+   *  @brief
+   *  Fenwick tree of aggregates.
+   *
+   *  `fenwick_[k - 1]` is the aggregate of the elements with indices in
+   *    `[k - lowbit(k), k)`.
+   *  Empty unless `kHasAggregates` is `true`.
+   */
+  std::vector<value_type, allocator_type> fenwick_;
+
+  /// Returns `floor(log2(x))` for `x > 0`.
+  static constexpr unsigned floor_log2(size_type x) {
+    assert(x > 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(
+        std::numeric_limits<unsigned long long>::digits - 1 -
+        __builtin_clzll(static_cast<unsigned long long>(x)));
+#else
+    unsigned r{0};
+    while (x >>= 1) {
+      ++r;
+    }
+    return r;
+#endif
+  }
+
+  /// Returns the lowest set bit of `k`.
+  static constexpr size_type lowbit(size_type k) {
+    return k & (~k + 1);
+  }
+
+  /// Returns the capacity of chunk `c`.
+  static constexpr size_type chunk_capacity(size_type c) {
+    return size_type{1} << (c + kFirstChunkShift);
+  }
+
+  /// Returns the index of the first element of chunk `c`.
+  static constexpr size_type chunk_begin(size_type c) {
+    return ((size_type{1} << c) - 1) << kFirstChunkShift;
+  }
+
+  /// Returns the chunk that contains `index`.
+  static constexpr size_type chunk_of(size_type index) {
+    return floor_log2((index >> kFirstChunkShift) + 1);
+  }
+
+  /// Returns the element at `index`.
+  value_type* locate(size_type index) const {
+    assert(index < size_);
+    size_type const c{chunk_of(index)};
+    return std::addressof(chunks_[c][index - chunk_begin(c)]);
+  }
+
+  /// Returns the element at `index` together with its contiguous run.
+  std::tuple<value_type*, value_type*, value_type*> locate_run(
+      size_type index) const {
+    assert(index < size_);
+    size_type const c{chunk_of(index)};
+    size_type const begin{chunk_begin(c)};
+    value_type* base{std::addressof(chunks_[c][0])};
+    size_type const count{std::min(chunk_capacity(c), size_ - begin)};
+    return {base + (index - begin), base, base + count};
+  }
+
+  /// Converts `index` into an iterator.
+  template<bool constant = false, bool reverse = false>
+  p_iterator<constant, reverse> make_iterator(size_type index) const {
+    return {const_cast<This*>(this), index};
+  }
+
+  /// Deallocates the last chunk, which must not contain elements.
+  void remove_last_chunk() {
+    size_type const c{chunks_.size() - 1};
+    assert(size_ <= chunk_begin(c));
+    std::allocator_traits<allocator_type>::deallocate(
+        allocator_, chunks_.back(), chunk_capacity(c));
+    chunks_.pop_back();
+  }
+
+  /// Appends the aggregate entry for the element that was just appended.
+  void push_aggregate() {
+    if constexpr (kHasAggregates) {
+      size_type const k{size_};
+      value_type acc{*locate(k - 1)};
+      for (size_type j{k - 1}; j > k - lowbit(k); j -= lowbit(j)) {
+        acc = operation_(fenwick_[j - 1], acc);
+      }
+      fenwick_.push_back(std::move(acc));
+    }
+  }
+
+  /// Removes the values at indices `[index, size())` and returns them.
+  std::vector<value_type, allocator_type> take_tail(size_type index) {
+    assert(index <= size_);
+    std::vector<value_type, allocator_type> tail(allocator_);
+    tail.reserve(size_ - index);
+    for (size_type i{index}; i < size_; ++i) {
+      tail.push_back(std::move(*locate(i)));
+    }
+    while (size_ > index) {
+      pop_back();
+    }
+    return tail;
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty sequence with a given `allocator`.
+   */
+  ImplicitSequence(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator},
+      chunks_{PointerAllocator{allocator}},
+      fenwick_{allocator} {}
+
+  /**
+   *  @brief
+   *  Creates an empty sequence that aggregates with `operation`.
+   */
+  ImplicitSequence(
+      operation_type const& operation,
+      allocator_type const& allocator = allocator_type())
+    : allocator_{allocator},
+      chunks_{PointerAllocator{allocator}},
+      operation_{operation},
+      fenwick_{allocator} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence using the given `allocator`.
+   */
+  ImplicitSequence(This const& other, allocator_type const& allocator)
+    : ImplicitSequence{other.operation_, allocator} {
+    for (auto const& value : other) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence. The allocator is copied via
+   *    `select_on_container_copy_construction()`.
+   */
+  ImplicitSequence(This const& other)
+    : ImplicitSequence{other,
+        std::allocator_traits<allocator_type>::
+          select_on_container_copy_construction(other.allocator_)} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence if `allocator != other.allocator`,
+   *    or takes ownership of the data from another sequence otherwise.
+   */
+  ImplicitSequence(This&& other, allocator_type const& allocator)
+    : ImplicitSequence{other.operation_, allocator} {
+    if (allocator_ == other.allocator_) {
+      std::swap(chunks_, other.chunks_);
+      std::swap(size_, other.size_);
+      std::swap(fenwick_, other.fenwick_);
+    } else {
+      for (auto& value : other) {
+        emplace_back(std::move(value));
+      }
+      other.clear();
+    }
+  }
+
+  /**
+   *  @brief
+   *  Moves data from another sequence.
+   */
+  ImplicitSequence(This&& other)
+    : allocator_{std::move(other.allocator_)},
+      chunks_{std::move(other.chunks_)},
+      size_{other.size_},
+      operation_{other.operation_},
+      fenwick_{std::move(other.fenwick_)} {
+    other.chunks_.clear();
+    other.size_ = 0;
+    other.fenwick_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Destroys the sequence.
+   */
+  ~ImplicitSequence() {
+    clear();
+  }
+
+  /**
+   *  @brief
+   *  Empties the sequence.
+   */
+  void clear() {
+    while (size_ > 0) {
+      std::allocator_traits<allocator_type>::destroy(
+          allocator_, locate(size_ - 1));
+      --size_;
+    }
+    while (!chunks_.empty()) {
+      remove_last_chunk();
+    }
+    fenwick_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Copies the sequence from `other`.
+   */
+  This& operator=(This const& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_copy_assignment::value) {
+      allocator_ = other.allocator_;
+    }
+    operation_ = other.operation_;
+    for (auto const& value : other) {
+      emplace_back(value);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes the sequence from `other`.
+   */
+  This& operator=(This&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_move_assignment::value) {
+      allocator_ = std::move(other.allocator_);
+    }
+    swap(other);
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Swaps this sequence with `other`.
+   */
+  void swap(This& other) {
+    using std::swap;
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_swap::value) {
+      swap(allocator_, other.allocator_);
+    }
+    swap(chunks_, other.chunks_);
+    swap(size_, other.size_);
+    swap(operation_, other.operation_);
+    swap(fenwick_, other.fenwick_);
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements in the sequence.
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the sequence is empty.
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns the allocator.
+   */
+  allocator_type get_allocator() const noexcept {
+    return allocator_;
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `[first, last)` to it.
+   */
+  template<class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    clear();
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `ilist` to it.
+   */
+  template<class V>
+  void assign(std::initializer_list<V> ilist) {
+    assign(ilist.begin(), ilist.end());
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns `n` copies of `value` to it.
+   */
+  void assign(size_type n, value_type const& value) {
+    clear();
+    for (size_type i{0}; i < n; ++i) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   *
+   *  When aggregates are maintained, assigning to the returned reference
+   *    does not update them.
+   */
+  reference operator[](size_type index) {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference operator[](size_type index) const {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("ImplicitSequence::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("ImplicitSequence::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  reference front() {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  const_reference front() const {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  reference back() {
+    return *locate(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  const_reference back() const {
+    return *locate(size_ - 1);
+  }
+
+  /// Returns the iterator to the first element.
+  iterator begin() {
+    return make_iterator(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator begin() const {
+    return make_iterator<true>(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  /// Returns the reverse-iterator to the last element.
+  reverse_iterator rbegin() {
+    return make_iterator<false, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator rbegin() const {
+    return make_iterator<true, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator crbegin() const {
+    return rbegin();
+  }
+
+  /// Returns the past-the-end iterator.
+  iterator end() {
+    return make_iterator(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator end() const {
+    return make_iterator<true>(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator cend() const {
+    return end();
+  }
+
+  /// Returns the past-the-beginning reverse-iterator.
+  reverse_iterator rend() {
+    return make_iterator<false, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator rend() const {
+    return make_iterator<true, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator crend() const {
+    return rend();
+  }
+
+  /**
+   *  @brief
+   *  Returns an iterator for the `index`-th element.
+   */
+  iterator get_iterator_at_index(size_type index) {
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Returns a const-iterator for the `index`-th element.
+   */
+  const_iterator get_iterator_at_index(size_type index) const {
+    return make_iterator<true>(index);
+  }
+
+  /// Returns an iterator for the first element.
+  iterator get_front_iterator() {
+    return begin();
+  }
+
+  /// Returns a const-iterator for the first element.
+  const_iterator get_front_iterator() const {
+    return begin();
+  }
+
+  /// Returns an iterator for the last element.
+  iterator get_back_iterator() {
+    assert(!empty());
+    return make_iterator(size_ - 1);
+  }
+
+  /// Returns a const-iterator for the last element.
+  const_iterator get_back_iterator() const {
+    assert(!empty());
+    return make_iterator<true>(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Converts a const-iterator to a regular iterator.
+   *
+   *  This function works on reverse iterators also.
+   */
+  template<bool constant = false, bool reverse = false>
+  p_iterator<false, reverse> make_mutable_iterator(
+      p_iterator<constant, reverse> it) const {
+    return make_iterator<false, reverse>(it.index_);
+  }
+
+  /**
+   *  @brief
+   *  Returns the aggregate of the first `index + 1` elements.
+   *
+   *  This takes O(log n).
+   */
+  value_type prefix_aggregate(size_type index) const {
+    static_assert(kHasAggregates,
+        "ImplicitSequence::prefix_aggregate requires OperationT");
+    assert(index < size_);
+    size_type k{index + 1};
+    value_type acc{fenwick_[k - 1]};
+    for (k -= lowbit(k); k > 0; k -= lowbit(k)) {
+      acc = operation_(fenwick_[k - 1], acc);
+    }
+    return acc;
+  }
+
+  /**
+   *  @brief
+   *  Returns the smallest `index` such that
+   *    `predicate(prefix_aggregate(index))` is `true`, or `size()` if there
+   *    is none.
+   *
+   *  `predicate` must be monotone: once it is `true` for a prefix, it must be
+   *    `true` for every longer prefix.
+   *  For example, with `std::plus` and non-negative values,
+   *    `prefix_search([&](auto s) { return s > x; })` finds the element that
+   *    contains offset `x`.
+   *  This takes O(log n).
+   */
+  template<class Predicate>
+  size_type prefix_search(Predicate predicate) const {
+    static_assert(kHasAggregates,
+        "ImplicitSequence::prefix_search requires OperationT");
+    if (size_ == 0) {
+      return 0;
+    }
+    size_type pos{0};
+    bool has_acc{false};
+    value_type acc{};
+    for (size_type step{size_type{1} << floor_log2(size_)};
+        step > 0;
+        step >>= 1) {
+      if (pos + step > size_) {
+        continue;
+      }
+      value_type candidate{has_acc
+          ? operation_(acc, fenwick_[pos + step - 1])
+          : fenwick_[pos + step - 1]};
+      if (!predicate(candidate)) {
+        pos += step;
+        acc = std::move(candidate);
+        has_acc = true;
+      }
+    }
+    return pos;
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type const& value) {
+    return emplace(pos, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a new `value` and inserts it right before `pos`, then returns
+   *    the iterator to the newly inserted value.
+   *
+   *  This takes O(n - index), or amortized O(1) at the back.
+   */
+  template<bool constant, class... Args>
+  iterator emplace(p_iterator<constant> pos, Args&&... args) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    if (index == size_) {
+      emplace_back(std::forward<Args>(args)...);
+    } else {
+      value_type value(std::forward<Args>(args)...);
+      auto tail{take_tail(index)};
+      emplace_back(std::move(value));
+      for (auto& v : tail) {
+        emplace_back(std::move(v));
+      }
+    }
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Inserts a list of values from `[first, last)` right before `pos`, then
+   *    returns the iterator to the first value that was inserted.
+   *
+   *  This takes O(n - index + count).
+   */
+  template<bool constant, class InputIterator>
+  iterator insert(
+      p_iterator<constant> pos,
+      InputIterator first,
+      InputIterator last) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    if (index == size_) {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    } else {
+      std::vector<value_type, allocator_type> values(first, last, allocator_);
+      auto tail{take_tail(index)};
+      for (auto& value : values) {
+        emplace_back(std::move(value));
+      }
+      for (auto& value : tail) {
+        emplace_back(std::move(value));
+      }
+    }
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Moves elements from `other` right before `pos`, then returns the iterator
+   *    to the first moved element.
+   *
+   *  `other` will be empty afterwards.
+   */
+  template<bool constant>
+  iterator join(p_iterator<constant> pos, This& other) {
+    assert(pos.seq_ == this);
+    if (empty() && allocator_ == other.allocator_) {
+      swap(other);
+      return begin();
+    }
+    iterator it{insert(
+        pos,
+        std::make_move_iterator(other.begin()),
+        std::make_move_iterator(other.end()))};
+    other.clear();
+    return it;
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(begin(), other)`.
+   */
+  iterator join_front(This& other) {
+    return join(begin(), other);
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(end(), other)`.
+   */
+  iterator join_back(This& other) {
+    return join(end(), other);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type const& value) {
+    emplace_front(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type&& value) {
+    emplace_front(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the first element.
+   *
+   *  This takes O(n).
+   */
+  template<class... Args>
+  void emplace_front(Args&&... args) {
+    emplace(begin(), std::forward<Args>(args)...);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the last element.
+   *
+   *  This takes amortized O(1), plus O(log n) if aggregates are maintained.
+   *  Existing elements are never moved.
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    size_type const c{chunk_of(size_)};
+    if (c == chunks_.size()) {
+      chunks_.push_back(std::allocator_traits<allocator_type>::allocate(
+          allocator_, chunk_capacity(c)));
+    }
+    std::allocator_traits<allocator_type>::construct(
+        allocator_,
+        std::addressof(chunks_[c][size_ - chunk_begin(c)]),
+        std::forward<Args>(args)...);
+    ++size_;
+    push_aggregate();
+  }
+
+  /**
+   *  @brief
+   *  Erases an element pointed to by `pos`, then returns the iterator to the
+   *    position right after `pos`.
+   *
+   *  This takes O(n - index).
+   */
+  template<bool constant>
+  iterator erase(p_iterator<constant> pos) {
+    assert(pos.seq_ == this);
+    return erase(pos, pos + 1);
+  }
+
+  /**
+   *  @brief
+   *  Erases elements in the interval `[first, last)`, then returns the
+   *    iterator to the position right after the erased elements.
+   *
+   *  This takes O(n - first).
+   */
+  template<bool constant_1, bool constant_2>
+  iterator erase(
+      p_iterator<constant_1> first,
+      p_iterator<constant_2> last) {
+    assert(first.seq_ == this);
+    assert(last.seq_ == this);
+    assert(first <= last);
+    size_type const begin_index{first.index_};
+    size_type const end_index{last.index_};
+    auto tail{take_tail(end_index)};
+    while (size_ > begin_index) {
+      pop_back();
+    }
+    for (auto& value : tail) {
+      emplace_back(std::move(value));
+    }
+    return make_iterator(begin_index);
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   *
+   *  This takes O(n).
+   */
+  void pop_front() {
+    assert(!empty());
+    erase(begin());
+  }
+
+  /**
+   *  @brief
+   *  Erases the last element.
+   *
+   *  The last chunk is deallocated once the chunk before it is also empty,
+   *    so alternating `push_back()` and `pop_back()` at a chunk boundary does
+   *    not allocate repeatedly.
+   */
+  void pop_back() {
+    assert(!empty());
+    std::allocator_traits<allocator_type>::destroy(
+        allocator_, locate(size_ - 1));
+    --size_;
+    if constexpr (kHasAggregates) {
+      fenwick_.pop_back();
+    }
+    while (chunks_.size() >= 2 && size_ <= chunk_begin(chunks_.size() - 2)) {
+      remove_last_chunk();
+    }
+  }
+
+};
+
+/**
+ *  @brief
+ *  Implementation struct that makes `ManagedTree<ImplicitSequenceImpl<...>>`
+ *    an `ImplicitSequence`.
+ *
+ *  This is the cheapest layout for sequences that only grow at the back:
+ *    there are no nodes, `operator[]` is O(1), and appending is amortized
+ *    O(1).
+ *  Pass an associative `OperationT` such as `std::plus<Value>` to get
+ *    `prefix_aggregate()` and `prefix_search()` in O(log n).
+ */
+template<
+    class ValueT,
+    class AllocatorT = std::allocator<ValueT>,
+    class OperationT = void>
+struct ImplicitSequenceImpl {
+  /// This type.
+  using This = ImplicitSequenceImpl<ValueT, AllocatorT, OperationT>;
+
+  /// Type of values to present to the user.
+  using Value = ValueT;
+
+  /// Type of allocators for `Value`.
+  using ValueAllocator = AllocatorT;
+
+  /// Container that provides the interface of `ManagedTree`.
+  using Container = ImplicitSequence<Value, ValueAllocator, OperationT>;
+};
+
+} // namespace ordered_binary_trees
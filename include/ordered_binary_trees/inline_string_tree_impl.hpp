@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#include <ordered_binary_trees/ordered_binary_tree.hpp>
+#include <ordered_binary_trees/ordered_binary_tree_iterator.hpp>
+#include <ordered_binary_trees/ordered_binary_tree_node.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  `Data` for `InlineStringTreeImpl`: a string stored right after the node
+ *    that contains this object, in the same allocation.
+ *
+ *  `OrderedBinaryTree::create_node()` sees `extra_bytes()` and allocates
+ *    enough room after the node for the characters.
+ *  `value` views these characters and never changes, so the payload cannot
+ *    be resized; replacing an element means erasing it and inserting a new
+ *    one.
+ *
+ *  This object must be the last member of its node, with no padding after
+ *    it, and must not be copied or moved other than into a new node.
+ */
+template<class CharT>
+struct InlineStringData {
+  /// Type of views of the payload.
+  using View = std::basic_string_view<CharT>;
+
+  /// View of the payload.
+  View value;
+
+  /// Returns the number of payload bytes for a string equal to `view`.
+  static constexpr std::size_t extra_bytes(View view) {
+    return view.size() * sizeof(CharT);
+  }
+
+  /// Returns the number of payload bytes of `data`.
+  static constexpr std::size_t extra_bytes(InlineStringData const& data) {
+    return extra_bytes(data.value);
+  }
+
+  /// Returns `0` for an empty string.
+  static constexpr std::size_t extra_bytes() {
+    return 0;
+  }
+
+  /// Creates an empty string.
+  InlineStringData() = default;
+
+  /// Copies `view` into the payload.
+  explicit InlineStringData(View view)
+    : value{std::uninitialized_copy(
+          view.begin(), view.end(), reinterpret_cast<CharT*>(this + 1)) -
+        view.size(), view.size()} {}
+
+  /// Copies the payload of `other` into the payload of this object.
+  InlineStringData(InlineStringData const& other)
+    : InlineStringData{other.value} {}
+
+  InlineStringData& operator=(InlineStringData const&) = delete;
+};
+
+/**
+ *  @brief
+ *  Tree implementation for sequences of immutable strings that stores each
+ *    string in the same allocation as its node.
+ *
+ *  With `std::string` values, every element costs a node allocation plus a
+ *    heap buffer, and reading an element follows two pointers.
+ *  Here, the characters follow the node directly, so each element is one
+ *    allocation, and reading it touches memory next to the node.
+ *  Elements are exposed as `std::basic_string_view<CharT> const` through
+ *    `ExtractValue`.
+ *
+ *  Elements are constructed from anything convertible to
+ *    `std::basic_string_view<CharT>`, e.g., `std::string` or string literals.
+ *  The tree itself is maintained by `BaseImplT`, which defaults to
+ *    `SplayTreeImpl`, so every operation has the same complexity as in
+ *    `BaseImplT`.
+ *
+ *  This class only contains types and static functions.
+ */
+template<
+    class CharT = char,
+    class AllocatorT = std::allocator<CharT>,
+    template<class, class> class BaseImplT = SplayTreeImpl>
+struct InlineStringTreeImpl: BaseImplT<
+    InlineStringData<CharT>,
+    typename std::allocator_traits<AllocatorT>::
+        template rebind_alloc<InlineStringData<CharT>>> {
+  /// This type.
+  using This = InlineStringTreeImpl<CharT, AllocatorT, BaseImplT>;
+
+  /// String stored after each node.
+  using Data = InlineStringData<CharT>;
+
+  /// Base class: `BaseImplT` over `Data`.
+  using Super = BaseImplT<
+      Data,
+      typename std::allocator_traits<AllocatorT>::
+          template rebind_alloc<Data>>;
+
+  /// Type of values to present to the user: read-only views.
+  using Value = typename Data::View const;
+
+  /// Type of allocators for characters.
+  using ValueAllocator = AllocatorT;
+
+  /// Extraction of `AddPointer` inside `AddPointerFromAllocator`.
+  template<class T>
+  using AddPointer = typename Super::template AddPointer<T>;
+
+  /// Type of nodes in a tree.
+  using Node = typename Super::Node;
+
+  /// Type of node allocators.
+  using Allocator = typename Super::Allocator;
+
+  /// Type of trees.
+  using Tree = typename Super::Tree;
+
+  /// Type of indices.
+  using size_type = typename Super::size_type;
+
+  /// Type of node pointers.
+  using NodePtr = typename Super::NodePtr;
+
+  /// `Tree::InsertPosition`.
+  using InsertPosition = typename Super::InsertPosition;
+
+  static_assert(HasExtraBytes<Data>::value);
+  static_assert(std::is_standard_layout_v<Node> &&
+      offsetof(Node, data) + sizeof(Data) == sizeof(Node),
+      "InlineStringData must be at the end of the node");
+  static_assert(alignof(Node) % alignof(CharT) == 0);
+
+  /// Conversion from `Data` to the view of the payload.
+  struct ExtractValue {
+    /// `InlineStringTreeImpl::Value`.
+    using Value = typename This::Value;
+
+    /// Returns `data.value`.
+    static constexpr Value& value_in_data(Data const& data) {
+      return data.value;
+    }
+  };
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include <ordered_binary_trees/managed_tree.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Function object that uses a whole value as its key.
+ */
+struct IdentityKey {
+  /// Returns `value`.
+  template<class T>
+  constexpr T const& operator()(T const& value) const {
+    return value;
+  }
+};
+
+/**
+ *  @brief
+ *  `ManagedTree` with a hash index from keys to nodes.
+ *
+ *  Every element has a unique key, computed by `KeyOfT` from its value.
+ *  The hash index maps each key to the node that holds the element, so
+ *    `find()`, `erase(key)` and `move()` locate the element in O(1) expected
+ *    time, and `index_of()` computes its position by climbing from the node
+ *    to the root with `Node::get_index()`.
+ *  Every insertion and erasure through this class keeps the index up to date.
+ *
+ *  Modifying the key of an element through an iterator or a reference is not
+ *    allowed.
+ *
+ *  @tparam TreeImplT
+ *    Tree implementation whose nodes stay in place while other nodes are
+ *    inserted or erased, e.g., `SplayTreeImpl`.
+ *  @tparam KeyOfT
+ *    Function object type that returns the key of a value.
+ */
+template<
+    class TreeImplT,
+    class KeyOfT = IdentityKey,
+    class HashT = std::hash<std::decay_t<std::invoke_result_t<
+        KeyOfT const&, typename TreeImplT::Value const&>>>,
+    class KeyEqualT = std::equal_to<std::decay_t<std::invoke_result_t<
+        KeyOfT const&, typename TreeImplT::Value const&>>>>
+class KeyIndexedTree: protected ManagedTree<TreeImplT> {
+ private:
+  /// This class.
+  using This = KeyIndexedTree<TreeImplT, KeyOfT, HashT, KeyEqualT>;
+
+ protected:
+  /// Base class.
+  using Super = ManagedTree<TreeImplT>;
+
+  using typename Super::TreeImpl;
+  using typename Super::Tree;
+  using typename Super::NodePtr;
+  using typename Super::Value;
+  using typename Super::ValueAllocator;
+  using typename Super::ExtractValue;
+  using Super::tree_;
+  using Super::make_iterator;
+  using Super::node_of;
+
+  /// Iterator types accepted as positions.
+  template<bool constant>
+  using p_iterator = OrderedBinaryTreeIterator<
+      Tree,
+      constant,
+      false,
+      ExtractValue>;
+
+  /// Type of keys.
+  using Key = std::decay_t<std::invoke_result_t<KeyOfT const&, Value const&>>;
+
+  /// Type of the hash index.
+  using Index = std::unordered_map<
+      Key,
+      NodePtr,
+      HashT,
+      KeyEqualT,
+      typename std::allocator_traits<ValueAllocator>::template rebind_alloc<
+          std::pair<Key const, NodePtr>>>;
+
+  /// Function object that computes keys.
+  KeyOfT key_of_;
+
+  /// Map from keys to nodes.
+  Index index_;
+
+  /// Rebuilds `index_` from the nodes in the tree.
+  void rebuild_index() {
+    index_.clear();
+    index_.reserve(size());
+    for (NodePtr n{tree_.first}; n; n = n->find_next_node()) {
+      index_.emplace(key_of_(ExtractValue::value_in_data(n->data)), n);
+    }
+  }
+
+  /// Returns the node holding `key`, or null if there is none.
+  template<class K>
+  NodePtr find_node(K const& key) const {
+    auto it{index_.find(key)};
+    return it == index_.end() ? nullptr : it->second;
+  }
+
+  /**
+   *  @brief
+   *  Adds `value` before `node` unless its key is already present.
+   */
+  template<class V>
+  std::pair<typename Super::iterator, bool> insert_before(
+      NodePtr node,
+      V&& value) {
+    auto [index_it, inserted]{index_.try_emplace(key_of_(value), nullptr)};
+    if (!inserted) {
+      return {make_iterator(index_it->second), false};
+    }
+    try {
+      index_it->second = TreeImpl::emplace_node_before(
+          tree_, node, std::forward<V>(value));
+    } catch (...) {
+      index_.erase(index_it);
+      throw;
+    }
+    return {make_iterator(index_it->second), true};
+  }
+
+ public:
+  using typename Super::value_type;
+  using typename Super::allocator_type;
+  using typename Super::size_type;
+  using typename Super::reference;
+  using typename Super::const_reference;
+  using typename Super::iterator;
+  using typename Super::const_iterator;
+  using typename Super::reverse_iterator;
+  using typename Super::const_reverse_iterator;
+
+  /// Type of keys.
+  using key_type = Key;
+
+  /**
+   *  @brief
+   *  Creates an empty tree.
+   */
+  KeyIndexedTree(
+      KeyOfT const& key_of = KeyOfT(),
+      allocator_type const& allocator = allocator_type())
+    : Super{allocator},
+      key_of_{key_of},
+      index_(0, HashT(), KeyEqualT(),
+          typename Index::allocator_type(allocator)) {}
+
+  /**
+   *  @brief
+   *  Copies elements from `other` and indexes the new nodes.
+   */
+  KeyIndexedTree(This const& other)
+    : Super{other},
+      key_of_{other.key_of_},
+      index_(0, other.index_.hash_function(), other.index_.key_eq(),
+          other.index_.get_allocator()) {
+    rebuild_index();
+  }
+
+  /**
+   *  @brief
+   *  Takes elements and the index from `other`.
+   */
+  KeyIndexedTree(This&& other) = default;
+
+  /**
+   *  @brief
+   *  Copies elements from `other` and indexes the new nodes.
+   */
+  This& operator=(This const& other) {
+    Super::operator=(other);
+    key_of_ = other.key_of_;
+    rebuild_index();
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes elements and the index from `other`.
+   */
+  This& operator=(This&& other) = default;
+
+  using Super::size;
+  using Super::empty;
+  using Super::get_allocator;
+  using Super::freeze;
+  using Super::operator[];
+  using Super::at;
+  using Super::front;
+  using Super::back;
+  using Super::begin;
+  using Super::cbegin;
+  using Super::rbegin;
+  using Super::crbegin;
+  using Super::end;
+  using Super::cend;
+  using Super::rend;
+  using Super::crend;
+  using Super::get_iterator_at_index;
+
+  /**
+   *  @brief
+   *  Erases all elements.
+   */
+  void clear() {
+    Super::clear();
+    index_.clear();
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` if an element with `key` exists.
+   */
+  bool contains(key_type const& key) const {
+    return index_.find(key) != index_.end();
+  }
+
+  /**
+   *  @brief
+   *  Returns the iterator to the element with `key`, or `end()` if there is
+   *    none.
+   */
+  iterator find(key_type const& key) {
+    return make_iterator(find_node(key));
+  }
+
+  /**
+   *  @brief
+   *  Returns the iterator to the element with `key`, or `end()` if there is
+   *    none.
+   */
+  const_iterator find(key_type const& key) const {
+    return Super::template make_iterator<true>(find_node(key));
+  }
+
+  /**
+   *  @brief
+   *  Returns the index of the element with `key`.
+   *
+   *  This takes O(depth) time and does not restructure the tree.
+   *  If there is no such element, `std::out_of_range` will be thrown.
+   */
+  size_type index_of(key_type const& key) const {
+    NodePtr n{find_node(key)};
+    if (!n) {
+      throw std::out_of_range("KeyIndexedTree::index_of -- key not found");
+    }
+    return n->get_index();
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` unless its key is already present.
+   *
+   *  The return value has the same meaning as in
+   *    `std::unordered_map::insert()`.
+   */
+  template<bool constant>
+  std::pair<iterator, bool> insert(
+      p_iterator<constant> pos,
+      Value const& value) {
+    return insert_before(node_of(pos), value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` unless its key is already present.
+   */
+  template<bool constant>
+  std::pair<iterator, bool> insert(
+      p_iterator<constant> pos,
+      Value&& value) {
+    return insert_before(node_of(pos), std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Prepends `value` unless its key is already present.
+   */
+  std::pair<iterator, bool> push_front(Value const& value) {
+    return insert_before(tree_.first, value);
+  }
+
+  /**
+   *  @brief
+   *  Prepends `value` unless its key is already present.
+   */
+  std::pair<iterator, bool> push_front(Value&& value) {
+    return insert_before(tree_.first, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Appends `value` unless its key is already present.
+   */
+  std::pair<iterator, bool> push_back(Value const& value) {
+    return insert_before(nullptr, value);
+  }
+
+  /**
+   *  @brief
+   *  Appends `value` unless its key is already present.
+   */
+  std::pair<iterator, bool> push_back(Value&& value) {
+    return insert_before(nullptr, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Erases the element pointed to by `pos` and returns the iterator to the
+   *    next element.
+   */
+  template<bool constant>
+  iterator erase(p_iterator<constant> pos) {
+    assert(node_of(pos));
+    index_.erase(key_of_(*pos));
+    return Super::erase(pos);
+  }
+
+  /**
+   *  @brief
+   *  Erases the element with `key` and returns the number of erased elements.
+   */
+  size_type erase(key_type const& key) {
+    auto it{index_.find(key)};
+    if (it == index_.end()) {
+      return 0;
+    }
+    NodePtr n{it->second};
+    index_.erase(it);
+    TreeImpl::erase_node(tree_, n);
+    return 1;
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    assert(!empty());
+    index_.erase(key_of_(front()));
+    Super::pop_front();
+  }
+
+  /**
+   *  @brief
+   *  Erases the last element.
+   */
+  void pop_back() {
+    assert(!empty());
+    index_.erase(key_of_(back()));
+    Super::pop_back();
+  }
+
+  /**
+   *  @brief
+   *  Moves the element with `key` so that its index becomes `new_index`, and
+   *    returns the iterator to it.
+   *
+   *  The node is unlinked and linked again without being reallocated, so
+   *    iterators to it remain valid.
+   *  `new_index` must be less than `size()`.
+   *  If there is no element with `key`, `std::out_of_range` will be thrown.
+   */
+  iterator move(key_type const& key, size_type new_index) {
+    NodePtr n{find_node(key)};
+    if (!n) {
+      throw std::out_of_range("KeyIndexedTree::move -- key not found");
+    }
+    assert(new_index < size());
+    tree_.template erase<true, false>(n);
+    n->parent = nullptr;
+    n->left_child = nullptr;
+    n->right_child = nullptr;
+    n->size = 1;
+    tree_.link_at_index(new_index, n);
+    return make_iterator(n);
+  }
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,575 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Effect of adding `delta` to each of `count` values on their sum.
+ */
+struct AddToSum {
+  /// Returns `aggregate + delta * count`.
+  template<class ValueT, class SizeT>
+  constexpr ValueT operator()(
+      ValueT const& aggregate, ValueT const& delta, SizeT count) const {
+    return aggregate + delta * static_cast<ValueT>(count);
+  }
+};
+
+/**
+ *  @brief
+ *  Effect of adding `delta` to each of `count` values on their minimum or
+ *    maximum.
+ */
+struct AddToExtremum {
+  /// Returns `aggregate + delta`.
+  template<class ValueT, class SizeT>
+  constexpr ValueT operator()(
+      ValueT const& aggregate, ValueT const& delta, SizeT) const {
+    return aggregate + delta;
+  }
+};
+
+/**
+ *  @brief
+ *  Dynamic forest of rooted trees with values on vertices, supporting
+ *    structural changes and path queries in O(log n) amortized time.
+ *
+ *  This is a link-cut tree.
+ *  Each tree is decomposed into preferred paths, and each path is a splay
+ *    tree of `OrderedBinaryTreeNode`s ordered by depth.
+ *  The root of each splay tree remembers the vertex that its path hangs from.
+ *  Splaying uses `OrderedBinaryTreeNode::splay()` with an update function
+ *    that recomputes sizes and aggregates, after pending changes have been
+ *    pushed down from the root of the splay tree.
+ *
+ *  Aggregates combine values in path order with `OperationT`, which must be
+ *    associative but need not be commutative.
+ *  `path_add()` adds a delta to every value on a path.
+ *  Deltas are combined with `+`, and `ActionT` describes their effect on an
+ *    aggregate, e.g., `AddToSum` for `std::plus`, or `AddToExtremum` for a
+ *    minimum or a maximum.
+ *  If `ActionT` is `void`, `path_add()` is not available.
+ *
+ *  Vertices are numbered from `0` to `num_vertices() - 1`.
+ */
+template<
+    class ValueT,
+    class OperationT = std::plus<ValueT>,
+    class ActionT = AddToSum,
+    class AllocatorT = std::allocator<ValueT>>
+class LinkCutForest {
+ private:
+  /// This class.
+  using This = LinkCutForest<ValueT, OperationT, ActionT, AllocatorT>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator.
+  using allocator_type = AllocatorT;
+
+  /// Type of vertices and sizes.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// Type of the aggregation operation.
+  using operation_type = OperationT;
+
+  /// `true` iff `path_add()` is available.
+  static constexpr bool kHasPathAdd{!std::is_void_v<ActionT>};
+
+ protected:
+  /// Placeholder for `ActionT = void`.
+  struct NoAction {};
+
+ public:
+  /// Type of the effect of deltas on aggregates.
+  using action_type = std::conditional_t<kHasPathAdd, ActionT, NoAction>;
+
+  /// Vertex returned when there is none.
+  static constexpr size_type kNone{std::numeric_limits<size_type>::max()};
+
+ protected:
+  /**
+   *  @brief
+   *  Data of a vertex in its splay tree.
+   *
+   *  Pending changes apply to the descendants of the node only.
+   *  The fields of the node itself are always up to date.
+   */
+  struct Vertex {
+    /// Index of the vertex.
+    size_type id;
+    /// Value of the vertex.
+    value_type value;
+    /// Aggregate of the subtree in path order.
+    value_type aggregate;
+    /// Aggregate of the subtree in reverse path order.
+    value_type reverse_aggregate;
+    /// Delta to add to all descendants.
+    value_type pending;
+    /// Vertex that the path hangs from, if this node is the root of its
+    ///   splay tree. `kNone` otherwise.
+    size_type path_parent{kNone};
+    /// `true` iff `pending` holds a delta.
+    bool has_pending{false};
+    /// `true` iff the children of all descendants must be swapped.
+    bool reversed{false};
+
+    /// Creates a vertex with no edges.
+    Vertex(size_type id, value_type const& value)
+      : id{id},
+        value{value},
+        aggregate{value},
+        reverse_aggregate{value},
+        pending{value} {}
+  };
+
+  /// Allocator for values of type `T`.
+  template<class T>
+  using RebindAllocator = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<T>;
+
+  /// Tree implementation whose nodes hold vertices.
+  using TreeImpl = SplayTreeImpl<Vertex, RebindAllocator<Vertex>>;
+
+  /// Type of nodes.
+  using Node = typename TreeImpl::Node;
+
+  /// Type of pointers to nodes.
+  using NodePtr = typename TreeImpl::NodePtr;
+
+  /// Type of node allocators.
+  using Allocator = typename TreeImpl::Allocator;
+
+  /// Allocator for nodes.
+  OBT_NO_UNIQUE_ADDRESS Allocator allocator_;
+
+  /// Aggregation operation.
+  OBT_NO_UNIQUE_ADDRESS operation_type operation_;
+
+  /// Effect of deltas on aggregates.
+  OBT_NO_UNIQUE_ADDRESS action_type action_;
+
+  /// `vertices_[v]` is the node of vertex `v`.
+  std::vector<NodePtr, RebindAllocator<NodePtr>> vertices_;
+
+  /// Nodes from a node up to the root of its splay tree, used by `splay()`.
+  std::vector<NodePtr, RebindAllocator<NodePtr>> path_;
+
+  /// Destroys a node.
+  void destroy_node(NodePtr n) {
+    std::allocator_traits<Allocator>::destroy(allocator_, std::addressof(*n));
+    std::allocator_traits<Allocator>::deallocate(allocator_, n, 1);
+  }
+
+  /// Reverses the path order of the subtree rooted at `n`.
+  static void apply_reverse(NodePtr n) {
+    if (n) {
+      std::swap(n->left_child, n->right_child);
+      std::swap(n->data.aggregate, n->data.reverse_aggregate);
+      n->data.reversed = !n->data.reversed;
+    }
+  }
+
+  /// Adds `delta` to every value in the subtree rooted at `n`.
+  void apply_add(NodePtr n, value_type const& delta) {
+    if (!n) {
+      return;
+    }
+    Vertex& v{n->data};
+    v.value = v.value + delta;
+    v.aggregate = action_(v.aggregate, delta, n->size);
+    v.reverse_aggregate = action_(v.reverse_aggregate, delta, n->size);
+    v.pending = v.has_pending ? v.pending + delta : delta;
+    v.has_pending = true;
+  }
+
+  /// Passes the pending changes of `n` to its children.
+  void push(NodePtr n) {
+    Vertex& v{n->data};
+    if (v.reversed) {
+      apply_reverse(n->left_child);
+      apply_reverse(n->right_child);
+      v.reversed = false;
+    }
+    if constexpr (kHasPathAdd) {
+      if (v.has_pending) {
+        apply_add(n->left_child, v.pending);
+        apply_add(n->right_child, v.pending);
+        v.has_pending = false;
+      }
+    }
+  }
+
+  /**
+   *  @brief
+   *  Recomputes the size and the aggregates of `n` from its children.
+   *
+   *  This is the update function given to `OrderedBinaryTreeNode::splay()`.
+   */
+  void pull(NodePtr n) {
+    n->update_size();
+    Vertex& v{n->data};
+    v.aggregate = v.value;
+    v.reverse_aggregate = v.value;
+    if (NodePtr l{n->left_child}) {
+      v.aggregate = operation_(l->data.aggregate, v.aggregate);
+      v.reverse_aggregate =
+          operation_(v.reverse_aggregate, l->data.reverse_aggregate);
+    }
+    if (NodePtr r{n->right_child}) {
+      v.aggregate = operation_(v.aggregate, r->data.aggregate);
+      v.reverse_aggregate =
+          operation_(r->data.reverse_aggregate, v.reverse_aggregate);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Splays `n` to be an immediate child of `top`, or to be the root of its
+   *    splay tree if `top` is null.
+   *
+   *  `top` must be an ancestor of `n` in the same splay tree.
+   */
+  void splay(NodePtr n, NodePtr top = nullptr) {
+    path_.clear();
+    for (NodePtr a{n}; a; a = a->parent) {
+      path_.push_back(a);
+    }
+    for (auto i{path_.rbegin()}; i != path_.rend(); ++i) {
+      push(*i);
+    }
+    NodePtr const root{path_.back()};
+    n->splay([this](NodePtr a) { pull(a); }, top);
+    if (!top && root != n) {
+      n->data.path_parent = root->data.path_parent;
+      root->data.path_parent = kNone;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Makes the path from the root of the tree to `n` a preferred path that
+   *    ends at `n`, with `n` at the root of its splay tree.
+   *
+   *  Returns the last vertex where the walk up joined the path that was
+   *    preferred before, which is the lowest common ancestor of `n` and the
+   *    vertex accessed before.
+   */
+  NodePtr access(NodePtr n) {
+    NodePtr last{nullptr};
+    for (NodePtr a{n}; a;) {
+      splay(a);
+      if (NodePtr r{a->right_child}) {
+        r->parent = nullptr;
+        r->data.path_parent = a->data.id;
+      }
+      a->right_child = last;
+      if (last) {
+        last->parent = a;
+        last->data.path_parent = kNone;
+      }
+      pull(a);
+      last = a;
+      size_type const p{a->data.path_parent};
+      a = p == kNone ? nullptr : vertices_[p];
+    }
+    splay(n);
+    return last;
+  }
+
+  /// Makes `n` the root of its tree.
+  void make_root(NodePtr n) {
+    access(n);
+    apply_reverse(n);
+  }
+
+  /// Returns the root of the tree of `n`.
+  NodePtr find_root_node(NodePtr n) {
+    access(n);
+    NodePtr r{n};
+    push(r);
+    while (r->left_child) {
+      r = r->left_child;
+      push(r);
+    }
+    splay(r);
+    return r;
+  }
+
+  /**
+   *  @brief
+   *  Returns the parent of `n` in its tree, or null.
+   *
+   *  After the call, `n` is the root of its splay tree, and the parent is its
+   *    left child with no right child.
+   */
+  NodePtr parent_node(NodePtr n) {
+    access(n);
+    NodePtr p{n->left_child};
+    if (!p) {
+      return nullptr;
+    }
+    push(p);
+    while (p->right_child) {
+      p = p->right_child;
+      push(p);
+    }
+    splay(p, n);
+    return p;
+  }
+
+  /// Removes the edge between `n` and its parent found by `parent_node()`.
+  void detach_from_parent(NodePtr n) {
+    NodePtr p{n->left_child};
+    assert(p && !p->right_child);
+    p->parent = nullptr;
+    n->left_child = nullptr;
+    pull(n);
+  }
+
+  /**
+   *  @brief
+   *  Makes `u` the root of its tree and accesses `v`, so that the splay tree
+   *    rooted at `v` holds exactly the path from `u` to `v`.
+   *
+   *  Returns the former root of the tree, which the caller passes to
+   *    `make_root()` afterwards to restore the parent of every vertex.
+   */
+  NodePtr expose_path(size_type u, size_type v) {
+    assert(connected(u, v));
+    NodePtr const root{find_root_node(vertices_[u])};
+    make_root(vertices_[u]);
+    access(vertices_[v]);
+    return root;
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates a forest of `num_vertices` isolated vertices with value
+   *    `value`.
+   */
+  explicit LinkCutForest(
+      size_type num_vertices = 0,
+      value_type const& value = value_type(),
+      operation_type const& operation = operation_type(),
+      action_type const& action = action_type(),
+      allocator_type const& allocator = allocator_type())
+    : allocator_(allocator),
+      operation_(operation),
+      action_(action),
+      vertices_(RebindAllocator<NodePtr>(allocator)),
+      path_(RebindAllocator<NodePtr>(allocator)) {
+    vertices_.reserve(num_vertices);
+    for (size_type v{0}; v < num_vertices; ++v) {
+      add_vertex(value);
+    }
+  }
+
+  LinkCutForest(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the forest.
+   */
+  ~LinkCutForest() {
+    for (NodePtr n : vertices_) {
+      destroy_node(n);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of vertices.
+   */
+  size_type num_vertices() const {
+    return static_cast<size_type>(vertices_.size());
+  }
+
+  /**
+   *  @brief
+   *  Adds an isolated vertex with value `value` and returns it.
+   */
+  size_type add_vertex(value_type const& value = value_type()) {
+    size_type const v{num_vertices()};
+    NodePtr n{std::allocator_traits<Allocator>::allocate(allocator_, 1)};
+    try {
+      std::allocator_traits<Allocator>::construct(allocator_,
+          std::addressof(*n), v, value);
+    } catch (...) {
+      std::allocator_traits<Allocator>::deallocate(allocator_, n, 1);
+      throw;
+    }
+    try {
+      vertices_.push_back(n);
+    } catch (...) {
+      destroy_node(n);
+      throw;
+    }
+    return v;
+  }
+
+  /**
+   *  @brief
+   *  Returns the value of `v`.
+   */
+  value_type const& value(size_type v) {
+    access(vertices_[v]);
+    return vertices_[v]->data.value;
+  }
+
+  /**
+   *  @brief
+   *  Sets the value of `v` to `value`.
+   */
+  void set_value(size_type v, value_type const& value) {
+    NodePtr n{vertices_[v]};
+    access(n);
+    n->data.value = value;
+    pull(n);
+  }
+
+  /**
+   *  @brief
+   *  Returns the root of the tree of `v`.
+   */
+  size_type find_root(size_type v) {
+    return find_root_node(vertices_[v])->data.id;
+  }
+
+  /**
+   *  @brief
+   *  Returns the parent of `v`, or `kNone` if `v` is a root.
+   */
+  size_type parent(size_type v) {
+    NodePtr p{parent_node(vertices_[v])};
+    return p ? p->data.id : kNone;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of edges between `v` and the root of its tree.
+   */
+  size_type depth(size_type v) {
+    NodePtr n{vertices_[v]};
+    access(n);
+    return Node::get_size(n->left_child);
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff `u` and `v` are in the same tree.
+   */
+  bool connected(size_type u, size_type v) {
+    return u == v || find_root(u) == find_root(v);
+  }
+
+  /**
+   *  @brief
+   *  Returns the lowest common ancestor of `u` and `v`, or `kNone` if they
+   *    are in different trees.
+   */
+  size_type lca(size_type u, size_type v) {
+    if (!connected(u, v)) {
+      return kNone;
+    }
+    access(vertices_[u]);
+    return access(vertices_[v])->data.id;
+  }
+
+  /**
+   *  @brief
+   *  Makes `u` the root of its tree, then makes it a child of `v`.
+   *
+   *  Returns `false` without changing anything if `u` and `v` are already
+   *    connected.
+   */
+  bool link(size_type u, size_type v) {
+    if (connected(u, v)) {
+      return false;
+    }
+    NodePtr n{vertices_[u]};
+    make_root(n);
+    n->data.path_parent = v;
+    return true;
+  }
+
+  /**
+   *  @brief
+   *  Removes the edge between `v` and its parent.
+   *
+   *  Returns `false` if `v` is a root.
+   */
+  bool cut(size_type v) {
+    NodePtr n{vertices_[v]};
+    if (!parent_node(n)) {
+      return false;
+    }
+    detach_from_parent(n);
+    return true;
+  }
+
+  /**
+   *  @brief
+   *  Removes the edge between `u` and `v`.
+   *
+   *  Returns `false` if there is no such edge.
+   */
+  bool cut(size_type u, size_type v) {
+    NodePtr nu{vertices_[u]};
+    NodePtr nv{vertices_[v]};
+    if (parent_node(nu) == nv) {
+      detach_from_parent(nu);
+      return true;
+    }
+    if (parent_node(nv) == nu) {
+      detach_from_parent(nv);
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   *  @brief
+   *  Returns the aggregate of the values on the path from `u` to `v`, in
+   *    that order.
+   *
+   *  `u` and `v` must be connected.
+   */
+  value_type path_aggregate(size_type u, size_type v) {
+    NodePtr const root{expose_path(u, v)};
+    value_type aggregate{vertices_[v]->data.aggregate};
+    make_root(root);
+    return aggregate;
+  }
+
+  /**
+   *  @brief
+   *  Adds `delta` to the values on the path from `u` to `v`.
+   *
+   *  `u` and `v` must be connected.
+   */
+  void path_add(size_type u, size_type v, value_type const& delta) {
+    static_assert(kHasPathAdd, "LinkCutForest -- ActionT is void");
+    NodePtr const root{expose_path(u, v)};
+    apply_add(vertices_[v], delta);
+    make_root(root);
+  }
+};
+
+} // namespace ordered_binary_trees
@@ -1,20 +1,56 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iterator>
 #include <memory>
 #include <stdexcept>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/change_feed.hpp>
+#include <ordered_binary_trees/frozen_sequence.hpp>
+#include <ordered_binary_trees/ordered_binary_tree_iterator.hpp>
 
 namespace ordered_binary_trees {
 
+/**
+ *  @brief
+ *  Replaces the value type of a tree implementation with `U`.
+ *
+ *  This works for implementations of the form `Impl<Value, Allocator>`.
+ *  The allocator is rebound to `U`.
+ */
+template<class TreeImplT, class U>
+struct RebindTreeImpl;
+
+template<template<class, class> class TreeImplT, class V, class A, class U>
+struct RebindTreeImpl<TreeImplT<V, A>, U> {
+  using type = TreeImplT<
+      U, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+};
+
+/// `RebindTreeImpl<TreeImplT, U>::type`.
+template<class TreeImplT, class U>
+using RebindTreeImplT = typename RebindTreeImpl<TreeImplT, U>::type;
+
 /**
  *  @brief
  *  Template class for binary tree-based list data structures.
  *
  *  This class provides a `std::deque`-like interface for tree-based data
  *    structures.
+ *
+ *  The second template parameter is only used to select the specialization
+ *    for implementations that provide their own `Container`.
+ *  (See the specialization below.)
  */
-template<class TreeImplT>
+template<class TreeImplT, class = void>
 class ManagedTree {
  private:
   /// This class.
@@ -57,6 +93,22 @@ class ManagedTree {
   /// Actual representation of the tree.
   mutable Tree tree_;
 
+  /// `map()` fills in `tree_` of trees with other value types.
+  template<class, class>
+  friend class ManagedTree;
+
+  /// `CompactTree` converts to and from `ManagedTree` by moving `tree_`.
+  template<class>
+  friend class CompactTree;
+
+  /// Cursors in `bulk_cursors.hpp` take, copy and build `tree_` in steps.
+  template<class>
+  friend class DestructionCursor;
+  template<class>
+  friend class CloneCursor;
+  template<class, class>
+  friend class BuildCursor;
+
   /// Parametrized iterator type.
   template<bool constant = false, bool reverse = false>
   using p_iterator = OrderedBinaryTreeIterator<
@@ -71,6 +123,100 @@ class ManagedTree {
     return {&tree_, node};
   }
 
+  /// Returns the node that `it` points to.
+  template<bool constant, bool reverse>
+  static constexpr NodePtr node_of(p_iterator<constant, reverse> const& it) {
+    return it.node_;
+  }
+
+  /**
+   *  @brief
+   *  Creates nodes in `target` with the same shape as the subtree rooted at
+   *    `n`, holding `f(x)` for each value `x`, and returns the new root.
+   *
+   *  Nodes are created in pre-order with an explicit stack, and each node is
+   *    linked to its parent as soon as it is created.
+   *  Children with at least `frozen_type::kParallelGrainSize` nodes are
+   *    mapped by asynchronous tasks, as long as `budget` allows more tasks.
+   *  Tasks call `target.create_node()` concurrently, so `budget` must be `0`
+   *    unless the node allocator of `target` is always equal.
+   */
+  template<class TargetTree, class F>
+  static typename TargetTree::NodePtr map_nodes(
+      TargetTree& target,
+      NodePtr n,
+      F& f,
+      unsigned budget) {
+    using TargetNodePtr = typename TargetTree::NodePtr;
+    struct Task {
+      std::future<TargetNodePtr> future;
+      TargetNodePtr parent;
+      bool left;
+    };
+    auto create{[&target, &f](NodePtr source) {
+      TargetNodePtr node{
+          target.create_node(f(ExtractValue::value_in_data(source->data)))};
+      node->size = source->size;
+      return node;
+    }};
+
+    TargetNodePtr const root{create(n)};
+    std::vector<Task> tasks;
+    std::exception_ptr error;
+    try {
+      std::vector<std::pair<NodePtr, TargetNodePtr>> stack{{n, root}};
+      while (!stack.empty()) {
+        auto [source, parent]{stack.back()};
+        stack.pop_back();
+        for (bool left : {false, true}) {
+          NodePtr const child{left ? source->left_child : source->right_child};
+          if (!child) {
+            continue;
+          }
+          if (budget > 0 && child->size >= frozen_type::kParallelGrainSize) {
+            --budget;
+            unsigned const child_budget{budget / 2};
+            budget -= child_budget;
+            tasks.push_back(Task{
+                std::async(std::launch::async,
+                    [&target, &f, child, child_budget]() {
+                      return map_nodes(target, child, f, child_budget);
+                    }),
+                parent,
+                left});
+            continue;
+          }
+          TargetNodePtr const node{create(child)};
+          (left ? parent->left_child : parent->right_child) = node;
+          node->parent = parent;
+          stack.emplace_back(child, node);
+        }
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    for (auto& task : tasks) {
+      try {
+        TargetNodePtr const node{task.future.get()};
+        (task.left ? task.parent->left_child : task.parent->right_child) =
+            node;
+        node->parent = task.parent;
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error) {
+      TargetTree::Node::template traverse_postorder<false>(root,
+          [&target](TargetNodePtr node) {
+            target.destroy_node(node);
+          });
+      std::rethrow_exception(error);
+    }
+    return root;
+  }
+
   /**
    *  @brief
    *  Const-iterator type to facilitate initialization with repeated values.
@@ -180,6 +326,13 @@ class ManagedTree {
   using const_pointer = typename std::allocator_traits<allocator_type>::
       const_pointer;
 
+  /// Type of immutable snapshots produced by `freeze()`.
+  using frozen_type = FrozenSequence<value_type, allocator_type>;
+
+  /// Type of feeds given to `set_change_feed()`.
+  using change_feed_type = ChangeFeed<size_type>;
+
+
   /// Type of iterators.
   using iterator = p_iterator<false, false>;
   /// Type of const-iterators.
@@ -189,6 +342,159 @@ class ManagedTree {
   /// Type of const-reverse-iterators.
   using const_reverse_iterator = p_iterator<true, true>;
 
+  /**
+   *  @brief
+   *  Batch of positional edits that defers size maintenance until `commit()`.
+   *
+   *  Each insertion or erasure through the session links or unlinks a single
+   *    node without walking to the root, and remembers the lowest node whose
+   *    size became stale.
+   *  `commit()` repairs the sizes of all ancestors of those nodes bottom-up,
+   *    updating each of them exactly once.
+   *  A burst of `k` edits then costs O(k) plus the number of distinct
+   *    ancestors, instead of O(k * depth).
+   *
+   *  Until the session is committed, sizes are stale, so the tree must not be
+   *    accessed by index and iterators must not be compared or subtracted.
+   *  Moving iterators with `++` and `--` and dereferencing them are fine.
+   *  The destructor commits if `commit()` has not been called.
+   */
+  class EditSession {
+   public:
+    /// Starts a session on `tree`.
+    explicit EditSession(ManagedTree& tree) : tree_{tree} {}
+
+    EditSession(EditSession const&) = delete;
+
+    EditSession& operator=(EditSession const&) = delete;
+
+    /// Commits pending edits.
+    ~EditSession() {
+      commit();
+    }
+
+    /**
+     *  @brief
+     *  Constructs a value right before `pos` and returns the iterator to it.
+     */
+    template<bool constant, class... Args>
+    iterator emplace(p_iterator<constant> pos, Args&&... args) {
+      Tree& tree{tree_.tree_};
+      NodePtr node{node_of(pos)};
+      NodePtr n{tree.template emplace<false>(
+          node ? node->get_prev_insert_position()
+               : tree.get_last_insert_position(),
+          std::forward<Args>(args)...)};
+      if (n->parent) {
+        dirty_.insert(std::addressof(*n->parent));
+      }
+      modified_ = true;
+      return tree_.make_iterator(n);
+    }
+
+    /**
+     *  @brief
+     *  Inserts `value` right before `pos` and returns the iterator to it.
+     */
+    template<bool constant>
+    iterator insert(p_iterator<constant> pos, Value const& value) {
+      return emplace(pos, value);
+    }
+
+    /**
+     *  @brief
+     *  Inserts `value` right before `pos` and returns the iterator to it.
+     */
+    template<bool constant>
+    iterator insert(p_iterator<constant> pos, Value&& value) {
+      return emplace(pos, std::move(value));
+    }
+
+    /**
+     *  @brief
+     *  Erases the element at `pos` and returns the iterator to the next
+     *    element.
+     */
+    template<bool constant>
+    iterator erase(p_iterator<constant> pos) {
+      Tree& tree{tree_.tree_};
+      NodePtr n{node_of(pos)};
+      assert(n);
+      NodePtr next{n->find_next_node()};
+      dirty_.erase(std::addressof(*n));
+      NodePtr stale{tree.template erase<false, true>(n).second};
+      if (stale) {
+        dirty_.insert(std::addressof(*stale));
+      }
+      modified_ = true;
+      return tree_.make_iterator(next);
+    }
+
+    /**
+     *  @brief
+     *  Recomputes sizes on every path from a modified node to the root.
+     *
+     *  Each such node is updated once, after its children.
+     *  Indices are not known during the session, so a `kReset` is recorded
+     *    in the tree's change feed if anything was edited.
+     */
+    void commit() {
+      if (modified_) {
+        tree_.record_change(ChangeKind::kReset, 0, 0);
+        modified_ = false;
+      }
+      if (dirty_.empty()) {
+        return;
+      }
+      // Mark every ancestor of a dirty node, stopping at nodes that are
+      //   already marked.
+      std::unordered_set<Node*> marked;
+      for (Node* d : dirty_) {
+        NodePtr n{d};
+        while (n && marked.insert(std::addressof(*n)).second) {
+          n = n->parent;
+        }
+      }
+      dirty_.clear();
+
+      // Post-order over marked nodes. Unmarked children have correct sizes.
+      auto const is_marked = [&marked](NodePtr n) {
+        return n && marked.count(std::addressof(*n));
+      };
+      std::vector<std::pair<NodePtr, bool>> stack;
+      NodePtr root{tree_.tree_.root};
+      if (is_marked(root)) {
+        stack.emplace_back(root, false);
+      }
+      while (!stack.empty()) {
+        auto& [n, expanded]{stack.back()};
+        if (expanded) {
+          n->update_size();
+          stack.pop_back();
+          continue;
+        }
+        expanded = true;
+        NodePtr const node{n};
+        if (is_marked(node->left_child)) {
+          stack.emplace_back(node->left_child, false);
+        }
+        if (is_marked(node->right_child)) {
+          stack.emplace_back(node->right_child, false);
+        }
+      }
+    }
+
+   protected:
+    /// The tree being edited.
+    ManagedTree& tree_;
+
+    /// Lowest nodes whose sizes may be stale.
+    std::unordered_set<Node*> dirty_;
+
+    /// `true` iff an edit was made since the last `commit()`.
+    bool modified_{false};
+  };
+
   /**
    *  @brief
    *  Creates an empty tree with a given `allocator`.
@@ -231,6 +537,7 @@ class ManagedTree {
       if (allocator != other.tree_.allocator) {
         tree_.template clone_from<false>(other.tree_.root);
       } else {
+        other.record_change(ChangeKind::kErase, 0, other.size());
         tree_ = std::move(other.tree_);
       }
     }
@@ -242,6 +549,7 @@ class ManagedTree {
    */
   constexpr ManagedTree(This&& other)
     : tree_{std::move(other.tree_.allocator)} {
+    other.record_change(ChangeKind::kErase, 0, other.size());
     tree_ = std::move(other.tree_);
   }
 
@@ -253,7 +561,8 @@ class ManagedTree {
    *  Destroys the tree.
    */
   ~ManagedTree() {
-    clear();
+    tree_.destroy_all_nodes();
+    destroy_index_cache();
   }
 
   /**
@@ -261,22 +570,34 @@ class ManagedTree {
    *  Empties the tree.
    */
   constexpr void clear() {
+    record_change(ChangeKind::kErase, 0, size());
     tree_.destroy_all_nodes();
   }
 
   /**
    *  @brief
-   *  Clones the tree from `other`.
+   *  Copies the values of `other` into this tree.
+   *
+   *  Existing nodes are reused, and the result is balanced.
+   *  (See `OrderedBinaryTree::assign_reusing_nodes()`.)
+   *  If a copy throws, the tree holds some of the values, and a `kReset` is
+   *    recorded in the change feed.
    */
   constexpr This& operator=(This const& other) {
-    clear();
-    if constexpr (std::allocator_traits<allocator_type>::
-        propagate_on_container_copy_assignment::value) {
-      tree_.allocator = other.tree_.allocator;
-    }
-    if (other.tree_.root) {
-      tree_.clone_from(other.tree_.root);
+    if (this == &other) {
+      return *this;
     }
+    record_replacement([&] {
+      if constexpr (std::allocator_traits<allocator_type>::
+          propagate_on_container_copy_assignment::value) {
+        if (tree_.allocator != other.tree_.allocator) {
+          // Nodes from the old allocator cannot be kept.
+          tree_.destroy_all_nodes();
+        }
+        replace_allocator([&] { tree_.allocator = other.tree_.allocator; });
+      }
+      tree_.copy_reusing_nodes(other.tree_.root);
+    });
     return *this;
   }
 
@@ -288,9 +609,12 @@ class ManagedTree {
     clear();
     if constexpr (std::allocator_traits<allocator_type>::
         propagate_on_container_move_assignment::value) {
-      tree_.allocator = std::move(other.tree_.allocator);
+      replace_allocator(
+          [&] { tree_.allocator = std::move(other.tree_.allocator); });
     }
+    other.record_change(ChangeKind::kErase, 0, other.size());
     tree_ = std::move(other.tree_);
+    record_change(ChangeKind::kInsert, 0, size());
     return *this;
   }
 
@@ -301,10 +625,20 @@ class ManagedTree {
   constexpr void swap(This& other) {
     if constexpr (std::allocator_traits<allocator_type>::
         propagate_on_container_swap::value) {
-      using std::swap;
-      swap(tree_.allocator, other.tree_.allocator);
+      // Each cache moves to the allocator that stays with its tree.
+      size_type const other_capacity{other.index_cache_capacity()};
+      other.set_index_cache_capacity(0);
+      replace_allocator([&] {
+        using std::swap;
+        swap(tree_.allocator, other.tree_.allocator);
+      });
+      other.set_index_cache_capacity(other_capacity);
     }
+    record_change(ChangeKind::kErase, 0, size());
+    other.record_change(ChangeKind::kErase, 0, other.size());
     tree_.swap(other.tree_);
+    record_change(ChangeKind::kInsert, 0, size());
+    other.record_change(ChangeKind::kInsert, 0, other.size());
   }
 
   /**
@@ -334,10 +668,13 @@ class ManagedTree {
   /**
    *  @brief
    *  Clears the tree and assigns values from `[first, last)` to the tree.
+   *
+   *  If a copy throws, the tree holds some of the values, and a `kReset` is
+   *    recorded in the change feed.
    */
   template<class InputIterator>
   constexpr void assign(InputIterator first, InputIterator last) {
-    TreeImpl::assign(tree_, first, last);
+    record_replacement([&] { TreeImpl::assign(tree_, first, last); });
   }
 
   /**
@@ -359,13 +696,118 @@ class ManagedTree {
         ValueRepeater<size_type>{value, n});
   }
 
+  /**
+   *  @brief
+   *  Copies all elements into an immutable, contiguous `FrozenSequence`.
+   *
+   *  This takes O(n) time and does not modify the tree.
+   *  Large trees are copied by several threads in parallel.
+   *  If a copy throws, the values copied so far are destroyed.
+   */
+  frozen_type freeze() const {
+    return frozen_type::template from_subtree<ExtractValue>(
+        tree_.root, get_allocator());
+  }
+
+  /**
+   *  @brief
+   *  Replaces the content of the tree with the values in `frozen`, arranged
+   *    in a balanced shape.
+   *
+   *  This takes O(n) time.
+   *  If a copy throws, the tree is not modified.
+   */
+  void thaw(frozen_type const& frozen) {
+    size_type const old_size{size()};
+    tree_.build_balanced_from(frozen.begin(), frozen.size());
+    record_change(ChangeKind::kErase, 0, old_size);
+    record_change(ChangeKind::kInsert, 0, size());
+  }
+
+  /**
+   *  @brief
+   *  Replaces the content of the tree with the values in `frozen`, arranged
+   *    in a balanced shape, moving values out of `frozen`.
+   *
+   *  `frozen` will be empty afterwards.
+   */
+  void thaw(frozen_type&& frozen) {
+    using MutablePtr = value_type*;
+    size_type const old_size{size()};
+    tree_.build_balanced_from(
+        std::make_move_iterator(const_cast<MutablePtr>(frozen.data())),
+        frozen.size());
+    record_change(ChangeKind::kErase, 0, old_size);
+    record_change(ChangeKind::kInsert, 0, size());
+    frozen.clear();
+  }
+
+  /**
+   *  @brief
+   *  Returns a tree of type `ManagedTree<TargetImplT>` whose elements are
+   *    `f(x)` for all elements `x` of this tree, in the same order.
+   *
+   *  The new tree has exactly the same shape as this tree, so node sizes are
+   *    copied instead of recomputed, and this takes O(n) time.
+   *  `TargetImplT` must be built on `OrderedBinaryTree`, and its `Data` must
+   *    be constructible from `U`.
+   *
+   *  If the node allocator of the new tree is always equal, e.g.,
+   *    `std::allocator`, large subtrees are mapped by up to
+   *    `std::thread::hardware_concurrency()` threads, so `f` must be safe to
+   *    call concurrently and must not depend on the order of calls.
+   *  Stateful allocators are not assumed to be thread-safe, so trees that use
+   *    them are mapped on this thread.
+   *  If `f` throws, all nodes created so far are destroyed and the exception
+   *    is rethrown.
+   */
+  template<
+      class U,
+      class TargetImplT = RebindTreeImplT<TreeImpl, U>,
+      class F>
+  ManagedTree<TargetImplT> map(F f) const {
+    using Mapped = ManagedTree<TargetImplT>;
+    Mapped mapped{typename Mapped::allocator_type{get_allocator()}};
+    NodePtr const root{tree_.root};
+    if (!root) {
+      return mapped;
+    }
+    auto& target{mapped.tree_};
+    using TargetAllocator =
+        typename std::remove_reference_t<decltype(target)>::Allocator;
+    unsigned budget{0};
+    if constexpr (
+        std::allocator_traits<TargetAllocator>::is_always_equal::value) {
+      if (root->size >= 2 * frozen_type::kParallelGrainSize) {
+        budget = std::thread::hardware_concurrency();
+        budget = budget > 1 ? budget - 1 : 0;
+      }
+    }
+    target.root = map_nodes(target, root, f, budget);
+    target.first = target.root->find_first_node();
+    target.last = target.root->find_last_node();
+    return mapped;
+  }
+
+  /**
+   *  @brief
+   *  Reshapes the tree so that elements accessed often by index are close to
+   *    the root.
+   *
+   *  This is only available if `TreeImpl` records accesses, e.g.,
+   *    `FrequencyBiasedTreeImpl`.
+   *  Elements and iterators are not affected.
+   */
+  void rebuild_by_access_frequency() {
+    TreeImpl::rebuild_by_access_frequency(tree_);
+  }
+
   /**
    *  @brief
    *  Accesses the `index`-th element.
    */
   constexpr reference operator[](size_type index) {
-    return ExtractValue::value_in_data(
-        TreeImpl::find_node_at_index(tree_, index)->data);
+    return ExtractValue::value_in_data(find_node_at_index(index)->data);
   }
 
   /**
@@ -373,8 +815,7 @@ class ManagedTree {
    *  Accesses the `index`-th element.
    */
   constexpr const_reference operator[](size_type index) const {
-    return ExtractValue::value_in_data(
-        TreeImpl::find_node_at_index(tree_, index)->data);
+    return ExtractValue::value_in_data(find_node_at_index(index)->data);
   }
 
   /**
@@ -534,7 +975,7 @@ class ManagedTree {
    *  This is equivalent to `begin() + index`, but may be more efficient.
    */
   constexpr iterator get_iterator_at_index(size_type index) {
-    return make_iterator(TreeImpl::find_node_at_index(tree_, index));
+    return make_iterator(find_node_at_index(index));
   }
 
   /**
@@ -544,7 +985,7 @@ class ManagedTree {
    *  This is equivalent to `cbegin() + index`, but may be more efficient.
    */
   constexpr const_iterator get_iterator_at_index(size_type index) const {
-    return make_iterator<true>(TreeImpl::find_node_at_index(tree_, index));
+    return make_iterator<true>(find_node_at_index(index));
   }
 
   /**
@@ -613,8 +1054,8 @@ class ManagedTree {
   template<bool constant>
   constexpr iterator insert(p_iterator<constant> pos, Value const& value) {
     assert(pos.tree_ == &tree_);
-    return make_iterator(
-        TreeImpl::emplace_node_before(tree_, pos.node_, value));
+    return make_iterator(record_insert(
+        TreeImpl::emplace_node_before(tree_, pos.node_, value), 1));
   }
 
   /**
@@ -625,8 +1066,9 @@ class ManagedTree {
   template<bool constant>
   constexpr iterator insert(p_iterator<constant> pos, Value&& value) {
     assert(pos.tree_ == &tree_);
-    return make_iterator(
-        TreeImpl::emplace_node_before(tree_, pos.node_, std::move(value)));
+    return make_iterator(record_insert(
+        TreeImpl::emplace_node_before(tree_, pos.node_, std::move(value)),
+        1));
   }
 
   /**
@@ -637,9 +1079,10 @@ class ManagedTree {
   template<bool constant, class... Args>
   constexpr iterator emplace(p_iterator<constant> pos, Args&&... args) {
     assert(pos.tree_ == &tree_);
-    return make_iterator(
+    return make_iterator(record_insert(
         TreeImpl::emplace_node_before(
-          tree_, pos.node_, std::forward<Args>(args)...));
+          tree_, pos.node_, std::forward<Args>(args)...),
+        1));
   }
 
   /**
@@ -656,8 +1099,9 @@ class ManagedTree {
       InputIterator first,
       InputIterator last) {
     assert(pos.tree_ == &tree_);
-    return make_iterator(
-        TreeImpl::insert_nodes_before(tree_, pos.node_, first, last));
+    size_type const old_size{size()};
+    NodePtr n{TreeImpl::insert_nodes_before(tree_, pos.node_, first, last)};
+    return make_iterator(record_insert(n, size() - old_size));
   }
 
   /**
@@ -684,13 +1128,15 @@ class ManagedTree {
       return make_iterator(pos.node_);
     }
     NodePtr n{other.tree_.first};
+    size_type const count{other.size()};
+    other.record_change(ChangeKind::kErase, 0, count);
     TreeImpl::join(
         tree_,
         pos.node_ ?
           pos.node_->get_prev_insert_position() :
           tree_.get_last_insert_position(),
         other.tree_);
-    return make_iterator(n);
+    return make_iterator(record_insert(n, count, ChangeKind::kJoin));
   }
 
   /**
@@ -703,7 +1149,10 @@ class ManagedTree {
       return make_iterator(tree_.first);
     }
     NodePtr n{other.tree_.first};
+    size_type const count{other.size()};
+    other.record_change(ChangeKind::kErase, 0, count);
     TreeImpl::join_front(tree_, other.tree_);
+    record_change(ChangeKind::kJoin, 0, count);
     return make_iterator(n);
   }
 
@@ -717,16 +1166,44 @@ class ManagedTree {
       return make_iterator(nullptr);
     }
     NodePtr n{other.tree_.first};
+    size_type const count{other.size()};
+    other.record_change(ChangeKind::kErase, 0, count);
     TreeImpl::join_back(tree_, other.tree_);
+    record_change(ChangeKind::kJoin, size() - count, count);
     return make_iterator(n);
   }
 
+  /**
+   *  @brief
+   *  Similar to `join_back(other)`, but takes O(1) amortized time
+   *    independently of the size of this tree.
+   *
+   *  The first element of `other` becomes the new root, with this tree on its
+   *    left and the rest of `other` on its right, so only the depth of the
+   *    first element of `other` is paid for.
+   *  A few rotations near the root then keep the leftmost path at O(log(n))
+   *    nodes. (See `OrderedBinaryTree::concat_back()`.)
+   *  After any number of such joins, the depth is O(log(n)) plus the depths
+   *    of the joined trees.
+   */
+  iterator join_back_lazy(This& other) {
+    assert(tree_.allocator == other.tree_.allocator);
+    if (other.empty()) {
+      return make_iterator(nullptr);
+    }
+    size_type const count{other.size()};
+    other.record_change(ChangeKind::kErase, 0, count);
+    record_change(ChangeKind::kJoin, size(), count);
+    return make_iterator(tree_.concat_back(other.tree_));
+  }
+
   /**
    *  @brief
    *  Inserts `value` as the first element.
    */
   constexpr void push_front(Value const& value) {
     TreeImpl::emplace_front(tree_, value);
+    record_change(ChangeKind::kInsert, 0, 1);
   }
   
   /**
@@ -735,6 +1212,7 @@ class ManagedTree {
    */
   constexpr void push_front(Value&& value) {
     TreeImpl::emplace_front(tree_, std::move(value));
+    record_change(ChangeKind::kInsert, 0, 1);
   }
 
   /**
@@ -744,6 +1222,7 @@ class ManagedTree {
   template<class... Args>
   constexpr void emplace_front(Args&&... args) {
     TreeImpl::emplace_front(tree_, std::forward<Args>(args)...);
+    record_change(ChangeKind::kInsert, 0, 1);
   }
   
   /**
@@ -752,6 +1231,7 @@ class ManagedTree {
    */
   constexpr void push_back(Value const& value) {
     TreeImpl::emplace_back(tree_, value);
+    record_change(ChangeKind::kInsert, size() - 1, 1);
   }
 
   /**
@@ -760,6 +1240,7 @@ class ManagedTree {
    */
   constexpr void push_back(Value&& value) {
     TreeImpl::emplace_back(tree_, std::move(value));
+    record_change(ChangeKind::kInsert, size() - 1, 1);
   }
 
   /**
@@ -769,6 +1250,7 @@ class ManagedTree {
   template<class... Args>
   constexpr void emplace_back(Args&&... args) {
     TreeImpl::emplace_back(tree_, std::forward<Args>(args)...);
+    record_change(ChangeKind::kInsert, size() - 1, 1);
   }
 
   /**
@@ -780,6 +1262,10 @@ class ManagedTree {
   constexpr iterator erase(p_iterator<constant> pos) {
     assert(pos.tree_ == &tree_);
     assert(pos.node_);
+    invalidate_index_cache();
+    if (change_feed_) {
+      record_change(ChangeKind::kErase, pos.node_->get_index(), 1);
+    }
     return make_iterator(TreeImpl::erase_node(tree_, pos.node_));
   }
   
@@ -798,6 +1284,11 @@ class ManagedTree {
     assert(first.tree_ == &tree_);
     assert(last.tree_ == &tree_);
     assert(first <= last);
+    invalidate_index_cache();
+    if (change_feed_) {
+      size_type const index{first.get_index()};
+      record_change(ChangeKind::kErase, index, last.get_index() - index);
+    }
     return make_iterator(TreeImpl::erase_nodes(
         tree_, first.node_, last.node_));
   }
@@ -808,6 +1299,7 @@ class ManagedTree {
    */
   constexpr void pop_front() {
     assert(!tree_.empty());
+    record_change(ChangeKind::kErase, 0, 1);
     TreeImpl::erase_front(tree_);
   }
 
@@ -817,9 +1309,294 @@ class ManagedTree {
    */
   constexpr void pop_back() {
     assert(!tree_.empty());
+    record_change(ChangeKind::kErase, size() - 1, 1);
     TreeImpl::erase_back(tree_);
   }
 
+  /**
+   *  @brief
+   *  Starts an `EditSession` on this tree.
+   */
+  EditSession edit_session() {
+    return EditSession{*this};
+  }
+
+  /**
+   *  @brief
+   *  Makes this tree record its changes in `feed`, or stops recording if
+   *    `feed` is null.
+   *
+   *  While a feed is attached, each insertion and erasure through an
+   *    iterator also computes the index of the affected element, which adds
+   *    O(log n) time.
+   *  Modifications through references and iterators are not detected; call
+   *    `feed->record_update()` after them.
+   *  The feed must outlive its attachment, and it is not copied or moved
+   *    with the tree.
+   */
+  void set_change_feed(change_feed_type* feed) {
+    change_feed_ = feed;
+  }
+
+  /**
+   *  @brief
+   *  Returns the feed given to `set_change_feed()`, or null.
+   */
+  change_feed_type* change_feed() const {
+    return change_feed_;
+  }
+
+  /**
+   *  @brief
+   *  Makes `operator[]`, `at()` and `get_iterator_at_index()` remember the
+   *    nodes they find in a direct-mapped cache with `capacity` entries,
+   *    rounded up to a power of 2, or removes the cache if `capacity` is 0.
+   *
+   *  Every insertion and erasure bumps an epoch that invalidates all entries,
+   *    so the cache pays off when many lookups happen between edits, and
+   *    more so when a few indices are looked up most of the time.
+   *  A hit returns the node without descending from the root.
+   *  On a miss, an index close to the previous lookup is reached by walking
+   *    from the previous node, and any other index is found as before.
+   *  Hits and walks do not call `TreeImpl::find_node_at_index()`, so they do
+   *    not splay, but they report the node to `TreeImpl::record_access()`,
+   *    so implementations that count accesses still count them.
+   *
+   *  The cache itself is modified by const lookups, so while it is enabled,
+   *    const lookups must not run concurrently.
+   *  The cache is allocated with the tree's allocator, and a tree without
+   *    a cache only holds a null pointer for it.
+   *  The cache belongs to this object and is not copied, moved or swapped
+   *    with the elements.
+   */
+  void set_index_cache_capacity(size_type capacity) {
+    size_type rounded{capacity > 0 ? size_type{1} : size_type{0}};
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    destroy_index_cache();
+    if (rounded > 0) {
+      index_cache_ = create_index_cache(rounded);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of entries in the index cache, or 0 if there is no
+   *    cache.
+   */
+  size_type index_cache_capacity() const {
+    return index_cache_ ? index_cache_->capacity : 0;
+  }
+
+ protected:
+  /// Feed that receives changes to this tree, or null.
+  change_feed_type* change_feed_{nullptr};
+
+  /// Entry of the index cache.
+  struct IndexCacheEntry {
+    /// Index of `node` when the entry was filled.
+    size_type index{0};
+    /// Node at `index`.
+    NodePtr node{nullptr};
+    /// `IndexCache::epoch` when the entry was filled. `0` is never valid.
+    std::uint64_t epoch{0};
+  };
+
+  /// Allocator traits for index cache entries.
+  using IndexCacheEntryTraits = typename std::allocator_traits<Allocator>::
+      template rebind_traits<IndexCacheEntry>;
+
+  /// Type of pointers to index cache entries.
+  using IndexCacheEntryPtr = typename IndexCacheEntryTraits::pointer;
+
+  /**
+   *  @brief
+   *  Index cache. It is allocated only when enabled, so a tree without a
+   *    cache pays for one pointer.
+   */
+  struct IndexCache {
+    /// Direct-mapped entries.
+    IndexCacheEntryPtr entries;
+    /// Number of entries. This is a power of 2.
+    size_type capacity;
+    /// Result of the previous lookup.
+    IndexCacheEntry last;
+    /// Number of changes so far plus one. Entries of older epochs are stale.
+    std::uint64_t epoch;
+  };
+
+  /// Allocator traits for `IndexCache`.
+  using IndexCacheTraits = typename std::allocator_traits<Allocator>::
+      template rebind_traits<IndexCache>;
+
+  /// Type of pointers to `IndexCache`.
+  using IndexCachePtr = typename IndexCacheTraits::pointer;
+
+  /// Largest distance from the previous lookup that is reached by walking.
+  static constexpr size_type kIndexCacheWalkDistance{16};
+
+  /// Index cache allocated by `tree_.allocator`, or null.
+  IndexCachePtr index_cache_{nullptr};
+
+  /// Allocates an index cache with `capacity` entries.
+  IndexCachePtr create_index_cache(size_type capacity) {
+    typename IndexCacheEntryTraits::allocator_type entry_allocator{
+        tree_.allocator};
+    typename IndexCacheTraits::allocator_type cache_allocator{
+        tree_.allocator};
+    IndexCacheEntryPtr entries{
+        IndexCacheEntryTraits::allocate(entry_allocator, capacity)};
+    IndexCachePtr cache;
+    try {
+      cache = IndexCacheTraits::allocate(cache_allocator, 1);
+    } catch (...) {
+      IndexCacheEntryTraits::deallocate(entry_allocator, entries, capacity);
+      throw;
+    }
+    for (size_type i{0}; i < capacity; ++i) {
+      IndexCacheEntryTraits::construct(
+          entry_allocator, std::addressof(entries[i]));
+    }
+    IndexCacheTraits::construct(cache_allocator, std::addressof(*cache),
+        IndexCache{entries, capacity, IndexCacheEntry{}, 1});
+    return cache;
+  }
+
+  /// Frees `index_cache_` if there is one.
+  void destroy_index_cache() {
+    if (!index_cache_) {
+      return;
+    }
+    typename IndexCacheEntryTraits::allocator_type entry_allocator{
+        tree_.allocator};
+    typename IndexCacheTraits::allocator_type cache_allocator{
+        tree_.allocator};
+    IndexCacheEntryPtr const entries{index_cache_->entries};
+    size_type const capacity{index_cache_->capacity};
+    for (size_type i{0}; i < capacity; ++i) {
+      IndexCacheEntryTraits::destroy(
+          entry_allocator, std::addressof(entries[i]));
+    }
+    IndexCacheEntryTraits::deallocate(entry_allocator, entries, capacity);
+    IndexCacheTraits::destroy(cache_allocator, std::addressof(*index_cache_));
+    IndexCacheTraits::deallocate(cache_allocator, index_cache_, 1);
+    index_cache_ = nullptr;
+  }
+
+  /**
+   *  @brief
+   *  Calls `f()`, which replaces the allocator, and moves the index cache to
+   *    the new allocator.
+   */
+  template<class F>
+  void replace_allocator(F f) {
+    size_type const capacity{index_cache_capacity()};
+    destroy_index_cache();
+    f();
+    set_index_cache_capacity(capacity);
+  }
+
+  /// Makes all entries of the index cache stale.
+  void invalidate_index_cache() {
+    if (index_cache_ && ++index_cache_->epoch == 0) {
+      // Entries may not tell a wrapped epoch from an old one.
+      for (size_type i{0}; i < index_cache_->capacity; ++i) {
+        index_cache_->entries[i] = IndexCacheEntry{};
+      }
+      index_cache_->last = IndexCacheEntry{};
+      index_cache_->epoch = 1;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Finds the node at `index`, through the index cache if there is one.
+   */
+  NodePtr find_node_at_index(size_type index) const {
+    if (!index_cache_ || index >= size()) {
+      return TreeImpl::find_node_at_index(tree_, index);
+    }
+    IndexCache& cache{*index_cache_};
+    IndexCacheEntry& entry{cache.entries[index & (cache.capacity - 1)]};
+    if (entry.epoch != cache.epoch || entry.index != index) {
+      IndexCacheEntry const& last{cache.last};
+      NodePtr n;
+      if (last.epoch == cache.epoch &&
+          index <= last.index + kIndexCacheWalkDistance &&
+          last.index <= index + kIndexCacheWalkDistance) {
+        n = index >= last.index ?
+            last.node->find_next_node(index - last.index) :
+            last.node->find_prev_node(last.index - index);
+        TreeImpl::record_access(tree_, n);
+      } else {
+        n = TreeImpl::find_node_at_index(tree_, index);
+      }
+      entry = IndexCacheEntry{index, n, cache.epoch};
+    } else {
+      TreeImpl::record_access(tree_, entry.node);
+    }
+    cache.last = entry;
+    return entry.node;
+  }
+
+  /// Calls `replace()`, which replaces all elements, and records the change.
+  /// If `replace()` throws, the tree may hold any elements, so a `kReset` is
+  /// recorded.
+  template<class F>
+  void record_replacement(F replace) {
+    record_change(ChangeKind::kErase, 0, size());
+    try {
+      replace();
+    } catch (...) {
+      record_change(ChangeKind::kReset, 0, 0);
+      throw;
+    }
+    record_change(ChangeKind::kInsert, 0, size());
+  }
+
+  /// Records a change in `change_feed_` if there is one.
+  void record_change(ChangeKind kind, size_type index, size_type count) {
+    invalidate_index_cache();
+    if (change_feed_) {
+      change_feed_->record(kind, index, count);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Records that `count` elements were inserted, the first of which is at
+   *    `n`, then returns `n`.
+   */
+  NodePtr record_insert(
+      NodePtr n,
+      size_type count,
+      ChangeKind kind = ChangeKind::kInsert) {
+    invalidate_index_cache();
+    if (change_feed_ && count > 0) {
+      change_feed_->record(kind, n->get_index(), count);
+    }
+    return n;
+  }
+
+};
+
+/**
+ *  @brief
+ *  Specialization of `ManagedTree` for implementations that are not built on
+ *    `OrderedBinaryTree`.
+ *
+ *  If `TreeImplT` has a member type `Container`, that type must provide the
+ *    same public interface as `ManagedTree` by itself, and
+ *    `ManagedTree<TreeImplT>` simply inherits it.
+ *  This allows switching between, say, `SplayTreeImpl` and
+ *    `TieredVectorImpl` with a type alias.
+ */
+template<class TreeImplT>
+class ManagedTree<TreeImplT, std::void_t<typename TreeImplT::Container>>
+  : public TreeImplT::Container {
+ public:
+  using TreeImplT::Container::Container;
 };
 
 } // namespace ordered_binary_trees
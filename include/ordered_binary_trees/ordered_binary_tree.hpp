@@ -8,8 +8,39 @@
 #include <type_traits>
 #include <utility>
 
+/**
+ *  @brief
+ *  `[[no_unique_address]]` if the compiler supports it.
+ *
+ *  This lets a stateless allocator member take no space.
+ */
+#ifndef OBT_NO_UNIQUE_ADDRESS
+#if defined(__has_cpp_attribute) && __has_cpp_attribute(no_unique_address)
+#define OBT_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#else
+#define OBT_NO_UNIQUE_ADDRESS
+#endif
+#endif
+
 namespace ordered_binary_trees {
 
+/**
+ *  @brief
+ *  `std::true_type` if `DataT` has a static function `extra_bytes()` that
+ *    takes `DataT const&`.
+ *
+ *  Such a `DataT` stores a payload of `extra_bytes(args...)` bytes right
+ *    after the node, in the same allocation, when it is constructed from
+ *    `args...`. (See `InlineStringData`.)
+ */
+template<class DataT, class = void>
+struct HasExtraBytes : std::false_type {};
+
+template<class DataT>
+struct HasExtraBytes<DataT, std::void_t<
+    decltype(DataT::extra_bytes(std::declval<DataT const&>()))>>
+  : std::true_type {};
+
 /**
  *  @brief
  *  Convenience struct for allocating nodes, deallocating nodes, and managing
@@ -59,8 +90,10 @@ struct OrderedBinaryTree {
   /**
    *  @brief
    *  Allocator for nodes.
+   *
+   *  A stateless allocator takes no space.
    */
-  mutable Allocator allocator;
+  OBT_NO_UNIQUE_ADDRESS mutable Allocator allocator;
 
   /**
    *  @brief
@@ -323,6 +356,244 @@ struct OrderedBinaryTree {
     last = root->find_last_node();
   }
 
+  /**
+   *  @brief
+   *  Creates a balanced subtree whose nodes are constructed from
+   *    `values[0], ..., values[count - 1]` in order, and returns its root.
+   *
+   *  Each node is constructed with `values[i]` as the only argument, so
+   *    passing a `std::move_iterator` moves the values.
+   *  This takes O(count) time, and the recursion depth is O(log(count)).
+   *  If `count` is `0`, the return value is null.
+   *  If a construction throws, the nodes created so far are destroyed.
+   */
+  template<class RandomAccessIterator>
+  NodePtr create_balanced_nodes(
+      RandomAccessIterator values,
+      size_type count) const {
+    if (count == 0) {
+      return nullptr;
+    }
+    size_type const mid{count / 2};
+    NodePtr n{create_node(values[mid])};
+    n->size = count;
+    try {
+      NodePtr l{create_balanced_nodes(values, mid)};
+      if (l) {
+        n->left_child = l;
+        l->parent = n;
+      }
+      NodePtr r{create_balanced_nodes(values + (mid + 1), count - mid - 1)};
+      if (r) {
+        n->right_child = r;
+        r->parent = n;
+      }
+    } catch (...) {
+      destroy_subtree(n);
+      throw;
+    }
+    return n;
+  }
+
+  /**
+   *  @brief
+   *  Replaces the tree with a balanced tree made from `count` values starting
+   *    at `values`.
+   *
+   *  If `destroy_nodes` is `true`, `destroy_all_nodes()` will be called after
+   *    the build.
+   *  Otherwise, the current tree will be abandoned without a cleanup.
+   *  If a construction throws, the tree is not modified.
+   */
+  template<bool destroy_nodes = true, class RandomAccessIterator>
+  void build_balanced_from(
+      RandomAccessIterator values,
+      size_type count) {
+    NodePtr const new_root{create_balanced_nodes(values, count)};
+    if constexpr (destroy_nodes) {
+      destroy_all_nodes();
+    }
+    root = new_root;
+    first = root ? root->find_first_node() : nullptr;
+    last = root ? root->find_last_node() : nullptr;
+  }
+
+  /**
+   *  @brief
+   *  Input iterator over `data` of the nodes from `node` onwards, in order.
+   */
+  struct ConstDataIterator {
+    /// Current node, or null past the end.
+    ConstNodePtr node;
+
+    /// Returns `node->data`.
+    constexpr Data const& operator*() const {
+      return node->data;
+    }
+
+    /// Moves to the next node.
+    constexpr ConstDataIterator& operator++() {
+      node = node->find_next_node();
+      return *this;
+    }
+
+    /// Returns `true` iff the two iterators point to the same node.
+    constexpr bool operator==(ConstDataIterator const& other) const {
+      return node == other.node;
+    }
+
+    /// Returns `true` iff the two iterators point to different nodes.
+    constexpr bool operator!=(ConstDataIterator const& other) const {
+      return node != other.node;
+    }
+  };
+
+  /**
+   *  @brief
+   *  Relinks all nodes into a list in order, chained through `right_child`,
+   *    and returns the first node.
+   *
+   *  This is the first phase of the Day-Stout-Warren algorithm: every
+   *    rotation moves one node onto the list, so it takes O(n) time.
+   *  `left_child`, `parent` and `size` are left stale.
+   *  `root`, `first` and `last` are not changed.
+   */
+  constexpr NodePtr flatten_to_list() {
+    NodePtr head{nullptr};
+    NodePtr tail{nullptr};
+    NodePtr rest{root};
+    while (rest) {
+      if (NodePtr l{rest->left_child}) {
+        rest->left_child = l->right_child;
+        l->right_child = rest;
+        rest = l;
+      } else {
+        (tail ? tail->right_child : head) = rest;
+        tail = rest;
+        rest = rest->right_child;
+      }
+    }
+    return head;
+  }
+
+  /**
+   *  @brief
+   *  Links the first `count` nodes of a list chained through `right_child`
+   *    into a balanced subtree, advances `head` past them, and returns the
+   *    root of the subtree.
+   *
+   *  The recursion depth is O(log(count)).
+   */
+  static constexpr NodePtr link_balanced_from_list(
+      NodePtr& head,
+      size_type count) {
+    if (count == 0) {
+      return nullptr;
+    }
+    size_type const left_count{count / 2};
+    NodePtr l{link_balanced_from_list(head, left_count)};
+    NodePtr n{head};
+    head = head->right_child;
+    n->left_child = l;
+    if (l) {
+      l->parent = n;
+    }
+    NodePtr r{link_balanced_from_list(head, count - left_count - 1)};
+    n->right_child = r;
+    if (r) {
+      r->parent = n;
+    }
+    n->size = count;
+    return n;
+  }
+
+  /**
+   *  @brief
+   *  Replaces all values in the tree with values from
+   *    `[input_i, input_end)`, reusing existing nodes, and makes the tree
+   *    balanced.
+   *
+   *  Existing nodes receive the new values in order by assignment to `data`.
+   *  Only the nodes beyond the new size are destroyed, and only the values
+   *    beyond the old size get new nodes.
+   *  If `Data` cannot be assigned from a value, or `Data` stores a payload
+   *    after the node (see `HasExtraBytes`), all nodes are replaced.
+   *  This takes O(n) time for the old and new sizes combined.
+   *
+   *  If an assignment or a construction throws, the tree is left balanced
+   *    with some of the values replaced.
+   */
+  template<class InputIterator>
+  void assign_reusing_nodes(
+      InputIterator input_i,
+      InputIterator input_end) {
+    NodePtr head{flatten_to_list()};
+    NodePtr* link{&head};
+    try {
+      if constexpr (
+          std::is_assignable_v<Data&, decltype(*input_i)> &&
+          !HasExtraBytes<Data>::value) {
+        for (; *link && input_i != input_end; ++input_i) {
+          (*link)->data = *input_i;
+          link = &(*link)->right_child;
+        }
+      }
+      NodePtr rest{*link};
+      *link = nullptr;
+      while (rest) {
+        NodePtr next{rest->right_child};
+        destroy_node(rest);
+        rest = next;
+      }
+      for (; input_i != input_end; ++input_i) {
+        *link = create_node(*input_i);
+        link = &(*link)->right_child;
+      }
+    } catch (...) {
+      build_balanced_from_list(head);
+      throw;
+    }
+    build_balanced_from_list(head);
+  }
+
+  /**
+   *  @brief
+   *  Replaces all values in the tree with copies of the values in the
+   *    subtree rooted at `n`, reusing existing nodes as in
+   *    `assign_reusing_nodes()`.
+   *
+   *  Unlike `clone_from()`, the result is balanced rather than a copy of the
+   *    shape of the source.
+   */
+  void copy_reusing_nodes(ConstNodePtr n) {
+    if (!n) {
+      destroy_all_nodes();
+      return;
+    }
+    assign_reusing_nodes(
+        ConstDataIterator{Node::template find_first_node<true>(n)},
+        ConstDataIterator{Node::template find_next_node<true>(
+            Node::template find_last_node<true>(n))});
+  }
+
+  /**
+   *  @brief
+   *  Makes a balanced tree from a list chained through `right_child` whose
+   *    first node is `head`, and updates `root`, `first` and `last`.
+   */
+  constexpr void build_balanced_from_list(NodePtr head) {
+    size_type count{0};
+    for (NodePtr n{head}; n; n = n->right_child) {
+      ++count;
+    }
+    root = link_balanced_from_list(head, count);
+    if (root) {
+      root->parent = nullptr;
+    }
+    first = root ? root->find_first_node() : nullptr;
+    last = root ? root->find_last_node() : nullptr;
+  }
+
   /**
    *  @brief
    *  Returns the `index`-th node, relative to `root`.
@@ -381,15 +652,41 @@ struct OrderedBinaryTree {
     return root ? Node::template find_last_node<true>(root) : nullptr;
   }
 
+  /**
+   *  @brief
+   *  Returns the number of `Node`-sized slots to allocate for a node whose
+   *    `data` is constructed from `args`.
+   *
+   *  This is `1` unless `HasExtraBytes<Data>`, in which case the extra slots
+   *    hold the payload.
+   */
+  template<class... Args>
+  static constexpr size_type node_slots([[maybe_unused]] Args const&... args) {
+    if constexpr (HasExtraBytes<Data>::value) {
+      return 1 + static_cast<size_type>(
+          (Data::extra_bytes(args...) + sizeof(Node) - 1) / sizeof(Node));
+    } else {
+      return 1;
+    }
+  }
+
   /**
    *  @brief
    *  Creates a node using `allocator`.
+   *
+   *  If the construction throws, the memory is deallocated.
    */
   template<class... Args>
-  constexpr NodePtr create_node(Args&&... args) const {
-    NodePtr n{std::allocator_traits<Allocator>::allocate(allocator, 1)};
-    std::allocator_traits<Allocator>::construct(allocator,
-        n, std::forward<Args>(args)...);
+  NodePtr create_node(Args&&... args) const {
+    size_type const slots{node_slots(args...)};
+    NodePtr n{std::allocator_traits<Allocator>::allocate(allocator, slots)};
+    try {
+      std::allocator_traits<Allocator>::construct(allocator,
+          std::addressof(*n), std::forward<Args>(args)...);
+    } catch (...) {
+      std::allocator_traits<Allocator>::deallocate(allocator, n, slots);
+      throw;
+    }
     return n;
   }
 
@@ -397,10 +694,24 @@ struct OrderedBinaryTree {
    *  @brief
    *  Destroys a node using `allocator`.
    */
-  constexpr void destroy_node(NodePtr n) {
+  constexpr void destroy_node(NodePtr n) const {
     assert(n);
-    std::allocator_traits<Allocator>::destroy(allocator, n);
-    std::allocator_traits<Allocator>::deallocate(allocator, n, 1);
+    size_type const slots{node_slots(n->data)};
+    std::allocator_traits<Allocator>::destroy(allocator, std::addressof(*n));
+    std::allocator_traits<Allocator>::deallocate(allocator, n, slots);
+  }
+
+  /**
+   *  @brief
+   *  Calls `destroy_node()` for every node in the subtree rooted at `n`,
+   *    which must not be part of this tree.
+   */
+  constexpr void destroy_subtree(NodePtr n) const {
+    Node::template traverse_postorder<false>(
+        n,
+        [this](NodePtr m) {
+          destroy_node(m);
+        });
   }
 
   /**
@@ -589,6 +900,57 @@ struct OrderedBinaryTree {
     other.clear();
   }
 
+  /**
+   *  @brief
+   *  Appends all nodes of `other` to this tree by making the first node of
+   *    `other` the new root, with the old root as its left child and the rest
+   *    of `other` as its right child, then returns that node.
+   *
+   *  To keep the leftmost path short, the root is then rotated to the right
+   *    while its right subtree is not much smaller than the right subtree of
+   *    its left child.
+   *  Afterwards, the sizes of the right subtrees along the leftmost path more
+   *    than double at every step down, so the path has O(log(n)) nodes.
+   *  Like carries in a binary counter, the rotations take O(1) amortized
+   *    time, so this takes O(1) amortized time plus the depth of
+   *    `other.first`, independently of the size of this tree.
+   *
+   *  The ownership of all the nodes in `other` is transferred to this tree.
+   */
+  constexpr NodePtr concat_back(This& other) {
+    assert(!other.empty());
+    NodePtr joint{other.first};
+    other.template erase<true, false>(joint);
+    joint->parent = nullptr;
+    joint->left_child = root;
+    joint->right_child = other.root;
+    joint->size = size() + other.size() + 1;
+    if (root) {
+      root->parent = joint;
+    } else {
+      first = joint;
+    }
+    if (other.root) {
+      other.root->parent = joint;
+      last = other.last;
+    } else {
+      last = joint;
+    }
+    root = joint;
+    other.clear();
+
+    while (root->left_child &&
+        Node::get_size(root->left_child->right_child) <=
+          2 * Node::get_size(root->right_child) + 1) {
+      NodePtr const top{root};
+      root = top->left_child;
+      top->rotate_right();
+      top->update_size();
+      root->update_size();
+    }
+    return joint;
+  }
+
   /**
    *  @brief
    *  Allocates a new node and adds it to the tree at the given
@@ -62,24 +62,30 @@ class OrderedBinaryTreeIterator {
   /// `Tree::Node`.
   using Node = typename Tree::Node;
 
+  /// `Tree::NodePtr`. This may be a fancy pointer.
+  using NodePtr = typename Tree::NodePtr;
+
   /// `Node::Data`.
   using Data = typename Node::Data;
 
   /// `ExtractValueT`.
   using ExtractValue = ExtractValueT;
 
+  /// `ExtractValue::Value`, which may differ from `Data`.
+  using Value = typename ExtractValue::Value;
+
   Tree* tree_{nullptr};
-  Node* node_{nullptr};
+  NodePtr node_{nullptr};
 
   friend class
       OrderedBinaryTreeIterator<Tree, !constant, reverse, ExtractValue>;
   friend class
       OrderedBinaryTreeIterator<Tree, constant, !reverse, ExtractValue>;
   
-  template<class TreeImplT>
+  template<class TreeImplT, class Enable>
   friend class ManagedTree;
   
-  constexpr Node* begin_node() const {
+  constexpr NodePtr begin_node() const {
     assert(tree_);
     if constexpr (reverse) {
       return tree_->last;
@@ -88,7 +94,7 @@ class OrderedBinaryTreeIterator {
     }
   }
 
-  constexpr Node* before_end_node() const {
+  constexpr NodePtr before_end_node() const {
     assert(tree_);
     if constexpr (reverse) {
       return tree_->first;
@@ -97,7 +103,7 @@ class OrderedBinaryTreeIterator {
     }
   }
 
-  static constexpr Node* next_node(Node* n) {
+  static constexpr NodePtr next_node(NodePtr n) {
     if constexpr (reverse) {
       return n->find_prev_node();
     } else {
@@ -106,7 +112,7 @@ class OrderedBinaryTreeIterator {
   }
 
   template<class Integer>
-  static constexpr Node* next_node(Node* n, Integer steps) {
+  static constexpr NodePtr next_node(NodePtr n, Integer steps) {
     if constexpr (reverse) {
       return n->find_prev_node(steps);
     } else {
@@ -114,7 +120,7 @@ class OrderedBinaryTreeIterator {
     }
   }
 
-  static constexpr Node* prev_node(Node* n) {
+  static constexpr NodePtr prev_node(NodePtr n) {
     if constexpr (reverse) {
       return n->find_next_node();
     } else {
@@ -123,7 +129,7 @@ class OrderedBinaryTreeIterator {
   }
 
   template<class Integer>
-  static constexpr Node* prev_node(Node* n, Integer steps) {
+  static constexpr NodePtr prev_node(NodePtr n, Integer steps) {
     if constexpr (reverse) {
       return n->find_next_node(steps);
     } else {
@@ -135,15 +141,17 @@ class OrderedBinaryTreeIterator {
 
   using size_type = typename Tree::size_type;
   using difference_type = std::make_signed_t<size_type>;
-  using value_type = std::conditional_t<constant, Data const, Data>;
+  using value_type = std::conditional_t<constant, Value const, Value>;
   using pointer = std::add_pointer_t<value_type>;
   using reference = std::add_lvalue_reference_t<value_type>;
   using iterator_category = std::random_access_iterator_tag;
 
-  constexpr OrderedBinaryTreeIterator(Tree* tree_ = nullptr, Node* node_ = nullptr)
+  constexpr OrderedBinaryTreeIterator(
+      Tree* tree_ = nullptr,
+      NodePtr node_ = nullptr)
     : tree_{tree_}, node_{node_} {}
   
-  constexpr void reset(Tree* new_tree = nullptr, Node* new_node = nullptr) {
+  constexpr void reset(Tree* new_tree = nullptr, NodePtr new_node = nullptr) {
     tree_ = new_tree;
     node_ = new_node;
   }
@@ -188,13 +196,13 @@ class OrderedBinaryTreeIterator {
     return node_ != other.node_;
   }
 
-  constexpr std::conditional_t<constant, Data const&, Data&> operator*()
+  constexpr std::conditional_t<constant, Value const&, Value&> operator*()
       const {
     assert(node_);
     return ExtractValue::value_in_data(node_->data);
   }
 
-  constexpr std::conditional_t<constant, Data const*, Data*> operator->()
+  constexpr std::conditional_t<constant, Value const*, Value*> operator->()
       const {
     assert(node_);
     return &(operator*());
@@ -283,7 +291,7 @@ class OrderedBinaryTreeIterator {
 
   template<class Integer,
       std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
-  constexpr std::conditional_t<constant, Data const&, Data&> operator[](
+  constexpr std::conditional_t<constant, Value const&, Value&> operator[](
       Integer steps) const {
     return *(operator+(steps));
   }
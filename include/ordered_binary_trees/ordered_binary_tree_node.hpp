@@ -162,6 +162,36 @@ struct OrderedBinaryTreeNode {
     return parent->left_child == this ? kLeftChild : kRightChild;
   }
 
+  /**
+   *  @brief
+   *  Returns `right_child` if `right` is `true`, or `left_child` otherwise.
+   *
+   *  Code that is symmetric in the two directions can compute `right` from a
+   *    comparison and use this instead of branching on it.
+   */
+  constexpr ThisPtr& child(bool right) {
+    return right ? right_child : left_child;
+  }
+
+  /**
+   *  @brief
+   *  Returns `right_child` if `right` is `true`, or `left_child` otherwise.
+   */
+  constexpr ThisPtr const& child(bool right) const {
+    return right ? right_child : left_child;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff `this` is the right child of `parent`.
+   *
+   *  `parent` must not be null.
+   */
+  constexpr bool is_right_child() const {
+    assert(parent);
+    return parent->right_child == this;
+  }
+
   /**
    *  @brief
    *  Returns `true` iff `this` is a leaf node.
@@ -410,9 +440,7 @@ struct OrderedBinaryTreeNode {
       if (!p) {
         return index;
       }
-      if (p->right_child == n) {
-        index += get_size(p->left_child) + 1;
-      }
+      index += p->right_child == n ? get_size(p->left_child) + 1 : 0;
       n = p;
     }
   }
@@ -431,20 +459,16 @@ struct OrderedBinaryTreeNode {
     if (n->size <= index) {
       return nullptr;
     }
+    // The direction is computed from a comparison, so the only branch in
+    //   the loop is the exit.
     while (true) {
-      auto l{n->left_child};
-      if (l) {
-        if (index < l->size) {
-          n = l;
-          continue;
-        }
-        index -= l->size;
-      }
-      if (index == 0) {
+      size_type const left_size{get_size(n->left_child)};
+      if (index == left_size) {
         return n;
       }
-      --index;
-      n = n->right_child;
+      bool const right{index > left_size};
+      index -= right ? left_size + 1 : 0;
+      n = n->child(right);
       assert(n);
     }
   }
@@ -945,10 +969,12 @@ struct OrderedBinaryTreeNode {
 
   /**
    *  @brief
-   *  Rotates the subtree rooted at `this` to the left.
+   *  Rotates the subtree rooted at `this` to the left if `left` is `true`, or
+   *    to the right otherwise.
    *
-   *  `right_child` must not be null before the call.
-   *  After the call, `parent` (formerly `right_child`) will be the new root
+   *  The child that moves up, `child(left)`, must not be null before the
+   *    call.
+   *  After the call, `parent` (formerly `child(left)`) will be the new root
    *    of the subtree.
    *
    *  This function does not update sizes of rotated nodes.
@@ -956,27 +982,40 @@ struct OrderedBinaryTreeNode {
    *    `parent->update_size()` afterwards.
    *  (`parent` is guaranteed to be non-null.)
    */
-  constexpr void rotate_left() {
-    assert(right_child);
+  constexpr void rotate(bool left) {
     ThisPtr p{parent};
-    ChildType child_type{get_child_type()};
+    ThisPtr c{child(left)};
+    assert(c);
+    ThisPtr inner{c->child(!left)};
 
-    ThisPtr r{right_child};
-    ThisPtr rl{r->left_child};
-
-    right_child = rl;
-    if (rl) {
-      rl->parent = this;
+    child(left) = inner;
+    if (inner) {
+      inner->parent = this;
     }
-    r->left_child = this;
-    parent = r;
+    c->child(!left) = this;
+    parent = c;
 
-    if (child_type == kLeftChild) {
-      p->left_child = r;
-    } else if (child_type == kRightChild) {
-      p->right_child = r;
+    if (p) {
+      p->child(p->right_child == this) = c;
     }
-    r->parent = p;
+    c->parent = p;
+  }
+
+  /**
+   *  @brief
+   *  Rotates the subtree rooted at `this` to the left.
+   *
+   *  `right_child` must not be null before the call.
+   *  After the call, `parent` (formerly `right_child`) will be the new root
+   *    of the subtree.
+   *
+   *  This function does not update sizes of rotated nodes.
+   *  The caller can manually call `update_size()` and
+   *    `parent->update_size()` afterwards.
+   *  (`parent` is guaranteed to be non-null.)
+   */
+  constexpr void rotate_left() {
+    rotate(true);
   }
 
   /**
@@ -993,26 +1032,7 @@ struct OrderedBinaryTreeNode {
    *  (`parent` is guaranteed to be non-null.)
    */
   constexpr void rotate_right() {
-    assert(left_child);
-    ThisPtr p{parent};
-    ChildType child_type{get_child_type()};
-
-    ThisPtr r{left_child};
-    ThisPtr rl{r->right_child};
-
-    left_child = rl;
-    if (rl) {
-      rl->parent = this;
-    }
-    r->right_child = this;
-    parent = r;
-
-    if (child_type == kRightChild) {
-      p->right_child = r;
-    } else if (child_type == kLeftChild) {
-      p->left_child = r;
-    }
-    r->parent = p;
+    rotate(false);
   }
 
   /**
@@ -1031,12 +1051,7 @@ struct OrderedBinaryTreeNode {
   constexpr ThisPtr splay_1() {
     assert(parent);
     ThisPtr p{parent};
-    ChildType child_type{get_child_type()};
-    if (child_type == kLeftChild) {
-      parent->rotate_right();
-    } else {
-      parent->rotate_left();
-    }
+    p->rotate(is_right_child());
     return p;
   }
 
@@ -1063,80 +1078,46 @@ struct OrderedBinaryTreeNode {
     ThisPtr p{parent};
     ThisPtr pp{p->parent};
     ThisPtr ppp{pp->parent};
-    ChildType child_type{get_child_type()};
-    ChildType p_child_type{p->get_child_type()};
-    ChildType pp_child_type{pp->get_child_type()};
-    if (p_child_type == kLeftChild) {
-      if (child_type == kLeftChild) {
-        // left-left zig-zig
-        ThisPtr s{p->right_child}; // s = sibling
-        pp->left_child = s;
-        if (s) {
-          s->parent = pp;
-        }
-        p->right_child = pp;
-        pp->parent = p;
-        p->left_child = right_child;
-        if (right_child) {
-          right_child->parent = p;
-        }
-        right_child = p;
-        p->parent = this;
-      } else {
-        // left-right zig-zag
-        ThisPtr left{left_child};
-        ThisPtr right{right_child};
-        p->right_child = left;
-        if (left) {
-          left->parent = p;
-        }
-        left_child = p;
-        p->parent = this;
-        pp->left_child = right;
-        if (right) {
-          right->parent = pp;
-        }
-        right_child = pp;
-        pp->parent = this;
-      }
-    } else if (child_type == kLeftChild) {
-      // right-left zig-zag
-      ThisPtr left{left_child};
-      ThisPtr right{right_child};
-      p->left_child = right;
-      if (right) {
-        right->parent = p;
-      }
-      right_child = p;
-      p->parent = this;
-      pp->right_child = left;
-      if (left) {
-        left->parent = pp;
-      }
-      left_child = pp;
-      pp->parent = this;
-    } else {
-      // right-right zig-zig
-      ThisPtr s{p->left_child};
-      pp->right_child = s;
+    // `d` is the side of `this` under `p`, and `pd` is the side of `p` under
+    //   `pp`. The four cases reduce to two by symmetry.
+    bool const d{is_right_child()};
+    bool const pd{p->is_right_child()};
+    ThisPtr const outer{child(!d)};
+    if (d == pd) {
+      // zig-zig
+      ThisPtr s{p->child(!d)}; // s = sibling
+      pp->child(d) = s;
       if (s) {
         s->parent = pp;
       }
-      p->left_child = pp;
+      p->child(!d) = pp;
       pp->parent = p;
-      p->right_child = left_child;
-      if (left_child) {
-        left_child->parent = p;
+      p->child(d) = outer;
+      if (outer) {
+        outer->parent = p;
       }
-      left_child = p;
+      child(!d) = p;
       p->parent = this;
+    } else {
+      // zig-zag
+      ThisPtr const inner{child(d)};
+      p->child(d) = outer;
+      if (outer) {
+        outer->parent = p;
+      }
+      child(!d) = p;
+      p->parent = this;
+      pp->child(pd) = inner;
+      if (inner) {
+        inner->parent = pp;
+      }
+      child(d) = pp;
+      pp->parent = this;
     }
 
     parent = ppp;
-    if (pp_child_type == kLeftChild) {
-      ppp->left_child = this;
-    } else if (pp_child_type == kRightChild) {
-      ppp->right_child = this;
+    if (ppp) {
+      ppp->child(ppp->right_child == pp) = this;
     }
 
     return {pp, p};
@@ -0,0 +1,1292 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/tiered_vector_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Sequence that keeps recently modified regions in small *hot* leaves and
+ *    packs regions that have not been modified for a while into large
+ *    contiguous *packed* leaves.
+ *
+ *  Elements are stored in leaves, which are arrays of values, under a tree
+ *    of internal nodes that record the number of elements under each child.
+ *  A hot leaf holds at most `kHotCapacity` values, so an edit in a hot region
+ *    moves only a few values besides the O(log n) descent.
+ *  A packed leaf holds up to `kPackedCapacity` values in an array of exactly
+ *    that many elements, so a cold region costs about as much memory as a
+ *    `std::vector`, and iteration runs through it without touching any node.
+ *
+ *  Every leaf remembers when it was last modified, measured in number of
+ *    modifications of the whole sequence.
+ *  `pack_cold()` merges runs of adjacent leaves that are older than
+ *    `cold_age()` into packed leaves and rebuilds the internal nodes above
+ *    them.
+ *  It runs automatically once every `max(cold_age(), size())` modifications,
+ *    so its cost is amortized O(1) per modification.
+ *  When an insertion or an erasure lands inside a packed leaf, the leaf is
+ *    split around the position: the values near it become a hot leaf and the
+ *    rest stay packed.
+ *  Assigning through references does not count as a modification and never
+ *    splits a packed leaf.
+ *
+ *  Like `TieredVector`, this class uses `TieredVectorIterator`, whose
+ *    iterators refer to positions rather than elements.
+ *
+ *  The public interface mirrors that of `ManagedTree`, so this class can be
+ *    used through `ManagedTree<PackedTreeImpl<...>>`.
+ */
+template<
+    class ValueT,
+    class AllocatorT = std::allocator<ValueT>,
+    std::size_t kHotCapacity = 8,
+    std::size_t kPackedCapacity =
+        std::max<std::size_t>(64, 32768 / sizeof(ValueT)),
+    std::size_t kFanout = 16>
+class PackedTree {
+  static_assert(kHotCapacity >= 2, "PackedTree -- hot leaves are too small");
+  static_assert(kPackedCapacity >= kHotCapacity,
+      "PackedTree -- packed leaves must not be smaller than hot leaves");
+  static_assert(kFanout >= 4, "PackedTree -- fanout is too small");
+
+ private:
+  /// This type.
+  using This = PackedTree<
+      ValueT, AllocatorT, kHotCapacity, kPackedCapacity, kFanout>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<value_type>;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// `difference_type` derived from `allocator_type`.
+  using difference_type = typename std::allocator_traits<allocator_type>::
+      difference_type;
+
+  /// `value_type&`.
+  using reference = value_type&;
+
+  /// `value_type const&`.
+  using const_reference = value_type const&;
+
+  /// `pointer` type dervied from `allocator_type`.
+  using pointer = typename std::allocator_traits<allocator_type>::pointer;
+
+  /// `const_pointer` type dervied from `allocator_type`.
+  using const_pointer = typename std::allocator_traits<allocator_type>::
+      const_pointer;
+
+ protected:
+  /// Parametrized iterator type.
+  template<bool constant = false, bool reverse = false>
+  using p_iterator = TieredVectorIterator<This, constant, reverse>;
+
+  template<class SequenceT, bool constant, bool reverse>
+  friend class TieredVectorIterator;
+
+ public:
+  /// Type of iterators.
+  using iterator = p_iterator<false, false>;
+  /// Type of const-iterators.
+  using const_iterator = p_iterator<true, false>;
+  /// Type of reverse-iterators.
+  using reverse_iterator = p_iterator<false, true>;
+  /// Type of const-reverse-iterators.
+  using const_reverse_iterator = p_iterator<true, true>;
+
+  /// Default number of modifications after which an untouched leaf is cold.
+  static constexpr size_type kDefaultColdAge{size_type{1} << 16};
+
+ protected:
+  /// Allocator for values of type `T`.
+  template<class T>
+  using RebindAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<T>;
+
+  struct Node;
+
+  /**
+   *  @brief
+   *  Child of an internal node.
+   */
+  struct Child {
+    /// Child node.
+    Node* node;
+    /// Number of values under `node`.
+    size_type count;
+  };
+
+  /// Type of lists of children.
+  using Children = std::vector<Child, RebindAllocator<Child>>;
+
+  /// Type of arrays of values.
+  using Values = std::vector<value_type, allocator_type>;
+
+  /**
+   *  @brief
+   *  Leaf or internal node.
+   *
+   *  A leaf only uses `values`, `last_modified` and `packed`; an internal
+   *    node only uses `children`.
+   *  All leaves are at the same depth.
+   */
+  struct Node {
+    Node(bool leaf, allocator_type const& allocator)
+      : values(allocator),
+        children(RebindAllocator<Child>(allocator)),
+        leaf{leaf} {}
+
+    /// Values in a leaf.
+    Values values;
+    /// Children of an internal node.
+    Children children;
+    /// Value of `PackedTree::clock_` when this leaf was last modified.
+    size_type last_modified{0};
+    /// Whether this node is a leaf.
+    bool leaf;
+    /// Whether this leaf is packed.
+    bool packed{false};
+  };
+
+  /// Allocator for nodes.
+  using NodeAllocator = RebindAllocator<Node>;
+
+  /// Allocator for values.
+  mutable allocator_type allocator_;
+
+  /// Root, which is an internal node, or null if the sequence is empty.
+  Node* root_{nullptr};
+
+  /// Number of elements.
+  size_type size_{0};
+
+  /// Number of modifications so far.
+  size_type clock_{0};
+
+  /// Value of `clock_` at the last call to `pack_cold()`.
+  size_type last_pack_{0};
+
+  /// Age after which a leaf is cold.
+  size_type cold_age_{kDefaultColdAge};
+
+  /// Creates an empty node.
+  Node* new_node(bool leaf) {
+    NodeAllocator node_allocator{allocator_};
+    Node* n{std::allocator_traits<NodeAllocator>::allocate(node_allocator, 1)};
+    std::allocator_traits<NodeAllocator>::construct(
+        node_allocator, n, leaf, allocator_);
+    return n;
+  }
+
+  /// Creates a leaf with the values in `[first, last)`.
+  template<class Iterator>
+  Node* new_leaf(Iterator first, Iterator last, bool packed) {
+    Node* n{new_node(true)};
+    n->values.reserve(static_cast<size_type>(std::distance(first, last)));
+    n->values.insert(n->values.end(), first, last);
+    n->packed = packed;
+    n->last_modified = clock_;
+    return n;
+  }
+
+  /// Destroys one node without its children.
+  void delete_node(Node* n) {
+    NodeAllocator node_allocator{allocator_};
+    std::allocator_traits<NodeAllocator>::destroy(node_allocator, n);
+    std::allocator_traits<NodeAllocator>::deallocate(node_allocator, n, 1);
+  }
+
+  /// Destroys `n` and all its descendants.
+  void delete_subtree(Node* n) {
+    for (Child const& child : n->children) {
+      delete_subtree(child.node);
+    }
+    delete_node(n);
+  }
+
+  /// Returns the sum of `count` over `[first, last)`.
+  template<class Iterator>
+  static size_type total_count(Iterator first, Iterator last) {
+    size_type total{0};
+    for (; first != last; ++first) {
+      total += first->count;
+    }
+    return total;
+  }
+
+  /**
+   *  @brief
+   *  Returns the child of `n` that contains `index`, and rebases `index` on
+   *    that child.
+   *
+   *  If `for_insertion` is `true`, an index at the end of a child selects
+   *    that child.
+   */
+  static std::size_t find_child(
+      Node const* n,
+      size_type& index,
+      bool for_insertion) {
+    std::size_t c{0};
+    std::size_t const last{n->children.size() - 1};
+    while (c < last &&
+        (for_insertion
+          ? index > n->children[c].count
+          : index >= n->children[c].count)) {
+      index -= n->children[c].count;
+      ++c;
+    }
+    return c;
+  }
+
+  /**
+   *  @brief
+   *  Splits the packed leaf `children[c]` so that the values near `index`
+   *    move to a new hot leaf, and returns the position of that leaf.
+   *
+   *  `index` is rebased on the hot leaf.
+   */
+  std::size_t unpack_around(Children& children, std::size_t c,
+      size_type& index) {
+    Node* n{children[c].node};
+    assert(n->leaf && n->packed);
+    size_type const length{n->values.size()};
+    size_type const reach{kHotCapacity / 4};
+    size_type const first{index - std::min(index, reach)};
+    size_type const last{std::min(length, index + reach + 1)};
+    auto const begin{n->values.begin()};
+    Node* hot{new_leaf(
+        std::make_move_iterator(begin + first),
+        std::make_move_iterator(begin + last),
+        false)};
+    std::size_t position{c};
+    Children pieces{children.get_allocator()};
+    if (first > 0) {
+      pieces.push_back(Child{new_leaf(
+          std::make_move_iterator(begin),
+          std::make_move_iterator(begin + first),
+          true), first});
+      pieces.back().node->last_modified = n->last_modified;
+      ++position;
+    }
+    pieces.push_back(Child{hot, last - first});
+    if (last < length) {
+      pieces.push_back(Child{new_leaf(
+          std::make_move_iterator(begin + last),
+          std::make_move_iterator(n->values.end()),
+          true), length - last});
+      pieces.back().node->last_modified = n->last_modified;
+    }
+    delete_node(n);
+    children.erase(children.begin() + c);
+    children.insert(children.begin() + c, pieces.begin(), pieces.end());
+    index -= first;
+    return position;
+  }
+
+  /// Inserts `value` at `index` under `n`.
+  void insert_into(Node* n, size_type index, value_type&& value) {
+    std::size_t c{find_child(n, index, true)};
+    Children& children{n->children};
+    if (!children[c].node->leaf) {
+      ++children[c].count;
+      insert_into(children[c].node, index, std::move(value));
+      fix_child(n, c);
+      return;
+    }
+    if (children[c].node->packed) {
+      c = unpack_around(children, c, index);
+    }
+    Node* leaf{children[c].node};
+    leaf->values.insert(leaf->values.begin() + index, std::move(value));
+    leaf->last_modified = clock_;
+    ++children[c].count;
+    if (leaf->values.size() > kHotCapacity) {
+      size_type const half{leaf->values.size() / 2};
+      Node* right{new_leaf(
+          std::make_move_iterator(leaf->values.begin() + half),
+          std::make_move_iterator(leaf->values.end()),
+          false)};
+      leaf->values.erase(leaf->values.begin() + half, leaf->values.end());
+      children[c].count = half;
+      children.insert(children.begin() + c + 1,
+          Child{right, right->values.size()});
+    }
+  }
+
+  /// Erases the value at `index` under `n`.
+  void erase_from(Node* n, size_type index) {
+    std::size_t c{find_child(n, index, false)};
+    Children& children{n->children};
+    if (!children[c].node->leaf) {
+      --children[c].count;
+      erase_from(children[c].node, index);
+      fix_child(n, c);
+      return;
+    }
+    if (children[c].node->packed) {
+      c = unpack_around(children, c, index);
+    }
+    Node* leaf{children[c].node};
+    leaf->values.erase(leaf->values.begin() + index);
+    leaf->last_modified = clock_;
+    --children[c].count;
+    if (leaf->values.empty()) {
+      delete_node(leaf);
+      children.erase(children.begin() + c);
+      return;
+    }
+    // Merge a small hot leaf into a hot neighbor.
+    if (leaf->values.size() >= kHotCapacity / 4) {
+      return;
+    }
+    for (std::size_t d : {c + 1, c - 1}) {
+      if (d >= children.size()) {
+        continue;
+      }
+      std::size_t const l{std::min(c, d)};
+      Node* left{children[l].node};
+      Node* right{children[l + 1].node};
+      if (left->packed || right->packed ||
+          left->values.size() + right->values.size() > kHotCapacity) {
+        continue;
+      }
+      left->values.insert(left->values.end(),
+          std::make_move_iterator(right->values.begin()),
+          std::make_move_iterator(right->values.end()));
+      left->last_modified = clock_;
+      children[l].count += children[l + 1].count;
+      delete_node(right);
+      children.erase(children.begin() + l + 1);
+      return;
+    }
+  }
+
+  /**
+   *  @brief
+   *  Splits the internal child `children[c]` of `n` if it has too many
+   *    children, or merges it with a sibling if it has too few.
+   */
+  void fix_child(Node* n, std::size_t c) {
+    Children& children{n->children};
+    Node* child{children[c].node};
+    assert(!child->leaf);
+    if (child->children.empty()) {
+      delete_node(child);
+      children.erase(children.begin() + c);
+      return;
+    }
+    if (child->children.size() > kFanout) {
+      split_child(n, c);
+      return;
+    }
+    if (child->children.size() >= kFanout / 4 || children.size() == 1) {
+      return;
+    }
+    std::size_t const l{c + 1 < children.size() ? c : c - 1};
+    Node* left{children[l].node};
+    Node* right{children[l + 1].node};
+    left->children.insert(left->children.end(),
+        right->children.begin(), right->children.end());
+    right->children.clear();
+    children[l].count += children[l + 1].count;
+    delete_node(right);
+    children.erase(children.begin() + l + 1);
+    if (left->children.size() > kFanout) {
+      split_child(n, l);
+    }
+  }
+
+  /// Splits the internal child `children[c]` of `n` into two halves.
+  void split_child(Node* n, std::size_t c) {
+    Children& children{n->children};
+    Node* child{children[c].node};
+    std::size_t const half{child->children.size() / 2};
+    Node* right{new_node(false)};
+    right->children.assign(
+        child->children.begin() + half, child->children.end());
+    child->children.erase(child->children.begin() + half,
+        child->children.end());
+    size_type const right_count{
+        total_count(right->children.begin(), right->children.end())};
+    children[c].count -= right_count;
+    children.insert(children.begin() + c + 1, Child{right, right_count});
+  }
+
+  /// Grows or shrinks the tree at the root after a modification.
+  void fix_root() {
+    while (root_) {
+      if (root_->children.size() > kFanout) {
+        Node* n{new_node(false)};
+        n->children.push_back(Child{root_, size_});
+        split_child(n, 0);
+        root_ = n;
+      } else if (root_->children.empty()) {
+        delete_node(root_);
+        root_ = nullptr;
+      } else if (root_->children.size() == 1 &&
+          !root_->children.front().node->leaf) {
+        Node* n{root_};
+        root_ = n->children.front().node;
+        n->children.clear();
+        delete_node(n);
+      } else {
+        return;
+      }
+    }
+  }
+
+  /// Appends the leaves under `n` to `leaves` and deletes internal nodes.
+  void collect_leaves(Node* n, Children& leaves) {
+    for (Child const& child : n->children) {
+      if (child.node->leaf) {
+        leaves.push_back(child);
+      } else {
+        collect_leaves(child.node, leaves);
+      }
+    }
+    n->children.clear();
+    delete_node(n);
+  }
+
+  /**
+   *  @brief
+   *  Builds internal nodes over `level`, which lists nodes of the same
+   *    depth, and returns the root.
+   */
+  Node* build_internal_nodes(Children level) {
+    do {
+      std::size_t const length{level.size()};
+      std::size_t const num_groups{(length + kFanout - 1) / kFanout};
+      Children parents{level.get_allocator()};
+      parents.reserve(num_groups);
+      for (std::size_t g{0}; g < num_groups; ++g) {
+        Node* n{new_node(false)};
+        auto const first{level.begin() + length * g / num_groups};
+        auto const last{level.begin() + length * (g + 1) / num_groups};
+        n->children.assign(first, last);
+        parents.push_back(Child{n, total_count(first, last)});
+      }
+      level = std::move(parents);
+    } while (level.size() > 1);
+    return level.front().node;
+  }
+
+  /**
+   *  @brief
+   *  Replaces `run`, a list of adjacent cold leaves, with packed leaves, and
+   *    appends them to `out`.
+   */
+  void pack_run(Children& run, Children& out) {
+    if (run.empty()) {
+      return;
+    }
+    if (run.size() == 1 && run.front().node->packed) {
+      out.push_back(run.front());
+      run.clear();
+      return;
+    }
+    size_type const length{total_count(run.begin(), run.end())};
+    size_type const num_leaves{
+        (length + kPackedCapacity - 1) / kPackedCapacity};
+    size_type last_modified{0};
+    for (Child const& child : run) {
+      last_modified = std::max(last_modified, child.node->last_modified);
+    }
+    auto source{run.begin()};
+    size_type offset{0};
+    for (size_type k{0}; k < num_leaves; ++k) {
+      size_type const count{
+          length * (k + 1) / num_leaves - length * k / num_leaves};
+      Node* n{new_node(true)};
+      n->packed = true;
+      n->last_modified = last_modified;
+      n->values.reserve(count);
+      while (n->values.size() < count) {
+        Values& values{source->node->values};
+        size_type const take{std::min<size_type>(
+            count - n->values.size(), values.size() - offset)};
+        n->values.insert(n->values.end(),
+            std::make_move_iterator(values.begin() + offset),
+            std::make_move_iterator(values.begin() + offset + take));
+        offset += take;
+        if (offset == values.size()) {
+          delete_node(source->node);
+          ++source;
+          offset = 0;
+        }
+      }
+      out.push_back(Child{n, count});
+    }
+    run.clear();
+  }
+
+  /// Runs `pack_cold()` if enough modifications have happened since the
+  ///   last run.
+  void maybe_pack() {
+    if (clock_ - last_pack_ >= std::max(cold_age_, size_)) {
+      pack_cold();
+    }
+  }
+
+  /// Inserts `value` at `index`.
+  void insert_at(size_type index, value_type&& value) {
+    assert(index <= size_);
+    ++clock_;
+    if (!root_) {
+      root_ = new_node(false);
+      root_->children.push_back(Child{new_node(true), 0});
+      root_->children.back().node->last_modified = clock_;
+    }
+    insert_into(root_, index, std::move(value));
+    ++size_;
+    fix_root();
+    maybe_pack();
+  }
+
+  /// Erases the element at `index`.
+  void erase_at(size_type index) {
+    assert(index < size_);
+    ++clock_;
+    erase_from(root_, index);
+    --size_;
+    fix_root();
+    maybe_pack();
+  }
+
+  /**
+   *  @brief
+   *  Returns the element at `index` together with the leaf that contains it.
+   */
+  std::tuple<value_type*, value_type*, value_type*> locate_run(
+      size_type index) const {
+    assert(index < size_);
+    Node* n{root_};
+    while (!n->leaf) {
+      std::size_t const c{find_child(n, index, false)};
+      n = n->children[c].node;
+    }
+    value_type* first{n->values.data()};
+    return {first + index, first, first + n->values.size()};
+  }
+
+  /// Returns the element at `index`.
+  value_type* locate(size_type index) const {
+    return std::get<0>(locate_run(index));
+  }
+
+  /**
+   *  @brief
+   *  Replaces the contents with the values in `[first, last)`, stored in
+   *    full packed leaves.
+   */
+  template<class InputIterator>
+  void assign_packed(InputIterator first, InputIterator last) {
+    clear();
+    Children leaves{RebindAllocator<Child>(allocator_)};
+    while (first != last) {
+      Node* n{new_node(true)};
+      n->packed = true;
+      n->last_modified = clock_;
+      n->values.reserve(kPackedCapacity);
+      for (; first != last && n->values.size() < kPackedCapacity; ++first) {
+        n->values.emplace_back(*first);
+      }
+      n->values.shrink_to_fit();
+      size_ += n->values.size();
+      leaves.push_back(Child{n, n->values.size()});
+    }
+    if (!leaves.empty()) {
+      root_ = build_internal_nodes(std::move(leaves));
+    }
+  }
+
+  /// Converts `index` into an iterator.
+  template<bool constant = false, bool reverse = false>
+  p_iterator<constant, reverse> make_iterator(size_type index) const {
+    return {const_cast<This*>(this), index};
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty sequence with a given `allocator`.
+   */
+  PackedTree(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence using the given `allocator`.
+   *
+   *  All values are stored in packed leaves.
+   */
+  PackedTree(This const& other, allocator_type const& allocator)
+    : PackedTree{allocator} {
+    cold_age_ = other.cold_age_;
+    assign_packed(other.begin(), other.end());
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence. The allocator is copied via
+   *    `select_on_container_copy_construction()`.
+   */
+  PackedTree(This const& other)
+    : PackedTree{other,
+        std::allocator_traits<allocator_type>::
+          select_on_container_copy_construction(other.allocator_)} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence if `allocator != other.allocator`,
+   *    or takes ownership of the data from another sequence otherwise.
+   */
+  PackedTree(This&& other, allocator_type const& allocator)
+    : PackedTree{allocator} {
+    if (allocator_ == other.allocator_) {
+      swap(other);
+    } else {
+      cold_age_ = other.cold_age_;
+      assign_packed(
+          std::make_move_iterator(other.begin()),
+          std::make_move_iterator(other.end()));
+      other.clear();
+    }
+  }
+
+  /**
+   *  @brief
+   *  Moves data from another sequence.
+   */
+  PackedTree(This&& other)
+    : allocator_{std::move(other.allocator_)},
+      root_{std::exchange(other.root_, nullptr)},
+      size_{std::exchange(other.size_, 0)},
+      clock_{other.clock_},
+      last_pack_{other.last_pack_},
+      cold_age_{other.cold_age_} {}
+
+  /**
+   *  @brief
+   *  Destroys the sequence.
+   */
+  ~PackedTree() {
+    clear();
+  }
+
+  /**
+   *  @brief
+   *  Empties the sequence.
+   */
+  void clear() {
+    if (root_) {
+      delete_subtree(root_);
+      root_ = nullptr;
+    }
+    size_ = 0;
+  }
+
+  /**
+   *  @brief
+   *  Copies the sequence from `other`.
+   */
+  This& operator=(This const& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_copy_assignment::value) {
+      allocator_ = other.allocator_;
+    }
+    cold_age_ = other.cold_age_;
+    assign_packed(other.begin(), other.end());
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes the sequence from `other`.
+   */
+  This& operator=(This&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_move_assignment::value) {
+      allocator_ = std::move(other.allocator_);
+    }
+    swap(other);
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Swaps this sequence with `other`.
+   */
+  void swap(This& other) {
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_swap::value) {
+      using std::swap;
+      swap(allocator_, other.allocator_);
+    }
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(clock_, other.clock_);
+    std::swap(last_pack_, other.last_pack_);
+    std::swap(cold_age_, other.cold_age_);
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements in the sequence.
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the sequence is empty.
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns the allocator.
+   */
+  allocator_type get_allocator() const noexcept {
+    return allocator_;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of modifications after which an untouched leaf is
+   *    considered cold.
+   */
+  size_type cold_age() const {
+    return cold_age_;
+  }
+
+  /**
+   *  @brief
+   *  Sets the number of modifications after which an untouched leaf is
+   *    considered cold.
+   *
+   *  With `0`, every leaf is packed at the next `pack_cold()`.
+   */
+  void set_cold_age(size_type cold_age) {
+    cold_age_ = cold_age;
+  }
+
+  /**
+   *  @brief
+   *  Packs every run of adjacent cold leaves into packed leaves and rebuilds
+   *    the internal nodes.
+   *
+   *  This takes O(n) time in the worst case, and O(number of leaves) if
+   *    nothing needs to be packed.
+   */
+  void pack_cold() {
+    last_pack_ = clock_;
+    if (!root_) {
+      return;
+    }
+    Children leaves{RebindAllocator<Child>(allocator_)};
+    collect_leaves(root_, leaves);
+    root_ = nullptr;
+    Children packed{RebindAllocator<Child>(allocator_)};
+    packed.reserve(leaves.size());
+    Children run{RebindAllocator<Child>(allocator_)};
+    for (Child const& leaf : leaves) {
+      if (clock_ - leaf.node->last_modified >= cold_age_) {
+        run.push_back(leaf);
+      } else {
+        pack_run(run, packed);
+        packed.push_back(leaf);
+      }
+    }
+    pack_run(run, packed);
+    root_ = build_internal_nodes(std::move(packed));
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements stored in packed leaves.
+   *
+   *  This takes O(number of nodes) time.
+   */
+  size_type packed_size() const {
+    size_type count{0};
+    std::vector<Node const*, RebindAllocator<Node const*>> stack{
+        RebindAllocator<Node const*>{allocator_}};
+    if (root_) {
+      stack.push_back(root_);
+    }
+    while (!stack.empty()) {
+      Node const* n{stack.back()};
+      stack.pop_back();
+      for (Child const& child : n->children) {
+        if (!child.node->leaf) {
+          stack.push_back(child.node);
+        } else if (child.node->packed) {
+          count += child.count;
+        }
+      }
+    }
+    return count;
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `[first, last)` to it.
+   *
+   *  The values are stored in packed leaves, as they are considered loaded
+   *    rather than edited.
+   */
+  template<class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    assign_packed(first, last);
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `ilist` to it.
+   */
+  template<class V>
+  void assign(std::initializer_list<V> ilist) {
+    assign(ilist.begin(), ilist.end());
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns `n` copies of `value` to it.
+   */
+  void assign(size_type n, value_type const& value) {
+    clear();
+    for (size_type i{0}; i < n; ++i) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference operator[](size_type index) {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference operator[](size_type index) const {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("PackedTree::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("PackedTree::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  reference front() {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  const_reference front() const {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  reference back() {
+    return *locate(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  const_reference back() const {
+    return *locate(size_ - 1);
+  }
+
+  /// Returns the iterator to the first element.
+  iterator begin() {
+    return make_iterator(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator begin() const {
+    return make_iterator<true>(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  /// Returns the reverse-iterator to the last element.
+  reverse_iterator rbegin() {
+    return make_iterator<false, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator rbegin() const {
+    return make_iterator<true, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator crbegin() const {
+    return rbegin();
+  }
+
+  /// Returns the past-the-end iterator.
+  iterator end() {
+    return make_iterator(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator end() const {
+    return make_iterator<true>(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator cend() const {
+    return end();
+  }
+
+  /// Returns the past-the-beginning reverse-iterator.
+  reverse_iterator rend() {
+    return make_iterator<false, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator rend() const {
+    return make_iterator<true, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator crend() const {
+    return rend();
+  }
+
+  /**
+   *  @brief
+   *  Returns an iterator for the `index`-th element.
+   */
+  iterator get_iterator_at_index(size_type index) {
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Returns a const-iterator for the `index`-th element.
+   */
+  const_iterator get_iterator_at_index(size_type index) const {
+    return make_iterator<true>(index);
+  }
+
+  /// Returns an iterator for the first element.
+  iterator get_front_iterator() {
+    return begin();
+  }
+
+  /// Returns a const-iterator for the first element.
+  const_iterator get_front_iterator() const {
+    return begin();
+  }
+
+  /// Returns an iterator for the last element.
+  iterator get_back_iterator() {
+    assert(!empty());
+    return make_iterator(size_ - 1);
+  }
+
+  /// Returns a const-iterator for the last element.
+  const_iterator get_back_iterator() const {
+    assert(!empty());
+    return make_iterator<true>(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Converts a const-iterator to a regular iterator.
+   *
+   *  This function works on reverse iterators also.
+   */
+  template<bool constant = false, bool reverse = false>
+  p_iterator<false, reverse> make_mutable_iterator(
+      p_iterator<constant, reverse> it) const {
+    return make_iterator<false, reverse>(it.index_);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type const& value) {
+    return emplace(pos, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a new `value` and inserts it right before `pos`, then returns
+   *    the iterator to the newly inserted value.
+   */
+  template<bool constant, class... Args>
+  iterator emplace(p_iterator<constant> pos, Args&&... args) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    insert_at(index, value_type(std::forward<Args>(args)...));
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Inserts a list of values from `[first, last)` right before `pos`, then
+   *    returns the iterator to the first value that was inserted.
+   *
+   *  The values are inserted one at a time into hot leaves.
+   */
+  template<bool constant, class InputIterator>
+  iterator insert(
+      p_iterator<constant> pos,
+      InputIterator first,
+      InputIterator last) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    std::vector<value_type, allocator_type> values(first, last, allocator_);
+    for (size_type i{0}; i < values.size(); ++i) {
+      insert_at(index + i, std::move(values[i]));
+    }
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Moves elements from `other` right before `pos`, then returns the iterator
+   *    to the first moved element.
+   *
+   *  `other` will be empty afterwards.
+   */
+  template<bool constant>
+  iterator join(p_iterator<constant> pos, This& other) {
+    assert(pos.seq_ == this);
+    if (empty() && allocator_ == other.allocator_) {
+      swap(other);
+      return begin();
+    }
+    iterator it{insert(
+        pos,
+        std::make_move_iterator(other.begin()),
+        std::make_move_iterator(other.end()))};
+    other.clear();
+    return it;
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(begin(), other)`.
+   */
+  iterator join_front(This& other) {
+    return join(begin(), other);
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(end(), other)`.
+   */
+  iterator join_back(This& other) {
+    return join(end(), other);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type const& value) {
+    emplace_front(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type&& value) {
+    emplace_front(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the first element.
+   */
+  template<class... Args>
+  void emplace_front(Args&&... args) {
+    insert_at(0, value_type(std::forward<Args>(args)...));
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the last element.
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    insert_at(size_, value_type(std::forward<Args>(args)...));
+  }
+
+  /**
+   *  @brief
+   *  Erases an element pointed to by `pos`, then returns the iterator to the
+   *    position right after `pos`.
+   */
+  template<bool constant>
+  iterator erase(p_iterator<constant> pos) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    erase_at(index);
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Erases elements in the interval `[first, last)`, then returns the
+   *    iterator to the position right after the erased elements.
+   */
+  template<bool constant_1, bool constant_2>
+  iterator erase(
+      p_iterator<constant_1> first,
+      p_iterator<constant_2> last) {
+    assert(first.seq_ == this);
+    assert(last.seq_ == this);
+    assert(first <= last);
+    size_type const begin_index{first.index_};
+    size_type const count{last.index_ - begin_index};
+    for (size_type i{0}; i < count; ++i) {
+      erase_at(begin_index);
+    }
+    return make_iterator(begin_index);
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    assert(!empty());
+    erase_at(0);
+  }
+
+  /**
+   *  @brief
+   *  Erases the last element.
+   */
+  void pop_back() {
+    assert(!empty());
+    erase_at(size_ - 1);
+  }
+
+};
+
+/**
+ *  @brief
+ *  Implementation struct that makes `ManagedTree<PackedTreeImpl<...>>` a
+ *    `PackedTree`.
+ *
+ *  A packed tree suits large sequences that are mostly static after loading
+ *    but still receive occasional edits: cold regions are stored and scanned
+ *    like arrays, while edited regions keep cheap O(log n) modifications.
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+struct PackedTreeImpl {
+  /// This type.
+  using This = PackedTreeImpl<ValueT, AllocatorT>;
+
+  /// Type of values to present to the user.
+  using Value = ValueT;
+
+  /// Type of allocators for `Value`.
+  using ValueAllocator = AllocatorT;
+
+  /// Container that provides the interface of `ManagedTree`.
+  using Container = PackedTree<Value, ValueAllocator>;
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Computes LRU stack distances (reuse distances) of a stream of accesses.
+ *
+ *  The stack distance of an access to `address` is the number of distinct
+ *    other addresses accessed since the previous access to `address`, or
+ *    `kInfinite` if `address` has not been accessed before.
+ *  An LRU cache of capacity `c` hits exactly the accesses whose distance is
+ *    less than `c`, so `histogram()` gives the miss ratio for every cache
+ *    size at once.
+ *
+ *  Addresses are kept in a splay tree ordered by their last access, most
+ *    recent first, and a hash map finds each address's node.
+ *  An access splays the node to the root, reads the size of its left subtree
+ *    as the distance, and moves it to the front, in O(log n) amortized time.
+ *
+ *  `analyze()` processes a whole trace with several threads.
+ */
+template<
+    class AddressT = std::uint64_t,
+    class AllocatorT = std::allocator<AddressT>>
+class ReuseDistanceAnalyzer {
+ private:
+  /// This class.
+  using This = ReuseDistanceAnalyzer<AddressT, AllocatorT>;
+
+ protected:
+  /// Tree implementation for the LRU stack.
+  using TreeImpl = SplayTreeImpl<AddressT, AllocatorT>;
+
+  /// Type of the LRU stack.
+  using Tree = typename TreeImpl::Tree;
+
+  /// Type of nodes in the LRU stack.
+  using Node = typename TreeImpl::Node;
+
+  /// Type of pointers to nodes.
+  using NodePtr = typename TreeImpl::NodePtr;
+
+ public:
+  /// Type of addresses.
+  using address_type = AddressT;
+
+  /// Type of the allocator.
+  using allocator_type = AllocatorT;
+
+  /// Type of distances.
+  using size_type = typename TreeImpl::size_type;
+
+  /// Distance of an access to an address that has not been accessed before.
+  static constexpr size_type kInfinite{std::numeric_limits<size_type>::max()};
+
+ protected:
+  /// Allocator for values of type `T`.
+  template<class T>
+  using RebindAllocator = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<T>;
+
+  /// Type of the map from addresses to nodes.
+  using Positions = std::unordered_map<
+      address_type,
+      NodePtr,
+      std::hash<address_type>,
+      std::equal_to<address_type>,
+      RebindAllocator<std::pair<address_type const, NodePtr>>>;
+
+  /// Minimum number of accesses per thread in `analyze()`.
+  static constexpr std::size_t kMinChunkSize{std::size_t{1} << 16};
+
+  /// LRU stack. `tree_.first` is the most recently accessed address.
+  Tree tree_;
+
+  /// Node of each address in `tree_`.
+  Positions positions_;
+
+  /// `histogram_[d]` is the number of accesses with distance `d`.
+  std::vector<std::uint64_t> histogram_;
+
+  /// Number of accesses with distance `kInfinite`.
+  std::uint64_t cold_misses_{0};
+
+  /**
+   *  @brief
+   *  Moves `address` to the top of the stack and returns its distance
+   *    without recording it.
+   */
+  size_type touch(address_type const& address) {
+    auto [it, inserted]{positions_.try_emplace(address, nullptr)};
+    if (inserted) {
+      it->second = TreeImpl::emplace_front(tree_, address);
+      return kInfinite;
+    }
+    NodePtr n{it->second};
+    tree_.splay(n);
+    NodePtr l{n->left_child};
+    if (!l) {
+      return 0;
+    }
+    size_type const distance{l->size};
+
+    // Make the rightmost node `m` of the left subtree the left child of `n`,
+    //   then hang everything except `n` under `m` and put `m` on the right.
+    NodePtr m{l->find_last_node()};
+    tree_.splay(m, n);
+    assert(n->left_child == m);
+    assert(!m->right_child);
+    NodePtr r{n->right_child};
+    m->right_child = r;
+    if (r) {
+      r->parent = m;
+    }
+    m->size = n->size - 1;
+    n->left_child = nullptr;
+    n->right_child = m;
+    if (tree_.last == n) {
+      tree_.last = m;
+    }
+    tree_.first = n;
+    return distance;
+  }
+
+  /// Adds `distance` to the histogram.
+  void record(size_type distance) {
+    if (distance == kInfinite) {
+      ++cold_misses_;
+      return;
+    }
+    if (distance >= histogram_.size()) {
+      histogram_.resize(distance + 1);
+    }
+    ++histogram_[distance];
+  }
+
+  /// Adds `histogram` to the histogram.
+  void merge_histogram(std::vector<std::uint64_t> const& histogram) {
+    if (histogram.size() > histogram_.size()) {
+      histogram_.resize(histogram.size());
+    }
+    for (std::size_t d{0}; d < histogram.size(); ++d) {
+      histogram_[d] += histogram[d];
+    }
+  }
+
+  /**
+   *  @brief
+   *  Summary of one part of a trace, analyzed independently.
+   *
+   *  Accesses that repeat an address from the same part already have their
+   *    final distances in `histogram`.
+   *  The other accesses are listed in `first_accesses` and are resolved
+   *    against the stack left by the preceding parts.
+   */
+  struct Chunk {
+    /// Distances of accesses that repeat an address within the part.
+    std::vector<std::uint64_t> histogram;
+    /// Addresses in the order of their first access within the part.
+    std::vector<address_type> first_accesses;
+    /// Addresses in the order of their last access within the part.
+    std::vector<address_type> last_accesses;
+  };
+
+  /// Analyzes `[first, last)` on a fresh stack.
+  template<class RandomAccessIterator>
+  static Chunk analyze_chunk(
+      RandomAccessIterator first,
+      RandomAccessIterator last,
+      allocator_type const& allocator) {
+    This local{allocator};
+    Chunk chunk;
+    for (; first != last; ++first) {
+      size_type const distance{local.touch(*first)};
+      if (distance == kInfinite) {
+        chunk.first_accesses.push_back(*first);
+      } else {
+        local.record(distance);
+      }
+    }
+    chunk.histogram = std::move(local.histogram_);
+    chunk.last_accesses.reserve(chunk.first_accesses.size());
+    for (NodePtr n{local.tree_.last}; n; n = n->find_prev_node()) {
+      chunk.last_accesses.push_back(n->data);
+    }
+    return chunk;
+  }
+
+  /**
+   *  @brief
+   *  Applies a chunk that follows every access seen so far.
+   *
+   *  When a chunk accesses an address for the first time, every address
+   *    above it in the combined stack is either an address the chunk has
+   *    already accessed or an address above it in the current stack.
+   *  Replaying only the first accesses therefore gives exact distances.
+   *  Replaying the last accesses afterwards puts the stack in the order it
+   *    would have after a sequential pass.
+   */
+  void apply_chunk(Chunk const& chunk) {
+    for (address_type const& address : chunk.first_accesses) {
+      record(touch(address));
+    }
+    for (address_type const& address : chunk.last_accesses) {
+      touch(address);
+    }
+    merge_histogram(chunk.histogram);
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an analyzer that has not seen any access.
+   */
+  ReuseDistanceAnalyzer(allocator_type const& allocator = allocator_type())
+    : tree_{typename TreeImpl::Allocator(allocator)},
+      positions_(0,
+          std::hash<address_type>(),
+          std::equal_to<address_type>(),
+          typename Positions::allocator_type(allocator)) {}
+
+  ReuseDistanceAnalyzer(This const&) = delete;
+
+  This& operator=(This const&) = delete;
+
+  /**
+   *  @brief
+   *  Destroys the analyzer.
+   */
+  ~ReuseDistanceAnalyzer() {
+    tree_.destroy_all_nodes();
+  }
+
+  /**
+   *  @brief
+   *  Forgets all accesses.
+   */
+  void clear() {
+    tree_.destroy_all_nodes();
+    positions_.clear();
+    histogram_.clear();
+    cold_misses_ = 0;
+  }
+
+  /**
+   *  @brief
+   *  Records an access to `address` and returns its distance.
+   */
+  size_type access(address_type const& address) {
+    size_type const distance{touch(address)};
+    record(distance);
+    return distance;
+  }
+
+  /**
+   *  @brief
+   *  Records the accesses in `[first, last)` in order.
+   *
+   *  The result is the same as calling `access()` on each element.
+   *  The trace is split into up to `num_threads` parts, which are analyzed
+   *    in parallel on separate stacks.
+   *  The parts are then applied in order, which only needs to revisit the
+   *    addresses each part accesses, not every access.
+   *  If `num_threads` is `0`, `std::thread::hardware_concurrency()` will be
+   *    used.
+   */
+  template<class RandomAccessIterator>
+  void analyze(
+      RandomAccessIterator first,
+      RandomAccessIterator last,
+      std::size_t num_threads = 0) {
+    if (num_threads == 0) {
+      num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::size_t const length{static_cast<std::size_t>(last - first)};
+    std::size_t const num_chunks{
+        std::min(num_threads, length / kMinChunkSize)};
+    if (num_chunks <= 1) {
+      for (; first != last; ++first) {
+        access(*first);
+      }
+      return;
+    }
+    allocator_type const allocator{tree_.allocator};
+    std::vector<std::future<Chunk>> tasks;
+    tasks.reserve(num_chunks);
+    for (std::size_t c{0}; c < num_chunks; ++c) {
+      RandomAccessIterator const chunk_first{first + c * length / num_chunks};
+      RandomAccessIterator const chunk_last{
+          first + (c + 1) * length / num_chunks};
+      tasks.push_back(std::async(std::launch::async,
+          [chunk_first, chunk_last, &allocator]() {
+            return analyze_chunk(chunk_first, chunk_last, allocator);
+          }));
+    }
+    for (auto& task : tasks) {
+      apply_chunk(task.get());
+    }
+  }
+
+  /**
+   *  @brief
+   *  Returns the histogram of finite distances.
+   *
+   *  `histogram()[d]` is the number of accesses with distance `d`.
+   */
+  std::vector<std::uint64_t> const& histogram() const {
+    return histogram_;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of accesses to addresses not accessed before.
+   */
+  std::uint64_t cold_misses() const {
+    return cold_misses_;
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of distinct addresses accessed.
+   */
+  size_type num_addresses() const {
+    return tree_.size();
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of misses that an LRU cache of `capacity` entries
+   *    would have had.
+   */
+  std::uint64_t misses_for_capacity(size_type capacity) const {
+    std::uint64_t misses{cold_misses_};
+    for (std::size_t d{capacity}; d < histogram_.size(); ++d) {
+      misses += histogram_[d];
+    }
+    return misses;
+  }
+};
+
+} // namespace ordered_binary_trees
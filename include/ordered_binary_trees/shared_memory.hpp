@@ -0,0 +1,807 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Fancy pointer that stores the distance from itself to the pointee.
+ *
+ *  An `OffsetPtr` that lives in a shared memory segment and points into the
+ *    same segment stays valid no matter where the segment is mapped, so trees
+ *    whose nodes are linked with `OffsetPtr` can be read in place by every
+ *    process that maps the segment.
+ *
+ *  `OffsetPtr` satisfies the requirements of `std::allocator_traits` and
+ *    `std::pointer_traits`, so it can be returned by an allocator and picked
+ *    up by `AddPointerFromAllocator`.
+ */
+template<class T>
+class OffsetPtr {
+ private:
+  /// This type.
+  using This = OffsetPtr<T>;
+
+  template<class U>
+  friend class OffsetPtr;
+
+  /**
+   *  @brief
+   *  Offset that represents null.
+   *
+   *  `0` cannot be used because it would make a pointer to itself
+   *    indistinguishable from null.
+   */
+  static constexpr std::ptrdiff_t kNullOffset{1};
+
+  /// Distance in bytes from `this` to the pointee, or `kNullOffset`.
+  std::ptrdiff_t offset_{kNullOffset};
+
+  /// Stores `p` relative to `this`.
+  void set(T* p) noexcept {
+    if (p) {
+      offset_ = static_cast<std::ptrdiff_t>(
+          reinterpret_cast<std::uintptr_t>(p) -
+          reinterpret_cast<std::uintptr_t>(this));
+    } else {
+      offset_ = kNullOffset;
+    }
+  }
+
+ public:
+  /// `T`.
+  using element_type = T;
+  /// `T` without cv-qualifiers.
+  using value_type = std::remove_cv_t<T>;
+  /// Type of differences between pointers.
+  using difference_type = std::ptrdiff_t;
+  /// Raw pointer type.
+  using pointer = T*;
+  /// Type of `*p`.
+  using reference = typename std::add_lvalue_reference<T>::type;
+  /// Offset pointers are random-access iterators.
+  using iterator_category = std::random_access_iterator_tag;
+
+  /// `OffsetPtr<U>`.
+  template<class U>
+  using rebind = OffsetPtr<U>;
+
+  /// Creates a null pointer.
+  OffsetPtr() noexcept {}
+
+  /// Creates a null pointer.
+  OffsetPtr(std::nullptr_t) noexcept {}
+
+  /// Points to `p`.
+  OffsetPtr(T* p) noexcept {
+    set(p);
+  }
+
+  /// Points to the same object as `other`.
+  OffsetPtr(This const& other) noexcept {
+    set(other.get());
+  }
+
+  /// Points to the same object as `other`.
+  template<
+      class U,
+      std::enable_if_t<std::is_convertible_v<U*, T*>, int> = 0>
+  OffsetPtr(OffsetPtr<U> const& other) noexcept {
+    set(other.get());
+  }
+
+  /**
+   *  @brief
+   *  Points to `static_cast<T*>(other.get())`.
+   *
+   *  This is needed for conversions from `OffsetPtr<void>`.
+   */
+  template<
+      class U,
+      std::enable_if_t<!std::is_convertible_v<U*, T*>, int> = 0,
+      class = decltype(static_cast<T*>(std::declval<U*>()))>
+  explicit OffsetPtr(OffsetPtr<U> const& other) noexcept {
+    set(static_cast<T*>(other.get()));
+  }
+
+  /// Points to the same object as `other`.
+  This& operator=(This const& other) noexcept {
+    set(other.get());
+    return *this;
+  }
+
+  /// Points to `p`.
+  This& operator=(T* p) noexcept {
+    set(p);
+    return *this;
+  }
+
+  /// Becomes null.
+  This& operator=(std::nullptr_t) noexcept {
+    offset_ = kNullOffset;
+    return *this;
+  }
+
+  /// Returns the raw pointer.
+  T* get() const noexcept {
+    if (offset_ == kNullOffset) {
+      return nullptr;
+    }
+    return reinterpret_cast<T*>(
+        reinterpret_cast<std::uintptr_t>(this) +
+        static_cast<std::uintptr_t>(offset_));
+  }
+
+  /// Returns the raw pointer.
+  T* operator->() const noexcept {
+    return get();
+  }
+
+  /// Dereferences the pointer.
+  template<class U = T, std::enable_if_t<!std::is_void_v<U>, int> = 0>
+  U& operator*() const noexcept {
+    return *get();
+  }
+
+  /// Accesses `*(*this + i)`.
+  template<class U = T, std::enable_if_t<!std::is_void_v<U>, int> = 0>
+  U& operator[](difference_type i) const noexcept {
+    return get()[i];
+  }
+
+  /// Returns `true` iff the pointer is not null.
+  explicit operator bool() const noexcept {
+    return offset_ != kNullOffset;
+  }
+
+  /// Required by `std::pointer_traits`.
+  template<class U = T, std::enable_if_t<!std::is_void_v<U>, int> = 0>
+  static This pointer_to(U& r) noexcept {
+    return This{std::addressof(r)};
+  }
+
+  This& operator+=(difference_type n) noexcept {
+    set(get() + n);
+    return *this;
+  }
+
+  This& operator-=(difference_type n) noexcept {
+    set(get() - n);
+    return *this;
+  }
+
+  This& operator++() noexcept {
+    return *this += 1;
+  }
+
+  This operator++(int) noexcept {
+    This old{*this};
+    ++*this;
+    return old;
+  }
+
+  This& operator--() noexcept {
+    return *this -= 1;
+  }
+
+  This operator--(int) noexcept {
+    This old{*this};
+    --*this;
+    return old;
+  }
+
+  friend This operator+(This const& p, difference_type n) noexcept {
+    return This{p.get() + n};
+  }
+
+  friend This operator+(difference_type n, This const& p) noexcept {
+    return This{p.get() + n};
+  }
+
+  friend This operator-(This const& p, difference_type n) noexcept {
+    return This{p.get() - n};
+  }
+
+  friend difference_type operator-(This const& a, This const& b) noexcept {
+    return a.get() - b.get();
+  }
+
+  template<class U>
+  friend bool operator==(This const& a, OffsetPtr<U> const& b) noexcept {
+    return a.get() == b.get();
+  }
+
+  template<class U>
+  friend bool operator!=(This const& a, OffsetPtr<U> const& b) noexcept {
+    return a.get() != b.get();
+  }
+
+  template<class U>
+  friend bool operator==(This const& a, U* b) noexcept {
+    return a.get() == b;
+  }
+
+  template<class U>
+  friend bool operator==(U* a, This const& b) noexcept {
+    return a == b.get();
+  }
+
+  template<class U>
+  friend bool operator!=(This const& a, U* b) noexcept {
+    return a.get() != b;
+  }
+
+  template<class U>
+  friend bool operator!=(U* a, This const& b) noexcept {
+    return a != b.get();
+  }
+
+  friend bool operator==(This const& a, std::nullptr_t) noexcept {
+    return !a;
+  }
+
+  friend bool operator==(std::nullptr_t, This const& a) noexcept {
+    return !a;
+  }
+
+  friend bool operator!=(This const& a, std::nullptr_t) noexcept {
+    return bool(a);
+  }
+
+  friend bool operator!=(std::nullptr_t, This const& a) noexcept {
+    return bool(a);
+  }
+
+  friend bool operator<(This const& a, This const& b) noexcept {
+    return std::less<T*>{}(a.get(), b.get());
+  }
+
+  friend bool operator>(This const& a, This const& b) noexcept {
+    return b < a;
+  }
+
+  friend bool operator<=(This const& a, This const& b) noexcept {
+    return !(b < a);
+  }
+
+  friend bool operator>=(This const& a, This const& b) noexcept {
+    return !(a < b);
+  }
+
+  friend void swap(This& a, This& b) noexcept {
+    T* const pa{a.get()};
+    a.set(b.get());
+    b.set(pa);
+  }
+};
+
+/**
+ *  @brief
+ *  Reader-writer spin lock that works across processes.
+ *
+ *  The whole state is a single lock-free atomic integer, so the lock works
+ *    when it is placed in shared memory and mapped at different addresses.
+ *  A waiting writer blocks new readers, so readers cannot starve writers.
+ *
+ *  `SharedRwLock` meets the *SharedMutex* requirements, so it can be used with
+ *    `std::unique_lock` and `std::shared_lock`.
+ *  A process that dies while holding the lock leaves it locked.
+ */
+class SharedRwLock {
+ private:
+  /// Set while a writer holds the lock.
+  static constexpr std::uint32_t kWriter{std::uint32_t{1} << 31};
+  /// Set while a writer is waiting for readers to leave.
+  static constexpr std::uint32_t kWriterWaiting{std::uint32_t{1} << 30};
+  /// Bits that count readers.
+  static constexpr std::uint32_t kReaderMask{kWriterWaiting - 1};
+
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+  std::atomic<std::uint32_t> state_{0};
+
+ public:
+  SharedRwLock() = default;
+  SharedRwLock(SharedRwLock const&) = delete;
+  SharedRwLock& operator=(SharedRwLock const&) = delete;
+
+  /// Acquires the lock exclusively.
+  void lock() {
+    while (true) {
+      std::uint32_t s{state_.fetch_or(kWriterWaiting, std::memory_order_relaxed)
+          | kWriterWaiting};
+      if (s == kWriterWaiting &&
+          state_.compare_exchange_weak(s, kWriter, std::memory_order_acquire)) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  /// Tries to acquire the lock exclusively without waiting.
+  bool try_lock() {
+    std::uint32_t s{0};
+    return state_.compare_exchange_strong(
+        s, kWriter, std::memory_order_acquire);
+  }
+
+  /// Releases the exclusive lock.
+  void unlock() {
+    state_.fetch_and(~kWriter, std::memory_order_release);
+  }
+
+  /// Acquires the lock for reading.
+  void lock_shared() {
+    while (!try_lock_shared()) {
+      std::this_thread::yield();
+    }
+  }
+
+  /// Tries to acquire the lock for reading without waiting.
+  bool try_lock_shared() {
+    std::uint32_t s{state_.load(std::memory_order_relaxed)};
+    while (!(s & (kWriter | kWriterWaiting))) {
+      assert((s & kReaderMask) != kReaderMask);
+      if (state_.compare_exchange_weak(
+            s, s + 1, std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Releases a lock for reading.
+  void unlock_shared() {
+    state_.fetch_sub(1, std::memory_order_release);
+  }
+};
+
+/**
+ *  @brief
+ *  Bookkeeping at the beginning of a shared memory segment.
+ *
+ *  Free memory is managed with one free list per power-of-two size class.
+ *  Blocks are carved from the end of the used region when their free list is
+ *    empty, and are never returned to the bump region.
+ */
+struct SharedMemoryHeader {
+  /// Value of `magic` in an initialized segment.
+  static constexpr std::uint64_t kMagic{0x6f62742d73686d31};
+
+  /// Smallest block size is `1 << kMinSizeClassShift`.
+  static constexpr unsigned kMinSizeClassShift{4};
+
+  /// Number of size classes.
+  static constexpr unsigned kNumSizeClasses{48};
+
+  /// Alignment of every block.
+  static constexpr std::size_t kAlignment{alignof(std::max_align_t)};
+
+  /// Free block. Only used while the block is free.
+  struct FreeBlock {
+    OffsetPtr<FreeBlock> next;
+  };
+
+  /// `kMagic` once the header has been initialized.
+  std::uint64_t magic{0};
+
+  /// Size of the segment in bytes.
+  std::size_t capacity{0};
+
+  /// Offset of the first byte that has never been allocated.
+  std::size_t used{0};
+
+  /// Protects `used` and `free_lists`.
+  std::atomic<std::uint32_t> allocation_lock{0};
+
+  /// Heads of the free lists.
+  OffsetPtr<FreeBlock> free_lists[kNumSizeClasses];
+
+  /// Object registered with `SharedMemorySegment::construct_root()`.
+  OffsetPtr<void> root;
+
+  /// Lock for users of `root`.
+  SharedRwLock lock;
+
+  /// Returns the size class for a request of `bytes` bytes.
+  static unsigned size_class(std::size_t bytes) {
+    unsigned c{0};
+    while ((std::size_t{1} << (c + kMinSizeClassShift)) < bytes) {
+      ++c;
+    }
+    return c;
+  }
+
+  /// Returns the first byte of the segment.
+  unsigned char* base() {
+    return reinterpret_cast<unsigned char*>(this);
+  }
+
+  /**
+   *  @brief
+   *  Allocates `bytes` bytes.
+   *
+   *  Throws `std::bad_alloc` if the segment is full.
+   */
+  void* allocate(std::size_t bytes) {
+    unsigned const c{size_class(bytes)};
+    if (c >= kNumSizeClasses) {
+      throw std::bad_alloc{};
+    }
+    std::size_t const block_size{std::size_t{1} << (c + kMinSizeClassShift)};
+    lock_allocation();
+    void* p{free_lists[c].get()};
+    if (p) {
+      free_lists[c] = free_lists[c]->next;
+    } else if (capacity - used >= block_size) {
+      p = base() + used;
+      used += block_size;
+    }
+    unlock_allocation();
+    if (!p) {
+      throw std::bad_alloc{};
+    }
+    return p;
+  }
+
+  /// Returns a block of `bytes` bytes obtained from `allocate()`.
+  void deallocate(void* p, std::size_t bytes) {
+    unsigned const c{size_class(bytes)};
+    FreeBlock* block{::new(p) FreeBlock{}};
+    lock_allocation();
+    block->next = free_lists[c];
+    free_lists[c] = block;
+    unlock_allocation();
+  }
+
+  void lock_allocation() {
+    std::uint32_t expected{0};
+    while (!allocation_lock.compare_exchange_weak(
+          expected, 1, std::memory_order_acquire)) {
+      expected = 0;
+      std::this_thread::yield();
+    }
+  }
+
+  void unlock_allocation() {
+    allocation_lock.store(0, std::memory_order_release);
+  }
+};
+
+/**
+ *  @brief
+ *  Allocator that allocates from a shared memory segment and returns
+ *    `OffsetPtr`.
+ *
+ *  The allocator itself only holds an `OffsetPtr` to the segment header, so a
+ *    container that is constructed inside the segment, together with its
+ *    allocator, can be used from any process that maps the segment.
+ */
+template<class T>
+class SharedMemoryAllocator {
+ private:
+  /// This type.
+  using This = SharedMemoryAllocator<T>;
+
+  template<class U>
+  friend class SharedMemoryAllocator;
+
+  /// Header of the segment.
+  OffsetPtr<SharedMemoryHeader> header_;
+
+ public:
+  using value_type = T;
+  using pointer = OffsetPtr<T>;
+  using const_pointer = OffsetPtr<T const>;
+  using void_pointer = OffsetPtr<void>;
+  using const_void_pointer = OffsetPtr<void const>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  template<class U>
+  struct rebind {
+    using other = SharedMemoryAllocator<U>;
+  };
+
+  /// Creates an allocator for the segment that starts with `header`.
+  explicit SharedMemoryAllocator(SharedMemoryHeader* header) noexcept
+    : header_{header} {}
+
+  SharedMemoryAllocator(This const& other) noexcept
+    : header_{other.header_} {}
+
+  template<class U>
+  SharedMemoryAllocator(SharedMemoryAllocator<U> const& other) noexcept
+    : header_{other.header_} {}
+
+  This& operator=(This const& other) noexcept {
+    header_ = other.header_;
+    return *this;
+  }
+
+  /// Allocates space for `n` objects of type `T`.
+  pointer allocate(size_type n) {
+    static_assert(alignof(T) <= SharedMemoryHeader::kAlignment);
+    return pointer{static_cast<T*>(header_->allocate(n * sizeof(T)))};
+  }
+
+  /// Deallocates space obtained from `allocate(n)`.
+  void deallocate(pointer p, size_type n) noexcept {
+    header_->deallocate(p.get(), n * sizeof(T));
+  }
+
+  /// Returns the segment header.
+  SharedMemoryHeader* header() const noexcept {
+    return header_.get();
+  }
+
+  template<class U>
+  friend bool operator==(This const& a, SharedMemoryAllocator<U> const& b) {
+    return a.header_.get() == b.header_.get();
+  }
+
+  template<class U>
+  friend bool operator!=(This const& a, SharedMemoryAllocator<U> const& b) {
+    return !(a == b);
+  }
+};
+
+/**
+ *  @brief
+ *  POSIX shared memory segment (`shm_open` + `mmap`) that hosts one root
+ *    object and everything it allocates.
+ *
+ *  The creating process calls `create()` and `construct_root()`.
+ *  Other processes call `open()` with the same name and access the object
+ *    through `root()`, holding `lock()` as appropriate.
+ *  For example:
+ *
+ *      using Tree = ManagedTree<BasicTreeImpl<int, SharedMemoryAllocator<int>>>;
+ *      auto segment{SharedMemorySegment::create("/seq", 1 << 30)};
+ *      Tree* tree{segment.construct_root<Tree>(segment.allocator<int>())};
+ *
+ *  Readers in other processes should take `lock()` shared and only use
+ *    operations that do not modify the tree.
+ *  (Lookups in `SplayTreeImpl` do modify the tree.)
+ *
+ *  Destroying a `SharedMemorySegment` unmaps the segment but does not remove
+ *    it; call `remove()` for that.
+ */
+class SharedMemorySegment {
+ private:
+  /// This type.
+  using This = SharedMemorySegment;
+
+  /// Name passed to `shm_open`.
+  std::string name_;
+
+  /// Address where the segment is mapped.
+  void* address_{nullptr};
+
+  /// Size of the mapping in bytes.
+  std::size_t size_{0};
+
+  SharedMemorySegment(std::string name, void* address, std::size_t size)
+    : name_{std::move(name)}, address_{address}, size_{size} {}
+
+  [[noreturn]] static void throw_errno(char const* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  /// Maps `size` bytes of the shared memory object `fd`, then closes `fd`.
+  static void* map(int fd, std::size_t size) {
+    void* address{::mmap(
+        nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    int const map_errno{errno};
+    ::close(fd);
+    if (address == MAP_FAILED) {
+      errno = map_errno;
+      throw_errno("SharedMemorySegment -- mmap");
+    }
+    return address;
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates a new segment of `size` bytes.
+   *
+   *  Throws `std::system_error` if a segment with the same name exists.
+   */
+  static This create(std::string const& name, std::size_t size) {
+    int const fd{::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)};
+    if (fd < 0) {
+      throw_errno("SharedMemorySegment::create -- shm_open");
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      int const truncate_errno{errno};
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      errno = truncate_errno;
+      throw_errno("SharedMemorySegment::create -- ftruncate");
+    }
+    void* address{map(fd, size)};
+    auto* header{::new(address) SharedMemoryHeader{}};
+    header->capacity = size;
+    header->used = (sizeof(SharedMemoryHeader) +
+        SharedMemoryHeader::kAlignment - 1) &
+        ~(SharedMemoryHeader::kAlignment - 1);
+    header->magic = SharedMemoryHeader::kMagic;
+    return This{name, address, size};
+  }
+
+  /**
+   *  @brief
+   *  Maps an existing segment.
+   */
+  static This open(std::string const& name) {
+    int const fd{::shm_open(name.c_str(), O_RDWR, 0600)};
+    if (fd < 0) {
+      throw_errno("SharedMemorySegment::open -- shm_open");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      int const stat_errno{errno};
+      ::close(fd);
+      errno = stat_errno;
+      throw_errno("SharedMemorySegment::open -- fstat");
+    }
+    std::size_t const size{static_cast<std::size_t>(st.st_size)};
+    This segment{name, map(fd, size), size};
+    if (segment.header()->magic != SharedMemoryHeader::kMagic) {
+      throw std::runtime_error(
+          "SharedMemorySegment::open -- segment is not initialized");
+    }
+    return segment;
+  }
+
+  /**
+   *  @brief
+   *  Removes the segment with the given name.
+   *
+   *  Existing mappings stay valid until they are unmapped.
+   */
+  static void remove(std::string const& name) {
+    ::shm_unlink(name.c_str());
+  }
+
+  SharedMemorySegment(This const&) = delete;
+  This& operator=(This const&) = delete;
+
+  SharedMemorySegment(This&& other) noexcept
+    : name_{std::move(other.name_)},
+      address_{std::exchange(other.address_, nullptr)},
+      size_{std::exchange(other.size_, 0)} {}
+
+  This& operator=(This&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      name_ = std::move(other.name_);
+      address_ = std::exchange(other.address_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  /// Unmaps the segment.
+  ~SharedMemorySegment() {
+    unmap();
+  }
+
+  /// Unmaps the segment. The segment is not removed.
+  void unmap() {
+    if (address_) {
+      ::munmap(address_, size_);
+      address_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  /// Returns the name of the segment.
+  std::string const& name() const {
+    return name_;
+  }
+
+  /// Returns the address where the segment is mapped in this process.
+  void* address() const {
+    return address_;
+  }
+
+  /// Returns the size of the segment in bytes.
+  std::size_t size() const {
+    return size_;
+  }
+
+  /// Returns the number of bytes that have been carved from the segment.
+  std::size_t used() const {
+    return header()->used;
+  }
+
+  /// Returns the segment header.
+  SharedMemoryHeader* header() const {
+    return static_cast<SharedMemoryHeader*>(address_);
+  }
+
+  /// Returns an allocator for `T` that allocates from this segment.
+  template<class T>
+  SharedMemoryAllocator<T> allocator() const {
+    return SharedMemoryAllocator<T>{header()};
+  }
+
+  /// Returns the lock that protects the root object.
+  SharedRwLock& lock() const {
+    return header()->lock;
+  }
+
+  /**
+   *  @brief
+   *  Constructs the root object inside the segment and returns it.
+   *
+   *  There must not be a root object already.
+   */
+  template<class T, class... Args>
+  T* construct_root(Args&&... args) {
+    assert(!header()->root);
+    SharedMemoryAllocator<T> alloc{header()};
+    OffsetPtr<T> p{alloc.allocate(1)};
+    try {
+      ::new(static_cast<void*>(p.get())) T(std::forward<Args>(args)...);
+    } catch (...) {
+      alloc.deallocate(p, 1);
+      throw;
+    }
+    header()->root = p.get();
+    return p.get();
+  }
+
+  /**
+   *  @brief
+   *  Returns the root object, or null if there is none.
+   *
+   *  `T` must be the type that was passed to `construct_root()`.
+   */
+  template<class T>
+  T* root() const {
+    return static_cast<T*>(header()->root.get());
+  }
+
+  /**
+   *  @brief
+   *  Destroys the root object.
+   */
+  template<class T>
+  void destroy_root() {
+    T* p{root<T>()};
+    if (p) {
+      p->~T();
+      SharedMemoryAllocator<T>{header()}.deallocate(OffsetPtr<T>{p}, 1);
+      header()->root = nullptr;
+    }
+  }
+};
+
+} // namespace ordered_binary_trees
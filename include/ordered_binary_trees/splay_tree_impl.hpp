@@ -43,7 +43,7 @@ struct SplayTreeImpl: BasicTreeImpl<ValueT, AllocatorT> {
   using Node = typename Super::Node;
 
   /// Type of node allocators.
-  using Allocator = typename Super::Node;
+  using Allocator = typename Super::Allocator;
 
   /// Type of trees.
   using Tree = typename Super::Tree;
@@ -157,16 +157,18 @@ struct SplayTreeImpl: BasicTreeImpl<ValueT, AllocatorT> {
 
   /**
    *  @brief
-   *  Clears the tree and assigns values from `[input_begin, input_end)` to the
-   *    tree.
+   *  Replaces the values in the tree with values from
+   *    `[input_begin, input_end)`.
+   *
+   *  Existing nodes are reused, and the result is balanced.
+   *  (See `OrderedBinaryTree::assign_reusing_nodes()`.)
    */
   template<class InputIterator>
   static constexpr void assign(
       Tree& tree,
       InputIterator input_begin,
       InputIterator input_end) {
-    tree.destroy_all_nodes();
-    insert_nodes_before(tree, tree.first, input_begin, input_end);
+    tree.assign_reusing_nodes(input_begin, input_end);
   }
 
   /**
@@ -0,0 +1,1253 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ordered_binary_trees {
+
+/**
+ *  @brief
+ *  Random access iterator for `TieredVector`.
+ *
+ *  The iterator keeps its position as an index, and additionally caches a
+ *    pointer to the current element together with the contiguous run of
+ *    memory that contains it.
+ *  Stepping through a run only moves the pointer; the block lookup is
+ *    repeated only when the iterator leaves the run.
+ *
+ *  Unlike `OrderedBinaryTreeIterator`, this iterator refers to a *position*
+ *    rather than to an element, so insertions and erasures before the
+ *    position invalidate it in the same way as `std::deque` iterators.
+ *
+ *  Any `SequenceT` that provides `size()` and `locate_run()` can use this
+ *    iterator; `ImplicitSequence` does.
+ */
+template<class SequenceT, bool constant, bool reverse = false>
+class TieredVectorIterator {
+ private:
+  /// This type.
+  using This = TieredVectorIterator<SequenceT, constant, reverse>;
+
+ protected:
+  /// `SequenceT`.
+  using Sequence = SequenceT;
+
+  /// `Sequence::value_type`.
+  using Value = typename Sequence::value_type;
+
+  /// `Sequence const` if `constant` is `true`, `Sequence` otherwise.
+  using CondSequence = std::conditional_t<constant, Sequence const, Sequence>;
+
+  /// Pointer to the underlying sequence.
+  CondSequence* seq_{nullptr};
+  /// Position in iteration order. This is `seq_->size()` at the end.
+  typename Sequence::size_type index_{0};
+  /// Pointer to the current element, or null at the end.
+  Value* ptr_{nullptr};
+  /// Beginning of the contiguous run of memory that contains `ptr_`.
+  Value* lo_{nullptr};
+  /// End of the contiguous run of memory that contains `ptr_`.
+  Value* hi_{nullptr};
+
+  friend class TieredVectorIterator<Sequence, !constant, reverse>;
+  friend class TieredVectorIterator<Sequence, constant, !reverse>;
+  friend Sequence;
+
+  /// Recomputes `ptr_`, `lo_` and `hi_` from `index_`.
+  constexpr void seek() {
+    if (!seq_ || index_ >= seq_->size()) {
+      ptr_ = lo_ = hi_ = nullptr;
+      return;
+    }
+    typename Sequence::size_type i{index_};
+    if constexpr (reverse) {
+      i = seq_->size() - 1 - i;
+    }
+    std::tie(ptr_, lo_, hi_) = seq_->locate_run(i);
+  }
+
+ public:
+  using size_type = typename Sequence::size_type;
+  using difference_type = std::make_signed_t<size_type>;
+  using value_type = std::conditional_t<constant, Value const, Value>;
+  using pointer = std::add_pointer_t<value_type>;
+  using reference = std::add_lvalue_reference_t<value_type>;
+  using iterator_category = std::random_access_iterator_tag;
+
+  constexpr TieredVectorIterator(
+      CondSequence* seq = nullptr,
+      size_type index = 0)
+    : seq_{seq}, index_{index} {
+    seek();
+  }
+
+  constexpr TieredVectorIterator(This const&) = default;
+
+  constexpr This& operator=(This const&) = default;
+
+  /// Converts a mutable iterator to a constant one.
+  template<bool other_constant,
+      std::enable_if_t<constant && !other_constant, int> = 0>
+  constexpr TieredVectorIterator(
+      TieredVectorIterator<Sequence, other_constant, reverse> const& other)
+    : seq_{other.seq_},
+      index_{other.index_},
+      ptr_{other.ptr_},
+      lo_{other.lo_},
+      hi_{other.hi_} {}
+
+  constexpr size_type get_index() const {
+    return index_;
+  }
+
+  constexpr TieredVectorIterator<Sequence, constant, !reverse>
+      make_reverse_iterator() const {
+    assert(seq_);
+    return {seq_, seq_->size() - index_ - 1};
+  }
+
+  constexpr bool operator==(This const& other) const {
+    assert(seq_ == other.seq_);
+    return index_ == other.index_;
+  }
+
+  constexpr bool operator!=(This const& other) const {
+    assert(seq_ == other.seq_);
+    return index_ != other.index_;
+  }
+
+  constexpr reference operator*() const {
+    assert(ptr_);
+    return *ptr_;
+  }
+
+  constexpr pointer operator->() const {
+    assert(ptr_);
+    return ptr_;
+  }
+
+  constexpr This& operator++() {
+    assert(ptr_);
+    ++index_;
+    if constexpr (reverse) {
+      if (ptr_ == lo_) {
+        seek();
+      } else {
+        --ptr_;
+      }
+    } else {
+      if (++ptr_ == hi_) {
+        seek();
+      }
+    }
+    return *this;
+  }
+
+  constexpr This operator++(int) {
+    This result{*this};
+    operator++();
+    return result;
+  }
+
+  constexpr This& operator--() {
+    assert(index_ > 0);
+    --index_;
+    if (!ptr_) {
+      seek();
+    } else if constexpr (reverse) {
+      if (++ptr_ == hi_) {
+        seek();
+      }
+    } else {
+      if (ptr_ == lo_) {
+        seek();
+      } else {
+        --ptr_;
+      }
+    }
+    return *this;
+  }
+
+  constexpr This operator--(int) {
+    This result{*this};
+    operator--();
+    return result;
+  }
+
+  template<class Integer,
+      std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+  constexpr This& operator+=(Integer steps) {
+    index_ = static_cast<size_type>(
+        static_cast<difference_type>(index_) +
+        static_cast<difference_type>(steps));
+    seek();
+    return *this;
+  }
+
+  template<class Integer,
+      std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+  constexpr This operator+(Integer steps) const {
+    This result{*this};
+    result += steps;
+    return result;
+  }
+
+  template<class Integer,
+      std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+  constexpr This& operator-=(Integer steps) {
+    return operator+=(-static_cast<difference_type>(steps));
+  }
+
+  template<class Integer,
+      std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+  constexpr This operator-(Integer steps) const {
+    This result{*this};
+    result -= steps;
+    return result;
+  }
+
+  template<class Integer,
+      std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+  constexpr reference operator[](Integer steps) const {
+    return *(operator+(steps));
+  }
+
+  constexpr difference_type operator-(This const& other) const {
+    assert(seq_ == other.seq_);
+    return static_cast<difference_type>(index_) -
+        static_cast<difference_type>(other.index_);
+  }
+
+  constexpr bool operator<(This const& other) const {
+    assert(seq_ == other.seq_);
+    return index_ < other.index_;
+  }
+
+  constexpr bool operator>(This const& other) const {
+    assert(seq_ == other.seq_);
+    return index_ > other.index_;
+  }
+
+  constexpr bool operator<=(This const& other) const {
+    assert(seq_ == other.seq_);
+    return index_ <= other.index_;
+  }
+
+  constexpr bool operator>=(This const& other) const {
+    assert(seq_ == other.seq_);
+    return index_ >= other.index_;
+  }
+
+};
+
+/**
+ *  @brief
+ *  Tiered vector: a list data structure made of equally sized circular
+ *    buffers, called *blocks*.
+ *
+ *  Every block except the last one is full, so the block that contains the
+ *    `index`-th element is simply `index / B`, where `B` is the block
+ *    capacity.
+ *  This gives O(1) `operator[]`.
+ *  Inserting or erasing in the middle shifts elements inside one block, then
+ *    moves one element between each pair of adjacent blocks up to the end.
+ *  Because blocks are circular, moving an element across a block boundary
+ *    takes O(1), so the total cost is O(B + n / B).
+ *  `B` is a power of two that is kept close to `sqrt(n)`, which makes
+ *    insertion and erasure O(sqrt(n)).
+ *
+ *  The public interface mirrors that of `ManagedTree`, so this class can be
+ *    used through `ManagedTree<TieredVectorImpl<...>>`.
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+class TieredVector {
+ private:
+  /// This type.
+  using This = TieredVector<ValueT, AllocatorT>;
+
+ public:
+  /// Type of values.
+  using value_type = ValueT;
+
+  /// Type of the allocator for values.
+  using allocator_type = typename std::allocator_traits<AllocatorT>::
+      template rebind_alloc<value_type>;
+
+  /// `size_type` derived from `allocator_type`.
+  using size_type = typename std::allocator_traits<allocator_type>::size_type;
+
+  /// `difference_type` derived from `allocator_type`.
+  using difference_type = typename std::allocator_traits<allocator_type>::
+      difference_type;
+
+  /// `value_type&`.
+  using reference = value_type&;
+
+  /// `value_type const&`.
+  using const_reference = value_type const&;
+
+  /// `pointer` type dervied from `allocator_type`.
+  using pointer = typename std::allocator_traits<allocator_type>::pointer;
+
+  /// `const_pointer` type dervied from `allocator_type`.
+  using const_pointer = typename std::allocator_traits<allocator_type>::
+      const_pointer;
+
+ protected:
+  /// Parametrized iterator type.
+  template<bool constant = false, bool reverse = false>
+  using p_iterator = TieredVectorIterator<This, constant, reverse>;
+
+  template<class SequenceT, bool constant, bool reverse>
+  friend class TieredVectorIterator;
+
+ public:
+  /// Type of iterators.
+  using iterator = p_iterator<false, false>;
+  /// Type of const-iterators.
+  using const_iterator = p_iterator<true, false>;
+  /// Type of reverse-iterators.
+  using reverse_iterator = p_iterator<false, true>;
+  /// Type of const-reverse-iterators.
+  using const_reverse_iterator = p_iterator<true, true>;
+
+  /// Base-2 logarithm of the smallest block capacity.
+  static constexpr unsigned kMinBlockShift{4};
+
+ protected:
+  /**
+   *  @brief
+   *  Circular buffer with capacity `1 << block_shift_`.
+   *
+   *  The `j`-th element of the block is stored at
+   *    `slots[(head + j) & block_mask()]`.
+   */
+  struct Block {
+    /// Storage. Only `count` slots starting from `head` are constructed.
+    pointer slots;
+    /// Slot of the first element.
+    size_type head;
+    /// Number of elements.
+    size_type count;
+  };
+
+  /// Allocator for `Block`s.
+  using BlockAllocator = typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<Block>;
+
+  /// Allocator for values.
+  mutable allocator_type allocator_;
+
+  /// Blocks. Only the last block may be partially filled, and none is empty.
+  std::vector<Block, BlockAllocator> blocks_;
+
+  /// Number of elements.
+  size_type size_{0};
+
+  /// Base-2 logarithm of the block capacity.
+  unsigned block_shift_{kMinBlockShift};
+
+  /// Capacity of every block.
+  constexpr size_type block_capacity() const {
+    return size_type{1} << block_shift_;
+  }
+
+  /// `block_capacity() - 1`.
+  constexpr size_type block_mask() const {
+    return block_capacity() - 1;
+  }
+
+  /// Returns the `j`-th element of `block`.
+  constexpr value_type* slot(Block const& block, size_type j) const {
+    return std::addressof(block.slots[(block.head + j) & block_mask()]);
+  }
+
+  /// Returns the element at `index` together with its contiguous run.
+  constexpr std::tuple<value_type*, value_type*, value_type*> locate_run(
+      size_type index) const {
+    assert(index < size_);
+    Block const& block{blocks_[index >> block_shift_]};
+    size_type const s{(block.head + (index & block_mask())) & block_mask()};
+    value_type* base{std::addressof(block.slots[0])};
+    size_type const tail{block.head + block.count};
+    if (tail <= block_capacity()) {
+      return {base + s, base + block.head, base + tail};
+    } else if (s >= block.head) {
+      return {base + s, base + block.head, base + block_capacity()};
+    }
+    return {base + s, base, base + (tail - block_capacity())};
+  }
+
+  /// Returns the element at `index`.
+  constexpr value_type* locate(size_type index) const {
+    assert(index < size_);
+    return slot(blocks_[index >> block_shift_], index & block_mask());
+  }
+
+  /// Appends an empty block.
+  void add_block() {
+    blocks_.push_back(Block{
+        std::allocator_traits<allocator_type>::allocate(
+          allocator_, block_capacity()),
+        0,
+        0});
+  }
+
+  /// Destroys the elements of the last block and deallocates it.
+  void remove_last_block() {
+    Block& block{blocks_.back()};
+    for (size_type j{0}; j < block.count; ++j) {
+      std::allocator_traits<allocator_type>::destroy(
+          allocator_, slot(block, j));
+    }
+    std::allocator_traits<allocator_type>::deallocate(
+        allocator_, block.slots, block_capacity());
+    blocks_.pop_back();
+  }
+
+  /// Moves the last element of `from` to the front of `to`.
+  void shift_back_to_front(Block& from, Block& to) {
+    assert(from.count > 0);
+    assert(to.count < block_capacity());
+    value_type* src{slot(from, from.count - 1)};
+    to.head = (to.head - 1) & block_mask();
+    std::allocator_traits<allocator_type>::construct(
+        allocator_, slot(to, 0), std::move(*src));
+    ++to.count;
+    std::allocator_traits<allocator_type>::destroy(allocator_, src);
+    --from.count;
+  }
+
+  /// Moves the first element of `from` to the back of `to`.
+  void shift_front_to_back(Block& from, Block& to) {
+    assert(from.count > 0);
+    assert(to.count < block_capacity());
+    value_type* src{slot(from, 0)};
+    std::allocator_traits<allocator_type>::construct(
+        allocator_, slot(to, to.count), std::move(*src));
+    ++to.count;
+    std::allocator_traits<allocator_type>::destroy(allocator_, src);
+    from.head = (from.head + 1) & block_mask();
+    --from.count;
+  }
+
+  /**
+   *  @brief
+   *  Opens a gap at the `j`-th position of a non-full `block` and moves
+   *    `value` into it.
+   *
+   *  The shorter side of the block is shifted.
+   */
+  void insert_into_block(Block& block, size_type j, value_type&& value) {
+    assert(block.count < block_capacity());
+    assert(j <= block.count);
+    if (j < block.count - j) {
+      // Shift [0, j) one slot towards the front.
+      block.head = (block.head - 1) & block_mask();
+      ++block.count;
+      if (j == 0) {
+        std::allocator_traits<allocator_type>::construct(
+            allocator_, slot(block, 0), std::move(value));
+        return;
+      }
+      std::allocator_traits<allocator_type>::construct(
+          allocator_, slot(block, 0), std::move(*slot(block, 1)));
+      for (size_type k{1}; k < j; ++k) {
+        *slot(block, k) = std::move(*slot(block, k + 1));
+      }
+      *slot(block, j) = std::move(value);
+      return;
+    }
+    // Shift [j, count) one slot towards the back.
+    size_type const count{block.count};
+    ++block.count;
+    if (j == count) {
+      std::allocator_traits<allocator_type>::construct(
+          allocator_, slot(block, count), std::move(value));
+      return;
+    }
+    std::allocator_traits<allocator_type>::construct(
+        allocator_, slot(block, count), std::move(*slot(block, count - 1)));
+    for (size_type k{count - 1}; k > j; --k) {
+      *slot(block, k) = std::move(*slot(block, k - 1));
+    }
+    *slot(block, j) = std::move(value);
+  }
+
+  /**
+   *  @brief
+   *  Removes the `j`-th element of `block`, closing the gap by shifting the
+   *    shorter side.
+   */
+  void erase_from_block(Block& block, size_type j) {
+    assert(j < block.count);
+    if (j < block.count - 1 - j) {
+      for (size_type k{j}; k > 0; --k) {
+        *slot(block, k) = std::move(*slot(block, k - 1));
+      }
+      std::allocator_traits<allocator_type>::destroy(
+          allocator_, slot(block, 0));
+      block.head = (block.head + 1) & block_mask();
+    } else {
+      for (size_type k{j}; k + 1 < block.count; ++k) {
+        *slot(block, k) = std::move(*slot(block, k + 1));
+      }
+      std::allocator_traits<allocator_type>::destroy(
+          allocator_, slot(block, block.count - 1));
+    }
+    --block.count;
+  }
+
+  /**
+   *  @brief
+   *  Moves all elements into blocks of capacity `1 << new_shift`.
+   *
+   *  This takes O(n).
+   */
+  void relayout(unsigned new_shift) {
+    This other{allocator_};
+    other.block_shift_ = new_shift;
+    other.blocks_.reserve((size_ >> new_shift) + 1);
+    for (Block& block : blocks_) {
+      for (size_type j{0}; j < block.count; ++j) {
+        other.emplace_back(std::move(*slot(block, j)));
+      }
+    }
+    clear();
+    std::swap(blocks_, other.blocks_);
+    std::swap(size_, other.size_);
+    std::swap(block_shift_, other.block_shift_);
+  }
+
+  /**
+   *  @brief
+   *  Grows or shrinks the block capacity when it drifts too far from
+   *    `sqrt(size())`.
+   *
+   *  The thresholds are a factor of 4 apart, so a relayout is amortized over
+   *    at least `Omega(n)` operations.
+   */
+  void rebalance_block_capacity() {
+    size_type const capacity{block_capacity()};
+    if (blocks_.size() > 2 * capacity) {
+      relayout(block_shift_ + 1);
+    } else if (block_shift_ > kMinBlockShift &&
+        blocks_.size() * 8 < capacity) {
+      relayout(block_shift_ - 1);
+    }
+  }
+
+  /// Converts `index` into an iterator.
+  template<bool constant = false, bool reverse = false>
+  p_iterator<constant, reverse> make_iterator(size_type index) const {
+    return {const_cast<This*>(this), index};
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` at `index`.
+   */
+  void insert_at(size_type index, value_type&& value) {
+    assert(index <= size_);
+    if (blocks_.empty() || blocks_.back().count == block_capacity()) {
+      add_block();
+    }
+    size_type const b{index >> block_shift_};
+    for (size_type k{blocks_.size() - 1}; k > b; --k) {
+      shift_back_to_front(blocks_[k - 1], blocks_[k]);
+    }
+    insert_into_block(blocks_[b], index & block_mask(), std::move(value));
+    ++size_;
+  }
+
+  /**
+   *  @brief
+   *  Erases the element at `index`.
+   */
+  void erase_at(size_type index) {
+    assert(index < size_);
+    size_type const b{index >> block_shift_};
+    erase_from_block(blocks_[b], index & block_mask());
+    for (size_type k{b + 1}; k < blocks_.size(); ++k) {
+      shift_front_to_back(blocks_[k], blocks_[k - 1]);
+    }
+    if (blocks_.back().count == 0) {
+      remove_last_block();
+    }
+    --size_;
+  }
+
+  /**
+   *  @brief
+   *  Erases `[first, last)` by shifting the tail down, then truncating.
+   *
+   *  This takes O(n - first).
+   */
+  void erase_range_by_compaction(size_type first, size_type last) {
+    for (size_type i{last}; i < size_; ++i) {
+      *locate(first + i - last) = std::move(*locate(i));
+    }
+    for (size_type i{last}; i > first; --i) {
+      pop_back_without_rebalancing();
+    }
+  }
+
+  /// Erases the last element without adjusting the block capacity.
+  void pop_back_without_rebalancing() {
+    assert(size_ > 0);
+    Block& block{blocks_.back()};
+    std::allocator_traits<allocator_type>::destroy(
+        allocator_, slot(block, block.count - 1));
+    if (--block.count == 0) {
+      remove_last_block();
+    }
+    --size_;
+  }
+
+ public:
+  /**
+   *  @brief
+   *  Creates an empty sequence with a given `allocator`.
+   */
+  TieredVector(allocator_type const& allocator = allocator_type())
+    : allocator_{allocator}, blocks_{BlockAllocator{allocator}} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence using the given `allocator`.
+   */
+  TieredVector(This const& other, allocator_type const& allocator)
+    : TieredVector{allocator} {
+    block_shift_ = other.block_shift_;
+    blocks_.reserve(other.blocks_.size());
+    for (auto const& value : other) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Copies data from another sequence. The allocator is copied via
+   *    `select_on_container_copy_construction()`.
+   */
+  TieredVector(This const& other)
+    : TieredVector{other,
+        std::allocator_traits<allocator_type>::
+          select_on_container_copy_construction(other.allocator_)} {}
+
+  /**
+   *  @brief
+   *  Copies data from another sequence if `allocator != other.allocator`,
+   *    or takes ownership of the data from another sequence otherwise.
+   */
+  TieredVector(This&& other, allocator_type const& allocator)
+    : TieredVector{allocator} {
+    if (allocator_ == other.allocator_) {
+      std::swap(blocks_, other.blocks_);
+      std::swap(size_, other.size_);
+      std::swap(block_shift_, other.block_shift_);
+    } else {
+      for (auto& value : other) {
+        emplace_back(std::move(value));
+      }
+      other.clear();
+    }
+  }
+
+  /**
+   *  @brief
+   *  Moves data from another sequence.
+   */
+  TieredVector(This&& other)
+    : allocator_{std::move(other.allocator_)},
+      blocks_{std::move(other.blocks_)},
+      size_{other.size_},
+      block_shift_{other.block_shift_} {
+    other.blocks_.clear();
+    other.size_ = 0;
+    other.block_shift_ = kMinBlockShift;
+  }
+
+  /**
+   *  @brief
+   *  Destroys the sequence.
+   */
+  ~TieredVector() {
+    clear();
+  }
+
+  /**
+   *  @brief
+   *  Empties the sequence.
+   */
+  void clear() {
+    while (!blocks_.empty()) {
+      remove_last_block();
+    }
+    size_ = 0;
+    block_shift_ = kMinBlockShift;
+  }
+
+  /**
+   *  @brief
+   *  Copies the sequence from `other`.
+   */
+  This& operator=(This const& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_copy_assignment::value) {
+      allocator_ = other.allocator_;
+    }
+    block_shift_ = other.block_shift_;
+    for (auto const& value : other) {
+      emplace_back(value);
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Takes the sequence from `other`.
+   */
+  This& operator=(This&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_move_assignment::value) {
+      allocator_ = std::move(other.allocator_);
+    }
+    swap(other);
+    return *this;
+  }
+
+  /**
+   *  @brief
+   *  Swaps this sequence with `other`.
+   */
+  void swap(This& other) {
+    if constexpr (std::allocator_traits<allocator_type>::
+        propagate_on_container_swap::value) {
+      using std::swap;
+      swap(allocator_, other.allocator_);
+    }
+    std::swap(blocks_, other.blocks_);
+    std::swap(size_, other.size_);
+    std::swap(block_shift_, other.block_shift_);
+  }
+
+  /**
+   *  @brief
+   *  Returns the number of elements in the sequence.
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   *  @brief
+   *  Returns `true` iff the sequence is empty.
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   *  @brief
+   *  Returns the allocator.
+   */
+  allocator_type get_allocator() const noexcept {
+    return allocator_;
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `[first, last)` to it.
+   */
+  template<class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    clear();
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns values from `ilist` to it.
+   */
+  template<class V>
+  void assign(std::initializer_list<V> ilist) {
+    assign(ilist.begin(), ilist.end());
+  }
+
+  /**
+   *  @brief
+   *  Clears the sequence and assigns `n` copies of `value` to it.
+   */
+  void assign(size_type n, value_type const& value) {
+    clear();
+    for (size_type i{0}; i < n; ++i) {
+      emplace_back(value);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference operator[](size_type index) {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference operator[](size_type index) const {
+    return *locate(index);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("TieredVector::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the `index`-th element.
+   */
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("TieredVector::at -- index out of range");
+    }
+    return operator[](pos);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  reference front() {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the first element.
+   */
+  const_reference front() const {
+    return *locate(0);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  reference back() {
+    return *locate(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Accesses the last element.
+   */
+  const_reference back() const {
+    return *locate(size_ - 1);
+  }
+
+  /// Returns the iterator to the first element.
+  iterator begin() {
+    return make_iterator(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator begin() const {
+    return make_iterator<true>(0);
+  }
+
+  /// Returns the const-iterator to the first element.
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  /// Returns the reverse-iterator to the last element.
+  reverse_iterator rbegin() {
+    return make_iterator<false, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator rbegin() const {
+    return make_iterator<true, true>(0);
+  }
+
+  /// Returns the const-reverse-iterator to the last element.
+  const_reverse_iterator crbegin() const {
+    return rbegin();
+  }
+
+  /// Returns the past-the-end iterator.
+  iterator end() {
+    return make_iterator(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator end() const {
+    return make_iterator<true>(size_);
+  }
+
+  /// Returns the past-the-end const-iterator.
+  const_iterator cend() const {
+    return end();
+  }
+
+  /// Returns the past-the-beginning reverse-iterator.
+  reverse_iterator rend() {
+    return make_iterator<false, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator rend() const {
+    return make_iterator<true, true>(size_);
+  }
+
+  /// Returns the past-the-beginning const-reverse-iterator.
+  const_reverse_iterator crend() const {
+    return rend();
+  }
+
+  /**
+   *  @brief
+   *  Returns an iterator for the `index`-th element.
+   */
+  iterator get_iterator_at_index(size_type index) {
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Returns a const-iterator for the `index`-th element.
+   */
+  const_iterator get_iterator_at_index(size_type index) const {
+    return make_iterator<true>(index);
+  }
+
+  /// Returns an iterator for the first element.
+  iterator get_front_iterator() {
+    return begin();
+  }
+
+  /// Returns a const-iterator for the first element.
+  const_iterator get_front_iterator() const {
+    return begin();
+  }
+
+  /// Returns an iterator for the last element.
+  iterator get_back_iterator() {
+    assert(!empty());
+    return make_iterator(size_ - 1);
+  }
+
+  /// Returns a const-iterator for the last element.
+  const_iterator get_back_iterator() const {
+    assert(!empty());
+    return make_iterator<true>(size_ - 1);
+  }
+
+  /**
+   *  @brief
+   *  Converts a const-iterator to a regular iterator.
+   *
+   *  This function works on reverse iterators also.
+   */
+  template<bool constant = false, bool reverse = false>
+  p_iterator<false, reverse> make_mutable_iterator(
+      p_iterator<constant, reverse> it) const {
+    return make_iterator<false, reverse>(it.index_);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type const& value) {
+    return emplace(pos, value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` right before `pos` and returns the iterator to the newly
+   *    inserted value.
+   */
+  template<bool constant>
+  iterator insert(p_iterator<constant> pos, value_type&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a new `value` and inserts it right before `pos`, then returns
+   *    the iterator to the newly inserted value.
+   */
+  template<bool constant, class... Args>
+  iterator emplace(p_iterator<constant> pos, Args&&... args) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    insert_at(index, value_type(std::forward<Args>(args)...));
+    rebalance_block_capacity();
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Inserts a list of values from `[first, last)` right before `pos`, then
+   *    returns the iterator to the first value that was inserted.
+   *
+   *  Short ranges are inserted one element at a time.
+   *  Long ranges are inserted by temporarily moving the tail out, appending
+   *    the new values, and appending the tail back, which takes
+   *    O(n - index + count).
+   */
+  template<bool constant, class InputIterator>
+  iterator insert(
+      p_iterator<constant> pos,
+      InputIterator first,
+      InputIterator last) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    std::vector<value_type, allocator_type> values(first, last, allocator_);
+    if (values.size() <= block_capacity()) {
+      for (size_type i{0}; i < values.size(); ++i) {
+        insert_at(index + i, std::move(values[i]));
+      }
+    } else {
+      std::vector<value_type, allocator_type> tail(allocator_);
+      tail.reserve(size_ - index);
+      for (size_type i{index}; i < size_; ++i) {
+        tail.push_back(std::move(*locate(i)));
+      }
+      while (size_ > index) {
+        pop_back_without_rebalancing();
+      }
+      for (auto& value : values) {
+        emplace_back(std::move(value));
+      }
+      for (auto& value : tail) {
+        emplace_back(std::move(value));
+      }
+    }
+    rebalance_block_capacity();
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Moves elements from `other` right before `pos`, then returns the iterator
+   *    to the first moved element.
+   *
+   *  `other` will be empty afterwards.
+   */
+  template<bool constant>
+  iterator join(p_iterator<constant> pos, This& other) {
+    assert(pos.seq_ == this);
+    if (empty() && allocator_ == other.allocator_) {
+      swap(other);
+      return begin();
+    }
+    iterator it{insert(
+        pos,
+        std::make_move_iterator(other.begin()),
+        std::make_move_iterator(other.end()))};
+    other.clear();
+    return it;
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(begin(), other)`.
+   */
+  iterator join_front(This& other) {
+    return join(begin(), other);
+  }
+
+  /**
+   *  @brief
+   *  Similar to `join(end(), other)`.
+   */
+  iterator join_back(This& other) {
+    return join(end(), other);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type const& value) {
+    emplace_front(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the first element.
+   */
+  void push_front(value_type&& value) {
+    emplace_front(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the first element.
+   */
+  template<class... Args>
+  void emplace_front(Args&&... args) {
+    emplace(begin(), std::forward<Args>(args)...);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type const& value) {
+    emplace_back(value);
+  }
+
+  /**
+   *  @brief
+   *  Inserts `value` as the last element.
+   */
+  void push_back(value_type&& value) {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   *  @brief
+   *  Constructs a value and inserts it as the last element.
+   *
+   *  This takes amortized O(1).
+   */
+  template<class... Args>
+  void emplace_back(Args&&... args) {
+    if (blocks_.empty() || blocks_.back().count == block_capacity()) {
+      add_block();
+    }
+    Block& block{blocks_.back()};
+    std::allocator_traits<allocator_type>::construct(
+        allocator_, slot(block, block.count), std::forward<Args>(args)...);
+    ++block.count;
+    ++size_;
+    if (blocks_.size() > 2 * block_capacity()) {
+      relayout(block_shift_ + 1);
+    }
+  }
+
+  /**
+   *  @brief
+   *  Erases an element pointed to by `pos`, then returns the iterator to the
+   *    position right after `pos`.
+   */
+  template<bool constant>
+  iterator erase(p_iterator<constant> pos) {
+    assert(pos.seq_ == this);
+    size_type const index{pos.index_};
+    erase_at(index);
+    rebalance_block_capacity();
+    return make_iterator(index);
+  }
+
+  /**
+   *  @brief
+   *  Erases elements in the interval `[first, last)`, then returns the
+   *    iterator to the position right after the erased elements.
+   */
+  template<bool constant_1, bool constant_2>
+  iterator erase(
+      p_iterator<constant_1> first,
+      p_iterator<constant_2> last) {
+    assert(first.seq_ == this);
+    assert(last.seq_ == this);
+    assert(first <= last);
+    size_type const begin_index{first.index_};
+    size_type const end_index{last.index_};
+    size_type const count{end_index - begin_index};
+    if (count <= 1 || count * block_capacity() < size_ - begin_index) {
+      for (size_type i{0}; i < count; ++i) {
+        erase_at(begin_index);
+      }
+    } else {
+      erase_range_by_compaction(begin_index, end_index);
+    }
+    rebalance_block_capacity();
+    return make_iterator(begin_index);
+  }
+
+  /**
+   *  @brief
+   *  Erases the first element.
+   */
+  void pop_front() {
+    assert(!empty());
+    erase_at(0);
+    rebalance_block_capacity();
+  }
+
+  /**
+   *  @brief
+   *  Erases the last element.
+   */
+  void pop_back() {
+    assert(!empty());
+    pop_back_without_rebalancing();
+    rebalance_block_capacity();
+  }
+
+};
+
+/**
+ *  @brief
+ *  Implementation struct that makes `ManagedTree<TieredVectorImpl<...>>` a
+ *    `TieredVector`.
+ *
+ *  `TieredVector` is not a binary tree, so instead of the node-level
+ *    functions found in `BasicTreeImpl`, this struct only names the
+ *    `Container` that `ManagedTree` should expose.
+ *
+ *  A tiered vector is a good fit for read-dominated sequences: `operator[]`
+ *    is O(1) and iteration walks contiguous memory, while insertion and
+ *    erasure in the middle cost O(sqrt(n)).
+ */
+template<class ValueT, class AllocatorT = std::allocator<ValueT>>
+struct TieredVectorImpl {
+  /// This type.
+  using This = TieredVectorImpl<ValueT, AllocatorT>;
+
+  /// Type of values to present to the user.
+  using Value = ValueT;
+
+  /// Type of allocators for `Value`.
+  using ValueAllocator = AllocatorT;
+
+  /// Container that provides the interface of `ManagedTree`.
+  using Container = TieredVector<Value, ValueAllocator>;
+};
+
+} // namespace ordered_binary_trees
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/buffered_tree_impl.hpp>
+#include <ordered_binary_trees/managed_tree.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using Tree = obt::ManagedTree<obt::BufferedTreeImpl<Value>>;
+
+// Tiny nodes and buffers give deep trees with many pending messages.
+using SmallTree = obt::BufferedTree<Value, allocator<Value>, 4, 4, 3>;
+
+TEST_CASE("BufferedTree - iteration across pending messages") {
+  SmallTree tree;
+  static constexpr size_t kLength{5000};
+  for (size_t i{0}; i < kLength; ++i) {
+    if (i % 3 == 0) {
+      tree.push_front(i);
+    } else {
+      tree.push_back(i);
+    }
+  }
+  vector<Value> forward(tree.begin(), tree.end());
+  vector<Value> backward(tree.rbegin(), tree.rend());
+  reverse(backward.begin(), backward.end());
+  CHECK(forward == backward);
+
+  auto it{tree.end()};
+  for (size_t i{kLength}; i > 0; --i) {
+    --it;
+    CHECK(*it == forward[i - 1]);
+    CHECK(it - tree.begin() == static_cast<ptrdiff_t>(i - 1));
+  }
+  CHECK(it == tree.begin());
+  CHECK(tree.rend()[-1] == tree.front());
+  CHECK(tree.rbegin()[0] == tree.back());
+}
+
+TEST_CASE("BufferedTree - random operations") {
+  check_random_sequence_operations<SmallTree>(3000);
+}
+
+TEST_CASE("BufferedTree - flush and modification through references") {
+  SmallTree tree;
+  deque<Value> list;
+  IndexRand rand{};
+  for (size_t i{0}; i < 2000; ++i) {
+    size_t index{rand(tree.size() + 1)};
+    tree.insert(tree.get_iterator_at_index(index), i);
+    list.insert(list.begin() + index, i);
+  }
+  // Some of these elements are still in messages, others in leaves.
+  for (size_t i{0}; i < list.size(); i += 7) {
+    tree[i] += 1000000;
+    list[i] += 1000000;
+  }
+  check_sequence_equal(tree, list);
+  tree.flush();
+  check_sequence_equal(tree, list);
+  for (size_t i{0}; i < 1500; ++i) {
+    size_t index{rand(tree.size())};
+    tree.erase(tree.get_iterator_at_index(index));
+    list.erase(list.begin() + index);
+  }
+  check_sequence_equal(tree, list);
+  tree.flush();
+  check_sequence_equal(tree, list);
+  while (!tree.empty()) {
+    tree.pop_front();
+    list.pop_front();
+  }
+  tree.flush();
+  CHECK(tree.begin() == tree.end());
+  CHECK_THROWS_AS(tree.at(0), out_of_range);
+}
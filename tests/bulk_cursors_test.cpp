@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/bulk_cursors.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>>;
+
+template<class Tree>
+void check_equal(Tree const& tree, vector<Value> const& list) {
+  REQUIRE(tree.size() == list.size());
+  REQUIRE(equal(tree.begin(), tree.end(), list.begin()));
+  for (size_t i{0}; i < list.size(); ++i) {
+    REQUIRE(tree[i] == list[i]);
+  }
+}
+
+/// Returns a tree of `n` random values with a random shape.
+template<class Tree>
+Tree make_random_tree(size_t n, IndexRand& rand, vector<Value>& list) {
+  Tree tree;
+  list.clear();
+  for (size_t i{0}; i < n; ++i) {
+    size_t const index{rand(list.size() + 1)};
+    Value const value{rand(1000)};
+    tree.emplace(tree.begin() + index, value);
+    list.insert(list.begin() + index, value);
+  }
+  return tree;
+}
+
+TEMPLATE_LIST_TEST_CASE("BulkCursors - traversal", "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+  IndexRand rand{};
+  vector<Value> list;
+  Tree tree{make_random_tree<Tree>(200, rand, list)};
+
+  ostringstream out;
+  size_t steps{0};
+  obt::TraversalCursor cursor{
+      tree, [&out](Value const& value) { out << value << ' '; }};
+  while (!cursor.step(7)) {
+    ++steps;
+  }
+  CHECK(steps == 200 / 7);
+  CHECK(cursor.done());
+  CHECK(cursor.step(7));
+
+  ostringstream expected;
+  for (Value value : list) {
+    expected << value << ' ';
+  }
+  CHECK(out.str() == expected.str());
+}
+
+TEMPLATE_LIST_TEST_CASE("BulkCursors - traversal with edits", "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+  Tree tree;
+  for (Value value{0}; value < 8; ++value) {
+    tree.push_back(value);
+  }
+  vector<Value> visited;
+  obt::TraversalCursor cursor{
+      tree, [&visited](Value const& value) { visited.push_back(value); }};
+  cursor.step(3);
+  // Edits away from the next element do not disturb the cursor.
+  tree.erase(tree.begin());
+  tree.insert(tree.begin() + 1, 100);
+  tree.insert(tree.end(), 8);
+  while (!cursor.step(2)) {}
+  CHECK(visited == vector<Value>{0, 1, 2, 3, 4, 5, 6, 7, 8});
+}
+
+TEMPLATE_LIST_TEST_CASE("BulkCursors - clone", "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+  IndexRand rand{};
+  vector<Value> list;
+  for (size_t n : {0, 1, 2, 50, 333}) {
+    Tree tree{make_random_tree<Tree>(n, rand, list)};
+    obt::CloneCursor<TestType> cursor{tree};
+    size_t calls{1};
+    while (!cursor.step(5)) {
+      ++calls;
+    }
+    CHECK(calls == max<size_t>(1, (n + 4) / 5));
+    Tree copy{cursor.take()};
+    check_equal(copy, list);
+    check_equal(tree, list);
+    copy.push_back(1);
+    copy.erase(copy.begin());
+    check_equal(tree, list);
+  }
+
+  // A partial copy is destroyed with the cursor.
+  Tree tree{make_random_tree<Tree>(100, rand, list)};
+  {
+    obt::CloneCursor<TestType> cursor{tree};
+    CHECK(!cursor.step(40));
+  }
+  check_equal(tree, list);
+}
+
+TEMPLATE_LIST_TEST_CASE("BulkCursors - destruction", "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+  IndexRand rand{};
+  vector<Value> list;
+  Tree tree{make_random_tree<Tree>(300, rand, list)};
+  {
+    obt::DestructionCursor<TestType> cursor{tree};
+    CHECK(tree.empty());
+    CHECK(tree.begin() == tree.end());
+    tree.push_back(5);
+    check_equal(tree, {5});
+
+    // Each node takes one destruction and at most one rotation.
+    size_t steps{0};
+    while (!cursor.step(10)) {
+      ++steps;
+    }
+    CHECK(steps < 2 * 300 / 10);
+    CHECK(cursor.done());
+  }
+
+  // Nodes that are left are destroyed with the cursor.
+  tree = make_random_tree<Tree>(100, rand, list);
+  {
+    obt::DestructionCursor<TestType> cursor{tree};
+    CHECK(!cursor.step(20));
+  }
+  CHECK(tree.empty());
+}
+
+TEMPLATE_LIST_TEST_CASE("BulkCursors - build and join", "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+  IndexRand rand{};
+  vector<Value> values(257);
+  for (Value& value : values) {
+    value = rand(1000);
+  }
+  for (size_t n : {0, 1, 2, 3, 100, 257}) {
+    obt::BuildCursor<TestType, vector<Value>::const_iterator> cursor{
+        values.cbegin(), n};
+    size_t calls{1};
+    while (!cursor.step(8)) {
+      ++calls;
+    }
+    CHECK(calls == max<size_t>(1, (n + 7) / 8));
+    Tree built{cursor.take()};
+    check_equal(built, vector<Value>(values.begin(), values.begin() + n));
+
+    vector<Value> list;
+    Tree tree{make_random_tree<Tree>(20, rand, list)};
+    size_t const index{rand(list.size() + 1)};
+    tree.join(tree.begin() + index, built);
+    list.insert(list.begin() + index, values.begin(), values.begin() + n);
+    CHECK(built.empty());
+    check_equal(tree, list);
+  }
+
+  // A partial tree is destroyed with the cursor.
+  obt::BuildCursor<TestType, vector<Value>::const_iterator> cursor{
+      values.cbegin(), values.size()};
+  CHECK(!cursor.step(100));
+}
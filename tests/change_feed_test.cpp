@@ -0,0 +1,337 @@
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/change_feed.hpp>
+#include <ordered_binary_trees/managed_tree.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>>;
+
+using Feed = obt::ChangeFeed<size_t>;
+using Record = Feed::record_type;
+using obt::ChangeKind;
+
+vector<Record> drain_all(Feed& feed) {
+  vector<Record> records;
+  feed.flush();
+  feed.drain([&records](Record const& r) { records.push_back(r); });
+  return records;
+}
+
+TEST_CASE("ChangeFeed - coalescing") {
+  Feed feed{8};
+  CHECK(feed.capacity() == 8);
+
+  for (size_t i{0}; i < 5; ++i) {
+    feed.record(ChangeKind::kInsert, 10 + i, 1);
+  }
+  feed.record(ChangeKind::kInsert, 10, 2);
+  feed.record(ChangeKind::kErase, 4, 1);
+  feed.record(ChangeKind::kErase, 4, 3);
+  feed.record(ChangeKind::kErase, 2, 2);
+  feed.record(ChangeKind::kUpdate, 7, 2);
+  feed.record(ChangeKind::kUpdate, 5, 2);
+  feed.record(ChangeKind::kUpdate, 8, 4);
+  feed.record(ChangeKind::kUpdate, 20, 1);
+  feed.record(ChangeKind::kInsert, 0, 0);
+
+  auto records{drain_all(feed)};
+  REQUIRE(records.size() == 4);
+  CHECK(records[0] == Record{ChangeKind::kInsert, 10, 7});
+  CHECK(records[1] == Record{ChangeKind::kErase, 2, 6});
+  CHECK(records[2] == Record{ChangeKind::kUpdate, 5, 7});
+  CHECK(records[3] == Record{ChangeKind::kUpdate, 20, 1});
+  CHECK(drain_all(feed).empty());
+}
+
+TEST_CASE("ChangeFeed - overflow") {
+  Feed feed{4};
+  for (size_t i{0}; i < 10; ++i) {
+    // Alternating kinds are never merged.
+    feed.record(i % 2 ? ChangeKind::kErase : ChangeKind::kInsert, i, 1);
+  }
+  feed.flush();
+  Record r;
+  size_t popped{0};
+  while (feed.try_pop(r)) {
+    CHECK(r.index == popped);
+    ++popped;
+  }
+  CHECK(popped == 4);
+
+  feed.record(ChangeKind::kUpdate, 0, 1);
+  auto records{drain_all(feed)};
+  REQUIRE(records.size() == 2);
+  CHECK(records[0].kind == ChangeKind::kReset);
+  CHECK(records[1] == Record{ChangeKind::kUpdate, 0, 1});
+}
+
+TEST_CASE("ChangeFeed - concurrent consumer") {
+  static constexpr size_t kNumRecords{200000};
+  Feed feed{64};
+  atomic<bool> done{false};
+  vector<Record> received;
+  thread consumer{[&feed, &done, &received]() {
+    while (true) {
+      bool const finished{done.load()};
+      size_t const count{feed.drain([&received](Record const& r) {
+        received.push_back(r);
+      })};
+      if (finished && count == 0) {
+        break;
+      }
+    }
+  }};
+  for (size_t i{0}; i < kNumRecords; ++i) {
+    // Alternating kinds are never merged.
+    feed.record(i % 2 ? ChangeKind::kErase : ChangeKind::kInsert, i, 1);
+    feed.flush();
+  }
+  done = true;
+  consumer.join();
+
+  // Records arrive in order, and a gap is always announced by `kReset`.
+  REQUIRE(!received.empty());
+  size_t next{0};
+  bool after_reset{false};
+  for (Record const& r : received) {
+    if (r.kind == ChangeKind::kReset) {
+      after_reset = true;
+      continue;
+    }
+    if (after_reset) {
+      CHECK(r.index >= next);
+      after_reset = false;
+    } else {
+      CHECK(r.index == next);
+    }
+    CHECK(r.kind == (r.index % 2 ? ChangeKind::kErase : ChangeKind::kInsert));
+    CHECK(r.count == 1);
+    next = r.index + 1;
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("ChangeFeed - ManagedTree replay", "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+
+  Tree tree;
+  Feed feed;
+  tree.set_change_feed(&feed);
+  CHECK(tree.change_feed() == &feed);
+
+  // The consumer mirrors the tree by applying records only.
+  deque<Value> mirror;
+  auto sync{[&]() {
+    for (Record const& r : drain_all(feed)) {
+      switch (r.kind) {
+        case ChangeKind::kInsert:
+        case ChangeKind::kJoin:
+        case ChangeKind::kUpdate:
+          if (r.kind == ChangeKind::kUpdate) {
+            mirror.erase(mirror.begin() + r.index,
+                mirror.begin() + r.index + r.count);
+          }
+          for (size_t i{0}; i < r.count; ++i) {
+            mirror.insert(mirror.begin() + r.index + i, tree[r.index + i]);
+          }
+          break;
+        case ChangeKind::kErase:
+          mirror.erase(mirror.begin() + r.index,
+              mirror.begin() + r.index + r.count);
+          break;
+        case ChangeKind::kReset:
+          mirror.assign(tree.begin(), tree.end());
+          break;
+      }
+    }
+    REQUIRE(mirror.size() == tree.size());
+    for (size_t i{0}; i < mirror.size(); ++i) {
+      REQUIRE(mirror[i] == tree[i]);
+    }
+  }};
+
+  for (Value i{0}; i < 100; ++i) {
+    tree.push_back(i);
+  }
+  auto records{drain_all(feed)};
+  REQUIRE(records.size() == 1);
+  CHECK(records[0] == Record{ChangeKind::kInsert, 0, 100});
+  mirror.assign(tree.begin(), tree.end());
+
+  IndexRand rand{};
+  Value value{1000};
+  for (size_t step{0}; step < 2000; ++step) {
+    size_t const index{rand(tree.size() + 1)};
+    switch (rand(12)) {
+      case 0:
+        tree.insert(tree.get_iterator_at_index(index), value++);
+        break;
+      case 1:
+        tree.push_front(value++);
+        break;
+      case 2:
+        tree.emplace_back(value++);
+        break;
+      case 3: {
+        vector<Value> values{value, value + 1, value + 2};
+        value += 3;
+        tree.insert(tree.get_iterator_at_index(index),
+            values.begin(), values.end());
+        break;
+      }
+      case 4: {
+        Tree other;
+        other.push_back(value++);
+        other.push_back(value++);
+        tree.join(tree.get_iterator_at_index(index), other);
+        break;
+      }
+      case 5: {
+        Tree other;
+        other.push_back(value++);
+        if (rand(2)) {
+          tree.join_front(other);
+        } else {
+          tree.join_back(other);
+        }
+        break;
+      }
+      case 6:
+      case 7:
+        if (index < tree.size()) {
+          tree.erase(tree.get_iterator_at_index(index));
+        }
+        break;
+      case 8: {
+        size_t const last{index + rand(tree.size() - index + 1)};
+        tree.erase(tree.get_iterator_at_index(index),
+            tree.get_iterator_at_index(last));
+        break;
+      }
+      case 9:
+        if (!tree.empty()) {
+          rand(2) ? tree.pop_front() : tree.pop_back();
+        }
+        break;
+      case 10:
+        if (index < tree.size()) {
+          tree[index] = value++;
+          feed.record_update(index);
+        }
+        break;
+      default: {
+        auto session{tree.edit_session()};
+        session.insert(tree.get_iterator_at_index(index), value++);
+        break;
+      }
+    }
+    sync();
+  }
+
+  // Erasing forward at one position coalesces into one record.
+  while (tree.size() < 50) {
+    tree.push_back(value++);
+  }
+  drain_all(feed);
+  mirror.assign(tree.begin(), tree.end());
+  for (size_t i{0}; i < 10; ++i) {
+    tree.erase(tree.get_iterator_at_index(20));
+  }
+  records = drain_all(feed);
+  REQUIRE(records.size() == 1);
+  CHECK(records[0] == Record{ChangeKind::kErase, 20, 10});
+
+  tree.assign({1, 2, 3});
+  tree.clear();
+  records = drain_all(feed);
+  REQUIRE(records.size() == 3);
+  CHECK(records[0].kind == ChangeKind::kErase);
+  CHECK(records[1] == Record{ChangeKind::kInsert, 0, 3});
+  CHECK(records[2] == Record{ChangeKind::kErase, 0, 3});
+
+  tree.set_change_feed(nullptr);
+  tree.push_back(1);
+  CHECK(drain_all(feed).empty());
+}
+
+/// Value whose copies throw once `copies_left` copies have been made.
+struct ThrowingCopy {
+  static inline size_t copies_left{SIZE_MAX};
+
+  size_t value;
+
+  ThrowingCopy(size_t value) : value{value} {}
+  ThrowingCopy(ThrowingCopy const& other) : value{other.value} {
+    count_copy();
+  }
+  ThrowingCopy& operator=(ThrowingCopy const& other) {
+    count_copy();
+    value = other.value;
+    return *this;
+  }
+
+  static void count_copy() {
+    if (copies_left == 0) {
+      throw runtime_error{"copy"};
+    }
+    --copies_left;
+  }
+};
+
+TEMPLATE_LIST_TEST_CASE("ChangeFeed - replacement that throws", "",
+    TreeImpls) {
+  using Tree = obt::ManagedTree<
+      obt::RebindTreeImplT<TestType, ThrowingCopy>>;
+
+  Tree tree;
+  Tree other;
+  vector<ThrowingCopy> values;
+  for (size_t i{0}; i < 5; ++i) {
+    tree.emplace_back(i);
+  }
+  for (size_t i{0}; i < 10; ++i) {
+    other.emplace_back(i + 100);
+    values.emplace_back(i + 100);
+  }
+  Feed feed;
+  tree.set_change_feed(&feed);
+
+  // A partly replaced tree is reported with `kReset`.
+  ThrowingCopy::copies_left = 3;
+  CHECK_THROWS_AS(tree.assign(values.begin(), values.end()), runtime_error);
+  auto records{drain_all(feed)};
+  REQUIRE(records.size() == 2);
+  CHECK(records[0] == Record{ChangeKind::kErase, 0, 5});
+  CHECK(records[1].kind == ChangeKind::kReset);
+
+  size_t const size{tree.size()};
+  ThrowingCopy::copies_left = 3;
+  CHECK_THROWS_AS(tree = other, runtime_error);
+  records = drain_all(feed);
+  REQUIRE(records.size() == 2);
+  CHECK(records[0] == Record{ChangeKind::kErase, 0, size});
+  CHECK(records[1].kind == ChangeKind::kReset);
+
+  ThrowingCopy::copies_left = SIZE_MAX;
+  tree = other;
+  records = drain_all(feed);
+  REQUIRE(records.size() == 2);
+  CHECK(records[1] == Record{ChangeKind::kInsert, 0, 10});
+}
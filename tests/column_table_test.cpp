@@ -0,0 +1,239 @@
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/column_table.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<size_t>,
+    obt::SplayTreeImpl<size_t>>;
+
+template<class Table>
+void check_equal(
+    Table& table,
+    deque<size_t> const& ids,
+    deque<string> const& names,
+    deque<double> const& scores) {
+  REQUIRE(table.size() == ids.size());
+  for (size_t i{0}; i < ids.size(); ++i) {
+    CHECK(table.template get<0>(i) == ids[i]);
+    CHECK(table.template get<1>(i) == names[i]);
+    CHECK(table.template get<2>(i) == scores[i]);
+  }
+  vector<string> column;
+  table.template for_each_in_column<1>(
+      [&column](string const& name) { column.push_back(name); });
+  CHECK(equal(column.begin(), column.end(), names.begin(), names.end()));
+}
+
+TEMPLATE_LIST_TEST_CASE("ColumnTable - random operations", "", TreeImpls) {
+  using Table = obt::ColumnTable<TestType, size_t, string, double>;
+
+  static constexpr size_t kNumOperations{3000};
+
+  Table table;
+  deque<size_t> ids;
+  deque<string> names;
+  deque<double> scores;
+
+  CHECK(table.empty());
+  CHECK_THROWS_AS(table.template at<0>(0), out_of_range);
+
+  IndexRand rand{};
+  for (size_t i{0}; i < kNumOperations; ++i) {
+    size_t const op{rand(table.empty() ? 3 : 5)};
+    string name{"row " + to_string(i)};
+    double const score{i * 0.5};
+    switch (op) {
+      case 0: {
+        size_t const index{rand(table.size() + 1)};
+        table.insert(index, i, name, score);
+        ids.insert(ids.begin() + index, i);
+        names.insert(names.begin() + index, name);
+        scores.insert(scores.begin() + index, score);
+        break;
+      }
+      case 1:
+        table.push_back(i, name, score);
+        ids.push_back(i);
+        names.push_back(name);
+        scores.push_back(score);
+        break;
+      case 2:
+        table.push_front(i, move(name), score);
+        ids.push_front(i);
+        names.push_front("row " + to_string(i));
+        scores.push_front(score);
+        break;
+      case 3: {
+        size_t const index{rand(table.size())};
+        table.erase(index);
+        ids.erase(ids.begin() + index);
+        names.erase(names.begin() + index);
+        scores.erase(scores.begin() + index);
+        break;
+      }
+      case 4: {
+        size_t const index{rand(table.size())};
+        auto [id, row_name, row_score] = table.row(index);
+        CHECK(id == ids[index]);
+        CHECK(row_name == names[index]);
+        row_score += 1.0;
+        scores[index] += 1.0;
+        break;
+      }
+    }
+    if (i % 250 == 0) {
+      check_equal(table, ids, names, scores);
+    }
+  }
+  check_equal(table, ids, names, scores);
+
+  SECTION("compact") {
+    table.compact();
+    CHECK(table.capacity() == table.size());
+    check_equal(table, ids, names, scores);
+    table.push_back(size_t{0}, string{"last"}, 0.0);
+    CHECK(table.template get<1>(table.size() - 1) == "last");
+  }
+
+  SECTION("slots are reused") {
+    size_t const capacity{table.capacity()};
+    size_t const size{table.size()};
+    for (size_t i{0}; i < size; ++i) {
+      table.erase(0);
+    }
+    CHECK(table.empty());
+    for (size_t i{0}; i < capacity; ++i) {
+      table.push_back(i, string{}, 0.0);
+    }
+    CHECK(table.capacity() == capacity);
+  }
+
+  SECTION("move") {
+    Table other{move(table)};
+    CHECK(table.empty());
+    check_equal(other, ids, names, scores);
+  }
+}
+
+/// Column value whose copy constructor and copy assignment throw while
+/// `fail` is set.
+struct ThrowingCopy {
+  static inline bool fail{false};
+
+  size_t value{0};
+
+  ThrowingCopy() = default;
+  ThrowingCopy(size_t value) : value{value} {}
+  ThrowingCopy(ThrowingCopy const& other) : value{other.value} {
+    if (fail) {
+      throw runtime_error{"copy"};
+    }
+  }
+  ThrowingCopy(ThrowingCopy&&) = default;
+  ThrowingCopy& operator=(ThrowingCopy const& other) {
+    if (fail) {
+      throw runtime_error{"copy"};
+    }
+    value = other.value;
+    return *this;
+  }
+  ThrowingCopy& operator=(ThrowingCopy&&) = default;
+};
+
+/// Makes every `FailingAllocator` throw while set.
+bool failing_allocations{false};
+
+/// Allocator that throws `bad_alloc` while `failing_allocations` is set.
+template<class T>
+struct FailingAllocator {
+  using value_type = T;
+
+  FailingAllocator() = default;
+  template<class U>
+  FailingAllocator(FailingAllocator<U> const&) {}
+
+  T* allocate(size_t n) {
+    if (failing_allocations) {
+      throw bad_alloc{};
+    }
+    return allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    allocator<T>{}.deallocate(p, n);
+  }
+
+  template<class U>
+  bool operator==(FailingAllocator<U> const&) const {
+    return true;
+  }
+  template<class U>
+  bool operator!=(FailingAllocator<U> const&) const {
+    return false;
+  }
+
+};
+
+TEST_CASE("ColumnTable - insertion that throws") {
+  using Impl = obt::BasicTreeImpl<size_t, FailingAllocator<size_t>>;
+  using Table = obt::ColumnTable<Impl, size_t, ThrowingCopy, string>;
+  Table table;
+  for (size_t i{0}; i < 10; ++i) {
+    table.push_back(i, ThrowingCopy{i}, to_string(i));
+  }
+  auto check_rows = [&table]() {
+    REQUIRE(table.size() == 10);
+    for (size_t i{0}; i < 10; ++i) {
+      auto [id, copy, name] = table.row(i);
+      CHECK(id == i);
+      CHECK(copy.value == i);
+      CHECK(name == to_string(i));
+    }
+  };
+  ThrowingCopy const copy{100};
+  string const name{"new"};
+
+  // The first column grows before the second one throws.
+  ThrowingCopy::fail = true;
+  CHECK_THROWS_AS(table.push_back(size_t{100}, copy, name), runtime_error);
+  CHECK_THROWS_AS(table.insert(5, size_t{100}, copy, name), runtime_error);
+  ThrowingCopy::fail = false;
+  CHECK(table.capacity() == 10);
+  check_rows();
+
+  // Adding the node throws after a slot has been taken.
+  failing_allocations = true;
+  CHECK_THROWS_AS(table.push_front(size_t{100}, copy, name), bad_alloc);
+  failing_allocations = false;
+  check_rows();
+  size_t const capacity{table.capacity()};
+  table.push_back(size_t{10}, ThrowingCopy{10}, string{"10"});
+  CHECK(table.capacity() == capacity);
+
+  // The same with a reused slot.
+  table.erase(10);
+  ThrowingCopy::fail = true;
+  CHECK_THROWS_AS(table.push_back(size_t{100}, copy, name), runtime_error);
+  ThrowingCopy::fail = false;
+  failing_allocations = true;
+  CHECK_THROWS_AS(table.insert(3, size_t{100}, copy, name), bad_alloc);
+  failing_allocations = false;
+  check_rows();
+  table.push_back(size_t{10}, ThrowingCopy{10}, string{"10"});
+  CHECK(table.capacity() == capacity);
+  CHECK(table.template get<2>(10) == "10");
+}
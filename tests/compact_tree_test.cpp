@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/compact_tree.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>>;
+
+template<class Tree>
+void check_equal(Tree const& tree, deque<Value> const& list) {
+  REQUIRE(tree.size() == list.size());
+  REQUIRE(tree.empty() == list.empty());
+  size_t i{0};
+  tree.for_each([&](Value const& value) {
+    REQUIRE(value == list[i]);
+    ++i;
+  });
+  REQUIRE(i == list.size());
+  for (i = 0; i < list.size(); ++i) {
+    REQUIRE(tree[i] == list[i]);
+  }
+  if (!list.empty()) {
+    CHECK(tree.front() == list.front());
+    CHECK(tree.back() == list.back());
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("CompactTree - header size", "", TreeImpls) {
+  using Tree = obt::CompactTree<TestType>;
+  CHECK(sizeof(Tree) == sizeof(void*));
+  // The stateless allocator takes no space in `OrderedBinaryTree`.
+  CHECK(sizeof(typename TestType::Tree) == 3 * sizeof(void*));
+}
+
+TEMPLATE_LIST_TEST_CASE("CompactTree - random operations", "", TreeImpls) {
+  using Tree = obt::CompactTree<TestType>;
+
+  Tree tree;
+  deque<Value> list;
+  IndexRand rand{};
+  Value value{0};
+  for (size_t step{0}; step < 3000; ++step) {
+    switch (list.empty() ? 0 : rand(8)) {
+      case 0:
+      case 1: {
+        size_t const index{rand(list.size() + 1)};
+        tree.insert(index, value);
+        list.insert(list.begin() + index, value++);
+        break;
+      }
+      case 2:
+        tree.push_front(value);
+        list.push_front(value++);
+        break;
+      case 3:
+        tree.emplace_back(value);
+        list.push_back(value++);
+        break;
+      case 4: {
+        size_t const index{rand(list.size())};
+        tree.erase(index);
+        list.erase(list.begin() + index);
+        break;
+      }
+      case 5:
+        tree.pop_front();
+        list.pop_front();
+        break;
+      case 6:
+        tree.pop_back();
+        list.pop_back();
+        break;
+      default: {
+        size_t const index{rand(list.size())};
+        tree.at(index) = value;
+        list[index] = value++;
+        break;
+      }
+    }
+    if (step % 300 == 0) {
+      check_equal(tree, list);
+    }
+  }
+  check_equal(tree, list);
+  CHECK_THROWS_AS(tree.at(list.size()), out_of_range);
+
+  Tree copy{tree};
+  check_equal(copy, list);
+  Tree moved{std::move(copy)};
+  CHECK(copy.empty());
+  check_equal(moved, list);
+  moved.clear();
+  CHECK(moved.empty());
+  moved = tree;
+  check_equal(moved, list);
+
+  // Converting to `ManagedTree` and back moves the nodes.
+  auto managed{tree.expand()};
+  CHECK(tree.empty());
+  REQUIRE(managed.size() == list.size());
+  CHECK(equal(managed.begin(), managed.end(), list.begin(), list.end()));
+  managed.push_back(value);
+  list.push_back(value++);
+  Tree compacted{std::move(managed)};
+  CHECK(managed.empty());
+  check_equal(compacted, list);
+
+  Tree small{1, 2, 3};
+  check_equal(small, deque<Value>{1, 2, 3});
+}
+
+TEMPLATE_LIST_TEST_CASE("CompactTree - many small trees", "", TreeImpls) {
+  using Tree = obt::CompactTree<TestType>;
+  static constexpr size_t kNumTrees{10000};
+  vector<Tree> trees(kNumTrees);
+  for (size_t i{0}; i < kNumTrees; ++i) {
+    for (size_t j{0}; j < i % 4; ++j) {
+      trees[i].push_back(i + j);
+    }
+  }
+  for (size_t i{0}; i < kNumTrees; ++i) {
+    REQUIRE(trees[i].size() == i % 4);
+    for (size_t j{0}; j < i % 4; ++j) {
+      REQUIRE(trees[i][j] == i + j);
+    }
+  }
+}
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <ordered_binary_trees/concurrent_skip_list.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using List = obt::ConcurrentSkipList<Value>;
+
+template<class Sequence>
+void check_equal(List& list, Sequence& expected) {
+  REQUIRE(list.size() == expected.size());
+  CHECK(list.check_invariants());
+  vector<Value> values{list.to_vector()};
+  CHECK(equal(values.begin(), values.end(),
+      expected.begin(), expected.end()));
+  for (size_t i{0}; i < expected.size(); ++i) {
+    CHECK(list[i] == expected[i]);
+  }
+}
+
+TEST_CASE("ConcurrentSkipList - single thread") {
+  List list;
+  deque<Value> expected;
+
+  static constexpr size_t kNumOperations{3000};
+
+  IndexRand rand{};
+
+  CHECK(list.height() == 0);
+  CHECK_THROWS_AS(list.at(0), out_of_range);
+  CHECK_THROWS_AS(list.erase(0), out_of_range);
+
+  size_t value{0};
+  for (size_t counter{0}; counter < kNumOperations; ++counter) {
+    size_t op{rand(list.empty() ? 1 : 4)};
+    switch (op) {
+      case 0:
+      case 1:
+        expected.push_back(value);
+        list.push_back(value);
+        break;
+      case 2: {
+        size_t index{rand(list.size())};
+        expected.erase(expected.begin() + index);
+        list.erase(index);
+        break;
+      }
+      case 3:
+        expected.pop_front();
+        list.pop_front();
+        break;
+    }
+    ++value;
+    if (counter % 100 == 0) {
+      check_equal(list, expected);
+    }
+    if (counter % 1000 == 999) {
+      list.collect_garbage();
+      CHECK(list.retired_size() == 0);
+      check_equal(list, expected);
+    }
+  }
+  check_equal(list, expected);
+  CHECK_THROWS_AS(list.at(expected.size()), out_of_range);
+  list.collect_garbage();
+  check_equal(list, expected);
+
+  // `collect_garbage()` renumbers the nodes, so the list stays shallow.
+  while (!list.empty()) {
+    list.pop_front();
+  }
+  list.collect_garbage();
+  CHECK(list.height() == 0);
+  list.push_back(1);
+  list.push_back(2);
+  CHECK(list.height() == 2);
+  CHECK(list.to_vector() == vector<Value>{1, 2});
+}
+
+TEST_CASE("ConcurrentSkipList - height") {
+  List list;
+  static constexpr size_t kLength{1 << 14};
+  for (size_t i{0}; i < kLength; ++i) {
+    list.push_back(i);
+  }
+  CHECK(list.check_invariants());
+  CHECK(list.height() == 15);
+  for (size_t i{0}; i < kLength; i += 3) {
+    CHECK(list[i] == i);
+  }
+  for (size_t i{0}; i < kLength / 2; ++i) {
+    list.erase(kLength / 2 - 1 - i);
+  }
+  CHECK(list.check_invariants());
+  for (size_t i{0}; i < kLength / 2; ++i) {
+    CHECK(list[i] == i + kLength / 2);
+  }
+}
+
+TEST_CASE("ConcurrentSkipList - concurrent appenders and readers") {
+  List list;
+
+  static constexpr size_t kNumWriters{4};
+  static constexpr size_t kNumReaders{2};
+  static constexpr size_t kNumAppends{20000};
+
+  vector<thread> threads;
+  for (size_t w{0}; w < kNumWriters; ++w) {
+    threads.emplace_back([&list, w]() {
+      for (size_t i{0}; i < kNumAppends; ++i) {
+        list.push_back(w * kNumAppends + i);
+      }
+    });
+  }
+  atomic<bool> done{false};
+  atomic<size_t> num_mismatches{0};
+  for (size_t r{0}; r < kNumReaders; ++r) {
+    threads.emplace_back([&list, &done, &num_mismatches, r]() {
+      IndexRand rand{r + 100};
+      vector<Value> seen;
+      while (!done.load()) {
+        // Appends never move existing elements, so an element read twice
+        // must be the same.
+        size_t const size{list.size()};
+        if (size == 0) {
+          continue;
+        }
+        size_t const index{rand(size)};
+        try {
+          Value const value{list[index]};
+          if (index < seen.size() && seen[index] != value) {
+            ++num_mismatches;
+          }
+          if (index == seen.size()) {
+            seen.push_back(value);
+          }
+        } catch (out_of_range const&) {
+          // `size()` includes appends that are still in progress.
+        }
+      }
+    });
+  }
+  for (size_t w{0}; w < kNumWriters; ++w) {
+    threads[w].join();
+  }
+  done.store(true);
+  for (size_t r{0}; r < kNumReaders; ++r) {
+    threads[kNumWriters + r].join();
+  }
+  CHECK(num_mismatches.load() == 0);
+
+  REQUIRE(list.size() == kNumWriters * kNumAppends);
+  CHECK(list.check_invariants());
+
+  // Every value appears once, and each writer's values are in order.
+  vector<Value> values{list.to_vector()};
+  vector<Value> next(kNumWriters, 0);
+  for (Value value : values) {
+    size_t const w{value / kNumAppends};
+    REQUIRE(w < kNumWriters);
+    CHECK(value == w * kNumAppends + next[w]);
+    ++next[w];
+  }
+  for (size_t i{0}; i < values.size(); i += 7) {
+    CHECK(list[i] == values[i]);
+  }
+}
+
+TEST_CASE("ConcurrentSkipList - concurrent appenders and erasers") {
+  List list;
+
+  static constexpr size_t kNumWriters{4};
+  static constexpr size_t kNumAppends{8000};
+  static constexpr size_t kNumErasures{3000};
+  static constexpr size_t kInitialSize{1000};
+
+  for (size_t i{0}; i < kInitialSize; ++i) {
+    list.push_back(i);
+  }
+
+  vector<thread> threads;
+  for (size_t w{0}; w < kNumWriters; ++w) {
+    threads.emplace_back([&list, w]() {
+      IndexRand rand{w + 1};
+      for (size_t i{0}; i < kNumAppends; ++i) {
+        list.push_back(kInitialSize + w * kNumAppends + i);
+        // Every writer appends before it erases, so the list never shrinks
+        // below `kInitialSize`.
+        if (i < kNumErasures) {
+          list.erase(rand(kInitialSize));
+        }
+      }
+    });
+  }
+  for (thread& t : threads) {
+    t.join();
+  }
+
+  size_t const expected_size{
+      kInitialSize + kNumWriters * (kNumAppends - kNumErasures)};
+  REQUIRE(list.size() == expected_size);
+  CHECK(list.retired_size() == kNumWriters * kNumErasures);
+  CHECK(list.check_invariants());
+
+  vector<Value> values{list.to_vector()};
+  REQUIRE(values.size() == expected_size);
+  for (size_t i{0}; i < values.size(); i += 7) {
+    CHECK(list[i] == values[i]);
+  }
+  vector<Value> sorted{values};
+  sort(sorted.begin(), sorted.end());
+  CHECK(adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+  list.collect_garbage();
+  CHECK(list.retired_size() == 0);
+  CHECK(list.check_invariants());
+  check_equal(list, values);
+}
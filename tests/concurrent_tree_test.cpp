@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <ordered_binary_trees/concurrent_tree.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using Tree = obt::ConcurrentTree<Value>;
+
+template<class List>
+void check_equal(Tree& tree, List& list) {
+  REQUIRE(tree.size() == list.size());
+  CHECK(tree.check_invariants());
+  vector<Value> values{tree.to_vector()};
+  CHECK(equal(values.begin(), values.end(), list.begin(), list.end()));
+  for (size_t i{0}; i < list.size(); ++i) {
+    CHECK(tree[i] == list[i]);
+  }
+}
+
+TEST_CASE("ConcurrentTree - single thread") {
+  Tree tree;
+  deque<Value> list;
+
+  static constexpr size_t kNumOperations{3000};
+
+  IndexRand rand{};
+
+  CHECK_THROWS_AS(tree.at(0), out_of_range);
+  CHECK_THROWS_AS(tree.erase(0), out_of_range);
+  CHECK_THROWS_AS(tree.insert(1, 0), out_of_range);
+
+  size_t value{0};
+  for (size_t counter{0}; counter < kNumOperations; ++counter) {
+    size_t op{rand(tree.empty() ? 3 : 5)};
+    switch (op) {
+      case 0: {
+        size_t index{rand(tree.size() + 1)};
+        list.insert(list.begin() + index, value);
+        tree.insert(index, value);
+        break;
+      }
+      case 1:
+        list.push_back(value);
+        tree.push_back(value);
+        break;
+      case 2:
+        list.push_front(value);
+        tree.push_front(value);
+        break;
+      case 3: {
+        size_t index{rand(tree.size())};
+        list.erase(list.begin() + index);
+        tree.erase(index);
+        break;
+      }
+      case 4:
+        list.pop_front();
+        tree.pop_front();
+        break;
+    }
+    ++value;
+    if (counter % 100 == 0) {
+      check_equal(tree, list);
+    }
+  }
+  check_equal(tree, list);
+  tree.collect_garbage();
+  CHECK(tree.retired_size() == 0);
+  check_equal(tree, list);
+}
+
+TEST_CASE("ConcurrentTree - balance") {
+  Tree tree;
+  static constexpr size_t kLength{1 << 14};
+  for (size_t i{0}; i < kLength; ++i) {
+    tree.push_back(i);
+  }
+  CHECK(tree.check_invariants());
+  // A weight-balanced tree with Delta = 3 has height below 2.5 * log2(n).
+  CHECK(tree.height() <= 35);
+  for (size_t i{0}; i < kLength / 2; ++i) {
+    tree.pop_front();
+  }
+  CHECK(tree.check_invariants());
+  CHECK(tree.height() <= 33);
+  for (size_t i{0}; i < kLength / 2; ++i) {
+    CHECK(tree[i] == i + kLength / 2);
+  }
+}
+
+TEST_CASE("ConcurrentTree - concurrent writers and readers") {
+  Tree tree;
+
+  static constexpr size_t kNumWriters{4};
+  static constexpr size_t kNumReaders{2};
+  static constexpr size_t kNumInsertions{4000};
+  static constexpr size_t kNumErasures{1000};
+  static constexpr size_t kInitialSize{1000};
+
+  for (size_t i{0}; i < kInitialSize; ++i) {
+    tree.push_back(i);
+  }
+
+  vector<thread> threads;
+  for (size_t w{0}; w < kNumWriters; ++w) {
+    threads.emplace_back([&tree, w]() {
+      IndexRand rand{w + 1};
+      for (size_t i{0}; i < kNumInsertions; ++i) {
+        Value value{kInitialSize + w * kNumInsertions + i};
+        // Every writer inserts before it erases, so the tree never shrinks
+        // below `kInitialSize`.
+        if (i % 2 == 0) {
+          tree.push_back(value);
+        } else {
+          tree.insert(rand(kInitialSize), value);
+        }
+        if (i < kNumErasures) {
+          tree.erase(rand(kInitialSize));
+        }
+      }
+    });
+  }
+  atomic<bool> done{false};
+  for (size_t r{0}; r < kNumReaders; ++r) {
+    threads.emplace_back([&tree, &done, r]() {
+      IndexRand rand{r + 100};
+      while (!done.load()) {
+        Value value{tree[rand(kInitialSize)]};
+        if (value >= kInitialSize + kNumWriters * kNumInsertions) {
+          // Never happens; keeps `value` from being optimized away.
+          throw logic_error("invalid value");
+        }
+      }
+    });
+  }
+  for (size_t w{0}; w < kNumWriters; ++w) {
+    threads[w].join();
+  }
+  done.store(true);
+  for (size_t r{0}; r < kNumReaders; ++r) {
+    threads[kNumWriters + r].join();
+  }
+
+  size_t const expected_size{
+      kInitialSize + kNumWriters * (kNumInsertions - kNumErasures)};
+  REQUIRE(tree.size() == expected_size);
+  CHECK(tree.check_invariants());
+  CHECK(tree.retired_size() == kNumWriters * kNumErasures);
+
+  // Every value appears at most once.
+  vector<Value> values{tree.to_vector()};
+  REQUIRE(values.size() == expected_size);
+  sort(values.begin(), values.end());
+  CHECK(adjacent_find(values.begin(), values.end()) == values.end());
+
+  // Each writer's `push_back` values appear in the order they were pushed.
+  vector<Value> in_order{tree.to_vector()};
+  for (size_t w{0}; w < kNumWriters; ++w) {
+    Value const first{kInitialSize + w * kNumInsertions};
+    Value const last{first + kNumInsertions};
+    Value previous{0};
+    bool has_previous{false};
+    for (Value value : in_order) {
+      if (value >= first && value < last && (value - first) % 2 == 0) {
+        if (has_previous) {
+          CHECK(previous < value);
+        }
+        previous = value;
+        has_previous = true;
+      }
+    }
+  }
+
+  tree.collect_garbage();
+  CHECK(tree.retired_size() == 0);
+}
@@ -0,0 +1,170 @@
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <ordered_binary_trees/disk_sequence.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = uint64_t;
+
+// Small pages give deep trees and frequent splits and merges.
+using Sequence = obt::DiskSequence<Value, 256>;
+
+string file_name(char const* suffix) {
+  return "/tmp/obt_disk_sequence_test_" + to_string(getpid()) + "_" + suffix;
+}
+
+void check_equal(Sequence const& sequence, deque<Value> const& list) {
+  REQUIRE(sequence.size() == list.size());
+  size_t i{0};
+  for (auto it{sequence.begin()}; it != sequence.end(); ++it, ++i) {
+    REQUIRE(it.get_index() == i);
+    REQUIRE(*it == list[i]);
+  }
+  REQUIRE(i == list.size());
+  i = 0;
+  sequence.for_each(0, sequence.size(), [&](Value const& value) {
+    REQUIRE(value == list[i]);
+    ++i;
+  });
+  REQUIRE(i == list.size());
+}
+
+TEST_CASE("DiskSequence - random operations") {
+  string const path{file_name("random")};
+  ::unlink(path.c_str());
+  {
+    Sequence sequence{path, Sequence::kMinNumFrames};
+    deque<Value> list;
+    IndexRand rand{};
+
+    for (size_t step{0}; step < 20000; ++step) {
+      size_t const op{list.empty() ? 0 : rand(10)};
+      if (op < 5) {
+        size_t const index{rand(list.size() + 1)};
+        Value const value{rand(1000000)};
+        sequence.insert(index, value);
+        list.insert(list.begin() + index, value);
+      } else if (op < 8) {
+        size_t const index{rand(list.size())};
+        sequence.erase(index);
+        list.erase(list.begin() + index);
+      } else {
+        size_t const index{rand(list.size())};
+        REQUIRE(sequence[index] == list[index]);
+        Value const value{rand(1000000)};
+        sequence.set(index, value);
+        list[index] = value;
+      }
+      if (step % 2000 == 0) {
+        check_equal(sequence, list);
+      }
+    }
+    check_equal(sequence, list);
+    CHECK_THROWS_AS(sequence.at(list.size()), out_of_range);
+
+    // Pages are read and written through a fixed number of frames.
+    CHECK(sequence.pool().num_frames() == Sequence::kMinNumFrames);
+    CHECK(sequence.pool().num_reads() > 0);
+    CHECK(sequence.pool().num_writes() > 0);
+
+    // Erasing everything returns every page to the free list, so refilling
+    // does not grow the file.
+    size_t const num_pages{sequence.num_pages()};
+    sequence.clear();
+    CHECK(sequence.empty());
+    CHECK(sequence.begin() == sequence.end());
+    for (size_t i{0}; i < list.size(); ++i) {
+      sequence.push_back(list[i]);
+    }
+    CHECK(sequence.num_pages() == num_pages);
+    check_equal(sequence, list);
+  }
+  ::unlink(path.c_str());
+}
+
+TEST_CASE("DiskSequence - persistence") {
+  string const path{file_name("persistence")};
+  ::unlink(path.c_str());
+  deque<Value> list;
+  {
+    Sequence sequence{path, Sequence::kMinNumFrames};
+    for (Value i{0}; i < 5000; ++i) {
+      if (i % 3 == 0) {
+        sequence.push_front(i);
+        list.push_front(i);
+      } else {
+        sequence.push_back(i);
+        list.push_back(i);
+      }
+    }
+    sequence.pop_front();
+    list.pop_front();
+    sequence.pop_back();
+    list.pop_back();
+  }
+  {
+    Sequence sequence{path, Sequence::kMinNumFrames};
+    check_equal(sequence, list);
+    CHECK(sequence.front() == list.front());
+    CHECK(sequence.back() == list.back());
+    sequence.insert(100, 7);
+    list.insert(list.begin() + 100, 7);
+    sequence.flush();
+    check_equal(sequence, list);
+  }
+  {
+    Sequence sequence{path};
+    check_equal(sequence, list);
+
+    vector<Value> partial;
+    sequence.for_each(1000, 1200, [&](Value const& value) {
+      partial.push_back(value);
+    });
+    REQUIRE(partial.size() == 200);
+    for (size_t i{0}; i < partial.size(); ++i) {
+      CHECK(partial[i] == list[1000 + i]);
+    }
+    auto it{sequence.get_iterator_at_index(4000)};
+    CHECK(*it == list[4000]);
+  }
+  // A file written with a different page size is rejected.
+  CHECK_THROWS_AS((obt::DiskSequence<Value, 512>{path}), runtime_error);
+  ::unlink(path.c_str());
+}
+
+TEST_CASE("DiskSequence - inserting at a leaf boundary") {
+  string const path{file_name("boundary")};
+  ::unlink(path.c_str());
+  {
+    // A leaf of a 4096-byte page holds 510 values, so index 510 is the end
+    // of the first leaf once the first few leaves are full.
+    obt::DiskSequence<Value> sequence{path};
+    deque<Value> list;
+    for (Value i{0}; i < 2000; ++i) {
+      sequence.push_back(i);
+      list.push_back(i);
+    }
+    for (Value i{0}; i < 20000; ++i) {
+      sequence.insert(510, i);
+      list.insert(list.begin() + 510, i);
+    }
+    REQUIRE(sequence.size() == list.size());
+    for (size_t i{0}; i < list.size(); i += 97) {
+      REQUIRE(sequence[i] == list[i]);
+    }
+    // Halved leaves are at least half full.
+    CHECK(sequence.num_pages() <= 2 * list.size() / 510 + 4);
+  }
+  ::unlink(path.c_str());
+}
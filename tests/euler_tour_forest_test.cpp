@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/euler_tour_forest.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Forest = obt::EulerTourForest<size_t>;
+
+/// Forest that answers queries by searching its adjacency lists.
+struct NaiveForest {
+  vector<set<size_t>> adjacent;
+
+  explicit NaiveForest(size_t n) : adjacent(n) {}
+
+  /// Returns the vertices reachable from `v` without crossing `blocked`.
+  vector<size_t> reach(size_t v, size_t blocked = SIZE_MAX) const {
+    vector<bool> seen(adjacent.size());
+    vector<size_t> stack{v};
+    vector<size_t> reached;
+    seen[v] = true;
+    while (!stack.empty()) {
+      size_t const u{stack.back()};
+      stack.pop_back();
+      reached.push_back(u);
+      for (size_t w : adjacent[u]) {
+        if (!seen[w] && w != blocked) {
+          seen[w] = true;
+          stack.push_back(w);
+        }
+      }
+    }
+    return reached;
+  }
+
+  bool connected(size_t u, size_t v) const {
+    for (size_t w : reach(u)) {
+      if (w == v) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+TEST_CASE("EulerTourForest - path") {
+  Forest forest{5};
+  CHECK(forest.num_vertices() == 5);
+  CHECK(forest.num_edges() == 0);
+  CHECK(!forest.connected(0, 4));
+  CHECK(forest.component_size(2) == 1);
+
+  for (size_t v{0}; v < 4; ++v) {
+    CHECK(forest.link(v, v + 1));
+  }
+  CHECK(forest.num_edges() == 4);
+  CHECK(forest.connected(0, 4));
+  CHECK(!forest.link(4, 0));
+  CHECK(forest.has_edge(2, 3));
+  CHECK(forest.has_edge(3, 2));
+  CHECK(!forest.has_edge(1, 3));
+  CHECK(forest.component_size(0) == 5);
+  CHECK(forest.subtree_size(3, 2) == 2);
+  CHECK(forest.subtree_size(2, 3) == 3);
+  CHECK(forest.subtree_size(0, 1) == 1);
+
+  CHECK(forest.cut(3, 2));
+  CHECK(!forest.cut(2, 3));
+  CHECK(!forest.connected(0, 4));
+  CHECK(forest.connected(3, 4));
+  CHECK(forest.component_size(1) == 3);
+  CHECK(forest.component_size(4) == 2);
+
+  size_t const v{forest.add_vertex()};
+  CHECK(v == 5);
+  CHECK(forest.link(2, v));
+  CHECK(forest.link(v, 3));
+  CHECK(forest.connected(0, 4));
+  CHECK(forest.subtree_size(v, 2) == 3);
+}
+
+TEST_CASE("EulerTourForest - random links and cuts") {
+  static constexpr size_t kNumVertices{60};
+  IndexRand rand{};
+  Forest forest{kNumVertices};
+  NaiveForest naive{kNumVertices};
+  vector<pair<size_t, size_t>> edges;
+
+  for (size_t step{0}; step < 4000; ++step) {
+    size_t const u{rand(kNumVertices)};
+    size_t const v{rand(kNumVertices)};
+    switch (rand(4)) {
+      case 0:
+      case 1: {
+        bool const linked{forest.link(u, v)};
+        REQUIRE(linked == !naive.connected(u, v));
+        if (linked) {
+          naive.adjacent[u].insert(v);
+          naive.adjacent[v].insert(u);
+          edges.emplace_back(u, v);
+        }
+        break;
+      }
+      case 2:
+        if (!edges.empty()) {
+          size_t const i{rand(edges.size())};
+          auto [a, b]{edges[i]};
+          edges[i] = edges.back();
+          edges.pop_back();
+          bool const cut{rand(2) ? forest.cut(a, b) : forest.cut(b, a)};
+          REQUIRE(cut);
+          naive.adjacent[a].erase(b);
+          naive.adjacent[b].erase(a);
+        }
+        break;
+      default:
+        REQUIRE(forest.connected(u, v) == naive.connected(u, v));
+        REQUIRE(forest.component_size(u) == naive.reach(u).size());
+        if (!edges.empty()) {
+          auto [a, b]{edges[rand(edges.size())]};
+          REQUIRE(forest.subtree_size(a, b) == naive.reach(a, b).size());
+          REQUIRE(forest.subtree_size(b, a) == naive.reach(b, a).size());
+        }
+        break;
+    }
+    REQUIRE(forest.num_edges() == edges.size());
+  }
+}
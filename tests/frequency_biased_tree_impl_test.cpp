@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <ordered_binary_trees/frequency_biased_tree_impl.hpp>
+#include <ordered_binary_trees/managed_tree.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using TreeImpl = obt::FrequencyBiasedTreeImpl<Value>;
+
+template<class NodePtr>
+size_t get_depth(NodePtr n) {
+  size_t depth{0};
+  for (n = n->parent; n; n = n->parent) {
+    ++depth;
+  }
+  return depth;
+}
+
+template<class NodePtr>
+bool check_sizes(NodePtr n) {
+  if (!n) {
+    return true;
+  }
+  size_t const l{n->left_child ? n->left_child->size : 0};
+  size_t const r{n->right_child ? n->right_child->size : 0};
+  return n->size == l + r + 1 &&
+      (!n->left_child || n->left_child->parent == n) &&
+      (!n->right_child || n->right_child->parent == n) &&
+      check_sizes(n->left_child) && check_sizes(n->right_child);
+}
+
+TEST_CASE("FrequencyBiasedTreeImpl - rebuild") {
+  static constexpr size_t kLength{1 << 14};
+  static constexpr size_t kNumHotAccesses{1 << 16};
+  static constexpr size_t kNumColdAccesses{1 << 12};
+  vector<size_t> const hot_indices{17, kLength / 2 + 3, kLength - 5};
+
+  TreeImpl::Tree tree{TreeImpl::Allocator{}};
+  for (size_t i{0}; i < kLength; ++i) {
+    TreeImpl::emplace_back(tree, i);
+  }
+
+  IndexRand rand{};
+  for (size_t i{0}; i < kNumHotAccesses; ++i) {
+    size_t const index{hot_indices[rand(hot_indices.size())]};
+    REQUIRE(TreeImpl::find_node_at_index(tree, index)->data.value == index);
+  }
+  for (size_t i{0}; i < kNumColdAccesses; ++i) {
+    TreeImpl::find_node_at_index(tree, rand(kLength));
+  }
+
+  TreeImpl::rebuild_by_access_frequency(tree);
+  REQUIRE(tree.root->size == kLength);
+  CHECK(!tree.root->parent);
+  CHECK(check_sizes(tree.root));
+  CHECK(tree.first == tree.root->find_first_node());
+  CHECK(tree.last == tree.root->find_last_node());
+
+  // Each hot element carries about a third of the weight, so it must be
+  //   within `log2(3) + 1` levels of the root.
+  for (size_t index : hot_indices) {
+    CHECK(get_depth(tree.find_node_at_index(index)) <= 2);
+  }
+  // Every element stays within `log2(total weight) + 1` levels of the root,
+  //   and the total weight is below `2^17`.
+  size_t max_depth{0};
+  size_t i{0};
+  for (auto n{tree.first}; n; n = n->find_next_node(), ++i) {
+    CHECK(n->data.value == i);
+    max_depth = max(max_depth, get_depth(n));
+  }
+  CHECK(max_depth <= 18);
+
+  // Counters are halved, so a rebuild without new accesses keeps the shape
+  //   biased towards the same elements.
+  TreeImpl::rebuild_by_access_frequency(tree);
+  CHECK(check_sizes(tree.root));
+  for (size_t index : hot_indices) {
+    CHECK(get_depth(tree.find_node_at_index(index)) <= 2);
+  }
+
+  tree.destroy_all_nodes();
+}
+
+TEST_CASE("FrequencyBiasedTreeImpl - ManagedTree") {
+  using Tree = obt::ManagedTree<TreeImpl>;
+  static constexpr size_t kNumOperations{2000};
+
+  Tree tree;
+  deque<Value> list;
+  tree.rebuild_by_access_frequency();
+  CHECK(tree.empty());
+
+  IndexRand rand{};
+  for (size_t i{0}; i < kNumOperations; ++i) {
+    size_t const op{rand(tree.empty() ? 1 : 4)};
+    if (op == 0) {
+      size_t const index{rand(tree.size() + 1)};
+      tree.insert(tree.get_iterator_at_index(index), i);
+      list.insert(list.begin() + index, i);
+    } else if (op == 1) {
+      size_t const index{rand(tree.size())};
+      tree.erase(tree.get_iterator_at_index(index));
+      list.erase(list.begin() + index);
+    } else {
+      // Skew lookups towards the front.
+      size_t const index{rand(min<size_t>(tree.size(), 8))};
+      REQUIRE(tree[index] == list[index]);
+    }
+    if (i % 97 == 0 && !tree.empty()) {
+      auto const front{tree.begin()};
+      Value const front_value{*front};
+      tree.rebuild_by_access_frequency();
+      // Nodes are relinked in place.
+      CHECK(front == tree.begin());
+      CHECK(*front == front_value);
+      REQUIRE(tree.size() == list.size());
+      CHECK(equal(tree.begin(), tree.end(), list.begin(), list.end()));
+    }
+  }
+  REQUIRE(tree.size() == list.size());
+  for (size_t i{0}; i < list.size(); ++i) {
+    CHECK(tree[i] == list[i]);
+  }
+}
+
+TEST_CASE("FrequencyBiasedTreeImpl - index cache") {
+  // Exposes the tree to check depths.
+  struct Tree: obt::ManagedTree<TreeImpl> {
+    using obt::ManagedTree<TreeImpl>::tree_;
+  };
+  static constexpr size_t kLength{1 << 12};
+  static constexpr size_t kNumHotAccesses{1 << 14};
+  vector<size_t> const hot_indices{17, kLength / 2 + 3, kLength - 5};
+
+  // With one entry, lookups of neighbours walk from the previous node; with
+  //   more entries, repeated lookups hit the cache.
+  for (size_t capacity : {1, 64}) {
+    Tree tree;
+    for (size_t i{0}; i < kLength; ++i) {
+      tree.push_back(i);
+    }
+    tree.set_index_cache_capacity(capacity);
+    IndexRand rand{};
+    for (size_t i{0}; i < kNumHotAccesses; ++i) {
+      size_t const index{hot_indices[rand(hot_indices.size())]};
+      REQUIRE(tree[index] == index);
+      REQUIRE(tree[index + 1] == index + 1);
+    }
+
+    // Hits and walks are counted, so each of the six hot elements carries
+    //   about a sixth of the weight and is within `log2(6) + 1` levels of
+    //   the root.
+    tree.rebuild_by_access_frequency();
+    CHECK(check_sizes(tree.tree_.root));
+    for (size_t index : hot_indices) {
+      CHECK(get_depth(tree.tree_.find_node_at_index(index)) <= 3);
+      CHECK(get_depth(tree.tree_.find_node_at_index(index + 1)) <= 3);
+    }
+    for (size_t i{0}; i < kLength; i += 97) {
+      CHECK(tree[i] == i);
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/managed_tree.hpp>
+#include <ordered_binary_trees/implicit_sequence_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using Tree = obt::ManagedTree<obt::ImplicitSequenceImpl<Value>>;
+
+TEST_CASE("ImplicitSequence - iteration across chunks") {
+  Tree tree;
+  static constexpr size_t kLength{5000};
+  for (size_t i{0}; i < kLength; ++i) {
+    tree.push_back(i);
+    CHECK(tree[i] == i);
+  }
+  vector<Value> forward(tree.begin(), tree.end());
+  vector<Value> backward(tree.rbegin(), tree.rend());
+  reverse(backward.begin(), backward.end());
+  CHECK(forward == backward);
+
+  auto it{tree.end()};
+  for (size_t i{kLength}; i > 0; --i) {
+    --it;
+    CHECK(*it == forward[i - 1]);
+    CHECK(it - tree.begin() == static_cast<ptrdiff_t>(i - 1));
+  }
+  CHECK(it == tree.begin());
+  CHECK(tree.rend()[-1] == tree.front());
+  CHECK(tree.rbegin()[0] == tree.back());
+}
+
+TEST_CASE("ImplicitSequence - aggregates") {
+  using SumTree = obt::ManagedTree<
+      obt::ImplicitSequenceImpl<Value, allocator<Value>, plus<Value>>>;
+  SumTree tree;
+  vector<Value> prefix;
+
+  static constexpr size_t kLength{3000};
+
+  IndexRand rand{};
+  for (size_t i{0}; i < kLength; ++i) {
+    Value value{rand(10)};
+    tree.push_back(value);
+    prefix.push_back((prefix.empty() ? 0 : prefix.back()) + value);
+  }
+  for (size_t i{0}; i < kLength; ++i) {
+    CHECK(tree.prefix_aggregate(i) == prefix[i]);
+  }
+
+  // `prefix_search` finds the first prefix whose sum exceeds `x`.
+  for (Value x{0}; x <= prefix.back(); x += 7) {
+    size_t expected{static_cast<size_t>(
+        upper_bound(prefix.begin(), prefix.end(), x) - prefix.begin())};
+    CHECK(tree.prefix_search([x](Value s) { return s > x; }) == expected);
+  }
+  CHECK(tree.prefix_search([](Value) { return false; }) == tree.size());
+
+  // Aggregates follow `pop_back` and edits in the middle.
+  for (size_t i{0}; i < 100; ++i) {
+    tree.pop_back();
+    prefix.pop_back();
+  }
+  tree.erase(tree.get_iterator_at_index(10), tree.get_iterator_at_index(20));
+  tree.insert(tree.get_iterator_at_index(5), 1000);
+  vector<Value> values(tree.begin(), tree.end());
+  Value sum{0};
+  for (size_t i{0}; i < values.size(); ++i) {
+    sum += values[i];
+    CHECK(tree.prefix_aggregate(i) == sum);
+  }
+
+  // A non-commutative operation.
+  using ConcatTree = obt::ManagedTree<obt::ImplicitSequenceImpl<
+      string, allocator<string>, plus<string>>>;
+  ConcatTree strings;
+  string expected;
+  for (size_t i{0}; i < 100; ++i) {
+    string s(1, static_cast<char>('a' + i % 26));
+    strings.push_back(s);
+    expected += s;
+    CHECK(strings.prefix_aggregate(i) == expected);
+  }
+}
@@ -0,0 +1,142 @@
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/inline_string_tree_impl.hpp>
+#include <ordered_binary_trees/managed_tree.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+/// Counters shared by all `CountingAllocator` types.
+struct AllocationCounts {
+  static inline size_t num_allocations{0};
+  static inline size_t num_bytes{0};
+};
+
+/// `std::allocator` that counts allocations and outstanding bytes.
+template<class T>
+struct CountingAllocator : AllocationCounts {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template<class U>
+  CountingAllocator(CountingAllocator<U> const&) {}
+
+  T* allocate(size_t n) {
+    ++num_allocations;
+    num_bytes += n * sizeof(T);
+    return allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    num_bytes -= n * sizeof(T);
+    allocator<T>{}.deallocate(p, n);
+  }
+  template<class U>
+  bool operator==(CountingAllocator<U> const&) const { return true; }
+  template<class U>
+  bool operator!=(CountingAllocator<U> const&) const { return false; }
+};
+
+using TreeImpls = tuple<
+    obt::InlineStringTreeImpl<char, CountingAllocator<char>, obt::BasicTreeImpl>,
+    obt::InlineStringTreeImpl<char, CountingAllocator<char>, obt::SplayTreeImpl>>;
+
+string make_string(size_t i) {
+  // Lengths cover empty strings and payloads that span several slots.
+  return string(i % 150, static_cast<char>('a' + i % 26)) + to_string(i);
+}
+
+template<class Tree>
+void check_equal(Tree const& tree, deque<string> const& list) {
+  REQUIRE(tree.size() == list.size());
+  size_t i{0};
+  for (string_view value : tree) {
+    REQUIRE(value == list[i]);
+    ++i;
+  }
+  for (i = 0; i < list.size(); ++i) {
+    REQUIRE(tree[i] == list[i]);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("InlineStringTreeImpl - random operations",
+    "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+  using Counts = AllocationCounts;
+
+  static_assert(is_same_v<typename Tree::value_type, string_view const>);
+
+  {
+    Tree tree;
+    deque<string> list;
+    IndexRand rand{};
+    size_t value{0};
+
+    size_t const allocations_before{Counts::num_allocations};
+    for (size_t i{0}; i < 300; ++i) {
+      string const s{make_string(value++)};
+      size_t const index{rand(list.size() + 1)};
+      tree.insert(tree.get_iterator_at_index(index), s);
+      list.insert(list.begin() + index, s);
+    }
+    // One allocation per element.
+    CHECK(Counts::num_allocations - allocations_before == 300);
+    check_equal(tree, list);
+
+    for (size_t step{0}; step < 2000; ++step) {
+      switch (rand(6)) {
+        case 0: {
+          string const s{make_string(value++)};
+          tree.push_front(s);
+          list.push_front(s);
+          break;
+        }
+        case 1: {
+          string const s{make_string(value++)};
+          tree.emplace_back(s);
+          list.push_back(s);
+          break;
+        }
+        case 2: {
+          size_t const index{rand(list.size() + 1)};
+          tree.emplace(tree.get_iterator_at_index(index), "literal");
+          list.insert(list.begin() + index, "literal");
+          break;
+        }
+        default:
+          if (!list.empty()) {
+            size_t const index{rand(list.size())};
+            tree.erase(tree.get_iterator_at_index(index));
+            list.erase(list.begin() + index);
+          }
+          break;
+      }
+      if (step % 200 == 0) {
+        check_equal(tree, list);
+      }
+    }
+    check_equal(tree, list);
+
+    // Copies allocate their own payloads.
+    Tree copy{tree};
+    tree.clear();
+    check_equal(copy, list);
+
+    Tree other;
+    other.assign(list.begin(), list.end());
+    check_equal(other, list);
+  }
+  CHECK(Counts::num_bytes == 0);
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/frequency_biased_tree_impl.hpp>
+#include <ordered_binary_trees/key_indexed_tree.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+struct Item {
+  size_t id;
+  string name;
+  bool operator==(Item const& other) const {
+    return id == other.id && name == other.name;
+  }
+};
+
+struct IdOf {
+  size_t operator()(Item const& item) const {
+    return item.id;
+  }
+};
+
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Item>,
+    obt::SplayTreeImpl<Item>,
+    obt::FrequencyBiasedTreeImpl<Item>>;
+
+template<class Tree>
+void check_equal(Tree const& tree, deque<Item> const& list) {
+  REQUIRE(tree.size() == list.size());
+  CHECK(equal(tree.begin(), tree.end(), list.begin(), list.end()));
+  for (size_t i{0}; i < list.size(); ++i) {
+    CHECK(tree.index_of(list[i].id) == i);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("KeyIndexedTree - random operations", "", TreeImpls) {
+  using Tree = obt::KeyIndexedTree<TestType, IdOf>;
+
+  static constexpr size_t kNumOperations{3000};
+
+  Tree tree;
+  deque<Item> list;
+
+  CHECK_THROWS_AS(tree.index_of(0), out_of_range);
+  CHECK(tree.find(0) == tree.end());
+
+  IndexRand rand{};
+  size_t next_id{0};
+  for (size_t i{0}; i < kNumOperations; ++i) {
+    size_t const op{rand(list.empty() ? 3 : 7)};
+    switch (op) {
+      case 0: {
+        size_t const index{rand(list.size() + 1)};
+        Item item{next_id++, "item " + to_string(i)};
+        auto [it, inserted] = tree.insert(
+            tree.get_iterator_at_index(index), item);
+        CHECK(inserted);
+        CHECK(it.get_index() == index);
+        list.insert(list.begin() + index, item);
+        break;
+      }
+      case 1: {
+        Item item{next_id++, "item " + to_string(i)};
+        list.push_back(item);
+        CHECK(tree.push_back(move(item)).second);
+        break;
+      }
+      case 2: {
+        Item item{next_id++, "item " + to_string(i)};
+        list.push_front(item);
+        CHECK(tree.push_front(item).second);
+        break;
+      }
+      case 3: {
+        size_t const index{rand(list.size())};
+        CHECK(tree.erase(list[index].id) == 1);
+        CHECK(tree.erase(list[index].id) == 0);
+        list.erase(list.begin() + index);
+        break;
+      }
+      case 4: {
+        size_t const index{rand(list.size())};
+        size_t const new_index{rand(list.size())};
+        Item item{list[index]};
+        auto it{tree.move(item.id, new_index)};
+        CHECK(*it == item);
+        list.erase(list.begin() + index);
+        list.insert(list.begin() + new_index, item);
+        break;
+      }
+      case 5: {
+        // Duplicate keys are rejected.
+        size_t const index{rand(list.size())};
+        auto [it, inserted] = tree.push_back(Item{list[index].id, "dup"});
+        CHECK(!inserted);
+        CHECK(it.get_index() == index);
+        break;
+      }
+      case 6: {
+        size_t const index{rand(list.size())};
+        auto it{tree.find(list[index].id)};
+        REQUIRE(it != tree.end());
+        CHECK(*it == list[index]);
+        if (index % 2 == 0) {
+          tree.erase(it);
+          list.erase(list.begin() + index);
+        }
+        break;
+      }
+    }
+    if (i % 200 == 0) {
+      check_equal(tree, list);
+    }
+  }
+  check_equal(tree, list);
+
+  SECTION("copy") {
+    Tree copy{tree};
+    check_equal(copy, list);
+    copy.pop_front();
+    copy.pop_back();
+    list.pop_front();
+    list.pop_back();
+    check_equal(copy, list);
+    CHECK(tree.size() == list.size() + 2);
+  }
+
+  SECTION("move") {
+    Tree other{move(tree)};
+    check_equal(other, list);
+    other.clear();
+    CHECK(other.empty());
+    CHECK(!other.contains(list.front().id));
+  }
+}
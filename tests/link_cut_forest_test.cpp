@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ordered_binary_trees/link_cut_forest.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+struct Min {
+  long long operator()(long long a, long long b) const {
+    return std::min(a, b);
+  }
+};
+
+/// Forest of rooted trees stored as an array of parents.
+struct NaiveForest {
+  static constexpr size_t kNone{SIZE_MAX};
+  vector<size_t> parent;
+  vector<long long> value;
+
+  explicit NaiveForest(size_t n) : parent(n, kNone), value(n) {}
+
+  size_t find_root(size_t v) const {
+    while (parent[v] != kNone) {
+      v = parent[v];
+    }
+    return v;
+  }
+
+  size_t depth(size_t v) const {
+    size_t d{0};
+    for (; parent[v] != kNone; v = parent[v]) {
+      ++d;
+    }
+    return d;
+  }
+
+  /// Returns the path from `v` up to its root.
+  vector<size_t> path_to_root(size_t v) const {
+    vector<size_t> path{v};
+    while (parent[v] != kNone) {
+      v = parent[v];
+      path.push_back(v);
+    }
+    return path;
+  }
+
+  size_t lca(size_t u, size_t v) const {
+    vector<size_t> pu{path_to_root(u)};
+    vector<size_t> pv{path_to_root(v)};
+    if (pu.back() != pv.back()) {
+      return kNone;
+    }
+    size_t a{pu.back()};
+    while (!pu.empty() && !pv.empty() && pu.back() == pv.back()) {
+      a = pu.back();
+      pu.pop_back();
+      pv.pop_back();
+    }
+    return a;
+  }
+
+  /// Returns the vertices on the path from `u` to `v`, in order.
+  vector<size_t> path(size_t u, size_t v) const {
+    size_t const a{lca(u, v)};
+    vector<size_t> result;
+    for (size_t x{u}; x != a; x = parent[x]) {
+      result.push_back(x);
+    }
+    result.push_back(a);
+    vector<size_t> down;
+    for (size_t x{v}; x != a; x = parent[x]) {
+      down.push_back(x);
+    }
+    result.insert(result.end(), down.rbegin(), down.rend());
+    return result;
+  }
+
+  void make_root(size_t v) {
+    size_t prev{kNone};
+    while (v != kNone) {
+      size_t const next{parent[v]};
+      parent[v] = prev;
+      prev = v;
+      v = next;
+    }
+  }
+};
+
+TEST_CASE("LinkCutForest - small tree") {
+  // 0 is the root, 1 is its child, and 2 and 3 are children of 1.
+  // 4 is a child of 3.
+  obt::LinkCutForest<long long> forest{5, 1};
+  CHECK(forest.num_vertices() == 5);
+  CHECK(forest.link(1, 0));
+  CHECK(forest.link(2, 1));
+  CHECK(forest.link(3, 1));
+  CHECK(forest.link(4, 3));
+  CHECK(!forest.link(4, 0));
+
+  CHECK(forest.find_root(4) == 0);
+  CHECK(forest.parent(4) == 3);
+  CHECK(forest.parent(0) == forest.kNone);
+  CHECK(forest.depth(4) == 3);
+  CHECK(forest.lca(2, 4) == 1);
+  CHECK(forest.lca(3, 4) == 3);
+  CHECK(forest.path_aggregate(2, 4) == 4);
+
+  forest.set_value(1, 10);
+  forest.path_add(0, 4, 100);
+  CHECK(forest.value(0) == 101);
+  CHECK(forest.value(1) == 110);
+  CHECK(forest.value(2) == 1);
+  CHECK(forest.path_aggregate(2, 4) == 1 + 110 + 101 + 101);
+  CHECK(forest.find_root(2) == 0);
+
+  CHECK(!forest.cut(2, 4));
+  CHECK(forest.cut(3, 1));
+  CHECK(forest.find_root(4) == 3);
+  CHECK(!forest.connected(4, 0));
+  CHECK(forest.lca(4, 0) == forest.kNone);
+  CHECK(!forest.cut(0));
+  CHECK(forest.cut(2));
+  CHECK(forest.parent(2) == forest.kNone);
+  CHECK(forest.add_vertex(7) == 5);
+  CHECK(forest.link(5, 2));
+  CHECK(forest.path_aggregate(5, 2) == 8);
+}
+
+TEST_CASE("LinkCutForest - path order") {
+  obt::LinkCutForest<string, plus<string>, void> forest;
+  for (char c : string{"abcdef"}) {
+    forest.add_vertex(string(1, c));
+  }
+  // a - b - c, d - e - f, then c - d.
+  CHECK(forest.link(1, 0));
+  CHECK(forest.link(2, 1));
+  CHECK(forest.link(4, 3));
+  CHECK(forest.link(5, 4));
+  CHECK(forest.link(2, 3));
+  CHECK(forest.find_root(0) == 3);
+  CHECK(forest.path_aggregate(0, 5) == "abcdef");
+  CHECK(forest.path_aggregate(5, 0) == "fedcba");
+  CHECK(forest.path_aggregate(1, 4) == "bcde");
+  CHECK(forest.path_aggregate(3, 3) == "d");
+  CHECK(forest.find_root(0) == 3);
+}
+
+TEST_CASE("LinkCutForest - random operations") {
+  static constexpr size_t kNumVertices{40};
+  IndexRand rand{};
+  obt::LinkCutForest<long long> sums{kNumVertices};
+  obt::LinkCutForest<long long, Min, obt::AddToExtremum> mins{kNumVertices};
+  NaiveForest naive{kNumVertices};
+  for (size_t v{0}; v < kNumVertices; ++v) {
+    long long const x{static_cast<long long>(rand(1000))};
+    naive.value[v] = x;
+    sums.set_value(v, x);
+    mins.set_value(v, x);
+  }
+
+  for (size_t step{0}; step < 4000; ++step) {
+    size_t const u{rand(kNumVertices)};
+    size_t const v{rand(kNumVertices)};
+    bool const connected{naive.find_root(u) == naive.find_root(v)};
+    switch (rand(6)) {
+      case 0:
+      case 1: {
+        bool const linked{sums.link(u, v)};
+        REQUIRE(mins.link(u, v) == linked);
+        REQUIRE(linked == !connected);
+        if (linked) {
+          naive.make_root(u);
+          naive.parent[u] = v;
+        }
+        break;
+      }
+      case 2: {
+        bool const is_edge{
+            naive.parent[u] == v || naive.parent[v] == u};
+        bool const cut{sums.cut(u, v)};
+        REQUIRE(mins.cut(u, v) == cut);
+        REQUIRE(cut == is_edge);
+        if (naive.parent[u] == v) {
+          naive.parent[u] = NaiveForest::kNone;
+        } else if (naive.parent[v] == u) {
+          naive.parent[v] = NaiveForest::kNone;
+        }
+        break;
+      }
+      case 3:
+        if (connected) {
+          long long const delta{static_cast<long long>(rand(21)) - 10};
+          sums.path_add(u, v, delta);
+          mins.path_add(u, v, delta);
+          for (size_t x : naive.path(u, v)) {
+            naive.value[x] += delta;
+          }
+        }
+        break;
+      default:
+        REQUIRE(sums.find_root(u) == naive.find_root(u));
+        REQUIRE(sums.parent(u) == naive.parent[u]);
+        REQUIRE(sums.depth(v) == naive.depth(v));
+        REQUIRE(sums.value(u) == naive.value[u]);
+        REQUIRE(sums.lca(u, v) == naive.lca(u, v));
+        if (connected) {
+          long long sum{0};
+          long long min{naive.value[u]};
+          for (size_t x : naive.path(u, v)) {
+            sum += naive.value[x];
+            min = std::min(min, naive.value[x]);
+          }
+          REQUIRE(sums.path_aggregate(u, v) == sum);
+          REQUIRE(mins.path_aggregate(u, v) == min);
+        }
+        break;
+    }
+  }
+}
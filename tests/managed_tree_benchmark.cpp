@@ -1,41 +1,55 @@
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <deque>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/buffered_tree_impl.hpp>
+#include <ordered_binary_trees/bulk_cursors.hpp>
+#include <ordered_binary_trees/compact_tree.hpp>
+#include <ordered_binary_trees/concurrent_skip_list.hpp>
+#include <ordered_binary_trees/concurrent_tree.hpp>
+#include <ordered_binary_trees/euler_tour_forest.hpp>
+#include <ordered_binary_trees/implicit_sequence_impl.hpp>
+#include <ordered_binary_trees/inline_string_tree_impl.hpp>
+#include <ordered_binary_trees/link_cut_forest.hpp>
 #include <ordered_binary_trees/managed_tree.hpp>
 #include <ordered_binary_trees/ordered_binary_tree.hpp>
 #include <ordered_binary_trees/ordered_binary_tree_node.hpp>
+#include <ordered_binary_trees/packed_tree_impl.hpp>
 #include <ordered_binary_trees/ordered_binary_tree_iterator.hpp>
 #include <ordered_binary_trees/splay_tree_impl.hpp>
+#include <ordered_binary_trees/tiered_vector_impl.hpp>
 
 #include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_template_test_macros.hpp>
 
+#include "test_utils.hpp"
+
 namespace obt = ordered_binary_trees;
 using namespace std;
 
-struct IndexRand {
-  mt19937_64 generator;
-  IndexRand(uint_fast64_t seed = 123456) : generator{seed} {}
-  size_t operator()(size_t modulus) {
-    return static_cast<size_t>(
-        generator() % static_cast<uint_fast64_t>(modulus));
-  }
-};
-
 using Value = size_t;
-using TreeImpls = tuple<obt::BasicTreeImpl<Value>, obt::SplayTreeImpl<Value>>;
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>,
+    obt::TieredVectorImpl<Value>,
+    obt::ImplicitSequenceImpl<Value>,
+    obt::BufferedTreeImpl<Value>,
+    obt::PackedTreeImpl<Value>>;
 
 TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - insertion",
     "", TreeImpls) {
@@ -71,6 +85,479 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - insertion",
   
 }
 
+// Hidden because it takes minutes and tens of gigabytes; run it with
+//   `"[large]" --benchmark-samples 1`.
+TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - large insertion",
+    "[.][large]", TreeImpls) {
+
+  using Tree = obt::ManagedTree<TestType>;
+
+  static constexpr size_t kLength{100000000};
+
+  BENCHMARK("insert at random index") {
+    IndexRand rand{};
+    Tree tree;
+    for (size_t i{0}; i < kLength; ++i) {
+      tree.insert(tree.get_iterator_at_index(rand(i + 1)), i);
+    }
+    return tree.size();
+  };
+
+}
+
+TEST_CASE("ManagedTree benchmark - many small trees") {
+
+  using Impl = obt::BasicTreeImpl<Value>;
+  using Managed = obt::ManagedTree<Impl>;
+  using Compact = obt::CompactTree<Impl>;
+
+  static constexpr size_t kNumTrees{1 << 16};
+
+  cout << "sizeof(ManagedTree) = " << sizeof(Managed)
+      << ", sizeof(CompactTree) = " << sizeof(Compact) << endl;
+
+  BENCHMARK("ManagedTree: build and sum") {
+    vector<Managed> trees(kNumTrees);
+    for (size_t i{0}; i < kNumTrees; ++i) {
+      for (size_t j{0}; j < i % 4; ++j) {
+        trees[i].push_back(j);
+      }
+    }
+    size_t sum{0};
+    for (auto const& tree : trees) {
+      for (auto const& value : tree) {
+        sum += value;
+      }
+    }
+    return sum;
+  };
+
+  BENCHMARK("CompactTree: build and sum") {
+    vector<Compact> trees(kNumTrees);
+    for (size_t i{0}; i < kNumTrees; ++i) {
+      for (size_t j{0}; j < i % 4; ++j) {
+        trees[i].push_back(j);
+      }
+    }
+    size_t sum{0};
+    for (auto const& tree : trees) {
+      tree.for_each([&sum](Value const& value) { sum += value; });
+    }
+    return sum;
+  };
+
+}
+
+using ReassignTreeImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>>;
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - reassignment",
+    "", ReassignTreeImpls) {
+
+  using Tree = obt::ManagedTree<TestType>;
+
+  static constexpr size_t kLength{1 << 14};
+
+  vector<Value> values;
+  for (size_t i{0}; i < kLength; ++i) {
+    values.push_back(i);
+  }
+  Tree other;
+  other.assign(values.begin(), values.end());
+  Tree tree{other};
+
+  BENCHMARK("clear, then assign") {
+    tree.clear();
+    tree.assign(values.begin(), values.end());
+    return tree.size();
+  };
+
+  BENCHMARK("assign over existing elements") {
+    tree.assign(values.begin(), values.end());
+    return tree.size();
+  };
+
+  BENCHMARK("copy-assign over existing elements") {
+    tree = other;
+    return tree.size();
+  };
+
+}
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - time-sliced bulk operations",
+    "", ReassignTreeImpls) {
+
+  using Tree = obt::ManagedTree<TestType>;
+
+  static constexpr size_t kLength{1 << 14};
+  static constexpr size_t kBudget{256};
+
+  vector<Value> values;
+  for (size_t i{0}; i < kLength; ++i) {
+    values.push_back(i);
+  }
+  Tree other;
+  other.assign(values.begin(), values.end());
+
+  BENCHMARK("copy, then clear") {
+    Tree tree{other};
+    tree.clear();
+    return tree.size();
+  };
+
+  BENCHMARK("copy, then clear, in steps") {
+    obt::CloneCursor<TestType> clone{other};
+    while (!clone.step(kBudget)) {}
+    Tree tree{clone.take()};
+    obt::DestructionCursor<TestType> destruction{tree};
+    while (!destruction.step(kBudget)) {}
+    return tree.size();
+  };
+
+  // The longest pause of the stepped version.
+  BENCHMARK("one step") {
+    obt::CloneCursor<TestType> clone{other};
+    return clone.step(kBudget);
+  };
+
+}
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - skewed random access",
+    "", ReassignTreeImpls) {
+
+  using Tree = obt::ManagedTree<TestType>;
+
+  static constexpr size_t kLength{1 << 16};
+  static constexpr size_t kNumReads{1 << 12};
+
+  vector<Value> values;
+  for (size_t i{0}; i < kLength; ++i) {
+    values.push_back(i);
+  }
+  Tree tree;
+  tree.assign(values.begin(), values.end());
+
+  // Indices are log-uniform, so index `i` is read with probability roughly
+  //   proportional to `1 / (i + 1)`.
+  mt19937_64 generator{1234};
+  uniform_real_distribution<double> exponent{0, log2(double{kLength})};
+  vector<size_t> indices;
+  for (size_t i{0}; i < kNumReads; ++i) {
+    indices.push_back(static_cast<size_t>(exp2(exponent(generator))) - 1);
+  }
+
+  BENCHMARK("without index cache") {
+    size_t sum{0};
+    for (size_t index : indices) {
+      sum += tree[index];
+    }
+    return sum;
+  };
+
+  tree.set_index_cache_capacity(256);
+  BENCHMARK("with index cache") {
+    size_t sum{0};
+    for (size_t index : indices) {
+      sum += tree[index];
+    }
+    return sum;
+  };
+
+}
+
+TEST_CASE("ManagedTree benchmark - string elements") {
+
+  using StringTree = obt::ManagedTree<obt::SplayTreeImpl<string>>;
+  using InlineTree = obt::ManagedTree<obt::InlineStringTreeImpl<char>>;
+
+  static constexpr size_t kLength{1 << 16};
+  static constexpr size_t kNumReads{1 << 16};
+
+  // Longer than the small-string buffer, so `std::string` allocates.
+  vector<string> strings;
+  for (size_t i{0}; i < kLength; ++i) {
+    strings.push_back(string(24 + i % 16, 'x') + to_string(i));
+  }
+
+  BENCHMARK("std::string: build") {
+    StringTree tree;
+    for (string const& s : strings) {
+      tree.push_back(s);
+    }
+    return tree.size();
+  };
+
+  BENCHMARK("inline payload: build") {
+    InlineTree tree;
+    for (string const& s : strings) {
+      tree.push_back(s);
+    }
+    return tree.size();
+  };
+
+  StringTree string_tree;
+  InlineTree inline_tree;
+  IndexRand rand{};
+  for (string const& s : strings) {
+    size_t const index{rand(string_tree.size() + 1)};
+    string_tree.insert(string_tree.get_iterator_at_index(index), s);
+    inline_tree.insert(inline_tree.get_iterator_at_index(index), s);
+  }
+
+  BENCHMARK("std::string: read last characters in order") {
+    size_t sum{0};
+    for (string const& s : string_tree) {
+      sum += static_cast<unsigned char>(s[s.size() - 1]);
+    }
+    return sum;
+  };
+
+  BENCHMARK("inline payload: read last characters in order") {
+    size_t sum{0};
+    for (string_view s : inline_tree) {
+      sum += static_cast<unsigned char>(s[s.size() - 1]);
+    }
+    return sum;
+  };
+
+  BENCHMARK("std::string: read at random indices") {
+    IndexRand rand{};
+    size_t sum{0};
+    for (size_t i{0}; i < kNumReads; ++i) {
+      string const& s{string_tree[rand(kLength)]};
+      sum += static_cast<unsigned char>(s[s.size() - 1]);
+    }
+    return sum;
+  };
+
+  BENCHMARK("inline payload: read at random indices") {
+    IndexRand rand{};
+    size_t sum{0};
+    for (size_t i{0}; i < kNumReads; ++i) {
+      string_view s{inline_tree[rand(kLength)]};
+      sum += static_cast<unsigned char>(s[s.size() - 1]);
+    }
+    return sum;
+  };
+
+}
+
+TEST_CASE("ManagedTree benchmark - dynamic connectivity") {
+
+  static constexpr size_t kNumVertices{1 << 12};
+  static constexpr size_t kNumChanges{1 << 8};
+  static constexpr size_t kNumQueries{16};
+
+  // A random spanning tree. Each change cuts an edge, answers queries, and
+  //   links the edge back.
+  vector<pair<size_t, size_t>> edges;
+  {
+    IndexRand rand{};
+    for (size_t v{1}; v < kNumVertices; ++v) {
+      edges.emplace_back(v, rand(v));
+    }
+  }
+
+  // Every change is undone at the end of each iteration, so the structures
+  //   are built only once.
+  vector<vector<size_t>> adjacent(kNumVertices);
+  obt::EulerTourForest<size_t> forest{kNumVertices};
+  for (auto [u, v] : edges) {
+    adjacent[u].push_back(v);
+    adjacent[v].push_back(u);
+    forest.link(u, v);
+  }
+
+  BENCHMARK("recompute components after every change") {
+    auto erase_from{[](vector<size_t>& list, size_t v) {
+      list.erase(find(list.begin(), list.end(), v));
+    }};
+    vector<size_t> label(kNumVertices);
+    vector<size_t> stack;
+    IndexRand rand{};
+    size_t count{0};
+    for (size_t i{0}; i < kNumChanges; ++i) {
+      auto [u, v]{edges[rand(edges.size())]};
+      erase_from(adjacent[u], v);
+      erase_from(adjacent[v], u);
+      fill(label.begin(), label.end(), kNumVertices);
+      for (size_t s{0}; s < kNumVertices; ++s) {
+        if (label[s] != kNumVertices) {
+          continue;
+        }
+        label[s] = s;
+        stack.push_back(s);
+        while (!stack.empty()) {
+          size_t const x{stack.back()};
+          stack.pop_back();
+          for (size_t y : adjacent[x]) {
+            if (label[y] == kNumVertices) {
+              label[y] = s;
+              stack.push_back(y);
+            }
+          }
+        }
+      }
+      for (size_t q{0}; q < kNumQueries; ++q) {
+        count += label[rand(kNumVertices)] == label[rand(kNumVertices)];
+      }
+      adjacent[u].push_back(v);
+      adjacent[v].push_back(u);
+    }
+    return count;
+  };
+
+  BENCHMARK("EulerTourForest") {
+    IndexRand rand{};
+    size_t count{0};
+    for (size_t i{0}; i < kNumChanges; ++i) {
+      auto [u, v]{edges[rand(edges.size())]};
+      forest.cut(u, v);
+      for (size_t q{0}; q < kNumQueries; ++q) {
+        count += forest.connected(rand(kNumVertices), rand(kNumVertices));
+      }
+      forest.link(u, v);
+    }
+    return count;
+  };
+
+}
+
+TEST_CASE("ManagedTree benchmark - dynamic path queries") {
+
+  static constexpr size_t kNumVertices{1 << 12};
+  static constexpr size_t kNumChanges{1 << 8};
+  static constexpr size_t kNumQueries{16};
+
+  // A deep random tree: each vertex hangs from one of the few vertices
+  //   before it. Each change moves a vertex under another parent, answers
+  //   path sum queries, and moves it back.
+  vector<size_t> parents(kNumVertices, kNumVertices);
+  {
+    IndexRand rand{};
+    for (size_t v{1}; v < kNumVertices; ++v) {
+      parents[v] = v - 1 - rand(min<size_t>(v, 4));
+    }
+  }
+
+  BENCHMARK("walk parent pointers") {
+    vector<size_t> parent{parents};
+    vector<long long> value(kNumVertices, 1);
+    vector<size_t> mark(kNumVertices, kNumVertices);
+    IndexRand rand{};
+    long long total{0};
+    for (size_t i{0}; i < kNumChanges; ++i) {
+      size_t const v{1 + rand(kNumVertices - 1)};
+      size_t const p{rand(v)};
+      size_t const old{parent[v]};
+      parent[v] = p;
+      for (size_t q{0}; q < kNumQueries; ++q) {
+        size_t const a{rand(kNumVertices)};
+        size_t const b{rand(kNumVertices)};
+        // Mark the path from `a` to the root, then climb from `b`.
+        for (size_t x{a}; x != kNumVertices; x = parent[x]) {
+          mark[x] = q + i * kNumQueries;
+        }
+        size_t lca{b};
+        long long sum{0};
+        for (; mark[lca] != q + i * kNumQueries; lca = parent[lca]) {
+          sum += value[lca];
+        }
+        for (size_t x{a}; x != lca; x = parent[x]) {
+          sum += value[x];
+        }
+        total += sum + value[lca];
+      }
+      parent[v] = old;
+    }
+    return total;
+  };
+
+  obt::LinkCutForest<long long> forest{kNumVertices, 1};
+  for (size_t v{1}; v < kNumVertices; ++v) {
+    forest.link(v, parents[v]);
+  }
+
+  BENCHMARK("LinkCutForest") {
+    IndexRand rand{};
+    long long total{0};
+    for (size_t i{0}; i < kNumChanges; ++i) {
+      size_t const v{1 + rand(kNumVertices - 1)};
+      size_t const p{rand(v)};
+      size_t const old{parents[v]};
+      forest.cut(v);
+      forest.link(v, p);
+      for (size_t q{0}; q < kNumQueries; ++q) {
+        total += forest.path_aggregate(
+            rand(kNumVertices), rand(kNumVertices));
+      }
+      forest.cut(v);
+      forest.link(v, old);
+    }
+    return total;
+  };
+
+}
+
+/// `ManagedTree` behind a global lock, as the baseline for concurrent use.
+template<class TreeImpl>
+struct LockedTree {
+  obt::ManagedTree<TreeImpl> tree;
+  mutable mutex tree_mutex;
+
+  size_t size() const {
+    lock_guard<mutex> lock{tree_mutex};
+    return tree.size();
+  }
+  Value operator[](size_t index) const {
+    lock_guard<mutex> lock{tree_mutex};
+    return tree[index];
+  }
+  void push_back(Value value) {
+    lock_guard<mutex> lock{tree_mutex};
+    tree.push_back(value);
+  }
+};
+
+using ConcurrentSequences = tuple<
+    LockedTree<obt::SplayTreeImpl<Value>>,
+    obt::ConcurrentTree<Value>,
+    obt::ConcurrentSkipList<Value>>;
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - contended append and index",
+    "", ConcurrentSequences) {
+
+  static constexpr size_t kNumThreads{4};
+  static constexpr size_t kNumAppends{1 << 12};
+  static constexpr size_t kReadsPerAppend{4};
+
+  BENCHMARK("append and read at random indices") {
+    TestType sequence;
+    sequence.push_back(0);
+    vector<thread> threads;
+    for (size_t t{0}; t < kNumThreads; ++t) {
+      threads.emplace_back([&sequence, t]() {
+        IndexRand rand{t + 1};
+        for (size_t i{0}; i < kNumAppends; ++i) {
+          sequence.push_back(i);
+          for (size_t j{0}; j < kReadsPerAppend; ++j) {
+            // Only the first element is guaranteed to be there.
+            if (sequence[rand(i / 2 + 1)] > kNumAppends) {
+              throw logic_error("invalid value");
+            }
+          }
+        }
+      });
+    }
+    for (thread& t : threads) {
+      t.join();
+    }
+    return sequence.size();
+  };
+
+}
+
 TEMPLATE_LIST_TEST_CASE("ManagedTree benchmark - element access",
     "", TreeImpls) {
 
@@ -1,43 +1,64 @@
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
-#include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/buffered_tree_impl.hpp>
+#include <ordered_binary_trees/frequency_biased_tree_impl.hpp>
+#include <ordered_binary_trees/implicit_sequence_impl.hpp>
 #include <ordered_binary_trees/managed_tree.hpp>
 #include <ordered_binary_trees/ordered_binary_tree.hpp>
 #include <ordered_binary_trees/ordered_binary_tree_node.hpp>
 #include <ordered_binary_trees/ordered_binary_tree_iterator.hpp>
+#include <ordered_binary_trees/packed_tree_impl.hpp>
 #include <ordered_binary_trees/splay_tree_impl.hpp>
+#include <ordered_binary_trees/tiered_vector_impl.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_template_test_macros.hpp>
 
+#include "test_utils.hpp"
+
 namespace obt = ordered_binary_trees;
 using namespace std;
 
-struct IndexRand {
-  mt19937_64 generator;
-  IndexRand(uint_fast64_t seed = 123456) : generator{seed} {}
-  size_t operator()(size_t modulus) {
-    return static_cast<size_t>(
-        generator() % static_cast<uint_fast64_t>(modulus));
-  }
-};
-
 using Value = size_t;
-using TreeImpls = tuple<obt::BasicTreeImpl<Value>, obt::SplayTreeImpl<Value>>;
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>,
+    obt::FrequencyBiasedTreeImpl<Value>>;
+
+// Implementations with their own `Container` share only the sequence
+// interface, so they run the cases that stick to it.
+using SequenceImpls = tuple<
+    obt::BasicTreeImpl<Value>,
+    obt::SplayTreeImpl<Value>,
+    obt::FrequencyBiasedTreeImpl<Value>,
+    obt::TieredVectorImpl<Value>,
+    obt::ImplicitSequenceImpl<Value>,
+    obt::BufferedTreeImpl<Value>,
+    obt::PackedTreeImpl<Value>>;
+
+template<class TreeImpl, class = void>
+struct HasContainer: false_type {};
+
+template<class TreeImpl>
+struct HasContainer<TreeImpl, void_t<typename TreeImpl::Container>>
+  : true_type {};
 
 TEMPLATE_LIST_TEST_CASE("ManagedTree - insertion",
-    "", TreeImpls) {
+    "", SequenceImpls) {
   
   using Tree = obt::ManagedTree<TestType>;
 
@@ -130,7 +151,7 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - insertion",
 }
 
 TEMPLATE_LIST_TEST_CASE("ManagedTree - element access",
-    "", TreeImpls) {
+    "", SequenceImpls) {
   
   using Tree = obt::ManagedTree<TestType>;
 
@@ -177,7 +198,7 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - element access",
 }
 
 TEMPLATE_LIST_TEST_CASE("ManagedTree - bulk insertion",
-    "", TreeImpls) {
+    "", SequenceImpls) {
   
   using Tree = obt::ManagedTree<TestType>;
 
@@ -214,7 +235,7 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - bulk insertion",
 }
 
 TEMPLATE_LIST_TEST_CASE("ManagedTree - erase",
-    "", TreeImpls) {
+    "", SequenceImpls) {
   
   using Tree = obt::ManagedTree<TestType>;
 
@@ -363,6 +384,59 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - join",
         list_1.begin(), list_1.end()));
   }
 
+  SECTION("back lazily") {
+    auto it{tree_1.join_back_lazy(tree_2)};
+    CHECK(it == tree_1.get_iterator_at_index(kLength));
+    CHECK(tree_2.empty());
+
+    list_1.insert(list_1.end(), list_2.begin(), list_2.end());
+    CHECK(equal(
+        tree_1.begin(), tree_1.end(),
+        list_1.begin(), list_1.end()));
+
+    it = tree_1.join_back_lazy(tree_3);
+    CHECK(it == tree_1.end());
+
+    IndexRand rand{};
+    Value value{list_1.back() + 1};
+    for (size_t i{0}; i < 1000; ++i) {
+      Tree piece;
+      for (size_t j{rand(4)}; j > 0; --j) {
+        piece.push_back(value);
+        list_1.push_back(value++);
+      }
+      bool const empty_piece{piece.empty()};
+      it = tree_1.join_back_lazy(piece);
+      CHECK(piece.empty());
+      if (empty_piece) {
+        CHECK(it == tree_1.end());
+      }
+      if (i % 7 == 0) {
+        size_t const index{rand(list_1.size())};
+        list_1.erase(list_1.begin() + index);
+        tree_1.erase(tree_1.get_iterator_at_index(index));
+      }
+      if (i % 100 == 0) {
+        for (size_t j{0}; j < list_1.size(); ++j) {
+          REQUIRE(tree_1[j] == list_1[j]);
+        }
+      }
+    }
+    CHECK(equal(
+        tree_1.begin(), tree_1.end(),
+        list_1.begin(), list_1.end()));
+    CHECK(equal(
+        tree_1.rbegin(), tree_1.rend(),
+        list_1.rbegin(), list_1.rend()));
+
+    Tree tree_4;
+    tree_4.push_back(1);
+    it = tree_3.join_back_lazy(tree_4);
+    CHECK(it == tree_3.begin());
+    CHECK(tree_3.size() == 1);
+    CHECK(tree_3.front() == 1);
+  }
+
   SECTION("middle") {
     for (size_t i{0}; i <= tree_1.size(); ++i) {
       Tree tree_a{tree_1};
@@ -388,13 +462,26 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - join",
 }
 
 TEMPLATE_LIST_TEST_CASE("ManagedTree - random operations",
-    "", TreeImpls) {
+    "", SequenceImpls) {
   
   using Tree = obt::ManagedTree<TestType>;
 
   Tree tree;
   deque<Value> list;
 
+  // Iterators of node-based trees stay valid through erasure, so `erase()`
+  // must return the iterator to the next element taken beforehand.
+  // Iterators of a `Container` are positions, so the returned iterator is
+  // compared with the erased position instead.
+  auto check_erase_result = [&tree](
+      auto const& result, auto const& next, size_t index) {
+    if constexpr (HasContainer<TestType>::value) {
+      CHECK(result == tree.get_iterator_at_index(index));
+    } else {
+      CHECK(result == next);
+    }
+  };
+
   auto read_only_check = [](auto& tree, auto& list) {
     CHECK(equal(tree.begin(), tree.end(), list.begin(), list.end()));
     CHECK(equal(tree.rbegin(), tree.rend(), list.rbegin(), list.rend()));
@@ -605,7 +692,9 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - random operations",
         cout << "erase an interval: [" << begin << ", " << end << ")\n";
         auto end_it{tree.get_iterator_at_index(end)};
         list.erase(list.begin() + begin, list.begin() + end);
-        CHECK(tree.erase(tree.get_iterator_at_index(begin), end_it) == end_it);
+        check_erase_result(
+            tree.erase(tree.get_iterator_at_index(begin), end_it),
+            end_it, begin);
         break;
       }
       case 4: { // Erase one element from one of the two ends.
@@ -622,28 +711,32 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - random operations",
           case 1: // erase at get_front_iterator()
             cout << "erase(get_front_iterator())\n";
             list.erase(list.begin());
-            CHECK(tree.erase(tree.get_front_iterator()) == it_1);
+            check_erase_result(tree.erase(tree.get_front_iterator()), it_1, 0);
             break;
           case 2: // erase at begin()
             cout << "erase(begin())\n";
             list.erase(list.cbegin());
-            CHECK(tree.erase(tree.cbegin()) == it_1);
+            check_erase_result(tree.erase(tree.cbegin()), it_1, 0);
             break;
           case 3: // pop_back
             cout << "pop_back()\n";
             list.pop_back();
             tree.pop_back();
             break;
-          case 4: // erase at get_back_iterator()
+          case 4: { // erase at get_back_iterator()
             cout << "erase(get_back_iterator())\n";
             list.erase(std::prev(list.end()));
-            CHECK(tree.erase(tree.get_back_iterator()) == it_end);
+            auto const it{tree.erase(tree.get_back_iterator())};
+            check_erase_result(it, it_end, tree.size());
             break;
-          case 5: // erase at end() - 1
+          }
+          case 5: { // erase at end() - 1
             cout << "erase(end() - 1)\n";
             list.erase(std::prev(list.cend()));
-            CHECK(tree.erase(std::prev(tree.cend())) == it_end);
+            auto const it{tree.erase(std::prev(tree.cend()))};
+            check_erase_result(it, it_end, tree.size());
             break;
+          }
           default:
             REQUIRE(false);
             break;
@@ -657,7 +750,8 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - random operations",
         cout << "erase(get_iterator_at_index(" << index << "))\n";
         auto it_next{tree.get_iterator_at_index(index + 1)};
         list.erase(list.begin() + index);
-        CHECK(tree.erase(tree.get_iterator_at_index(index)) == it_next);
+        check_erase_result(
+            tree.erase(tree.get_iterator_at_index(index)), it_next, index);
         break;
       }
     }
@@ -667,3 +761,474 @@ TEMPLATE_LIST_TEST_CASE("ManagedTree - random operations",
   }
 }
 
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree - freeze and thaw",
+    "", TreeImpls) {
+
+  using Tree = obt::ManagedTree<TestType>;
+  using Frozen = typename Tree::frozen_type;
+
+  SECTION("small") {
+    Tree tree;
+    deque<Value> list;
+    static constexpr size_t kLength{100};
+    for (size_t i{0}; i < kLength; ++i) {
+      tree.insert(tree.get_iterator_at_index(i / 2), i);
+      list.insert(list.begin() + i / 2, i);
+    }
+
+    Frozen frozen{tree.freeze()};
+    CHECK(equal(frozen.begin(), frozen.end(), list.begin(), list.end()));
+    CHECK(equal(frozen.rbegin(), frozen.rend(), list.rbegin(), list.rend()));
+    for (size_t i{0}; i < kLength; ++i) {
+      CHECK(frozen[i] == list[i]);
+      CHECK(frozen.data()[i] == list[i]);
+    }
+    CHECK(!frozen.has_prefix_aggregates());
+    frozen.compute_prefix_aggregates([](Value a, Value b) { return a + b; });
+    REQUIRE(frozen.has_prefix_aggregates());
+    Value sum{0};
+    for (size_t i{0}; i < kLength; ++i) {
+      sum += list[i];
+      CHECK(frozen.prefix_aggregate(i) == sum);
+    }
+
+    Tree thawed;
+    thawed.push_back(12345);
+    thawed.thaw(frozen);
+    CHECK(equal(thawed.begin(), thawed.end(), list.begin(), list.end()));
+    CHECK(frozen.size() == kLength);
+
+    Tree moved;
+    moved.thaw(std::move(frozen));
+    CHECK(frozen.empty());
+    CHECK(equal(moved.begin(), moved.end(), list.begin(), list.end()));
+    for (size_t i{0}; i < kLength; ++i) {
+      CHECK(moved[i] == list[i]);
+    }
+
+    Tree empty_tree;
+    CHECK(empty_tree.freeze().empty());
+  }
+
+  SECTION("large enough to be copied in parallel") {
+    static constexpr size_t kLength{Frozen::kParallelGrainSize * 8 + 3};
+    vector<Value> values;
+    for (size_t i{0}; i < kLength; ++i) {
+      values.push_back(i * 7 % 1000);
+    }
+    Tree tree;
+    tree.thaw(Frozen{values.begin(), values.end()});
+    REQUIRE(tree.size() == kLength);
+    Frozen frozen{tree.freeze()};
+    CHECK(equal(frozen.begin(), frozen.end(), values.begin(), values.end()));
+  }
+}
+
+/// Counts live instances and throws from the copy constructor once
+/// `copies_left` copies have been made.
+struct ThrowingCopy {
+  static inline size_t live{0};
+  static inline size_t copies_left{SIZE_MAX};
+
+  size_t value;
+
+  ThrowingCopy(size_t value) : value{value} {
+    ++live;
+  }
+  ThrowingCopy(ThrowingCopy const& other) : value{other.value} {
+    if (copies_left == 0) {
+      throw runtime_error{"copy"};
+    }
+    --copies_left;
+    ++live;
+  }
+  ~ThrowingCopy() {
+    --live;
+  }
+};
+
+TEST_CASE("ManagedTree - freeze and thaw with throwing copies") {
+  using Tree = obt::ManagedTree<obt::BasicTreeImpl<ThrowingCopy>>;
+  using Frozen = typename Tree::frozen_type;
+
+  static constexpr size_t kLength{100};
+  vector<ThrowingCopy> values;
+  for (size_t i{0}; i < kLength; ++i) {
+    values.emplace_back(i);
+  }
+  Tree tree;
+  for (size_t i{0}; i < 10; ++i) {
+    tree.emplace_back(i + 1000);
+  }
+  auto check_tree = [&tree]() {
+    REQUIRE(tree.size() == 10);
+    for (size_t i{0}; i < 10; ++i) {
+      CHECK(tree[i].value == i + 1000);
+    }
+  };
+  size_t const live{ThrowingCopy::live};
+
+  ThrowingCopy::copies_left = 5;
+  CHECK_THROWS_AS((Frozen{values.begin(), values.end()}), runtime_error);
+  CHECK(ThrowingCopy::live == live);
+
+  ThrowingCopy::copies_left = 5;
+  CHECK_THROWS_AS(tree.freeze(), runtime_error);
+  CHECK(ThrowingCopy::live == live);
+  check_tree();
+
+  ThrowingCopy::copies_left = SIZE_MAX;
+  Frozen frozen{values.begin(), values.end()};
+  size_t const frozen_live{ThrowingCopy::live};
+  ThrowingCopy::copies_left = 50;
+  CHECK_THROWS_AS(tree.thaw(frozen), runtime_error);
+  CHECK(ThrowingCopy::live == frozen_live);
+  check_tree();
+
+  ThrowingCopy::copies_left = SIZE_MAX;
+  tree.thaw(frozen);
+  REQUIRE(tree.size() == kLength);
+  for (size_t i{0}; i < kLength; ++i) {
+    CHECK(tree[i].value == i);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree - edit session",
+    "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+
+  static constexpr size_t kLength{2000};
+  static constexpr size_t kNumBursts{20};
+  static constexpr size_t kBurstLength{100};
+
+  Tree tree;
+  deque<Value> list;
+  for (size_t i{0}; i < kLength; ++i) {
+    tree.push_back(i);
+    list.push_back(i);
+  }
+
+  IndexRand rand{};
+  Value value{kLength};
+  for (size_t burst{0}; burst < kNumBursts; ++burst) {
+    size_t index{rand(list.size() + 1)};
+    {
+      auto session{tree.edit_session()};
+      auto it{tree.get_iterator_at_index(index)};
+      for (size_t i{0}; i < kBurstLength; ++i) {
+        switch (list.empty() ? 0 : rand(4)) {
+          case 0:
+            it = session.insert(it, value);
+            list.insert(list.begin() + index, value);
+            ++value;
+            break;
+          case 1:
+            if (index < list.size()) {
+              it = session.erase(it);
+              list.erase(list.begin() + index);
+            }
+            break;
+          case 2:
+            if (index < list.size()) {
+              ++it;
+              ++index;
+            }
+            break;
+          case 3:
+            if (index > 0) {
+              --it;
+              --index;
+            }
+            break;
+        }
+        if (index < list.size()) {
+          REQUIRE(*it == list[index]);
+        }
+      }
+    }
+    REQUIRE(tree.size() == list.size());
+    for (size_t i{0}; i < list.size(); ++i) {
+      REQUIRE(tree[i] == list[i]);
+      REQUIRE(tree.get_iterator_at_index(i).get_index() == i);
+    }
+  }
+
+  SECTION("erase everything in one session") {
+    auto session{tree.edit_session()};
+    auto it{tree.begin()};
+    while (it != tree.end()) {
+      it = session.erase(it);
+    }
+    session.commit();
+    CHECK(tree.empty());
+    session.insert(tree.end(), Value{1});
+    session.insert(tree.begin(), Value{0});
+    session.commit();
+    REQUIRE(tree.size() == 2);
+    CHECK(tree[0] == 0);
+    CHECK(tree[1] == 1);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree - map",
+    "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+
+  SECTION("small") {
+    Tree tree;
+    deque<Value> list;
+    static constexpr size_t kLength{300};
+    IndexRand rand{};
+    for (size_t i{0}; i < kLength; ++i) {
+      size_t const index{rand(list.size() + 1)};
+      tree.insert(tree.get_iterator_at_index(index), i);
+      list.insert(list.begin() + index, i);
+    }
+
+    auto doubled{tree.template map<Value>([](Value x) { return x * 2; })};
+    REQUIRE(doubled.size() == kLength);
+    for (size_t i{0}; i < kLength; ++i) {
+      CHECK(doubled[i] == list[i] * 2);
+      CHECK(doubled.get_iterator_at_index(i).get_index() == i);
+    }
+    CHECK(*doubled.begin() == list.front() * 2);
+    CHECK(*doubled.rbegin() == list.back() * 2);
+
+    auto strings{tree.template map<string>([](Value x) {
+      return to_string(x);
+    })};
+    REQUIRE(strings.size() == kLength);
+    size_t i{0};
+    for (auto it{strings.begin()}; it != strings.end(); ++it, ++i) {
+      CHECK(*it == to_string(list[i]));
+    }
+    strings.push_back("end");
+    CHECK(strings[kLength] == "end");
+
+    Tree empty_tree;
+    CHECK(empty_tree.template map<string>([](Value x) {
+      return to_string(x);
+    }).empty());
+
+    size_t calls{0};
+    CHECK_THROWS_AS(tree.template map<Value>([&calls](Value x) {
+      if (++calls == kLength / 2) {
+        throw runtime_error("map");
+      }
+      return x;
+    }), runtime_error);
+  }
+
+  SECTION("large enough to be mapped in parallel") {
+    using Frozen = typename Tree::frozen_type;
+    static constexpr size_t kLength{Frozen::kParallelGrainSize * 8 + 3};
+    vector<Value> values;
+    for (size_t i{0}; i < kLength; ++i) {
+      values.push_back(i * 7 % 1000);
+    }
+    Tree tree;
+    tree.thaw(Frozen{values.begin(), values.end()});
+    auto mapped{tree.template map<Value>([](Value x) { return x + 1; })};
+    REQUIRE(mapped.size() == kLength);
+    size_t i{0};
+    for (auto it{mapped.begin()}; it != mapped.end(); ++it, ++i) {
+      REQUIRE(*it == values[i] + 1);
+    }
+    CHECK(mapped[kLength / 3] == values[kLength / 3] + 1);
+  }
+}
+
+/// Stateful allocator that counts allocations made off its owner thread.
+template<class T>
+struct OwnerThreadAllocator {
+  using value_type = T;
+
+  static inline atomic<size_t> foreign_allocations{0};
+
+  thread::id owner{this_thread::get_id()};
+
+  OwnerThreadAllocator() = default;
+  template<class U>
+  OwnerThreadAllocator(OwnerThreadAllocator<U> const& other)
+    : owner{other.owner} {}
+
+  T* allocate(size_t n) {
+    if (this_thread::get_id() != owner) {
+      ++foreign_allocations;
+    }
+    return allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    allocator<T>{}.deallocate(p, n);
+  }
+
+  template<class U>
+  bool operator==(OwnerThreadAllocator<U> const& other) const {
+    return owner == other.owner;
+  }
+  template<class U>
+  bool operator!=(OwnerThreadAllocator<U> const& other) const {
+    return owner != other.owner;
+  }
+};
+
+TEST_CASE("ManagedTree - map with a stateful allocator") {
+  using Tree = obt::ManagedTree<
+      obt::BasicTreeImpl<Value, OwnerThreadAllocator<Value>>>;
+  using Frozen = typename Tree::frozen_type;
+  static constexpr size_t kLength{Frozen::kParallelGrainSize * 4 + 3};
+  vector<Value> values;
+  for (size_t i{0}; i < kLength; ++i) {
+    values.push_back(i * 7 % 1000);
+  }
+  Tree tree;
+  tree.thaw(Frozen{values.begin(), values.end()});
+  auto mapped{tree.template map<Value>([](Value x) { return x + 1; })};
+  CHECK(OwnerThreadAllocator<Value>::foreign_allocations == 0);
+  REQUIRE(mapped.size() == kLength);
+  size_t i{0};
+  for (auto it{mapped.begin()}; it != mapped.end(); ++it, ++i) {
+    REQUIRE(*it == values[i] + 1);
+  }
+}
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree - assignment reuses nodes",
+    "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+
+  auto get_addresses{[](Tree& tree) {
+    vector<Value*> addresses;
+    for (auto& value : tree) {
+      addresses.push_back(&value);
+    }
+    sort(addresses.begin(), addresses.end());
+    return addresses;
+  }};
+
+  Tree tree;
+  IndexRand rand{};
+  static constexpr size_t kLength{500};
+  for (size_t i{0}; i < kLength; ++i) {
+    tree.insert(tree.get_iterator_at_index(rand(i + 1)), i);
+  }
+  vector<Value*> const addresses{get_addresses(tree)};
+
+  deque<Value> list;
+  for (size_t i{0}; i < kLength; ++i) {
+    list.push_back(i * 3);
+  }
+  tree.assign(list.begin(), list.end());
+  REQUIRE(tree.size() == kLength);
+  CHECK(equal(tree.begin(), tree.end(), list.begin(), list.end()));
+  CHECK(get_addresses(tree) == addresses);
+
+  Tree other;
+  for (size_t i{0}; i < kLength / 2; ++i) {
+    other.push_back(i + 1);
+  }
+  tree = other;
+  REQUIRE(tree.size() == kLength / 2);
+  CHECK(equal(tree.begin(), tree.end(), other.begin(), other.end()));
+  vector<Value*> const small_addresses{get_addresses(tree)};
+  CHECK(includes(addresses.begin(), addresses.end(),
+      small_addresses.begin(), small_addresses.end()));
+  for (size_t i{0}; i < tree.size(); ++i) {
+    CHECK(tree[i] == i + 1);
+  }
+
+  tree = static_cast<Tree const&>(tree);
+  CHECK(tree.size() == kLength / 2);
+  CHECK(get_addresses(tree) == small_addresses);
+
+  other.clear();
+  tree = other;
+  CHECK(tree.empty());
+}
+
+TEMPLATE_LIST_TEST_CASE("ManagedTree - index cache",
+    "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+
+  Tree tree;
+  CHECK(tree.index_cache_capacity() == 0);
+  // A disabled cache costs one pointer.
+  CHECK(sizeof(Tree) == sizeof(typename TestType::Tree) + 2 * sizeof(void*));
+  tree.set_index_cache_capacity(10);
+  CHECK(tree.index_cache_capacity() == 16);
+
+  deque<Value> list;
+  IndexRand rand{};
+  // Small indices are looked up much more often than large ones.
+  auto const skewed_index = [&rand](size_t size) {
+    size_t const r{rand(size)};
+    return r * r / size * r / size;
+  };
+  Value value{0};
+  for (size_t step{0}; step < 20000; ++step) {
+    switch (rand(8)) {
+      case 0: {
+        size_t const index{skewed_index(list.size() + 1)};
+        tree.insert(tree.get_iterator_at_index(index), value);
+        list.insert(list.begin() + index, value);
+        ++value;
+        break;
+      }
+      case 1:
+        if (!list.empty()) {
+          size_t const index{skewed_index(list.size())};
+          tree.erase(tree.get_iterator_at_index(index));
+          list.erase(list.begin() + index);
+        }
+        break;
+      case 2:
+        tree.push_back(value);
+        list.push_back(value);
+        ++value;
+        break;
+      default:
+        if (!list.empty()) {
+          size_t const index{skewed_index(list.size())};
+          Tree const& const_tree{tree};
+          REQUIRE(tree[index] == list[index]);
+          REQUIRE(const_tree[index] == list[index]);
+          REQUIRE(tree.at(index) == list[index]);
+          REQUIRE(*const_tree.get_iterator_at_index(index) == list[index]);
+          size_t const near{min(index + rand(20), list.size() - 1)};
+          REQUIRE(tree[near] == list[near]);
+          REQUIRE(tree.get_iterator_at_index(index).get_index() == index);
+        }
+        break;
+    }
+  }
+  REQUIRE(tree.get_iterator_at_index(list.size()) == tree.end());
+
+  SECTION("whole-tree changes invalidate the cache") {
+    Tree other;
+    for (size_t i{0}; i < 100; ++i) {
+      other.push_back(i + 1000);
+    }
+    tree.swap(other);
+    for (size_t i{0}; i < 100; ++i) {
+      REQUIRE(tree[i] == i + 1000);
+    }
+    tree = other;
+    for (size_t i{0}; i < list.size(); ++i) {
+      REQUIRE(tree[i] == list[i]);
+    }
+    {
+      auto session{tree.edit_session()};
+      session.erase(tree.begin());
+    }
+    list.pop_front();
+    for (size_t i{0}; i < list.size(); ++i) {
+      REQUIRE(tree[i] == list[i]);
+    }
+    Tree moved{std::move(tree)};
+    tree.push_back(7);
+    CHECK(tree[0] == 7);
+    tree.set_index_cache_capacity(0);
+    CHECK(tree.index_cache_capacity() == 0);
+    CHECK(tree[0] == 7);
+  }
+}
@@ -389,6 +389,100 @@ TEST_CASE("OrderedBinaryTree -- clone") {
   tree.destroy_all_nodes();
 }
 
+template<class NodePtr>
+size_t get_height(NodePtr n) {
+  return n ? 1 + max(get_height(n->left_child), get_height(n->right_child)) : 0;
+}
+
+template<class NodePtr>
+bool check_links(NodePtr n) {
+  if (!n) {
+    return true;
+  }
+  size_t const l{n->left_child ? n->left_child->size : 0};
+  size_t const r{n->right_child ? n->right_child->size : 0};
+  return n->size == l + r + 1 &&
+      (!n->left_child || n->left_child->parent == n) &&
+      (!n->right_child || n->right_child->parent == n) &&
+      check_links(n->left_child) && check_links(n->right_child);
+}
+
+TEST_CASE("OrderedBinaryTree -- assign reusing nodes") {
+  using Node = obt::OrderedBinaryTreeNode<string>;
+  using Tree = obt::OrderedBinaryTree<Node>;
+
+  auto get_nodes{[](Tree& tree) {
+    vector<Node*> nodes;
+    for (Node* n{tree.first}; n; n = n->find_next_node()) {
+      nodes.push_back(n);
+    }
+    sort(nodes.begin(), nodes.end());
+    return nodes;
+  }};
+  auto check_shape{[](Tree& tree, size_t size) {
+    CHECK(tree.size() == size);
+    CHECK(check_links(tree.root));
+    CHECK((!tree.root || !tree.root->parent));
+    // A tree built from the middle out has the minimum height.
+    size_t min_height{0};
+    while ((size_t{1} << min_height) <= size) {
+      ++min_height;
+    }
+    CHECK(get_height(tree.root) == min_height);
+  }};
+
+  Tree tree;
+  insert_to_tree(tree, test_insertions_1);
+  vector<Node*> const old_nodes{get_nodes(tree)};
+
+  // Same size: every node is reused.
+  vector<string> list;
+  for (size_t i{0}; i < old_nodes.size(); ++i) {
+    list.push_back("v" + to_string(i));
+  }
+  tree.assign_reusing_nodes(list.begin(), list.end());
+  CHECK(tree_equals_list(tree, list));
+  check_shape(tree, list.size());
+  CHECK(get_nodes(tree) == old_nodes);
+
+  // Smaller: the remaining nodes are old nodes.
+  list.resize(10);
+  tree.assign_reusing_nodes(list.begin(), list.end());
+  CHECK(tree_equals_list(tree, list));
+  check_shape(tree, list.size());
+  vector<Node*> const small_nodes{get_nodes(tree)};
+  CHECK(includes(old_nodes.begin(), old_nodes.end(),
+      small_nodes.begin(), small_nodes.end()));
+
+  // Larger: all old nodes are kept.
+  for (size_t i{0}; i < 50; ++i) {
+    list.push_back("w" + to_string(i));
+  }
+  tree.assign_reusing_nodes(list.begin(), list.end());
+  CHECK(tree_equals_list(tree, list));
+  check_shape(tree, list.size());
+  vector<Node*> const large_nodes{get_nodes(tree)};
+  CHECK(includes(large_nodes.begin(), large_nodes.end(),
+      small_nodes.begin(), small_nodes.end()));
+
+  // Copying from another tree.
+  Tree other;
+  vector<string> other_list;
+  insert_to_tree(other, test_insertions_2);
+  insert_to_list(other_list, test_insertions_2);
+  tree.copy_reusing_nodes(other.root);
+  CHECK(tree_equals_list(tree, other_list));
+  check_shape(tree, other_list.size());
+  CHECK(tree_equals_list(other, other_list));
+
+  tree.assign_reusing_nodes(list.end(), list.end());
+  CHECK(tree.empty());
+  CHECK(!tree.first);
+  CHECK(!tree.last);
+
+  other.destroy_all_nodes();
+}
+
 TEST_CASE("OrderedBinaryTree -- insert positions") {
   using Node = obt::OrderedBinaryTreeNode<string>;
   using Tree = obt::OrderedBinaryTree<Node>;
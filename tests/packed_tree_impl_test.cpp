@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/packed_tree_impl.hpp>
+#include <ordered_binary_trees/managed_tree.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using Tree = obt::ManagedTree<obt::PackedTreeImpl<Value>>;
+
+// Tiny leaves and nodes give deep trees and frequent packing.
+using SmallTree = obt::PackedTree<Value, allocator<Value>, 4, 16, 4>;
+
+TEST_CASE("PackedTree - iteration across leaves") {
+  SmallTree tree;
+  tree.set_cold_age(100);
+  static constexpr size_t kLength{5000};
+  for (size_t i{0}; i < kLength; ++i) {
+    if (i % 3 == 0) {
+      tree.push_front(i);
+    } else {
+      tree.push_back(i);
+    }
+  }
+  vector<Value> forward(tree.begin(), tree.end());
+  vector<Value> backward(tree.rbegin(), tree.rend());
+  reverse(backward.begin(), backward.end());
+  CHECK(forward == backward);
+
+  auto it{tree.end()};
+  for (size_t i{kLength}; i > 0; --i) {
+    --it;
+    CHECK(*it == forward[i - 1]);
+    CHECK(it - tree.begin() == static_cast<ptrdiff_t>(i - 1));
+  }
+  CHECK(it == tree.begin());
+  CHECK(tree.rend()[-1] == tree.front());
+  CHECK(tree.rbegin()[0] == tree.back());
+}
+
+TEST_CASE("PackedTree - random operations") {
+  check_random_sequence_operations<SmallTree>(
+      3000, [](SmallTree& tree) { tree.set_cold_age(50); });
+}
+
+TEST_CASE("PackedTree - cold packing") {
+  SmallTree tree;
+  tree.set_cold_age(1000);
+  deque<Value> list;
+  for (size_t i{0}; i < 5000; ++i) {
+    list.push_back(i);
+  }
+  // Loaded values start out packed.
+  tree.assign(list.begin(), list.end());
+  CHECK(tree.packed_size() == list.size());
+  check_sequence_equal(tree, list);
+
+  // Writes through references do not unpack anything.
+  for (size_t i{0}; i < list.size(); i += 13) {
+    tree[i] += 100000;
+    list[i] += 100000;
+  }
+  CHECK(tree.packed_size() == list.size());
+
+  // An insertion unpacks only a few values around it.
+  IndexRand rand{};
+  size_t const hot_index{2500};
+  tree.insert(tree.get_iterator_at_index(hot_index), 7);
+  list.insert(list.begin() + hot_index, 7);
+  CHECK(tree.packed_size() >= list.size() - 4);
+  CHECK(tree.packed_size() < list.size());
+  check_sequence_equal(tree, list);
+
+  // Keep editing near the front; the region around `hot_index` is packed
+  // again once it has been idle for `cold_age()` modifications.
+  for (size_t i{0}; i < 2000; ++i) {
+    size_t const index{rand(100)};
+    if (i % 2 == 0) {
+      tree.insert(tree.get_iterator_at_index(index), i);
+      list.insert(list.begin() + index, i);
+    } else {
+      tree.erase(tree.get_iterator_at_index(index));
+      list.erase(list.begin() + index);
+    }
+  }
+  check_sequence_equal(tree, list);
+  tree.pack_cold();
+  CHECK(tree.packed_size() >= list.size() - 100);
+  tree.set_cold_age(0);
+  tree.pack_cold();
+  CHECK(tree.packed_size() == list.size());
+  check_sequence_equal(tree, list);
+
+  while (!tree.empty()) {
+    tree.pop_front();
+    list.pop_front();
+  }
+  CHECK(tree.begin() == tree.end());
+  CHECK(tree.packed_size() == 0);
+  CHECK_THROWS_AS(tree.at(0), out_of_range);
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include <ordered_binary_trees/reuse_distance_analyzer.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Analyzer = obt::ReuseDistanceAnalyzer<uint64_t>;
+
+/**
+ *  @brief
+ *  Returns a trace with a hot working set, a slowly drifting warm set, and
+ *    occasional cold addresses.
+ */
+vector<uint64_t> make_trace(size_t length, uint_fast64_t seed) {
+  IndexRand rand{seed};
+  vector<uint64_t> trace;
+  trace.reserve(length);
+  for (size_t i{0}; i < length; ++i) {
+    size_t const kind{rand(10)};
+    if (kind < 6) {
+      trace.push_back(rand(64));
+    } else if (kind < 9) {
+      trace.push_back(1000 + i / 16 + rand(512));
+    } else {
+      trace.push_back(1000000 + rand(1 << 20));
+    }
+  }
+  return trace;
+}
+
+/// Computes a distance by scanning an LRU list.
+size_t list_distance(list<uint64_t>& stack, uint64_t address) {
+  size_t distance{0};
+  for (auto it{stack.begin()}; it != stack.end(); ++it, ++distance) {
+    if (*it == address) {
+      stack.erase(it);
+      stack.push_front(address);
+      return distance;
+    }
+  }
+  stack.push_front(address);
+  return Analyzer::kInfinite;
+}
+
+TEST_CASE("ReuseDistanceAnalyzer - access") {
+  Analyzer analyzer;
+  CHECK(analyzer.access(1) == Analyzer::kInfinite);
+  CHECK(analyzer.access(2) == Analyzer::kInfinite);
+  CHECK(analyzer.access(1) == 1);
+  CHECK(analyzer.access(1) == 0);
+  CHECK(analyzer.access(3) == Analyzer::kInfinite);
+  CHECK(analyzer.access(2) == 2);
+  CHECK(analyzer.num_addresses() == 3);
+  CHECK(analyzer.cold_misses() == 3);
+  CHECK(analyzer.misses_for_capacity(1) == 5);
+  CHECK(analyzer.misses_for_capacity(3) == 3);
+
+  list<uint64_t> stack;
+  Analyzer other;
+  vector<uint64_t> const trace{make_trace(20000, 1)};
+  for (uint64_t address : trace) {
+    REQUIRE(other.access(address) == list_distance(stack, address));
+  }
+  CHECK(other.num_addresses() == stack.size());
+
+  other.clear();
+  CHECK(other.num_addresses() == 0);
+  CHECK(other.access(trace.front()) == Analyzer::kInfinite);
+}
+
+TEST_CASE("ReuseDistanceAnalyzer - analyze") {
+  vector<uint64_t> const trace{make_trace(1 << 19, 2)};
+  vector<uint64_t> const suffix{make_trace(1 << 12, 3)};
+
+  Analyzer sequential;
+  for (uint64_t address : trace) {
+    sequential.access(address);
+  }
+
+  for (size_t num_threads : {1, 3, 8}) {
+    Analyzer batched;
+    batched.analyze(trace.begin(), trace.end(), num_threads);
+    CHECK(batched.cold_misses() == sequential.cold_misses());
+    CHECK(batched.num_addresses() == sequential.num_addresses());
+    CHECK(batched.histogram() == sequential.histogram());
+
+    // The stack is left in the same order as after a sequential pass.
+    Analyzer reference;
+    reference.analyze(trace.begin(), trace.end(), 1);
+    for (uint64_t address : suffix) {
+      REQUIRE(batched.access(address) == reference.access(address));
+    }
+  }
+}
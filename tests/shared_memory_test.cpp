@@ -0,0 +1,215 @@
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ordered_binary_trees/basic_tree_impl.hpp>
+#include <ordered_binary_trees/managed_tree.hpp>
+#include <ordered_binary_trees/shared_memory.hpp>
+#include <ordered_binary_trees/splay_tree_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using Allocator = obt::SharedMemoryAllocator<Value>;
+using TreeImpls = tuple<
+    obt::BasicTreeImpl<Value, Allocator>,
+    obt::SplayTreeImpl<Value, Allocator>>;
+
+static constexpr size_t kSegmentSize{size_t{1} << 24};
+
+string segment_name(char const* suffix) {
+  return "/obt_shared_memory_test_" + to_string(getpid()) + "_" + suffix;
+}
+
+TEST_CASE("OffsetPtr - relocation") {
+  vector<unsigned char> buffer_a(64);
+  vector<unsigned char> buffer_b(64);
+  using Ptr = obt::OffsetPtr<unsigned char>;
+  Ptr* p_a{new(buffer_a.data()) Ptr{buffer_a.data() + 32}};
+  CHECK(p_a->get() == buffer_a.data() + 32);
+  // A byte-wise copy of a buffer that contains an offset pointer and its
+  // pointee still points inside the copy.
+  buffer_b = buffer_a;
+  Ptr* p_b{reinterpret_cast<Ptr*>(buffer_b.data())};
+  CHECK(p_b->get() == buffer_b.data() + 32);
+
+  Ptr null;
+  CHECK(!null);
+  CHECK(null == nullptr);
+  Ptr copy{*p_a};
+  CHECK(copy == *p_a);
+  CHECK(copy.get() == buffer_a.data() + 32);
+  ++copy;
+  CHECK(copy - *p_a == 1);
+  CHECK(*p_a < copy);
+  obt::OffsetPtr<void> v{copy};
+  CHECK(static_cast<obt::OffsetPtr<unsigned char>>(v) == copy);
+}
+
+TEMPLATE_LIST_TEST_CASE("SharedMemorySegment - ManagedTree in shared memory",
+    "", TreeImpls) {
+  using Tree = obt::ManagedTree<TestType>;
+
+  string const name{segment_name("tree")};
+  obt::SharedMemorySegment::remove(name);
+  auto segment{obt::SharedMemorySegment::create(name, kSegmentSize)};
+  Tree* tree{segment.construct_root<Tree>(segment.allocator<Value>())};
+  deque<Value> list;
+
+  IndexRand rand{};
+  for (size_t i{0}; i < 1000; ++i) {
+    size_t index{rand(tree->size() + 1)};
+    tree->insert(tree->get_iterator_at_index(index), i);
+    list.insert(list.begin() + index, i);
+  }
+  for (size_t i{0}; i < 200; ++i) {
+    size_t index{rand(tree->size())};
+    tree->erase(tree->get_iterator_at_index(index));
+    list.erase(list.begin() + index);
+  }
+  REQUIRE(tree->size() == list.size());
+  CHECK(equal(tree->begin(), tree->end(), list.begin(), list.end()));
+
+  SECTION("second mapping in the same process") {
+    // The second mapping lives at a different address, so this only works
+    // if every pointer in the segment is relative.
+    auto other{obt::SharedMemorySegment::open(name)};
+    REQUIRE(other.address() != segment.address());
+    Tree* other_tree{other.template root<Tree>()};
+    REQUIRE(other_tree != tree);
+    REQUIRE(other_tree->size() == list.size());
+    CHECK(equal(other_tree->begin(), other_tree->end(),
+        list.begin(), list.end()));
+    for (size_t i{0}; i < list.size(); ++i) {
+      CHECK((*other_tree)[i] == list[i]);
+    }
+
+    // Modifications through one mapping are visible through the other.
+    other_tree->push_front(12345);
+    CHECK(tree->front() == 12345);
+  }
+
+  SECTION("index cache in the segment") {
+    tree->set_index_cache_capacity(64);
+    for (size_t i{0}; i < list.size(); ++i) {
+      REQUIRE((*tree)[i] == list[i]);
+    }
+    auto other{obt::SharedMemorySegment::open(name)};
+    Tree* other_tree{other.template root<Tree>()};
+    CHECK(other_tree->index_cache_capacity() == 64);
+    for (size_t i{0}; i < list.size(); ++i) {
+      REQUIRE((*other_tree)[i] == list[i]);
+    }
+    tree->set_index_cache_capacity(0);
+  }
+
+  SECTION("freed nodes are reused") {
+    size_t const used{segment.used()};
+    for (size_t i{0}; i < 200; ++i) {
+      tree->push_back(i);
+    }
+    CHECK(segment.used() == used);
+  }
+
+  SECTION("child process reads in place") {
+    pid_t const pid{fork()};
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      int status{0};
+      try {
+        auto child_segment{obt::SharedMemorySegment::open(name)};
+        Tree* child_tree{child_segment.template root<Tree>()};
+        shared_lock<obt::SharedRwLock> lock{child_segment.lock()};
+        if (child_tree->size() != list.size() ||
+            !equal(child_tree->begin(), child_tree->end(),
+              list.begin(), list.end())) {
+          status = 1;
+        }
+      } catch (...) {
+        status = 2;
+      }
+      _exit(status);
+    }
+    int status{0};
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+  }
+
+  segment.template destroy_root<Tree>();
+  obt::SharedMemorySegment::remove(name);
+}
+
+TEST_CASE("SharedRwLock - writer and reader processes") {
+  using Tree = obt::ManagedTree<obt::BasicTreeImpl<Value, Allocator>>;
+  static constexpr size_t kNumWrites{2000};
+  static constexpr size_t kNumReaders{2};
+
+  string const name{segment_name("lock")};
+  obt::SharedMemorySegment::remove(name);
+  auto segment{obt::SharedMemorySegment::create(name, kSegmentSize)};
+  Tree* tree{segment.construct_root<Tree>(segment.allocator<Value>())};
+
+  // Readers check that the tree is always `0, 1, ..., size - 1` while the
+  // writer keeps appending to it.
+  vector<pid_t> readers;
+  for (size_t r{0}; r < kNumReaders; ++r) {
+    pid_t const pid{fork()};
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      int status{0};
+      try {
+        auto reader_segment{obt::SharedMemorySegment::open(name)};
+        Tree* reader_tree{reader_segment.root<Tree>()};
+        size_t last_size{0};
+        while (last_size < kNumWrites) {
+          shared_lock<obt::SharedRwLock> lock{reader_segment.lock()};
+          size_t const size{reader_tree->size()};
+          if (size < last_size) {
+            status = 1;
+            break;
+          }
+          size_t expected{0};
+          for (Value value : *reader_tree) {
+            if (value != expected++) {
+              status = 1;
+            }
+          }
+          last_size = size;
+        }
+      } catch (...) {
+        status = 2;
+      }
+      _exit(status);
+    }
+    readers.push_back(pid);
+  }
+
+  for (size_t i{0}; i < kNumWrites; ++i) {
+    unique_lock<obt::SharedRwLock> lock{segment.lock()};
+    tree->push_back(i);
+  }
+
+  for (pid_t pid : readers) {
+    int status{0};
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+  }
+
+  segment.destroy_root<Tree>();
+  obt::SharedMemorySegment::remove(name);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+/**
+ *  @brief
+ *  Source of random indices with a fixed default seed, so that test runs
+ *    are reproducible.
+ */
+struct IndexRand {
+  std::mt19937_64 generator;
+  IndexRand(std::uint_fast64_t seed = 123456) : generator{seed} {}
+  std::size_t operator()(std::size_t modulus) {
+    return static_cast<std::size_t>(
+        generator() % static_cast<std::uint_fast64_t>(modulus));
+  }
+};
+
+/**
+ *  @brief
+ *  Checks that `sequence` holds the same elements as `list` through every
+ *    kind of iterator and through `operator[]`.
+ */
+template<class Sequence, class List>
+void check_sequence_equal(Sequence& sequence, List& list) {
+  REQUIRE(sequence.size() == list.size());
+  CHECK(std::equal(
+      sequence.begin(), sequence.end(), list.begin(), list.end()));
+  CHECK(std::equal(
+      sequence.cbegin(), sequence.cend(), list.cbegin(), list.cend()));
+  CHECK(std::equal(
+      sequence.rbegin(), sequence.rend(), list.rbegin(), list.rend()));
+  CHECK(std::equal(
+      sequence.crbegin(), sequence.crend(), list.crbegin(), list.crend()));
+  for (std::size_t i{0}; i < list.size(); ++i) {
+    CHECK(sequence[i] == list[i]);
+  }
+}
+
+/**
+ *  @brief
+ *  Runs `num_operations` random insertions, joins and erasures on an empty
+ *    `Sequence` of `std::size_t` and a `std::deque`, checking that they agree
+ *    after each one, then checks copies and moves of the result.
+ *
+ *  `setup(sequence)` is called once before the first operation, e.g., to
+ *    tune the sequence.
+ */
+template<class Sequence, class Setup>
+void check_random_sequence_operations(
+    std::size_t num_operations,
+    Setup setup) {
+  using Value = std::size_t;
+  Sequence sequence;
+  setup(sequence);
+  std::deque<Value> list;
+
+  static constexpr std::size_t kMaxBulkSize{40};
+
+  IndexRand rand{};
+
+  Value value{0};
+  for (std::size_t counter{0}; counter < num_operations; ++counter) {
+    std::size_t op{rand(sequence.empty() ? 3 : 7)};
+    switch (op) {
+      case 0: { // Insert an element at a random index.
+        std::size_t index{rand(sequence.size() + 1)};
+        list.insert(list.begin() + index, value);
+        auto it{sequence.emplace(
+            sequence.get_iterator_at_index(index), value)};
+        CHECK(it == sequence.get_iterator_at_index(index));
+        CHECK(*it == value);
+        ++value;
+        break;
+      }
+      case 1: { // Insert multiple elements at a random index.
+        std::size_t index{rand(sequence.size() + 1)};
+        std::size_t size{rand(kMaxBulkSize + 1)};
+        std::vector<Value> list_to_insert;
+        for (std::size_t j{0}; j < size; ++j) {
+          list_to_insert.push_back(value++);
+        }
+        list.insert(list.begin() + index,
+            list_to_insert.begin(), list_to_insert.end());
+        sequence.insert(sequence.get_iterator_at_index(index),
+            list_to_insert.begin(), list_to_insert.end());
+        break;
+      }
+      case 2: { // Join another sequence at a random index.
+        std::size_t index{rand(sequence.size() + 1)};
+        std::size_t size{rand(kMaxBulkSize + 1)};
+        Sequence sequence_to_insert;
+        for (std::size_t j{0}; j < size; ++j) {
+          sequence_to_insert.push_back(value++);
+        }
+        list.insert(list.begin() + index,
+            sequence_to_insert.begin(), sequence_to_insert.end());
+        sequence.join(
+            sequence.get_iterator_at_index(index), sequence_to_insert);
+        CHECK(sequence_to_insert.empty());
+        break;
+      }
+      case 3: { // Erase a random interval of elements.
+        std::size_t begin{rand(sequence.size() + 1)};
+        std::size_t length{rand(kMaxBulkSize)};
+        std::size_t end{std::min(begin + length, sequence.size())};
+        list.erase(list.begin() + begin, list.begin() + end);
+        auto it{sequence.erase(
+            sequence.get_iterator_at_index(begin),
+            sequence.get_iterator_at_index(end))};
+        CHECK(it == sequence.get_iterator_at_index(begin));
+        break;
+      }
+      case 4: { // Erase one element at a random index.
+        std::size_t index{rand(sequence.size())};
+        list.erase(list.begin() + index);
+        sequence.erase(sequence.get_iterator_at_index(index));
+        break;
+      }
+      case 5:
+        list.pop_front();
+        sequence.pop_front();
+        break;
+      case 6:
+        list.pop_back();
+        sequence.pop_back();
+        break;
+    }
+    check_sequence_equal(sequence, list);
+  }
+
+  // Copy and move.
+  Sequence sequence_a{sequence};
+  check_sequence_equal(sequence_a, list);
+  Sequence sequence_b{std::move(sequence_a)};
+  check_sequence_equal(sequence_b, list);
+  CHECK(sequence_a.empty());
+  sequence_a = sequence_b;
+  check_sequence_equal(sequence_a, list);
+  sequence_b.clear();
+  CHECK(sequence_b.empty());
+  sequence_b = std::move(sequence_a);
+  check_sequence_equal(sequence_b, list);
+}
+
+/**
+ *  @brief
+ *  `check_random_sequence_operations()` on a default-constructed `Sequence`.
+ */
+template<class Sequence>
+void check_random_sequence_operations(std::size_t num_operations) {
+  check_random_sequence_operations<Sequence>(
+      num_operations, [](Sequence&) {});
+}
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ordered_binary_trees/managed_tree.hpp>
+#include <ordered_binary_trees/tiered_vector_impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_utils.hpp"
+
+namespace obt = ordered_binary_trees;
+using namespace std;
+
+using Value = size_t;
+using Tree = obt::ManagedTree<obt::TieredVectorImpl<Value>>;
+
+TEST_CASE("TieredVector - iteration across blocks") {
+  Tree tree;
+  static constexpr size_t kLength{5000};
+  for (size_t i{0}; i < kLength; ++i) {
+    // Push to the front half of the time so that blocks wrap around.
+    if (i % 3 == 0) {
+      tree.push_front(i);
+    } else {
+      tree.push_back(i);
+    }
+  }
+  vector<Value> forward(tree.begin(), tree.end());
+  vector<Value> backward(tree.rbegin(), tree.rend());
+  reverse(backward.begin(), backward.end());
+  CHECK(forward == backward);
+
+  auto it{tree.end()};
+  for (size_t i{kLength}; i > 0; --i) {
+    --it;
+    CHECK(*it == forward[i - 1]);
+    CHECK(it - tree.begin() == static_cast<ptrdiff_t>(i - 1));
+  }
+  CHECK(it == tree.begin());
+  CHECK(tree.rend()[-1] == tree.front());
+  CHECK(tree.rbegin()[0] == tree.back());
+}
+